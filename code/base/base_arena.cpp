@@ -20,6 +20,10 @@
 # define CommitVirtualMemory OS_Commit
 #endif
 
+#ifndef DecommitVirtualMemory
+# define DecommitVirtualMemory OS_Decommit
+#endif
+
 internal arena *
 AllocArenaSize(u64 ReserveNotCommit)
 {
@@ -129,8 +133,10 @@ DeallocArena(arena *Arena)
  while (Node)
  {
   arena *Next = Node->Next;
+  void *Memory = Node->Memory;
+  u64 Capacity = Node->Capacity;
   StructZero(Node);
-  DeallocVirtualMemory(Node->Memory, Node->Capacity);
+  DeallocVirtualMemory(Memory, Capacity);
   Node = Next;
  }
 }
@@ -140,11 +146,29 @@ ClearArena(arena *Arena)
 {
  for (arena *Node = Arena; Node; Node = Node->Next)
  {
+  Node->PeakUsed = Max(Node->PeakUsed, Node->Used);
   Node->Used = SizeOf(arena);
  }
  Arena->Cur = Arena;
 }
 
+// NOTE(hbr): Clears the arena and gives all of its pages except the header back to the OS
+internal void
+DecommitArena(arena *Arena)
+{
+ ClearArena(Arena);
+ u64 KeepCommited = AlignForwardPow2(SizeOf(arena), 4096);
+ for (arena *Node = Arena; Node; Node = Node->Next)
+ {
+  if (Node->Commited > KeepCommited)
+  {
+   umm DecommitAt = Cast(umm)Node->Memory + KeepCommited;
+   DecommitVirtualMemory(Cast(void *)DecommitAt, Node->Commited - KeepCommited);
+   Node->Commited = KeepCommited;
+  }
+ }
+}
+
 internal temp_arena
 BeginTemp(arena *Arena)
 {
@@ -159,6 +183,33 @@ BeginTemp(arena *Arena)
 internal void
 EndTemp(temp_arena Temp)
 {
- ClearArena(Temp.Arena);
- Temp.Arena->Used = Temp.SavedUsed;
+ // NOTE(hbr): Arena might have grown past the block it was in when temp began
+ for (arena *Node = Temp.SavedCur->Next; Node; Node = Node->Next)
+ {
+  Node->PeakUsed = Max(Node->PeakUsed, Node->Used);
+  Node->Used = SizeOf(arena);
+ }
+ Temp.Arena->Cur = Temp.SavedCur;
+ Temp.SavedCur->PeakUsed = Max(Temp.SavedCur->PeakUsed, Temp.SavedCur->Used);
+ Temp.SavedCur->Used = Temp.SavedUsed;
+}
+
+// NOTE(hbr): High-water mark is only folded in when memory is given back (clear/end temp),
+// so take current usage into account as well
+internal arena_usage
+GetArenaUsage(arena *Arena)
+{
+ arena_usage Usage = {};
+ for (arena *Node = Arena; Node; Node = Node->Next)
+ {
+  u64 Used = Node->Used - SizeOf(arena);
+  u64 PeakUsed = Max(Node->PeakUsed, Node->Used) - SizeOf(arena);
+  Usage.Used += Used;
+  Usage.PeakUsed += PeakUsed;
+  Usage.Commited += Node->Commited;
+  Usage.Reserved += Node->Capacity;
+  ++Usage.BlockCount;
+ }
+ 
+ return Usage;
 }
\ No newline at end of file
@@ -17,14 +17,25 @@ struct arena
  arena *Cur;
  
  b32 Freed;
+ u32 Tag;
  
  void *Memory;
  u64 Used;
+ u64 PeakUsed;
  u64 Capacity;
  u64 Commited;
  u64 Align;
 };
 
+struct arena_usage
+{
+ u64 Used;
+ u64 PeakUsed;
+ u64 Commited;
+ u64 Reserved;
+ u32 BlockCount;
+};
+
 struct temp_arena
 {
  arena *Arena;
@@ -35,6 +46,8 @@ struct temp_arena
 internal arena *AllocArena(u64 ReserveButNotCommit);
 internal void   DeallocArena(arena *Arena);
 internal void   ClearArena(arena *Arena);
+internal void   DecommitArena(arena *Arena);
+internal arena_usage GetArenaUsage(arena *Arena);
 internal void * PushSize(arena *Arena, u64 Size);
 internal void * PushSizeNonZero(arena *Arena, u64 Size);
 #define         PushStruct(Arena, Type) Cast(Type *)PushSize(Arena, SizeOf(Type))
@@ -35,6 +35,37 @@ OS_Init(int ArgCount, char *Args[])
  OS_State.InstructionSetFlags = OS_InstructionSetSupport();
 }
 
+internal void
+OS_CPUSetAdd(os_cpu_set *Set, u32 CPU)
+{
+ if (CPU < OS_MaxCPUCount)
+ {
+  Set->Bits[CPU / 64] |= (1ull << (CPU % 64));
+ }
+}
+
+internal b32
+OS_CPUSetHas(os_cpu_set *Set, u32 CPU)
+{
+ b32 Result = false;
+ if (CPU < OS_MaxCPUCount)
+ {
+  Result = ((Set->Bits[CPU / 64] >> (CPU % 64)) & 1);
+ }
+ return Result;
+}
+
+internal u32
+OS_CPUSetCount(os_cpu_set *Set)
+{
+ u32 Result = 0;
+ for (u32 CPU = 0; CPU < OS_MaxCPUCount; ++CPU)
+ {
+  Result += (OS_CPUSetHas(Set, CPU) ? 1 : 0);
+ }
+ return Result;
+}
+
 internal os_info
 OS_Info(void)
 {
@@ -118,6 +118,7 @@ typedef OS_THREAD_FUNC(os_thread_func);
 internal os_thread_handle OS_ThreadLaunch(os_thread_func *Func, void *Data);
 internal void             OS_ThreadWait(os_thread_handle Thread);
 internal void             OS_ThreadRelease(os_thread_handle Thread);
+internal void             OS_ThreadYield(void);
 
 //- mutex
 internal void OS_MutexAlloc(os_mutex_handle *Mutex);
@@ -131,6 +132,11 @@ internal void OS_SemaphorePost(os_semaphore_handle *Sem);
 internal void OS_SemaphoreWait(os_semaphore_handle *Sem);
 internal void OS_SemaphoreDealloc(os_semaphore_handle *Sem);
 
+//- futex
+// NOTE(hbr): Sleeps only if *Value still equals Expected, can return spuriously
+internal void OS_FutexWait(u32 volatile *Value, u32 Expected);
+internal void OS_FutexWake(u32 volatile *Value, u32 WakeCount); // U32_MAX wakes everyone
+
 //- barrier
 internal void OS_BarrierAlloc(os_barrier_handle *Barrier, u32 ThreadCount);
 internal void OS_BarrierWait(os_barrier_handle *Barrier);
@@ -145,6 +151,41 @@ internal u32 OS_AtomicIncr32(u32 volatile *Value);
 internal u32 OS_AtomicAdd32(u32 volatile *Value, u32 Add);
 internal u32 OS_AtomicCmpExch32(u32 volatile *Value, u32 Cmp, u32 Exch);
 
+internal void OS_MemoryBarrier(void); // full fence, also orders stores before later loads
+
+//- cpu topology
+#define OS_MaxCPUCount 1024
+struct os_cpu_set
+{
+ u64 Bits[OS_MaxCPUCount / 64];
+};
+
+struct os_cpu
+{
+ u32 Index; // logical processor, the one affinity refers to
+ u32 Core; // physical core, unique across packages
+ u32 Package;
+ u32 Node; // NUMA node
+ b32 FirstSibling; // first hardware thread of its core
+ b32 Efficient; // efficiency core of a hybrid CPU
+};
+struct os_cpu_topology
+{
+ u32 CPUCount;
+ os_cpu *CPUs;
+ u32 CoreCount;
+ u32 PackageCount;
+ u32 NodeCount;
+};
+
+internal void            OS_CPUSetAdd(os_cpu_set *Set, u32 CPU);
+internal b32             OS_CPUSetHas(os_cpu_set *Set, u32 CPU);
+internal u32             OS_CPUSetCount(os_cpu_set *Set);
+// NOTE(hbr): Only processors this process is allowed to run on, ordered by index.
+// Returns zero CPUs when the topology can't be read.
+internal os_cpu_topology OS_CPUTopology(arena *Arena);
+internal void            OS_ThreadSetAffinity(os_cpu_set *Set); // calling thread
+
 //- instruction sets
 enum
 {
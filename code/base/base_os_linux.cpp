@@ -31,6 +31,8 @@ OS_Commit(void *Memory, u64 Size)
 internal void
 OS_Decommit(void *Memory, u64 Size)
 {
+ // NOTE(hbr): [mprotect] alone keeps the pages resident
+ madvise(Memory, Size, MADV_DONTNEED);
  mprotect(Memory, Size, PROT_NONE);
 }
 
@@ -418,6 +420,12 @@ OS_ThreadRelease(os_thread_handle Thread)
  pthread_detach(Thread);
 }
 
+internal void
+OS_ThreadYield(void)
+{
+ sched_yield();
+}
+
 internal void
 OS_MutexAlloc(os_mutex_handle *Mutex)
 {
@@ -474,6 +482,19 @@ OS_SemaphoreDealloc(os_semaphore_handle *Sem)
  Assert(Ret == 0);
 }
 
+internal void
+OS_FutexWait(u32 volatile *Value, u32 Expected)
+{
+ syscall(SYS_futex, Value, FUTEX_WAIT_PRIVATE, Expected, 0, 0, 0);
+}
+
+internal void
+OS_FutexWake(u32 volatile *Value, u32 WakeCount)
+{
+ int Count = Cast(int)Min(WakeCount, Cast(u32)I32_MAX);
+ syscall(SYS_futex, Value, FUTEX_WAKE_PRIVATE, Count, 0, 0, 0);
+}
+
 internal void
 OS_BarrierAlloc(os_barrier_handle *Barrier, u32 ThreadCount)
 {
@@ -536,6 +557,12 @@ OS_AtomicCmpExch32(u32 volatile *Value, u32 Cmp, u32 Exch)
  return Result;
 }
 
+internal inline void
+OS_MemoryBarrier(void)
+{
+ __sync_synchronize();
+}
+
 internal inline u64
 OS_ReadCPUTimer(void)
 {
@@ -636,6 +663,212 @@ OS_ProcCount(void)
  return Result;
 }
 
+//- cpu topology
+// NOTE(hbr): sysfs files report 4096 bytes of size no matter the contents, read until EOF
+internal string
+LinuxReadSysFile(arena *Arena, string Path)
+{
+ string Result = {};
+ string CPath = CStrFromStr(Arena, Path);
+ int File = open(CPath.Data, O_RDONLY);
+ if (File >= 0)
+ {
+  u64 Capacity = 4096;
+  char *Data = PushArrayNonZero(Arena, Capacity, char);
+  ssize_t Read = read(File, Data, Capacity);
+  if (Read > 0)
+  {
+   Result = MakeStr(Data, Cast(u64)Read);
+   while (Result.Count > 0 && CharIsWhiteSpace(Result.Data[Result.Count - 1]))
+   {
+    --Result.Count;
+   }
+  }
+  close(File);
+ }
+ 
+ return Result;
+}
+
+internal b32
+LinuxReadSysU32(arena *Arena, string Path, u32 *Out)
+{
+ string Contents = LinuxReadSysFile(Arena, Path);
+ b32 Result = U32FromStr(Contents, Out);
+ return Result;
+}
+
+// NOTE(hbr): Kernel cpu list format, e.g. "0-3,8,10-11"
+internal b32
+LinuxReadSysCPUList(arena *Arena, string Path, os_cpu_set *Set)
+{
+ string Contents = LinuxReadSysFile(Arena, Path);
+ b32 Result = (Contents.Count > 0);
+ u64 At = 0;
+ while (At < Contents.Count && Result)
+ {
+  u64 RangeEnd = At;
+  u64 Dash = 0;
+  while (RangeEnd < Contents.Count && Contents.Data[RangeEnd] != ',')
+  {
+   if (Contents.Data[RangeEnd] == '-')
+   {
+    Dash = RangeEnd;
+   }
+   ++RangeEnd;
+  }
+  
+  u32 First = 0;
+  u32 Last = 0;
+  if (Dash)
+  {
+   Result = (U32FromStr(StrSubstr(Contents, At, Dash - At), &First) &&
+             U32FromStr(StrSubstr(Contents, Dash + 1, RangeEnd - Dash - 1), &Last));
+  }
+  else
+  {
+   Result = U32FromStr(StrSubstr(Contents, At, RangeEnd - At), &First);
+   Last = First;
+  }
+  if (Result)
+  {
+   for (u32 CPU = First; CPU <= Last && CPU < OS_MaxCPUCount; ++CPU)
+   {
+    OS_CPUSetAdd(Set, CPU);
+   }
+  }
+  
+  At = RangeEnd + 1;
+ }
+ 
+ return Result;
+}
+
+internal os_cpu_topology
+OS_CPUTopology(arena *Arena)
+{
+ os_cpu_topology Result = {};
+ 
+ cpu_set_t Allowed = {};
+ if (sched_getaffinity(0, SizeOf(Allowed), &Allowed) == 0)
+ {
+  u32 AllowedCount = Cast(u32)CPU_COUNT(&Allowed);
+  Result.CPUs = PushArray(Arena, AllowedCount, os_cpu);
+  
+  temp_arena Temp = TempArena(Arena);
+  u32 *CoreIDs = PushArrayNonZero(Temp.Arena, AllowedCount, u32);
+  u32 *Capacities = PushArrayNonZero(Temp.Arena, AllowedCount, u32);
+  u32 MaxCapacity = 0;
+  
+  // NOTE(hbr): Intel hybrid CPUs list their E-cores here
+  os_cpu_set AtomCPUs = {};
+  b32 Hybrid = LinuxReadSysCPUList(Temp.Arena, StrLit("/sys/devices/cpu_atom/cpus"), &AtomCPUs);
+  
+  os_cpu_set OnlineNodes = {};
+  LinuxReadSysCPUList(Temp.Arena, StrLit("/sys/devices/system/node/online"), &OnlineNodes);
+  
+  for (u32 CPU = 0;
+       CPU < CPU_SETSIZE && CPU < OS_MaxCPUCount && Result.CPUCount < AllowedCount;
+       ++CPU)
+  {
+   if (CPU_ISSET(CPU, &Allowed))
+   {
+    u32 CPUIndex = Result.CPUCount++;
+    os_cpu *Cpu = Result.CPUs + CPUIndex;
+    Cpu->Index = CPU;
+    
+    u32 CoreID = CPU;
+    u32 Package = 0;
+    LinuxReadSysU32(Temp.Arena, StrF(Temp.Arena, "/sys/devices/system/cpu/cpu%u/topology/core_id", CPU), &CoreID);
+    LinuxReadSysU32(Temp.Arena, StrF(Temp.Arena, "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", CPU), &Package);
+    Cpu->Package = Package;
+    CoreIDs[CPUIndex] = CoreID;
+    
+    // NOTE(hbr): cpu_capacity exists on ARM and on newer kernels for hybrid x86,
+    // max frequency is the best guess otherwise
+    u32 Capacity = 0;
+    if (!LinuxReadSysU32(Temp.Arena, StrF(Temp.Arena, "/sys/devices/system/cpu/cpu%u/cpu_capacity", CPU), &Capacity))
+    {
+     LinuxReadSysU32(Temp.Arena, StrF(Temp.Arena, "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq", CPU), &Capacity);
+    }
+    Capacities[CPUIndex] = Capacity;
+    MaxCapacity = Max(MaxCapacity, Capacity);
+    
+    // NOTE(hbr): Hardware threads of the same core share core_id within a package
+    Cpu->Core = Result.CoreCount;
+    Cpu->FirstSibling = true;
+    for (u32 PrevIndex = 0; PrevIndex < CPUIndex; ++PrevIndex)
+    {
+     os_cpu *Prev = Result.CPUs + PrevIndex;
+     if (Prev->Package == Package && CoreIDs[PrevIndex] == CoreID)
+     {
+      Cpu->Core = Prev->Core;
+      Cpu->FirstSibling = false;
+      break;
+     }
+    }
+    if (Cpu->FirstSibling)
+    {
+     ++Result.CoreCount;
+    }
+    
+    Result.PackageCount = Max(Result.PackageCount, Package + 1);
+   }
+  }
+  
+  for (u32 Node = 0; Node < OS_MaxCPUCount; ++Node)
+  {
+   if (OS_CPUSetHas(&OnlineNodes, Node))
+   {
+    os_cpu_set NodeCPUs = {};
+    LinuxReadSysCPUList(Temp.Arena, StrF(Temp.Arena, "/sys/devices/system/node/node%u/cpulist", Node), &NodeCPUs);
+    ForEachIndex(CPUIndex, Result.CPUCount)
+    {
+     os_cpu *Cpu = Result.CPUs + CPUIndex;
+     if (OS_CPUSetHas(&NodeCPUs, Cpu->Index))
+     {
+      Cpu->Node = Node;
+     }
+    }
+   }
+  }
+  
+  ForEachIndex(CPUIndex, Result.CPUCount)
+  {
+   os_cpu *Cpu = Result.CPUs + CPUIndex;
+   if (Hybrid)
+   {
+    Cpu->Efficient = OS_CPUSetHas(&AtomCPUs, Cpu->Index);
+   }
+   else
+   {
+    // NOTE(hbr): Leave some slack, P-cores differ slightly in max frequency too
+    Cpu->Efficient = (Cast(u64)Capacities[CPUIndex] * 10 < Cast(u64)MaxCapacity * 8);
+   }
+   Result.NodeCount = Max(Result.NodeCount, Cpu->Node + 1);
+  }
+  
+  EndTemp(Temp);
+ }
+ 
+ return Result;
+}
+
+internal void
+OS_ThreadSetAffinity(os_cpu_set *Set)
+{
+ cpu_set_t Affinity = {};
+ CPU_ZERO(&Affinity);
+ for (u32 CPU = 0; CPU < CPU_SETSIZE && CPU < OS_MaxCPUCount; ++CPU)
+ {
+  if (OS_CPUSetHas(Set, CPU))
+  {
+   CPU_SET(CPU, &Affinity);
+  }
+ }
+ pthread_setaffinity_np(pthread_self(), SizeOf(Affinity), &Affinity);
+}
+
 internal inline u32
 OS_PageSize(void)
 {
@@ -15,6 +15,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
 #include <semaphore.h>
 #include <dirent.h>
 #include <fcntl.h>
@@ -28,6 +29,8 @@
 #include <sys/sysinfo.h>
 #include <sys/wait.h>
 #include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 typedef int os_file_handle;
 typedef void *os_library_handle;
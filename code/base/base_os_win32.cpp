@@ -32,7 +32,7 @@ OS_Commit(void *Memory, u64 Size)
 internal void
 OS_Decommit(void *Memory, u64 Size)
 {
- VirtualAlloc(Memory, Size, MEM_RESET, PAGE_NOACCESS);
+ VirtualFree(Memory, Size, MEM_DECOMMIT);
 }
 
 internal date_time
@@ -456,6 +456,12 @@ OS_ThreadRelease(os_thread_handle Thread)
  CloseHandle(Thread);
 }
 
+internal void
+OS_ThreadYield(void)
+{
+ SwitchToThread();
+}
+
 inline internal void
 OS_MutexAlloc(os_mutex_handle *Mutex)
 {
@@ -540,6 +546,35 @@ OS_AtomicCmpExch32(u32 volatile *Value, u32 Cmp, u32 Exch)
  return InterlockedCompareExchange(Cast(LONG volatile *)Value, Exch, Cmp);
 }
 
+inline internal void
+OS_MemoryBarrier(void)
+{
+ MemoryBarrier();
+}
+
+internal void
+OS_FutexWait(u32 volatile *Value, u32 Expected)
+{
+ WaitOnAddress(Value, &Expected, SizeOf(Expected), INFINITE);
+}
+
+internal void
+OS_FutexWake(u32 volatile *Value, u32 WakeCount)
+{
+ if (WakeCount == U32_MAX)
+ {
+  WakeByAddressAll(Cast(void *)Value);
+ }
+ else
+ {
+  // NOTE(hbr): There is no wake N, every call wakes at most one waiter
+  for (u32 WakeIndex = 0; WakeIndex < WakeCount; ++WakeIndex)
+  {
+   WakeByAddressSingle(Cast(void *)Value);
+  }
+ }
+}
+
 inline internal void
 OS_BarrierAlloc(os_barrier_handle *Barrier, u32 ThreadCount)
 {
@@ -672,6 +707,95 @@ OS_ProcCount(void)
  return Result;
 }
 
+//- cpu topology
+// NOTE(hbr): Only the first processor group (up to 64 logical processors) is handled.
+// Efficiency classes would need GetLogicalProcessorInformationEx, every core is treated
+// as a performance core for now.
+internal os_cpu_topology
+OS_CPUTopology(arena *Arena)
+{
+ os_cpu_topology Result = {};
+ 
+ DWORD_PTR ProcessMask = 0;
+ DWORD_PTR SystemMask = 0;
+ DWORD Size = 0;
+ GetLogicalProcessorInformation(0, &Size);
+ if (GetProcessAffinityMask(GetCurrentProcess(), &ProcessMask, &SystemMask) && Size > 0)
+ {
+  temp_arena Temp = TempArena(Arena);
+  SYSTEM_LOGICAL_PROCESSOR_INFORMATION *Infos = Cast(SYSTEM_LOGICAL_PROCESSOR_INFORMATION *)PushSizeNonZero(Temp.Arena, Size);
+  u32 InfoCount = Size / SizeOf(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+  if (GetLogicalProcessorInformation(Infos, &Size))
+  {
+   u32 AllowedCount = 0;
+   for (u32 CPU = 0; CPU < 64; ++CPU)
+   {
+    AllowedCount += ((ProcessMask >> CPU) & 1);
+   }
+   Result.CPUs = PushArray(Arena, AllowedCount, os_cpu);
+   for (u32 CPU = 0; CPU < 64; ++CPU)
+   {
+    if ((ProcessMask >> CPU) & 1)
+    {
+     os_cpu *Cpu = Result.CPUs + Result.CPUCount++;
+     Cpu->Index = CPU;
+    }
+   }
+   
+   u32 PackageIndex = 0;
+   ForEachIndex(InfoIndex, InfoCount)
+   {
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION *Info = Infos + InfoIndex;
+    b32 AnyCPU = false;
+    b32 FirstSibling = true;
+    ForEachIndex(CPUIndex, Result.CPUCount)
+    {
+     os_cpu *Cpu = Result.CPUs + CPUIndex;
+     if ((Info->ProcessorMask >> Cpu->Index) & 1)
+     {
+      switch (Info->Relationship)
+      {
+       case RelationProcessorCore: {
+        Cpu->Core = Result.CoreCount;
+        Cpu->FirstSibling = FirstSibling;
+        FirstSibling = false;
+       }break;
+       case RelationProcessorPackage: {Cpu->Package = PackageIndex;}break;
+       case RelationNumaNode: {Cpu->Node = Info->NumaNode.NodeNumber;}break;
+       default: {}break;
+      }
+      AnyCPU = true;
+     }
+    }
+    if (AnyCPU && Info->Relationship == RelationProcessorCore)
+    {
+     ++Result.CoreCount;
+    }
+    if (Info->Relationship == RelationProcessorPackage)
+    {
+     ++PackageIndex;
+    }
+   }
+   
+   Result.PackageCount = PackageIndex;
+   ForEachIndex(CPUIndex, Result.CPUCount)
+   {
+    Result.NodeCount = Max(Result.NodeCount, Result.CPUs[CPUIndex].Node + 1);
+   }
+  }
+  EndTemp(Temp);
+ }
+ 
+ return Result;
+}
+
+internal void
+OS_ThreadSetAffinity(os_cpu_set *Set)
+{
+ DWORD_PTR Mask = Cast(DWORD_PTR)Set->Bits[0];
+ SetThreadAffinityMask(GetCurrentThread(), Mask);
+}
+
 internal u32
 OS_PageSize(void)
 {
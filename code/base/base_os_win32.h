@@ -15,6 +15,7 @@
 #include <intrin.h>
 #include <Shlobj.h>
 #pragma comment(lib, "shell32")
+#pragma comment(lib, "synchronization") // WaitOnAddress,...
 
 typedef HANDLE os_file_handle;
 typedef HMODULE os_library_handle;
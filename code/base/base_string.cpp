@@ -894,6 +894,27 @@ StrIsEmpty(string S)
  return Result;
 }
 
+internal b32
+U32FromStr(string S, u32 *Out)
+{
+ b32 Valid = (S.Count > 0);
+ u64 Value = 0;
+ for (u64 Index = 0;
+      Index < S.Count && Valid;
+      ++Index)
+ {
+  char C = S.Data[Index];
+  Value = 10 * Value + (C - '0');
+  Valid = (CharIsDigit(C) && Value <= U32_MAX);
+ }
+ if (Valid)
+ {
+  *Out = Cast(u32)Value;
+ }
+ 
+ return Valid;
+}
+
 internal string
 PathChopLastPart(string Str)
 {
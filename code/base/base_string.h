@@ -103,6 +103,7 @@ internal string_list StrSplit(arena *Arena, string Split, string On);
 internal b32         StrContains(string S, string Sub);
 internal string      StrSubstr(string S, u64 Pos, u64 Count);
 internal b32         StrIsEmpty(string S);
+internal b32         U32FromStr(string S, u32 *Out); // whole string has to be a decimal number
 
 //- path manipulation
 internal string      PathChopLastPart(string Path);
@@ -196,6 +196,37 @@ Stubs_Compilation(arena *Arena, build_platform BuildPlatform)
  return Target;
 }
 
+internal compilation_target
+Bench_Compilation(arena *Arena, b32 BuildBench, string STB_Output)
+{
+ compilation_target Target = {};
+ if (BuildBench)
+ {
+  // NOTE(hbr): Headless executable that includes whole editor unity build and benchmarks
+  // curve evaluation kernels. No window, renderer or ImGui backend is needed.
+  Target = MakeTarget(Target_Exe, OS_ExecutableRelativeToFullPath(Arena, StrLit("../code/editor_bench.cpp")), 0);
+  
+  operating_system OS = DetectOS();
+  switch (OS)
+  {
+   case OS_Win32: {
+    LinkLibrary(&Target, StrLit("User32.lib")); // MessageBoxA,...
+    LinkLibrary(&Target, StrLit("Comdlg32.lib")); // GetOpenFileName,...
+    LinkLibrary(&Target, StrLit("Shell32.lib")); // SHGetKnownFolderPath,...
+   }break;
+   
+   case OS_Linux: {
+    LinkLibrary(&Target, StrLit("pthread"));
+   }break;
+  }
+  
+  DefineHotReloadMacro(&Target, false);
+  StaticLink(&Target, STB_Output);
+ }
+ 
+ return Target;
+}
+
 internal string
 SmallU32ToStr(u32 N)
 {
@@ -232,7 +263,7 @@ internal exit_code_int
 CompileEditor(process_queue *ProcessQueue, compiler_choice Compiler,
               b32 Debug, b32 ForceRecompile,
               b32 Verbose, b32 GenerateDebuggerInfo,
-              b32 DevBuild)
+              b32 DevBuild, b32 BuildBench)
 {
  exit_code_int ExitCode = 0;
  temp_arena Temp = TempArena(0);
@@ -274,6 +305,8 @@ CompileEditor(process_queue *ProcessQueue, compiler_choice Compiler,
  compilation_target Editor = Editor_Compilation(Temp.Arena, BuildForHotReloading, STB_Output);
  string EditorOutput = ComputeCompilationTargetOutput(Setup, Editor).OutputTarget;
  
+ compilation_target Bench = Bench_Compilation(Temp.Arena, BuildBench, STB_Output);
+ 
  compilation_target PlatformExe = PlatformExe_Compilation(Temp.Arena, BuildForHotReloading,
                                                           EditorOutput, RendererOutput,
                                                           ImGuiOutput, GLFW_Output,
@@ -318,6 +351,7 @@ CompileEditor(process_queue *ProcessQueue, compiler_choice Compiler,
  
  ExitCode = OS_CombineExitCodes(ExitCode, OS_ProcessWait(STBProcess));
  os_process_handle EditorProcess = Compile(Setup, Editor);
+ os_process_handle BenchProcess = Compile(Setup, Bench);
  
  ExitCode = OS_CombineExitCodes(ExitCode, OS_ProcessWait(ImGuiProcess));
  ExitCode = OS_CombineExitCodes(ExitCode, OS_ProcessWait(StubsProcess));
@@ -330,6 +364,7 @@ CompileEditor(process_queue *ProcessQueue, compiler_choice Compiler,
  EnqueueProcess(ProcessQueue, EditorProcess);
  EnqueueProcess(ProcessQueue, RendererProcess);
  EnqueueProcess(ProcessQueue, PlatformExeProcess);
+ EnqueueProcess(ProcessQueue, BenchProcess);
  
  EndTemp(Temp);
  
@@ -356,6 +391,7 @@ int main(int ArgCount, char *Args[])
   b32 Verbose = false;
   b32 GenerateDebuggerInfo = false;
   b32 DevBuild = false;
+  b32 BuildBench = false;
   compiler_choice Compiler = Compiler_Default;
   for (int ArgIndex = 1;
        ArgIndex < ArgCount;
@@ -402,6 +438,10 @@ int main(int ArgCount, char *Args[])
    {
     DevBuild = true;
    }
+   if (StrMatch(Arg, StrLit("bench"), true))
+   {
+    BuildBench = true;
+   }
   }
   if (!Debug && !Release)
   {
@@ -412,12 +452,12 @@ int main(int ArgCount, char *Args[])
   process_queue ProcessQueue = {};
   if (Debug)
   {
-   exit_code_int SubProcessExitCode = CompileEditor(&ProcessQueue, Compiler, true, ForceRecompile, Verbose, GenerateDebuggerInfo, DevBuild);
+   exit_code_int SubProcessExitCode = CompileEditor(&ProcessQueue, Compiler, true, ForceRecompile, Verbose, GenerateDebuggerInfo, DevBuild, BuildBench);
    ExitCode = OS_CombineExitCodes(ExitCode, SubProcessExitCode);
   }
   if (Release)
   {
-   exit_code_int SubProcessExitCode = CompileEditor(&ProcessQueue, Compiler, false, ForceRecompile, Verbose, GenerateDebuggerInfo, DevBuild);
+   exit_code_int SubProcessExitCode = CompileEditor(&ProcessQueue, Compiler, false, ForceRecompile, Verbose, GenerateDebuggerInfo, DevBuild, BuildBench);
    ExitCode = OS_CombineExitCodes(ExitCode, SubProcessExitCode);
   }
   
@@ -41,27 +41,14 @@ MovePointAlongCurve(curve *Curve, v2 *TranslateInput, f32 *PointFractionInput, b
  
  u32 SampleCount = Curve->CurveSampleCount;
  v2 *Samples = Curve->CurveSamples;
- f32 *Ts = Curve->Ts;
- //f32 DeltaFraction = 1.0f / (SampleCount - 1);
  
- u32 PointIndex = 0;
- if (Forward)
+ // NOTE(hbr): Start from the sample just before Fraction when moving forward,
+ // or from the one just after it when moving backward.
+ u32 PointIndex = CurveSampleIndexAtT(Curve, Fraction);
+ if (!Forward && PointIndex + 1 < SampleCount && CurveSampleT(Curve, PointIndex) < Fraction)
  {
-  while (PointIndex < SampleCount && Ts[PointIndex + 1] <= Fraction)
-  {
-   ++PointIndex;
-  }
- }
- else
- {
-  while (PointIndex + 1 < SampleCount && Ts[PointIndex] < Fraction)
-  {
-   ++PointIndex;
-  }
+  ++PointIndex;
  }
- 
- //f32 PointIndexFloat = Fraction * (SampleCount - 1);
- //u32 PointIndex = Cast(u32)(Forward ? FloorF32(PointIndexFloat) : CeilF32(PointIndexFloat));
  PointIndex = ClampTop(PointIndex, SampleCount - 1);
  
  i32 DirSign = (Forward ? 1 : -1);
@@ -83,7 +70,7 @@ MovePointAlongCurve(curve *Curve, v2 *TranslateInput, f32 *PointFractionInput, b
    f32 InvAlongCurveLength = 1.0f / AlongCurveLength;
    f32 Projection = Clamp01(Dot(AlongCurve, Translate) * InvAlongCurveLength * InvAlongCurveLength);
    
-   f32 DeltaFraction = Ts[PointIndex] - Ts[PrevPointIndex];
+   f32 DeltaFraction = CurveSampleT(Curve, PointIndex) - CurveSampleT(Curve, PrevPointIndex);
    
    Translate -= Projection * AlongCurve;
    Fraction += Projection * DeltaFraction;
@@ -234,7 +221,7 @@ UpdateAndRenderDegreeReductionUI(editor *Editor, entity_with_modify_witness *Wit
     case CurveDegreeReductionMethod_InverseDegreeElevation: {}break;
     
     case CurveDegreeReductionMethod_UniformNormOptimal: {
-     curve_points_static *Points = GetCurvePoints(Curve);
+     curve_points *Points = GetCurvePoints(Curve);
      u32 PointCount = Points->ControlPointCount;
      f32 *Weights = Points->ControlPointWeights;
      
@@ -267,15 +254,15 @@ UpdateAndRenderDegreeReductionUI(editor *Editor, entity_with_modify_witness *Wit
      UI_Tooltip(DisabledMsg);
     }
     
-    curve_points_static *Points = GetCurvePoints(Curve);
+    curve_points *Points = GetCurvePoints(Curve);
     u32 PointCount = Points->ControlPointCount;
     
     if (Reduce && PointCount > 0)
     {    
-     begin_modify_curve_points_static_tracked_result Modify = BeginModifyCurvePointsTracked(Editor,
-                                                                                            Witness,
-                                                                                            PointCount - 1,
-                                                                                            ModifyCurvePointsWhichPoints_ControlPointsAndWeights);
+     begin_modify_curve_points_tracked_result Modify = BeginModifyCurvePointsTracked(Editor,
+                                                                                     Witness,
+                                                                                     PointCount - 1,
+                                                                                     ModifyCurvePointsWhichPoints_ControlPointsAndWeights);
      curve_points_modify_handle ModifyPoints = Modify.ModifyPoints;
      tracked_action *ModifyAction = Modify.ModifyAction;
      b32 ReductionSuccess = false;
@@ -284,8 +271,8 @@ UpdateAndRenderDegreeReductionUI(editor *Editor, entity_with_modify_witness *Wit
      {
       case CurveDegreeReductionMethod_InverseDegreeElevation: {
        
-       curve_points_static *OriginalPoints = PushStructNonZero(Reduction->Arena, curve_points_static);
-       CopyCurvePointsFromCurve(Curve, CurvePointsDynamicFromStatic(OriginalPoints));
+       curve_points *OriginalPoints = PushStructNonZero(Reduction->Arena, curve_points);
+       CopyCurvePointsToArena(Reduction->Arena, OriginalPoints, CurvePointsHandleFromCurvePoints(GetCurvePoints(Curve)));
        
        bezier_lower_degree_inverse_degree_elevation InverseElevation =
         BezierCurveLowerDegreeUsingInverseDegreeElevation(ModifyPoints.ControlPoints,
@@ -373,9 +360,9 @@ UpdateAndRenderDegreeReductionUI(editor *Editor, entity_with_modify_witness *Wit
    
    if (Revert)
    {
-    curve_points_static *Points = Reduction->OriginalCurvePoints;
+    curve_points *Points = Reduction->OriginalCurvePoints;
     Assert(Points);
-    SetCurvePointsTracked(Editor, Witness, CurvePointsHandleFromCurvePointsStatic(Points));
+    SetCurvePointsTracked(Editor, Witness, CurvePointsHandleFromCurvePoints(Points));
    }
    
    if (Accept || Revert)
@@ -419,10 +406,11 @@ RenderEntity(rendering_entity_handle Handle)
    
    if (CurveParams->DrawParams.Line.Enabled)
    {
+    vertex_array CurveVertices = CurveLODVertices(Entity, Handle.CurveLODLevel);
     PushVertexArray(RenderGroup,
-                    Curve->CurveVertices.Vertices,
-                    Curve->CurveVertices.VertexCount,
-                    Curve->CurveVertices.Primitive,
+                    CurveVertices.Vertices,
+                    CurveVertices.VertexCount,
+                    CurveVertices.Primitive,
                     Curve->Params.DrawParams.Line.Color,
                     GetCurvePartVisibilityZOffset(CurvePartVisibility_CurveLine));
    }
@@ -499,7 +487,7 @@ RenderEntity(rendering_entity_handle Handle)
                 GetCurvePartVisibilityZOffset(CurvePartVisibility_CubicBezierHelperPoints));
     }
     
-    curve_points_static *Points = GetCurvePoints(Curve);
+    curve_points *Points = GetCurvePoints(Curve);
     u32 ControlPointCount = Points->ControlPointCount;
     v2 *ControlPoints = Points->ControlPoints;
     for (u32 PointIndex = 0;
@@ -519,7 +507,7 @@ RenderEntity(rendering_entity_handle Handle)
    
    if (AreBSplineKnotsVisible(Curve))
    {
-    u32 PartitionSize = GetBSplineParams(Curve).KnotParams.PartitionSize;
+    u32 PartitionSize = Curve->BSplinePartitionKnotCount;
     v2 *PartitionKnotPoints = Curve->BSplinePartitionKnots;
     b_spline_params BSpline = CurveParams->BSpline;
     point_draw_info KnotPointInfo = GetBSplinePartitionKnotPointDrawInfo(Entity);
@@ -674,12 +662,16 @@ ComputeAnimationSamples(arena *Arena, animating_curves_state *Animation)
   };
   f32 MappedT = BezierCurveEvaluate(Animation->Bouncing.T, Points, 4).Y;
   
-  v2 *CurveSamples0 = Curve0->CurveSamples;
-  v2 *CurveSamples1 = Curve1->CurveSamples;
-  
   u32 CurveSampleCount0 = Curve0->CurveSampleCount;
   u32 CurveSampleCount1 = Curve1->CurveSampleCount;
   
+  f32 TotalLength0 = Curve0->ArcLength.TotalLength;
+  f32 TotalLength1 = Curve1->ArcLength.TotalLength;
+  b32 Reversed0 = IsCurveReversed(Entity0);
+  b32 Reversed1 = IsCurveReversed(Entity1);
+  curve_arc_length_cursor Cursor0 = {};
+  curve_arc_length_cursor Cursor1 = {};
+  
   // TODO(hbr): Multithread this
   // TODO(hbr): Use max instead
   u32 CurveSampleCount = Min(CurveSampleCount0, CurveSampleCount1);
@@ -688,14 +680,15 @@ ComputeAnimationSamples(arena *Arena, animating_curves_state *Animation)
        LinePointIndex < CurveSampleCount;
        ++LinePointIndex)
   {
-   u32 LinePointIndex0 = ClampTop(SafeDiv0(CurveSampleCount0 * LinePointIndex, CurveSampleCount - 1), CurveSampleCount0 - 1);
-   u32 LinePointIndex1 = ClampTop(SafeDiv0(CurveSampleCount1 * LinePointIndex, CurveSampleCount - 1), CurveSampleCount1 - 1);
-   
-   if (IsCurveReversed(Entity0)) LinePointIndex0 = (CurveSampleCount0-1 - LinePointIndex0);
-   if (IsCurveReversed(Entity1)) LinePointIndex1 = (CurveSampleCount1-1 - LinePointIndex1);
+   // NOTE(hbr): Pair points at the same fraction of arc length, not of sample index.
+   // Samples are not spread evenly along the curve, that would make both curves
+   // move at uneven speeds and get the intermediate curve distorted.
+   f32 Fraction = SafeDiv0(Cast(f32)LinePointIndex, (CurveSampleCount - 1));
+   f32 Fraction0 = (Reversed0 ? 1.0f - Fraction : Fraction);
+   f32 Fraction1 = (Reversed1 ? 1.0f - Fraction : Fraction);
    
-   v2 PointLocal0 = CurveSamples0[LinePointIndex0];
-   v2 PointLocal1 = CurveSamples1[LinePointIndex1];
+   v2 PointLocal0 = CurvePointAtArcLength(Curve0, Fraction0 * TotalLength0, &Cursor0);
+   v2 PointLocal1 = CurvePointAtArcLength(Curve1, Fraction1 * TotalLength1, &Cursor1);
    
    v2 Point0 = LocalToWorldEntityPosition(Entity0, PointLocal0);
    v2 Point1 = LocalToWorldEntityPosition(Entity1, PointLocal1);
@@ -707,8 +700,8 @@ ComputeAnimationSamples(arena *Arena, animating_curves_state *Animation)
   
   if (!Animation->ExtractedCurveDetailCustom)
   {
-   curve_points_static *Points0 = GetCurvePoints(Curve0);
-   curve_points_static *Points1 = GetCurvePoints(Curve1);
+   curve_points *Points0 = GetCurvePoints(Curve0);
+   curve_points *Points1 = GetCurvePoints(Curve1);
    Animation->ExtractedCurveDetail = Max(Points0->ControlPointCount, Points1->ControlPointCount);
   }
   
@@ -805,6 +798,25 @@ UpdateAndRenderEntities(editor *Editor, render_group *RenderGroup)
  ProfileFunctionBegin();
  
  entity_array Entities = AllEntityArrayFromStore(Editor->EntityStore);
+ 
+ // NOTE(hbr): Curves sampled with tolerance in pixels are refined (or coarsened) lazily,
+ // only once the camera zoomed far enough from what they were sampled for
+ f32 WorldUnitsPerPixel = PixelLengthToWorldSpace(RenderGroup, 1.0f);
+ BeginCurveRecomputeBatch();
+ ForEachIndex(EntityIndex, Entities.Count)
+ {
+  entity *Entity = Entities.Entities[EntityIndex];
+  if (IsEntityVisible(Entity) &&
+      Entity->Type == Entity_Curve &&
+      ShouldRetessellateCurveForZoom(&Entity->Curve, WorldUnitsPerPixel))
+  {
+   entity_with_modify_witness Witness = BeginEntityModify(Entity);
+   MarkEntityModified(&Witness);
+   EndEntityModify(Witness);
+  }
+ }
+ EndCurveRecomputeBatch();
+ 
  for (u32 EntityIndex = 0;
       EntityIndex < Entities.Count;
       ++EntityIndex)
@@ -813,6 +825,10 @@ UpdateAndRenderEntities(editor *Editor, render_group *RenderGroup)
   if (IsEntityVisible(Entity))
   {
    rendering_entity_handle Handle = BeginRenderingEntity(Entity, RenderGroup);
+   if (Entity->Type == Entity_Curve)
+   {
+    Handle.CurveLODLevel = PickCurveLODLevel(Entity, RenderGroup);
+   }
    
    RenderEntity(Handle);
    UpdateAndRenderPointTracking(Handle);
@@ -983,31 +999,32 @@ FocusCameraOnEntity(camera *Camera, entity *Entity, render_group *RenderGroup)
  }
 }
 
+// NOTE(hbr): Returns whether width/radius changed, that is the only thing baked into
+// computed vertices. Enabled and color are read when rendering.
 internal b32
 RenderDrawParamsUI(string Label, draw_params *Params, draw_params *Default, b32 IsPoint)
 {
- b32 Changed = false;
+ b32 FloatChanged = false;
  UI_Label(Label)
  {
   UI_Checkbox(&Params->Enabled, NilStr);
   UI_SameRow();
   UI_SeparatorText(Label);
   
-  Changed |= UI_DragFloat(&Params->Float, 0.0f, FLT_MAX, 0, (IsPoint ? StrLit("Radius") : StrLit("Width")));
+  FloatChanged |= UI_DragFloat(&Params->Float, 0.0f, FLT_MAX, 0, (IsPoint ? StrLit("Radius") : StrLit("Width")));
   if (ResetCtxMenu(StrLit("FloatReset")))
   {
    Params->Float = Default->Float;
-   Changed = true;
+   FloatChanged = true;
   }
   
-  Changed |= UI_ColorPicker(&Params->Color, StrLit("Color"));
+  UI_ColorPicker(&Params->Color, StrLit("Color"));
   if (ResetCtxMenu(StrLit("ColorReset")))
   {
    Params->Color = Default->Color;
-   Changed = true;
   }
  }
- return Changed;
+ return FloatChanged;
 }
 
 internal void
@@ -1169,6 +1186,16 @@ RenderSelectedEntityUI(editor *Editor, render_group *RenderGroup)
           CurveParams->Bezier = DefaultParams->Bezier;
           CrucialEntityParamChanged = true;
          }
+         
+         if (CurveParams->Bezier == Bezier_Rational)
+         {
+          CrucialEntityParamChanged |= UI_Combo(SafeCastToPtr(CurveParams->BezierPrecision, u32), CurveEvalPrecision_Count, CurveEvalPrecisionNames, StrLit("Precision"));
+          if (ResetCtxMenu(StrLit("BezierPrecisionReset")))
+          {
+           CurveParams->BezierPrecision = DefaultParams->BezierPrecision;
+           CrucialEntityParamChanged = true;
+          }
+         }
         }break;
         
         //@ render selected parametric curve ui
@@ -1226,7 +1253,7 @@ RenderSelectedEntityUI(editor *Editor, render_group *RenderGroup)
         case Curve_NURBS: {
          b_spline_params *BSpline = &CurveParams->BSpline;
          b_spline_knot_params *KnotParams = &BSpline->KnotParams;
-         curve_points_static *Points = GetCurvePoints(Curve);
+         curve_points *Points = GetCurvePoints(Curve);
          b_spline_degree_bounds Bounds = BSplineDegreeBounds(Points->ControlPointCount);
          
          CrucialEntityParamChanged |= UI_SliderInteger(SafeCastToPtr(KnotParams->Degree, i32), Bounds.MinDegree, Bounds.MaxDegree, StrLit("Degree"));
@@ -1272,7 +1299,7 @@ RenderSelectedEntityUI(editor *Editor, render_group *RenderGroup)
          if (UI_BeginTree(StrLit("Knots")))
          {         
           b_spline_knot_params KnotParams = GetBSplineParams(Curve).KnotParams;
-          curve_points_static *Points = GetCurvePoints(Curve);
+          curve_points *Points = GetCurvePoints(Curve);
           u32 KnotCount = KnotParams.KnotCount;
           u32 Degree = KnotParams.Degree;
           u32 PartitionSize = KnotParams.PartitionSize;
@@ -1312,8 +1339,7 @@ RenderSelectedEntityUI(editor *Editor, render_group *RenderGroup)
        
        if (CurveHasWeights(Curve))
        {
-        b32 WeightChanged = false;
-        curve_points_static *Points = GetCurvePoints(Curve);
+        curve_points *Points = GetCurvePoints(Curve);
         u32 PointCount = Points->ControlPointCount;
         f32 *Weights = Points->ControlPointWeights;
         
@@ -1321,11 +1347,15 @@ RenderSelectedEntityUI(editor *Editor, render_group *RenderGroup)
         if (IsControlPointSelected(Curve))
         {
          Selected = IndexFromControlPointHandle(Curve->SelectedControlPoint);
-         WeightChanged |= UI_DragFloatF(&Weights[Selected], 0.0f, FLT_MAX, 0, "Weight (%u)", Selected);
+         control_point_handle Handle = ControlPointHandleFromIndex(Selected);
+         f32 Weight = Weights[Selected];
+         if (UI_DragFloatF(&Weight, 0.0f, FLT_MAX, 0, "Weight (%u)", Selected))
+         {
+          SetControlPointWeight(&EntityWitness, Handle, Weight);
+         }
          if (ResetCtxMenu(StrLit("WeightReset")))
          {
-          Weights[Selected] = 1.0f;
-          WeightChanged = true;
+          SetControlPointWeight(&EntityWitness, Handle, 1.0f);
          }
         }
         
@@ -1345,23 +1375,22 @@ RenderSelectedEntityUI(editor *Editor, render_group *RenderGroup)
               ++PointIndex)
          {
           UI_Id(PointIndex)
-          {                              
-           WeightChanged |= UI_DragFloatF(&Weights[PointIndex], 0.0f, FLT_MAX, 0, "Point %u", PointIndex);
+          {
+           control_point_handle Handle = ControlPointHandleFromIndex(PointIndex);
+           f32 Weight = Weights[PointIndex];
+           if (UI_DragFloatF(&Weight, 0.0f, FLT_MAX, 0, "Point %u", PointIndex))
+           {
+            SetControlPointWeight(&EntityWitness, Handle, Weight);
+           }
            if (ResetCtxMenu(StrLit("WeightReset")))
            {
-            Weights[PointIndex] = 1.0f;
-            WeightChanged = true;
+            SetControlPointWeight(&EntityWitness, Handle, 1.0f);
            }
           }
          }
          
          UI_EndTree();
         }
-        
-        if (WeightChanged)
-        {
-         CrucialEntityParamChanged = true;
-        }
        }
       }
      }
@@ -1550,12 +1579,36 @@ RenderSelectedEntityUI(editor *Editor, render_group *RenderGroup)
      {
       UI_Label(StrLit("Line"))
       {
-       CrucialEntityParamChanged |= RenderDrawParamsUI(StrLit("Line"),
-                                                       &CurveParams->DrawParams.Line,
-                                                       &DefaultParams->DrawParams.Line,
-                                                       false);
+       if (RenderDrawParamsUI(StrLit("Line"),
+                              &CurveParams->DrawParams.Line,
+                              &DefaultParams->DrawParams.Line,
+                              false))
+       {
+        // NOTE(hbr): De Casteljau's lines are as wide as the curve
+        MarkCurveRecomputeStages(&EntityWitness, (CurveRecomputeStage_CurveVertices |
+                                                  CurveRecomputeStage_PointTracking));
+       }
+       
+       curve_adaptive_sampling_params *Adaptive = &CurveParams->AdaptiveSampling;
+       CrucialEntityParamChanged |= UI_Checkbox(&Adaptive->Enabled, StrLit("Adaptive Sampling"));
+       if (ResetCtxMenu(StrLit("AdaptiveSampling")))
+       {
+        *Adaptive = DefaultParams->AdaptiveSampling;
+        CrucialEntityParamChanged = true;
+       }
        
-       if (IsCurveTotalSamplesMode(Curve))
+       if (Adaptive->Enabled)
+       {
+        CrucialEntityParamChanged |= UI_DragFloat(&Adaptive->Tolerance, 0.001f, FLT_MAX, 0, StrLit("Tolerance"));
+        if (ResetCtxMenu(StrLit("Tolerance")))
+        {
+         Adaptive->Tolerance = DefaultParams->AdaptiveSampling.Tolerance;
+         CrucialEntityParamChanged = true;
+        }
+        
+        CrucialEntityParamChanged |= UI_Combo(SafeCastToPtr(Adaptive->Unit, u32), CurveSamplingTolerance_Count, CurveSamplingToleranceUnitNames, StrLit("Tolerance Unit"));
+       }
+       else if (IsCurveTotalSamplesMode(Curve))
        {
         CrucialEntityParamChanged |= UI_SliderInteger(SafeCastToPtr(CurveParams->TotalSamples, i32), 1, DEBUG_Vars->ParametricCurveMaxTotalSamples, StrLit("Total Samples"));
         if (ResetCtxMenu(StrLit("Samples")))
@@ -1588,28 +1641,37 @@ RenderSelectedEntityUI(editor *Editor, render_group *RenderGroup)
                           &DefaultParams->DrawParams.Points,
                           true);
        
-       CrucialEntityParamChanged |= RenderDrawParamsUI(StrLit("Polyline"),
-                                                       &CurveParams->DrawParams.Polyline,
-                                                       &DefaultParams->DrawParams.Polyline,
-                                                       false);
+       if (RenderDrawParamsUI(StrLit("Polyline"),
+                              &CurveParams->DrawParams.Polyline,
+                              &DefaultParams->DrawParams.Polyline,
+                              false))
+       {
+        MarkCurveRecomputeStages(&EntityWitness, CurveRecomputeStage_PolylineVertices);
+       }
        
-       CrucialEntityParamChanged |= RenderDrawParamsUI(StrLit("Convex Hull"),
-                                                       &CurveParams->DrawParams.ConvexHull,
-                                                       &DefaultParams->DrawParams.ConvexHull,
-                                                       false);
+       if (RenderDrawParamsUI(StrLit("Convex Hull"),
+                              &CurveParams->DrawParams.ConvexHull,
+                              &DefaultParams->DrawParams.ConvexHull,
+                              false))
+       {
+        MarkCurveRecomputeStages(&EntityWitness, CurveRecomputeStage_ConvexHullVertices);
+       }
       }
       
       if (IsBSplineCurve(Curve))
       {
-       CrucialEntityParamChanged |= RenderDrawParamsUI(StrLit("Partition Knots"),
-                                                       &CurveParams->DrawParams.BSplineKnots,
-                                                       &DefaultParams->DrawParams.BSplineKnots,
-                                                       true);
+       RenderDrawParamsUI(StrLit("Partition Knots"),
+                          &CurveParams->DrawParams.BSplineKnots,
+                          &DefaultParams->DrawParams.BSplineKnots,
+                          true);
        
-       CrucialEntityParamChanged |= RenderDrawParamsUI(StrLit("NURBS Partial Convex Hull"),
-                                                       &CurveParams->DrawParams.BSplinePartialConvexHull,
-                                                       &DefaultParams->DrawParams.BSplinePartialConvexHull,
-                                                       false);
+       if (RenderDrawParamsUI(StrLit("NURBS Partial Convex Hull"),
+                              &CurveParams->DrawParams.BSplinePartialConvexHull,
+                              &DefaultParams->DrawParams.BSplinePartialConvexHull,
+                              false))
+       {
+        MarkCurveRecomputeStages(&EntityWitness, CurveRecomputeStage_BSplineConvexHulls);
+       }
       }
       
       UI_EndTabItem();
@@ -1620,7 +1682,7 @@ RenderSelectedEntityUI(editor *Editor, render_group *RenderGroup)
     {
      if (Curve)
      {
-      curve_points_static *Points = GetCurvePoints(Curve);
+      curve_points *Points = GetCurvePoints(Curve);
       UI_TextF(false, "Number of control points  %u", Points->ControlPointCount);
       UI_TextF(false, "Number of samples         %u", Curve->CurveSampleCount);
      }
@@ -1734,6 +1796,7 @@ RenderMenuBarUI(editor *Editor)
    UI_MenuItem(&Editor->SelectedEntityWindow, NilStr, StrLit("Selected Entity"));
 #if BUILD_DEV
    UI_MenuItem(&Editor->DiagnosticsWindow, NilStr, StrLit("Diagnostics"));
+   UI_MenuItem(&Editor->MemoryWindow, NilStr, StrLit("Memory"));
    UI_MenuItem(&Editor->ProfilerWindow, NilStr, StrLit("Profiler"));
 #endif
    UI_MenuItem(&Editor->Grid, NilStr, StrLit("Grid"));
@@ -1912,9 +1975,116 @@ RenderDiagnosticsUI(editor *Editor, platform_input_output *Input)
    UI_TextF(false, "%-20s %.2f ms", "Min frame time", 1000.0f * Stats->MinFrameTime);
    UI_TextF(false, "%-20s %.2f ms", "Max frame time", 1000.0f * Stats->MaxFrameTime);
    UI_TextF(false, "%-20s %.2f ms", "Average frame time", 1000.0f * Stats->AvgFrameTime);
+   
+   curve_eval_cache *Cache = Editor->CurveEvalCache;
+   if (Cache)
+   {
+    UI_TextF(false, "%-20s %u (%.1f MB)", "Curve cache entries", Cache->EntryCount, Cast(f32)Cache->TotalSize / Megabytes(1));
+    UI_TextF(false, "%-20s %u / %u", "Curve cache hits", Cache->HitCount, Cache->HitCount + Cache->MissCount);
+   }
+  }
+  UI_EndWindow();
+ }
+}
+
+internal void
+RenderMemoryUI(editor *Editor)
+{
+ temp_arena Temp = TempArena(0);
+ if (Editor->MemoryWindow)
+ {
+  if (UI_BeginWindow(&Editor->MemoryWindow, 0, StrLit("Memory")))
+  {
+   memory_usage Usage = ComputeMemoryUsage(Editor);
+   
+   if (UI_Button(StrLit("Dump snapshot")))
+   {
+    DumpMemoryUsageSnapshot(Editor);
+   }
+   UI_SameRow();
+   if (UI_Button(StrLit("Trim idle arenas")))
+   {
+    TrimArenaStore(Editor->ArenaStore, 0);
+   }
+   
+   //- arenas by owner
+   UI_SeparatorText(StrLit("Arenas"));
+   if (UI_BeginTable(6, StrLit("MemoryByTag")))
+   {
+    char const *Headers[] = { "Owner", "Arenas", "Used", "Peak", "Commited", "Reserved" };
+    UI_TableNextRow();
+    ForEachElement(HeaderIndex, Headers)
+    {
+     UI_TableSetColumnIndex(SafeCastU32(HeaderIndex));
+     UI_TextF(false, "%s", Headers[HeaderIndex]);
+    }
+    ForEachIndex(Tag, MemoryTag_Count + 1)
+    {
+     b32 IsTotal = (Tag == MemoryTag_Count);
+     memory_tag_usage *TagUsage = (IsTotal ? &Usage.Total : Usage.Tags + Tag);
+     if (TagUsage->ArenaCount || IsTotal)
+     {
+      UI_TableNextRow();
+      UI_TableSetColumnIndex(0);
+      UI_Text(false, IsTotal ? StrLit("Total") : MemoryTagNames[Tag]);
+      UI_TableSetColumnIndex(1);
+      UI_TextF(false, "%u", TagUsage->ArenaCount);
+      UI_TableSetColumnIndex(2);
+      UI_TextF(false, "%.2f MB", MegabytesFromSize(TagUsage->Usage.Used));
+      UI_TableSetColumnIndex(3);
+      UI_TextF(false, "%.2f MB", MegabytesFromSize(TagUsage->Usage.PeakUsed));
+      UI_TableSetColumnIndex(4);
+      UI_TextF(false, "%.2f MB", MegabytesFromSize(TagUsage->Usage.Commited));
+      UI_TableSetColumnIndex(5);
+      UI_TextF(false, "%.0f MB", MegabytesFromSize(TagUsage->Usage.Reserved));
+     }
+    }
+    UI_EndTable();
+   }
+   
+   //- other owners
+   UI_SeparatorText(StrLit("Other"));
+   UI_TextF(false, "%-24s %u (%.2f MB)", "Curve points live", Usage.CurvePointsLiveCount, MegabytesFromSize(Usage.CurvePointsLiveSize));
+   UI_TextF(false, "%-24s %u (%.2f MB)", "Curve points in undo", Usage.CurvePointsUndoCount, MegabytesFromSize(Usage.CurvePointsUndoSize));
+   UI_TextF(false, "%-24s %u (%.2f MB)", "Curve points free", Usage.CurvePointsFreeBlockCount, MegabytesFromSize(Usage.CurvePointsFreeBlockSize));
+   UI_TextF(false, "%-24s %u groups, %u actions (%.2f MB)", "Undo history",
+            Usage.UndoGroupCount, Usage.UndoActionCount, MegabytesFromSize(Usage.UndoSize));
+   UI_TextF(false, "%-24s %.2f MB, %u pending", "Renderer transfer", MegabytesFromSize(Usage.RendererTransferMemorySize), Usage.RendererTransferPendingCount);
+   UI_TextF(false, "%-24s %.2f MB", "Profiler", MegabytesFromSize(Usage.ProfilerSize));
+   UI_TextF(false, "%-24s %.2f / %.2f MB", "Pool idle commited", MegabytesFromSize(Usage.PoolIdleCommited), MegabytesFromSize(Usage.PoolMaxIdleCommited));
+   
+   //- per entity breakdown
+   UI_SeparatorText(StrLit("Entities"));
+   UI_Combo(SafeCastToPtr(Editor->MemorySort, u32), EntityMemorySort_Count, EntityMemorySortNames, StrLit("Sort by"));
+   entity_memory_usage_array Entities = ComputeEntityMemoryUsage(Temp.Arena, Editor->EntityStore, Editor->MemorySort);
+   if (UI_BeginTable(1 + EntityMemorySort_Count, StrLit("MemoryByEntity")))
+   {
+    UI_TableNextRow();
+    UI_TableSetColumnIndex(0);
+    UI_Text(false, StrLit("Entity"));
+    ForEachEnumVal(Column, EntityMemorySort_Count, entity_memory_sort)
+    {
+     UI_TableSetColumnIndex(1 + Column);
+     UI_Text(false, EntityMemorySortNames[Column]);
+    }
+    ForEachIndex(EntityIndex, Entities.Count)
+    {
+     entity_memory_usage *Entity = Entities.Entities + EntityIndex;
+     UI_TableNextRow();
+     UI_TableSetColumnIndex(0);
+     UI_Text(false, GetEntityName(Entity->Entity));
+     ForEachEnumVal(Column, EntityMemorySort_Count, entity_memory_sort)
+     {
+      UI_TableSetColumnIndex(1 + Column);
+      UI_TextF(false, "%.1f KB", Cast(f32)Entity->Sizes[Column] / Kilobytes(1));
+     }
+    }
+    UI_EndTable();
+   }
   }
   UI_EndWindow();
  }
+ EndTemp(Temp);
 }
 
 internal void
@@ -2808,7 +2978,7 @@ ProcessInputEvents(editor *Editor,
     else if ((Collision.Flags & Collision_CurveLine) && CollisionTracking->Type)
     {
      BeginMovingTrackingPoint(LeftClick, Collision.Entity);
-     f32 Fraction = SafeDiv0(Cast(f32)Collision.CurveSampleIndex, (CollisionCurve->CurveSampleCount- 1));
+     f32 Fraction = CurveSampleFraction(CollisionCurve, Collision.CurveSampleIndex);
      SetTrackingPointFraction(&CollisionEntityWitness, Fraction);
     }
     else if (Collision.Flags & Collision_BSplineKnot)
@@ -2916,7 +3086,7 @@ ProcessInputEvents(editor *Editor,
      
      case EditorLeftClick_MovingBSplineKnot: {
       curve *Curve = SafeGetCurve(Entity);
-      curve_points_static *Points = GetCurvePoints(Curve);
+      curve_points *Points = GetCurvePoints(Curve);
       b_spline_knot_params KnotParams = GetBSplineParams(Curve).KnotParams;
       f32 *Knots = Points->BSplineKnots;
       b_spline_knot_handle Knot = LeftClick->BSplineKnot;
@@ -3186,8 +3356,8 @@ Merge2Curves(entity_with_modify_witness *MergeWitness,
  MaybeReverseCurvePoints(Entity0);
  MaybeReverseCurvePoints(Entity1);
  
- curve_points_static *Points0 = GetCurvePoints(Curve0);
- curve_points_static *Points1 = GetCurvePoints(Curve1);
+ curve_points *Points0 = GetCurvePoints(Curve0);
+ curve_points *Points1 = GetCurvePoints(Curve1);
  
  u32 PointCount0 = Points0->ControlPointCount;
  u32 PointCount1 = Points1->ControlPointCount;
@@ -4010,8 +4180,11 @@ InitGlobalsOnInitOrCodeReload(editor *Editor)
                 Editor->ImageLoadingStore,
                 Editor->StrStore,
                 Editor->CurvePointsStore,
+                Editor->CurveRecomputeBatch,
+                Editor->CurveEvalCache,
                 Editor->LowPriorityQueue,
-                Editor->HighPriorityQueue);
+                Editor->HighPriorityQueue,
+                &Editor->PersistentState.EvalCalibration);
  }
 }
 
@@ -4390,6 +4563,12 @@ EditorUpdateAndRenderImpl(editor_memory *Memory, platform_input_output *Input, s
   LoadLastSessionOrEmptyProject(Editor, Memory);
   InitGlobalsOnInitOrCodeReload(Editor);
   
+  curve_eval_calibration *EvalCalibration = &Editor->PersistentState.EvalCalibration;
+  if (!EvalCalibration->Calibrated)
+  {
+   CalibrateCurveEvaluation(EvalCalibration);
+  }
+  
   // NOTE(hbr): Sanity check that I didn't mess up keyboard shortcut definitions
   ForEachEnumVal(EditorCmd, EditorCommand_Count, editor_command)
   {
@@ -4406,11 +4585,13 @@ EditorUpdateAndRenderImpl(editor_memory *Memory, platform_input_output *Input, s
   RenderGroup_ = BeginRenderGroup(Frame,
                                   Camera->P, Camera->Rotation, Camera->Zoom,
                                   Editor->BackgroundColor);
+  GetCtx()->WorldUnitsPerPixel = PixelLengthToWorldSpace(RenderGroup, 1.0f);
  }
  
  DevUpdateAndRender(Editor, RenderGroup);
  
  ProcessImageLoadingTasks(Editor);
+ ProcessCurveAsyncRecomputes(Editor);
  ProcessInputEvents(Editor, Input, RenderGroup);
  
  if (!Editor->HideUI)
@@ -4421,6 +4602,7 @@ EditorUpdateAndRenderImpl(editor_memory *Memory, platform_input_output *Input, s
   RenderMenuBarUI(Editor);
   RenderEntityListUI(Editor, RenderGroup);
   RenderDiagnosticsUI(Editor, Input);
+  RenderMemoryUI(Editor);
   RenderHelpUI(Editor);
   RenderAnimatingCurvesUI(Editor);
   RenderMergingCurvesUI(Editor);
@@ -45,6 +45,7 @@ struct rendering_entity_handle
 {
  entity *Entity;
  render_group *RenderGroup;
+ u32 CurveLODLevel;
 };
 
 struct editor_keyboard_shortcut
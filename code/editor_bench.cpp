@@ -0,0 +1,700 @@
+/* ========================================================================
+   Parametric Curve Editor
+   Master's Thesis by Hubert Obrzut
+   Supervisor: Paweł Woźny
+   University of Wrocław
+   Faculty of Mathematics and Computer Science
+   Institute of Computer Science
+   Date: September 2025
+   ======================================================================== */
+
+// NOTE(hbr): Headless benchmark of curve evaluation kernels. It pulls in the whole editor
+// unity build (without any window, renderer or ImGui backend), sweeps every eval method
+// of every curve type over control point counts, sample counts and worker thread counts
+// and dumps the results into CSV file. Rational Bezier precision modes are measured
+// separately, cost and max error against f64 reference, into second CSV file. Work queue
+// dispatch to first execution latency, per worker wait policy, goes into third CSV file.
+//
+// Usage: editor_bench_release.exe [output.csv] [precision_output.csv] [wake_output.csv]
+
+#include "editor.h"
+#include "base/base_thread_ctx.h"
+#include "base/base_random.h"
+#include "editor_work_queue.h"
+
+#include "editor.cpp"
+#include "base/base_thread_ctx.cpp"
+#include "editor_work_queue.cpp"
+
+enum bench_curve_type
+{
+ BenchCurve_NURBS,
+ BenchCurve_Bezier,
+ BenchCurve_CubicSpline,
+ BenchCurve_Polynomial,
+ BenchCurve_Parametric,
+ BenchCurve_Count,
+};
+global read_only string BenchCurveNames[] = {
+ StrLit("NURBS"),
+ StrLit("Bezier"),
+ StrLit("CubicSpline"),
+ StrLit("Polynomial"),
+ StrLit("Parametric"),
+};
+StaticAssert(ArrayCount(BenchCurveNames) == BenchCurve_Count, BenchCurveNames_AllDefined);
+
+global read_only u32 BenchControlPointCounts[] = { 4, 16, 64, 256 };
+global read_only u32 BenchSampleCounts[] = { 1000, 10000, 100000 };
+
+// NOTE(hbr): Precision benchmark of rational Bezier evaluation. Compensated evaluation is
+// O(n^2) per sample, so keep sample count low.
+global read_only u32 BenchPrecisionControlPointCounts[] = { 8, 32, 128, 512 };
+#define BenchPrecisionSampleCount 1000
+
+// NOTE(hbr): Wake up latency benchmark. Every round first leaves the workers idle for the given
+// gap, so that they go through spinning, yielding and parking, then dispatches one entry per worker.
+global read_only f32 BenchWakeIdleGapsMs[] = { 0.0f, 0.05f, 1.0f, 5.0f };
+#define BenchWakeRoundCount 200
+
+// NOTE(hbr): Every configuration is repeated until it accumulates at least this much time
+// (but at least BenchMinRepeatCount times). Best time is reported.
+#define BenchMinSecondsPerConfig 0.05f
+#define BenchMinRepeatCount 3
+#define BenchMaxRepeatCount 1000
+#define BenchMaxWorkQueueCount 16
+
+struct bench_input
+{
+ u32 ControlCount;
+ v2 *Controls;
+ f32 *Weights;
+ 
+ b_spline_knot_params KnotParams;
+ f32 *Knots;
+ nurbs_bezier_extraction NURBS_Extraction;
+ 
+ polynomial_eval_input Polynomial;
+ 
+ parametric_equation_expr *X_Expr;
+ parametric_equation_expr *Y_Expr;
+ f32 MinT;
+ f32 MaxT;
+};
+
+struct bench_state
+{
+ arena *Arena;
+ arena *CSV_Arena;
+ curve BezierCurve; // NOTE(hbr): CalcBezierRational wants curve only for its ComputeArena
+ 
+ curve_eval_calibration EvalCalibration;
+ 
+ u32 WorkQueueCount;
+ u32 WorkerCounts[BenchMaxWorkQueueCount];
+ work_queue *WorkQueues[BenchMaxWorkQueueCount];
+ 
+ instruction_set_flags InstructionSets;
+ u64 CPU_TimerFreq;
+ 
+ string_list CSV;
+};
+
+PLATFORM_SET_WINDOW_TITLE(BenchSetWindowTitleStub) {}
+PLATFORM_TOGGLE_FULLSCREEN(BenchToggleFullscreenStub) {}
+
+internal os_file_dialog_result
+BenchOpenFileDialogStub(arena *Arena, os_file_dialog_filters Filters)
+{
+ os_file_dialog_result Result = {};
+ return Result;
+}
+
+internal os_file_dialog_result
+BenchSaveFileDialogStub(arena *Arena, os_file_dialog_filters Filters)
+{
+ os_file_dialog_result Result = {};
+ return Result;
+}
+
+platform_api Platform = {
+ OS_Reserve,
+ OS_Release,
+ OS_Commit,
+ OS_Decommit,
+ ThreadCtxGetScratch,
+ BenchOpenFileDialogStub,
+ BenchSaveFileDialogStub,
+ OS_ReadEntireFile,
+ BenchSetWindowTitleStub,
+ OS_Info,
+ BenchToggleFullscreenStub,
+ WorkQueueAddEntry,
+ WorkQueueCompleteAllWork,
+ WorkQueueFreeEntryCount,
+ WorkQueueAddGroupEntry,
+ WorkQueueAddGroupEntries,
+ WorkQueueCompleteGroup,
+ WorkQueueParallelFor,
+ OS_InstructionSetSupport,
+ // NOTE(hbr): No ImGui in headless mode
+};
+
+internal u32
+BenchMethodCount(bench_curve_type Curve)
+{
+ u32 Result = 0;
+ switch (Curve)
+ {
+  case BenchCurve_NURBS: {Result = NURBS_Eval_Count;}break;
+  case BenchCurve_Bezier: {Result = Bezier_Eval_Count;}break;
+  case BenchCurve_CubicSpline: {Result = CubicSpline_Eval_Count;}break;
+  case BenchCurve_Polynomial: {Result = Polynomial_Eval_Count;}break;
+  case BenchCurve_Parametric: {Result = Parametric_Eval_Count;}break;
+  case BenchCurve_Count: InvalidPath;
+ }
+ return Result;
+}
+
+internal string
+BenchMethodName(bench_curve_type Curve, u32 Method)
+{
+ string Result = {};
+ switch (Curve)
+ {
+  case BenchCurve_NURBS: {Result = NURBS_Eval_Names[Method];}break;
+  case BenchCurve_Bezier: {Result = Bezier_Eval_Names[Method];}break;
+  case BenchCurve_CubicSpline: {Result = CubicSpline_Eval_Names[Method];}break;
+  case BenchCurve_Polynomial: {Result = Polynomial_Eval_Names[Method];}break;
+  case BenchCurve_Parametric: {Result = Parametric_Eval_Names[Method];}break;
+  case BenchCurve_Count: InvalidPath;
+ }
+ return Result;
+}
+
+internal b32
+BenchMethodIsMultiThreaded(string MethodName)
+{
+ b32 Result = StrContains(MethodName, StrLit("MultiThreaded"));
+ return Result;
+}
+
+internal b32
+BenchMethodIsSupported(string MethodName, instruction_set_flags Flags)
+{
+ b32 Result = true;
+ if (StrContains(MethodName, StrLit("AVX512"))) Result = (Flags & InstructionSet_AVX512);
+ else if (StrContains(MethodName, StrLit("AVX2"))) Result = (Flags & InstructionSet_AVX2);
+ else if (StrContains(MethodName, StrLit("SSE"))) Result = (Flags & InstructionSet_SSE);
+ return Result;
+}
+
+internal bench_input
+BenchMakeInput(arena *Arena, bench_curve_type Curve, u32 ControlCount)
+{
+ bench_input Input = {};
+ 
+ if (Curve == BenchCurve_Parametric)
+ {
+  parametric_curve_predefined_example Example = ParametricCurvePredefinedExampleButterflyCurve;
+  Input.X_Expr = ParametricEquationParse(Arena, Example.X_Equation, 0, 0, 0).ParsedExpr;
+  Input.Y_Expr = ParametricEquationParse(Arena, Example.Y_Equation, 0, 0, 0).ParsedExpr;
+  Input.MinT = Example.Min_T.Value;
+  Input.MaxT = Example.Max_T.Value;
+ }
+ else
+ {
+  // NOTE(hbr): Wobbly circle, so that the curve is not degenerate in any way
+  Input.ControlCount = ControlCount;
+  Input.Controls = PushArrayNonZero(Arena, ControlCount, v2);
+  Input.Weights = PushArrayNonZero(Arena, ControlCount, f32);
+  ForEachIndex(PointIndex, ControlCount)
+  {
+   f32 Angle = 2*PiF32 * PointIndex / ControlCount;
+   f32 Radius = 1.0f + 0.25f * SinF32(5 * Angle);
+   Input.Controls[PointIndex] = V2(Radius * CosF32(Angle), Radius * SinF32(Angle));
+   Input.Weights[PointIndex] = 1.0f + 0.5f * (PointIndex & 1);
+  }
+  
+  b_spline_knot_params KnotParams = BSplineKnotParamsFromDegree(3, ControlCount);
+  Input.KnotParams = KnotParams;
+  Input.Knots = PushArrayNonZero(Arena, KnotParams.KnotCount, f32);
+  BSplineBaseKnots(KnotParams, Input.Knots);
+  BSplineKnotsNaturalExtension(KnotParams, Input.Knots);
+  // NOTE(hbr): Extraction is cached on the curve in the editor, so it's not part of the measurement
+  Input.NURBS_Extraction = NURBS_BezierExtraction(Arena, Input.Controls, Input.Weights, KnotParams, Input.Knots);
+  Input.MinT = KnotParams.A;
+  Input.MaxT = KnotParams.B;
+  
+  if (Curve == BenchCurve_Polynomial)
+  {
+   // NOTE(hbr): Chebyshev barycentric is the stable one for high degrees
+   polynomial_interpolation_params Params = {PolynomialInterpolation_Barycentric, PointSpacing_Chebychev};
+   Input.Polynomial = MakePolynomialEvalInput(Arena, Input.Controls, ControlCount, Params);
+   Input.MinT = -1.0f;
+   Input.MaxT = 1.0f;
+  }
+ }
+ 
+ return Input;
+}
+
+internal void
+BenchRunOnce(bench_state *Bench, bench_curve_type Curve, u32 Method,
+             bench_input *Input, u32 SampleCount, f32 *Ts, v2 *OutSamples)
+{
+ switch (Curve)
+ {
+  case BenchCurve_NURBS: {
+   DEBUG_Vars->NURBS_EvalMethod = Cast(nurbs_eval_method)Method;
+   CalcNURBS(Input->Controls, Input->Weights, Input->KnotParams, Input->Knots, &Input->NURBS_Extraction, SampleCount, Ts, OutSamples);
+  }break;
+  
+  case BenchCurve_Bezier: {
+   DEBUG_Vars->Bezier_EvalMethod = Cast(bezier_eval_method)Method;
+   ClearArena(Bench->BezierCurve.ComputeArena);
+   CalcBezierRational(&Bench->BezierCurve, Input->Controls, Input->Weights, Input->ControlCount, SampleCount, OutSamples);
+  }break;
+  
+  case BenchCurve_CubicSpline: {
+   DEBUG_Vars->CubicSpline_EvalMethod = Cast(cubic_spline_eval_method)Method;
+   CalcCubicSpline(Input->Controls, Input->ControlCount, CubicSpline_Natural, SampleCount, OutSamples);
+  }break;
+  
+  case BenchCurve_Polynomial: {
+   DEBUG_Vars->Polynomial_EvalMethod = Cast(polynomial_eval_method)Method;
+   curve_eval_kernel Kernel = PolynomialEvalKernel(DEBUG_Vars->Polynomial_EvalMethod);
+   CalcPolynomialWithKernel(&Input->Polynomial, SampleCount, Ts, OutSamples, Kernel);
+  }break;
+  
+  case BenchCurve_Parametric: {
+   // NOTE(hbr): CalcParametric reparses equations every call, call kernels directly
+   switch (Cast(parametric_eval_method)Method)
+   {
+    case Parametric_Eval_SingleThreaded: {
+     CalcParametric_SingleThreaded(Input->X_Expr, Input->Y_Expr, SampleCount, Ts, OutSamples);
+    }break;
+    
+    case Parametric_Eval_MultiThreaded: {
+     CalcParametric_MultiThreaded(Input->X_Expr, Input->Y_Expr, SampleCount, Ts, OutSamples);
+    }break;
+    
+    case Parametric_Eval_Count: InvalidPath;
+   }
+  }break;
+  
+  case BenchCurve_Count: InvalidPath;
+ }
+}
+
+internal f32
+BenchMeasure(bench_state *Bench, bench_curve_type Curve, u32 Method,
+             bench_input *Input, u32 SampleCount, f32 *Ts, v2 *OutSamples,
+             u32 *OutRepeatCount)
+{
+ // NOTE(hbr): Warm up caches and page in the output buffers
+ BenchRunOnce(Bench, Curve, Method, Input, SampleCount, Ts, OutSamples);
+ 
+ u64 BestTSC = U64_MAX;
+ u64 TotalTSC = 0;
+ u64 MinTotalTSC = Cast(u64)(BenchMinSecondsPerConfig * Bench->CPU_TimerFreq);
+ u32 RepeatCount = 0;
+ while (RepeatCount < BenchMaxRepeatCount &&
+        (RepeatCount < BenchMinRepeatCount || TotalTSC < MinTotalTSC))
+ {
+  u64 BeginTSC = OS_ReadCPUTimer();
+  BenchRunOnce(Bench, Curve, Method, Input, SampleCount, Ts, OutSamples);
+  u64 ElapsedTSC = OS_ReadCPUTimer() - BeginTSC;
+  
+  BestTSC = Min(BestTSC, ElapsedTSC);
+  TotalTSC += ElapsedTSC;
+  ++RepeatCount;
+ }
+ 
+ *OutRepeatCount = RepeatCount;
+ f32 BestSec = Cast(f32)BestTSC / Bench->CPU_TimerFreq;
+ 
+ return BestSec;
+}
+
+internal void
+BenchCurveType(bench_state *Bench, bench_curve_type Curve)
+{
+ arena *Arena = Bench->Arena;
+ 
+ u32 ControlCountCount = ArrayCount(BenchControlPointCounts);
+ if (Curve == BenchCurve_Parametric)
+ {
+  // NOTE(hbr): Parametric curves don't have control points
+  ControlCountCount = 1;
+ }
+ 
+ ForEachIndex(ControlCountIndex, ControlCountCount)
+ {
+  temp_arena InputTemp = BeginTemp(Arena);
+  
+  u32 ControlCount = (Curve == BenchCurve_Parametric ? 0 : BenchControlPointCounts[ControlCountIndex]);
+  bench_input Input = BenchMakeInput(Arena, Curve, ControlCount);
+  
+  ForEachElement(SampleCountIndex, BenchSampleCounts)
+  {
+   temp_arena SamplesTemp = BeginTemp(Arena);
+   
+   u32 SampleCount = BenchSampleCounts[SampleCountIndex];
+   v2 *OutSamples = PushArrayNonZero(Arena, SampleCount, v2);
+   f32 *Ts = PushArrayNonZero(Arena, SampleCount, f32);
+   EquidistantPoints(Ts, SampleCount, Input.MinT, Input.MaxT);
+   
+   u32 MethodCount = BenchMethodCount(Curve);
+   ForEachIndex(Method, MethodCount)
+   {
+    string MethodName = BenchMethodName(Curve, Cast(u32)Method);
+    if (BenchMethodIsSupported(MethodName, Bench->InstructionSets))
+    {
+     b32 MultiThreaded = BenchMethodIsMultiThreaded(MethodName);
+     u32 QueueCount = (MultiThreaded ? Bench->WorkQueueCount : 1);
+     f32 OneWorkerSec = 0.0f;
+     
+     ForEachIndex(QueueIndex, QueueCount)
+     {
+      u32 WorkerCount = (MultiThreaded ? Bench->WorkerCounts[QueueIndex] : 0);
+      GetCtx()->HighPriorityQueue = Bench->WorkQueues[QueueIndex];
+      
+      u32 RepeatCount = 0;
+      f32 BestSec = BenchMeasure(Bench, Curve, Cast(u32)Method, &Input, SampleCount, Ts, OutSamples, &RepeatCount);
+      if (QueueIndex == 0)
+      {
+       OneWorkerSec = BestSec;
+      }
+      
+      f32 NsPerSample = 1e9f * BestSec / SampleCount;
+      f32 SamplesPerSec = SafeDiv0(SampleCount, BestSec);
+      f32 Speedup = SafeDiv0(OneWorkerSec, BestSec);
+      
+      StrListPushF(Bench->CSV_Arena, &Bench->CSV, "%S,%S,%u,%u,%u,%u,%.9f,%.3f,%.1f,%.3f\n",
+                   BenchCurveNames[Curve], MethodName, ControlCount, SampleCount,
+                   WorkerCount, RepeatCount, BestSec, NsPerSample, SamplesPerSec, Speedup);
+      OS_PrintF("%-12S %-44S points=%-4u samples=%-7u workers=%-3u %10.3f ns/sample %8.3fx\n",
+                BenchCurveNames[Curve], MethodName, ControlCount, SampleCount,
+                WorkerCount, NsPerSample, Speedup);
+     }
+    }
+    else
+    {
+     OS_PrintF("%-12S %-44S skipped (instruction set not supported)\n", BenchCurveNames[Curve], MethodName);
+    }
+   }
+   
+   EndTemp(SamplesTemp);
+  }
+  
+  EndTemp(InputTemp);
+ }
+}
+
+// NOTE(hbr): Plain de Casteljau in f64 on homogeneous coordinates, it is the reference
+// that every precision mode is compared against.
+internal v2
+BenchBezierRationalReferenceF64(f32 T, v2 *P, f32 *W, u32 N, f64 *Scratch)
+{
+ f64 *X = Scratch;
+ f64 *Y = Scratch + N;
+ f64 *Z = Scratch + 2*N;
+ ForEachIndex(K, N)
+ {
+  X[K] = Cast(f64)W[K] * P[K].X;
+  Y[K] = Cast(f64)W[K] * P[K].Y;
+  Z[K] = W[K];
+ }
+ 
+ f64 T64 = T;
+ f64 U64 = 1.0 - T64;
+ for (u32 J = 1; J < N; ++J)
+ {
+  for (u32 I = 0; I < N - J; ++I)
+  {
+   X[I] = U64 * X[I] + T64 * X[I+1];
+   Y[I] = U64 * Y[I] + T64 * Y[I+1];
+   Z[I] = U64 * Z[I] + T64 * Z[I+1];
+  }
+ }
+ 
+ v2 Result = V2(Cast(f32)(X[0] / Z[0]), Cast(f32)(Y[0] / Z[0]));
+ return Result;
+}
+
+internal void
+BenchBezierPrecision(bench_state *Bench, string OutputPath)
+{
+ arena *Arena = Bench->Arena;
+ string_list CSV = {};
+ StrListPush(Bench->CSV_Arena, &CSV, StrLit("Precision,ControlPoints,Samples,BestSec,NsPerSample,MaxError,ErrorVsF32\n"));
+ 
+ ForEachElement(ControlCountIndex, BenchPrecisionControlPointCounts)
+ {
+  temp_arena Temp = BeginTemp(Arena);
+  
+  u32 ControlCount = BenchPrecisionControlPointCounts[ControlCountIndex];
+  bench_input Input = BenchMakeInput(Arena, BenchCurve_Bezier, ControlCount);
+  u32 SampleCount = BenchPrecisionSampleCount;
+  f32 *Ts = PushArrayNonZero(Arena, SampleCount, f32);
+  v2 *OutSamples = PushArrayNonZero(Arena, SampleCount, v2);
+  v2 *Reference = PushArrayNonZero(Arena, SampleCount, v2);
+  f64 *Scratch = PushArrayNonZero(Arena, 3 * ControlCount, f64);
+  EquidistantPoints(Ts, SampleCount, 0.0f, 1.0f);
+  ForEachIndex(SampleIndex, SampleCount)
+  {
+   Reference[SampleIndex] = BenchBezierRationalReferenceF64(Ts[SampleIndex], Input.Controls, Input.Weights, ControlCount, Scratch);
+  }
+  
+  f32 MaxErrors[CurveEvalPrecision_Count] = {};
+  ForEachEnumVal(Precision, CurveEvalPrecision_Count, curve_eval_precision)
+  {
+   // NOTE(hbr): Single-threaded, cost per sample is what matters here
+   curve_eval_kernel Kernel = BezierRationalPrecisionEvalKernel(Precision);
+   Kernel.MultiThreaded = false;
+   
+   CalcBezierRationalWithKernel(Input.Controls, Input.Weights, ControlCount, SampleCount, Ts, OutSamples, Kernel);
+   u64 BestTSC = U64_MAX;
+   ForEachIndex(RepeatIndex, BenchMinRepeatCount)
+   {
+    u64 BeginTSC = OS_ReadCPUTimer();
+    CalcBezierRationalWithKernel(Input.Controls, Input.Weights, ControlCount, SampleCount, Ts, OutSamples, Kernel);
+    BestTSC = Min(BestTSC, OS_ReadCPUTimer() - BeginTSC);
+   }
+   
+   f32 MaxError = 0.0f;
+   ForEachIndex(SampleIndex, SampleCount)
+   {
+    MaxError = Max(MaxError, Norm(OutSamples[SampleIndex] - Reference[SampleIndex]));
+   }
+   
+   MaxErrors[Precision] = MaxError;
+   
+   f32 BestSec = Cast(f32)BestTSC / Bench->CPU_TimerFreq;
+   f32 NsPerSample = 1e9f * BestSec / SampleCount;
+   f32 ErrorVsF32 = SafeDiv0(MaxError, MaxErrors[CurveEvalPrecision_F32]);
+   string PrecisionName = CurveEvalPrecisionNames[Precision];
+   StrListPushF(Bench->CSV_Arena, &CSV, "%S,%u,%u,%.9f,%.3f,%.10f,%.3f\n",
+                PrecisionName, ControlCount, SampleCount, BestSec, NsPerSample, MaxError, ErrorVsF32);
+   OS_PrintF("%-12S %-16S points=%-4u samples=%-7u %12.3f ns/sample max error %.10f (%.3fx f32)\n",
+             StrLit("Precision"), PrecisionName, ControlCount, SampleCount, NsPerSample, MaxError, ErrorVsF32);
+  }
+  
+  // NOTE(hbr): Compensated evaluation is built without fast math (see TwoSum), if that ever
+  // stops working it silently degrades to plain f32 or worse
+  if (MaxErrors[CurveEvalPrecision_Compensated] > MaxErrors[CurveEvalPrecision_F32])
+  {
+   OS_PrintErrorF("[compensated evaluation is less accurate than f32 for %u control points]\n", ControlCount);
+  }
+  
+  EndTemp(Temp);
+ }
+ 
+ if (OS_WriteDataListToFile(OutputPath, CSV))
+ {
+  OS_PrintF("[precision results written to %S]\n", OutputPath);
+ }
+ else
+ {
+  OS_PrintErrorF("[failed to write precision results to %S]\n", OutputPath);
+ }
+}
+
+struct bench_wake_entry
+{
+ u64 StartTSC;
+};
+
+internal void
+BenchWakeEntry_Work(void *UserData)
+{
+ bench_wake_entry *Entry = Cast(bench_wake_entry *)UserData;
+ Entry->StartTSC = OS_ReadCPUTimer();
+}
+
+internal int
+BenchU64Cmp(void *Data, u64 *A, u64 *B)
+{
+ MarkUnused(Data);
+ int Result = Cmp(*A, *B);
+ return Result;
+}
+
+internal void
+BenchWakeLatency(bench_state *Bench, string OutputPath)
+{
+ arena *Arena = Bench->Arena;
+ temp_arena Temp = BeginTemp(Arena);
+ 
+ string_list CSV = {};
+ StrListPush(Bench->CSV_Arena, &CSV, StrLit("Policy,SpinCount,YieldCount,IdleGapMs,Workers,Samples,P50Us,P90Us,P99Us,MaxUs\n"));
+ 
+ u32 QueueIndex = Bench->WorkQueueCount - 1;
+ work_queue *Queue = Bench->WorkQueues[QueueIndex];
+ u32 WorkerCount = Bench->WorkerCounts[QueueIndex];
+ work_queue_wait_policy SavedPolicy = Queue->WaitPolicy;
+ 
+ string PolicyNames[] = { StrLit("Park"), StrLit("SpinYieldPark") };
+ work_queue_wait_policy Policies[] = { {}, WorkQueueDefaultWaitPolicy() };
+ StaticAssert(ArrayCount(PolicyNames) == ArrayCount(Policies), BenchWakePolicies_AllNamed);
+ 
+ u32 SampleCount = BenchWakeRoundCount * WorkerCount;
+ bench_wake_entry *Entries = PushArrayNonZero(Arena, WorkerCount, bench_wake_entry);
+ u64 *Latencies = PushArrayNonZero(Arena, SampleCount, u64);
+ 
+ ForEachElement(PolicyIndex, Policies)
+ {
+  work_queue_wait_policy Policy = Policies[PolicyIndex];
+  Queue->WaitPolicy = Policy;
+  
+  ForEachElement(GapIndex, BenchWakeIdleGapsMs)
+  {
+   f32 IdleGapMs = BenchWakeIdleGapsMs[GapIndex];
+   u64 IdleGapTSC = Cast(u64)(IdleGapMs * 1e-3f * Bench->CPU_TimerFreq);
+   
+   u32 LatencyCount = 0;
+   ForEachIndex(RoundIndex, BenchWakeRoundCount)
+   {
+    u64 IdleBeginTSC = OS_ReadCPUTimer();
+    while (OS_ReadCPUTimer() - IdleBeginTSC < IdleGapTSC)
+    {
+     OS_ThreadYield();
+    }
+    
+    // NOTE(hbr): Don't help out, every entry has to be picked up by a worker
+    work_queue_group Group = {};
+    u64 DispatchTSC = OS_ReadCPUTimer();
+    WorkQueueAddGroupEntries(Queue, &Group, BenchWakeEntry_Work, Entries, SizeOf(Entries[0]), WorkerCount);
+    while (Group.PendingCount > 0)
+    {
+     OS_ThreadYield();
+    }
+    
+    ForEachIndex(EntryIndex, WorkerCount)
+    {
+     Latencies[LatencyCount++] = Entries[EntryIndex].StartTSC - DispatchTSC;
+    }
+   }
+   Assert(LatencyCount == SampleCount);
+   
+   SortTyped(Latencies, SampleCount, BenchU64Cmp, 0, SortFlag_None, u64);
+   f32 UsPerTSC = 1e6f / Bench->CPU_TimerFreq;
+   f32 P50Us = UsPerTSC * Latencies[SampleCount / 2];
+   f32 P90Us = UsPerTSC * Latencies[SampleCount * 9 / 10];
+   f32 P99Us = UsPerTSC * Latencies[SampleCount * 99 / 100];
+   f32 MaxUs = UsPerTSC * Latencies[SampleCount - 1];
+   
+   string PolicyName = PolicyNames[PolicyIndex];
+   StrListPushF(Bench->CSV_Arena, &CSV, "%S,%u,%u,%.3f,%u,%u,%.3f,%.3f,%.3f,%.3f\n",
+                PolicyName, Policy.SpinCount, Policy.YieldCount, IdleGapMs, WorkerCount, SampleCount, P50Us, P90Us, P99Us, MaxUs);
+   OS_PrintF("%-12S %-16S gap=%-6.2fms workers=%-3u p50 %9.3f us p90 %9.3f us p99 %9.3f us max %9.3f us\n",
+             StrLit("Wake"), PolicyName, IdleGapMs, WorkerCount, P50Us, P90Us, P99Us, MaxUs);
+  }
+ }
+ 
+ Queue->WaitPolicy = SavedPolicy;
+ EndTemp(Temp);
+ 
+ if (OS_WriteDataListToFile(OutputPath, CSV))
+ {
+  OS_PrintF("[wake results written to %S]\n", OutputPath);
+ }
+ else
+ {
+  OS_PrintErrorF("[failed to write wake results to %S]\n", OutputPath);
+ }
+}
+
+int main(int ArgCount, char *Args[])
+{
+ OS_Init(ArgCount, Args);
+ ThreadCtxInit();
+ // NOTE(hbr): No frames in headless mode, so nothing to profile into
+ ProfilerDisableOnThisThread();
+ 
+ string OutputPath = StrLit("curve_bench.csv");
+ if (ArgCount > 1)
+ {
+  OutputPath = StrFromCStr(Args[1]);
+ }
+ string PrecisionOutputPath = StrLit("curve_precision_bench.csv");
+ if (ArgCount > 2)
+ {
+  PrecisionOutputPath = StrFromCStr(Args[2]);
+ }
+ string WakeOutputPath = StrLit("work_queue_wake_bench.csv");
+ if (ArgCount > 3)
+ {
+  WakeOutputPath = StrFromCStr(Args[3]);
+ }
+ 
+ debug_vars BenchDebugVars = {};
+ DEBUG_Vars = &BenchDebugVars;
+ DEBUG_Vars->CubicSplinePeriodicM_EvalMethod = CubicSplinePeriodicM_Eval_Optimized;
+ 
+ bench_state Bench = {};
+ Bench.Arena = AllocArena(Gigabytes(64));
+ Bench.CSV_Arena = AllocArena(Gigabytes(1));
+ Bench.BezierCurve.ComputeArena = AllocArena(Gigabytes(1));
+ Bench.InstructionSets = Platform.InstructionSetSupport();
+ Bench.CPU_TimerFreq = OS_CPUTimerFreq();
+ 
+ // NOTE(hbr): Same amount of workers the editor itself uses for high priority queue is the
+ // maximum, scale up in powers of two. Every queue owns its own threads, idle ones just sleep.
+ u32 MaxWorkerCount = ClampBot(OS_ProcCount() - 1, 1);
+ for (u32 WorkerCount = 1;
+      Bench.WorkQueueCount < BenchMaxWorkQueueCount;
+      WorkerCount *= 2)
+ {
+  WorkerCount = Min(WorkerCount, MaxWorkerCount);
+  
+  work_queue *Queue = PushStruct(Bench.Arena, work_queue);
+  WorkQueueInit(Queue, WorkerCount);
+  
+  u32 QueueIndex = Bench.WorkQueueCount++;
+  Bench.WorkQueues[QueueIndex] = Queue;
+  Bench.WorkerCounts[QueueIndex] = WorkerCount;
+  
+  if (WorkerCount == MaxWorkerCount)
+  {
+   break;
+  }
+ }
+ 
+ // NOTE(hbr): Calibrate with all the workers, the same way the editor does at startup,
+ // so that adaptive methods are measured with the tuning that the editor would pick.
+ work_queue *MaxWorkQueue = Bench.WorkQueues[Bench.WorkQueueCount - 1];
+ InitEditorCtx(0, 0, 0, 0, 0, 0, 0, 0, 0, MaxWorkQueue, MaxWorkQueue, &Bench.EvalCalibration);
+ CalibrateCurveEvaluation(&Bench.EvalCalibration);
+ OS_PrintF("[calibration] Bezier: %S, block size %u\n",
+           Bezier_Eval_Names[Bench.EvalCalibration.Bezier.Method], Bench.EvalCalibration.Bezier.BlockSize);
+ OS_PrintF("[calibration] NURBS: %S, block size %u\n",
+           NURBS_Eval_Names[Bench.EvalCalibration.NURBS.Method], Bench.EvalCalibration.NURBS.BlockSize);
+ OS_PrintF("[calibration] CubicSpline: %S, block size %u\n",
+           CubicSpline_Eval_Names[Bench.EvalCalibration.CubicSpline.Method], Bench.EvalCalibration.CubicSpline.BlockSize);
+ OS_PrintF("[calibration] Polynomial: %S, block size %u\n",
+           Polynomial_Eval_Names[Bench.EvalCalibration.Polynomial.Method], Bench.EvalCalibration.Polynomial.BlockSize);
+ 
+ StrListPush(Bench.CSV_Arena, &Bench.CSV, StrLit("Curve,Method,ControlPoints,Samples,Workers,Repeats,BestSec,NsPerSample,SamplesPerSec,SpeedupVsOneWorker\n"));
+ ForEachEnumVal(Curve, BenchCurve_Count, bench_curve_type)
+ {
+  BenchCurveType(&Bench, Curve);
+ }
+ 
+ BenchBezierPrecision(&Bench, PrecisionOutputPath);
+ BenchWakeLatency(&Bench, WakeOutputPath);
+ 
+ int ExitCode = 0;
+ if (OS_WriteDataListToFile(OutputPath, Bench.CSV))
+ {
+  OS_PrintF("[results written to %S]\n", OutputPath);
+ }
+ else
+ {
+  OS_PrintErrorF("[failed to write results to %S]\n", OutputPath);
+  ExitCode = 1;
+ }
+ 
+ return ExitCode;
+}
@@ -14,6 +14,6 @@
 global string EditorAppName = StrLit("Apollo");
 global string EditorSessionFileExtension = StrLit("apo");
 global u32 EditorSaveFileMagicValue = 0xDEADC0DE;
-global u32 EditorVersion = 0x0;
+global u32 EditorVersion = 0xB;
 
 #endif //EDITOR_CONST_H
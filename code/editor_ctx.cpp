@@ -18,8 +18,11 @@ InitEditorCtx(arena_store *ArenaStore,
               image_loading_store *ImageLoadingStore,
               string_store *StrStore,
               curve_points_store *CurvePointsStore,
+              curve_recompute_batch *CurveRecomputeBatch,
+              curve_eval_cache *CurveEvalCache,
               struct work_queue *LowPriorityQueue,
-              struct work_queue *HighPriorityQueue)
+              struct work_queue *HighPriorityQueue,
+              curve_eval_calibration *EvalCalibration)
 {
  editor_ctx *Ctx = &GlobalEditorCtx;
  Ctx->ArenaStore = ArenaStore;
@@ -29,8 +32,11 @@ InitEditorCtx(arena_store *ArenaStore,
  Ctx->ImageLoadingStore = ImageLoadingStore;
  Ctx->StrStore = StrStore;
  Ctx->CurvePointsStore = CurvePointsStore;
+ Ctx->CurveRecomputeBatch = CurveRecomputeBatch;
+ Ctx->CurveEvalCache = CurveEvalCache;
  Ctx->LowPriorityQueue = LowPriorityQueue;
  Ctx->HighPriorityQueue = HighPriorityQueue;
+ Ctx->EvalCalibration = EvalCalibration;
 }
 
 internal editor_ctx *
@@ -39,17 +45,17 @@ GetCtx(void)
  return &GlobalEditorCtx;
 }
 
-inline internal curve_points_static *
+inline internal curve_points *
 GetCurvePoints(curve *Curve)
 {
- curve_points_static *Points = CurvePointsFromId(GetCtx()->CurvePointsStore, Curve->Points);
+ curve_points *Points = (Curve->SnapshotPoints ? Curve->SnapshotPoints : CurvePointsFromId(GetCtx()->CurvePointsStore, Curve->Points));
  return Points;
 }
 
 inline internal u32
 GetControlPointCount(curve *Curve)
 {
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  u32 Count = Points->ControlPointCount;
  return Count;
 }
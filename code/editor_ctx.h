@@ -20,8 +20,13 @@ struct editor_ctx
  image_loading_store *ImageLoadingStore;
  string_store *StrStore;
  curve_points_store *CurvePointsStore;
+ curve_recompute_batch *CurveRecomputeBatch;
+ curve_eval_cache *CurveEvalCache;
  struct work_queue *LowPriorityQueue;
  struct work_queue *HighPriorityQueue;
+ curve_eval_calibration *EvalCalibration;
+ // NOTE(hbr): Updated every frame, used to convert pixel tolerances into world space
+ f32 WorldUnitsPerPixel;
 };
 
 internal void InitEditorCtx(arena_store *ArenaStore,
@@ -31,13 +36,16 @@ internal void InitEditorCtx(arena_store *ArenaStore,
                             image_loading_store *ImageLoadingStore,
                             string_store *StrStore,
                             curve_points_store *CurvePointsStore,
+                            curve_recompute_batch *CurveRecomputeBatch,
+                            curve_eval_cache *CurveEvalCache,
                             struct work_queue *LowPriorityQueue,
-                            struct work_queue *HighPriorityQueue);
+                            struct work_queue *HighPriorityQueue,
+                            curve_eval_calibration *EvalCalibration);
 
 internal editor_ctx *GetCtx(void);
 
 //~ helpers
-internal curve_points_static *GetCurvePoints(curve *Curve);
+internal curve_points *GetCurvePoints(curve *Curve);
 internal u32 GetControlPointCount(curve *Curve);
 
 internal void FillCharBuffer(string_id Dst, string_id Src);
@@ -32,6 +32,21 @@ RenderDevConsoleUI(editor *Editor, render_group *RenderGroup)
    UI_TextF(false, "TransformAction: %p", Editor->SelectedEntityTransformState.TransformAction);
    
    UI_SliderUnsigned(&DEBUG_Vars->MultiThreadedEvaluationBlockSize, 1, 10000, StrLit("MultiThreaded Evaluation Block Size"));
+   UI_Checkbox(&DEBUG_Vars->AsyncCurveRecompute, StrLit("Recompute Heavy Curves In Background"));
+   
+   curve_eval_calibration *EvalCalibration = &Editor->PersistentState.EvalCalibration;
+   UI_TextF(false, "Calibrated Bezier: %S, BlockSize=%u",
+            Bezier_Eval_Names[EvalCalibration->Bezier.Method], EvalCalibration->Bezier.BlockSize);
+   UI_TextF(false, "Calibrated NURBS: %S, BlockSize=%u",
+            NURBS_Eval_Names[EvalCalibration->NURBS.Method], EvalCalibration->NURBS.BlockSize);
+   UI_TextF(false, "Calibrated Cubic Spline: %S, BlockSize=%u",
+            CubicSpline_Eval_Names[EvalCalibration->CubicSpline.Method], EvalCalibration->CubicSpline.BlockSize);
+   UI_TextF(false, "Calibrated Polynomial: %S, BlockSize=%u",
+            Polynomial_Eval_Names[EvalCalibration->Polynomial.Method], EvalCalibration->Polynomial.BlockSize);
+   if (UI_Button(StrLit("Recalibrate Curve Evaluation")))
+   {
+    CalibrateCurveEvaluation(EvalCalibration);
+   }
    
    UI_Checkbox(&DEBUG_Vars->NURBS_Benchmark, StrLit("NURBS Benchmark"));
    UI_Combo(SafeCastToPtr(DEBUG_Vars->NURBS_EvalMethod, u32), NURBS_Eval_Count, NURBS_Eval_Names, StrLit("NURBS Eval Method"));
@@ -45,6 +60,9 @@ RenderDevConsoleUI(editor *Editor, render_group *RenderGroup)
    UI_Checkbox(&DEBUG_Vars->CubicSpline_Benchmark, StrLit("Cubic Spline Benchmark"));
    UI_Combo(SafeCastToPtr(DEBUG_Vars->CubicSpline_EvalMethod, u32), CubicSpline_Eval_Count, CubicSpline_Eval_Names, StrLit("Cubic Spline Eval Method"));
    
+   UI_Checkbox(&DEBUG_Vars->Polynomial_Benchmark, StrLit("Polynomial Benchmark"));
+   UI_Combo(SafeCastToPtr(DEBUG_Vars->Polynomial_EvalMethod, u32), Polynomial_Eval_Count, Polynomial_Eval_Names, StrLit("Polynomial Eval Method"));
+   
    UI_Combo(SafeCastToPtr(DEBUG_Vars->CubicSplinePeriodicM_EvalMethod, u32),
             CubicSplinePeriodicM_Eval_Count,
             CubicSplinePeriodicM_Eval_Names,
@@ -205,6 +223,36 @@ AppendMultipleControlPoints(editor *Editor, entity_with_modify_witness *Witness,
  }
 }
 
+// NOTE(hbr): Eval methods index kernel tables, so don't trust ones read from a project file
+internal void
+SanitizeLoadedDebugVars(debug_vars *Vars)
+{
+ if (Vars->NURBS_EvalMethod >= NURBS_Eval_Count)
+ {
+  Vars->NURBS_EvalMethod = NURBS_Eval_Adaptive_MultiThreaded;
+ }
+ if (Vars->Parametric_EvalMethod >= Parametric_Eval_Count)
+ {
+  Vars->Parametric_EvalMethod = Parametric_Eval_MultiThreaded;
+ }
+ if (Vars->Bezier_EvalMethod >= Bezier_Eval_Count)
+ {
+  Vars->Bezier_EvalMethod = Bezier_Eval_Adaptive_MultiThreaded;
+ }
+ if (Vars->CubicSpline_EvalMethod >= CubicSpline_Eval_Count)
+ {
+  Vars->CubicSpline_EvalMethod = CubicSpline_Eval_Adaptive_MultiThreaded;
+ }
+ if (Vars->Polynomial_EvalMethod >= Polynomial_Eval_Count)
+ {
+  Vars->Polynomial_EvalMethod = Polynomial_Eval_Adaptive_MultiThreaded;
+ }
+ if (Vars->CubicSplinePeriodicM_EvalMethod >= CubicSplinePeriodicM_Eval_Count)
+ {
+  Vars->CubicSplinePeriodicM_EvalMethod = CubicSplinePeriodicM_Eval_Base;
+ }
+}
+
 internal void
 DevUpdateAndRender(editor *Editor, render_group *RenderGroup)
 {
@@ -289,6 +337,26 @@ DevUpdateAndRender(editor *Editor, render_group *RenderGroup)
   }
 #endif
   
+#if BUILD_DEV
+  // NOTE(hbr): Create Polynomial curve benchmark
+  {
+   entity *Entity = AddEntity(Editor);
+   
+   curve_params PolynomialCurveParams = DefaultCurveParams();
+   PolynomialCurveParams.Type = Curve_Polynomial;
+   PolynomialCurveParams.Polynomial.Type = PolynomialInterpolation_Barycentric;
+   PolynomialCurveParams.Polynomial.PointSpacing = PointSpacing_Chebychev;
+   PolynomialCurveParams.SamplesPerControlPoint = 500;
+   
+   InitEntityAsCurve(Entity, StrLit("Polynomial Benchmark"), PolynomialCurveParams);
+   entity_with_modify_witness Witness = BeginEntityModify(Entity);
+   AppendMultipleControlPoints(Editor, &Witness, 25);
+   EndEntityModify(Witness);
+   
+   DEBUG_Vars->Polynomial_BenchmarkEntity = Entity;
+  }
+#endif
+  
 #if BUILD_DEV
   DEBUG_Vars->ParametricCurveMaxTotalSamples = 50000;
   DEBUG_Vars->DevConsole = true;
@@ -302,9 +370,11 @@ DevUpdateAndRender(editor *Editor, render_group *RenderGroup)
   DEBUG_Vars->NURBS_EvalMethod = NURBS_Eval_Adaptive_MultiThreaded;
   DEBUG_Vars->Parametric_EvalMethod = Parametric_Eval_MultiThreaded;
   DEBUG_Vars->Bezier_EvalMethod = Bezier_Eval_Adaptive_MultiThreaded;
-  DEBUG_Vars->CubicSpline_EvalMethod = CubicSpline_Eval_ScalarWithBinarySearch_MultiThreaded;
+  DEBUG_Vars->CubicSpline_EvalMethod = CubicSpline_Eval_Adaptive_MultiThreaded;
+  DEBUG_Vars->Polynomial_EvalMethod = Polynomial_Eval_Adaptive_MultiThreaded;
   DEBUG_Vars->CubicSplinePeriodicM_EvalMethod = CubicSplinePeriodicM_Eval_Base;
   DEBUG_Vars->MultiThreadedEvaluationBlockSize = 1024;
+  DEBUG_Vars->AsyncCurveRecompute = true;
   
   DEBUG_Vars->Initialized = true;
  }
@@ -353,5 +423,16 @@ DevUpdateAndRender(editor *Editor, render_group *RenderGroup)
   }
  }
  
+ if (DEBUG_Vars->Polynomial_BenchmarkEntity)
+ {
+  SetEntityVisibility(DEBUG_Vars->Polynomial_BenchmarkEntity, DEBUG_Vars->Polynomial_Benchmark);
+  if (DEBUG_Vars->Polynomial_Benchmark)
+  { 
+   entity_with_modify_witness Witness = BeginEntityModify(DEBUG_Vars->Polynomial_BenchmarkEntity);
+   MarkEntityModified(&Witness);
+   EndEntityModify(Witness);
+  }
+ }
+ 
  RenderDevConsoleUI(Editor, RenderGroup);
 }
@@ -27,6 +27,13 @@ enum nurbs_eval_method : u32
  NURBS_Eval_SSE_MultiThreaded,
  NURBS_Eval_AVX2_MultiThreaded,
  NURBS_Eval_Adaptive_MultiThreaded,
+ NURBS_Eval_Extracted_Scalar,
+ NURBS_Eval_Extracted_SSE,
+ NURBS_Eval_Extracted_AVX2,
+ NURBS_Eval_Extracted_AVX512,
+ NURBS_Eval_Extracted_SSE_MultiThreaded,
+ NURBS_Eval_Extracted_AVX2_MultiThreaded,
+ NURBS_Eval_Extracted_AVX512_MultiThreaded,
  NURBS_Eval_Count
 };
 global read_only string NURBS_Eval_Names[] = {
@@ -38,6 +45,13 @@ global read_only string NURBS_Eval_Names[] = {
  StrLit("NURBS_Eval_SSE_MultiThreaded"),
  StrLit("NURBS_Eval_AVX2_MultiThreaded"),
  StrLit("NURBS_Eval_Adaptive_MultiThreaded"),
+ StrLit("NURBS_Eval_Extracted_Scalar"),
+ StrLit("NURBS_Eval_Extracted_SSE"),
+ StrLit("NURBS_Eval_Extracted_AVX2"),
+ StrLit("NURBS_Eval_Extracted_AVX512"),
+ StrLit("NURBS_Eval_Extracted_SSE_MultiThreaded"),
+ StrLit("NURBS_Eval_Extracted_AVX2_MultiThreaded"),
+ StrLit("NURBS_Eval_Extracted_AVX512_MultiThreaded"),
 };
 StaticAssert(ArrayCount(NURBS_Eval_Names) == NURBS_Eval_Count, NURBS_Eval_Names_AllDefined);
 
@@ -53,6 +67,8 @@ global read_only string Parametric_Eval_Names[] = {
 };
 StaticAssert(ArrayCount(Parametric_Eval_Names) == Parametric_Eval_Count, Parametric_Eval_Names_AllDefined);
 
+// NOTE(hbr): ForwardDifferencing is exact only up to cubics, higher degrees stay within
+// BezierForwardDifferencesRelativeTolerance of the curve
 enum bezier_eval_method : u32
 {
  Bezier_Eval_Scalar,
@@ -63,6 +79,8 @@ enum bezier_eval_method : u32
  Bezier_Eval_AVX2_MultiThreaded,
  Bezier_Eval_AVX512_MultiThreaded,
  Bezier_Eval_Adaptive_MultiThreaded,
+ Bezier_Eval_ForwardDifferencing,
+ Bezier_Eval_ForwardDifferencing_MultiThreaded,
  Bezier_Eval_Count
 };
 global read_only string Bezier_Eval_Names[] = {
@@ -74,6 +92,8 @@ global read_only string Bezier_Eval_Names[] = {
  StrLit("Bezier_Eval_AVX2_MultiThreaded"),
  StrLit("Bezier_Eval_AVX512_MultiThreaded"),
  StrLit("Bezier_Eval_Adaptive_MultiThreaded"),
+ StrLit("Bezier_Eval_ForwardDifferencing"),
+ StrLit("Bezier_Eval_ForwardDifferencing_MultiThreaded"),
 };
 StaticAssert(ArrayCount(Bezier_Eval_Names) == Bezier_Eval_Count, Bezier_Eval_Names_AllDefined);
 
@@ -84,6 +104,13 @@ enum cubic_spline_eval_method : u32
  CubicSpline_Eval_ScalarWithConstantSearch,
  CubicSpline_Eval_Scalar_MultiThreaded,
  CubicSpline_Eval_ScalarWithBinarySearch_MultiThreaded,
+ CubicSpline_Eval_Adaptive_MultiThreaded,
+ CubicSpline_Eval_SSE,
+ CubicSpline_Eval_AVX2,
+ CubicSpline_Eval_AVX512,
+ CubicSpline_Eval_SSE_MultiThreaded,
+ CubicSpline_Eval_AVX2_MultiThreaded,
+ CubicSpline_Eval_AVX512_MultiThreaded,
  CubicSpline_Eval_Count
 };
 global read_only string CubicSpline_Eval_Names[] = {
@@ -92,6 +119,13 @@ global read_only string CubicSpline_Eval_Names[] = {
  StrLit("CubicSpline_Eval_ScalarWithConstantSearch"),
  StrLit("CubicSpline_Eval_Scalar_MultiThreaded"),
  StrLit("CubicSpline_Eval_ScalarWithBinarySearch_MultiThreaded"),
+ StrLit("CubicSpline_Eval_Adaptive_MultiThreaded"),
+ StrLit("CubicSpline_Eval_SSE"),
+ StrLit("CubicSpline_Eval_AVX2"),
+ StrLit("CubicSpline_Eval_AVX512"),
+ StrLit("CubicSpline_Eval_SSE_MultiThreaded"),
+ StrLit("CubicSpline_Eval_AVX2_MultiThreaded"),
+ StrLit("CubicSpline_Eval_AVX512_MultiThreaded"),
 };
 StaticAssert(ArrayCount(CubicSpline_Eval_Names) == CubicSpline_Eval_Count, CubicSpline_Eval_Names_AllDefined);
 
@@ -107,6 +141,30 @@ global read_only string CubicSplinePeriodicM_Eval_Names[] = {
 };
 StaticAssert(ArrayCount(CubicSplinePeriodicM_Eval_Names) == CubicSplinePeriodicM_Eval_Count, CubicSplinePeriodicM_Eval_Names_AllDefined);
 
+enum polynomial_eval_method : u32
+{
+ Polynomial_Eval_Scalar,
+ Polynomial_Eval_SSE,
+ Polynomial_Eval_AVX2,
+ Polynomial_Eval_AVX512,
+ Polynomial_Eval_SSE_MultiThreaded,
+ Polynomial_Eval_AVX2_MultiThreaded,
+ Polynomial_Eval_AVX512_MultiThreaded,
+ Polynomial_Eval_Adaptive_MultiThreaded,
+ Polynomial_Eval_Count
+};
+global read_only string Polynomial_Eval_Names[] = {
+ StrLit("Polynomial_Eval_Scalar"),
+ StrLit("Polynomial_Eval_SSE"),
+ StrLit("Polynomial_Eval_AVX2"),
+ StrLit("Polynomial_Eval_AVX512"),
+ StrLit("Polynomial_Eval_SSE_MultiThreaded"),
+ StrLit("Polynomial_Eval_AVX2_MultiThreaded"),
+ StrLit("Polynomial_Eval_AVX512_MultiThreaded"),
+ StrLit("Polynomial_Eval_Adaptive_MultiThreaded"),
+};
+StaticAssert(ArrayCount(Polynomial_Eval_Names) == Polynomial_Eval_Count, Polynomial_Eval_Names_AllDefined);
+
 struct debug_vars
 {
  b32 Initialized;
@@ -127,7 +185,12 @@ struct debug_vars
  entity *CubicSpline_BenchmarkEntity;
  cubic_spline_eval_method CubicSpline_EvalMethod;
  
+ b32 Polynomial_Benchmark;
+ entity *Polynomial_BenchmarkEntity;
+ polynomial_eval_method Polynomial_EvalMethod;
+ 
  u32 MultiThreadedEvaluationBlockSize;
+ b32 AsyncCurveRecompute;
  
  cubic_spline_periodic_m_eval_method CubicSplinePeriodicM_EvalMethod;
  
@@ -141,6 +204,7 @@ struct debug_vars
 };
 global debug_vars *DEBUG_Vars;
 
+internal void SanitizeLoadedDebugVars(debug_vars *Vars);
 internal void DevUpdateAndRender(editor *Editor, render_group *RenderGroup);
 internal void UI_ParametricEquationExpr(parametric_equation_expr *Expr, string Label);
 internal void UI_ExponentialAnimation(exponential_animation *Anim);
@@ -11,7 +11,7 @@
 internal void
 InitLeftClickState(editor_left_click_state *LeftClick, arena_store *ArenaStore)
 {
- LeftClick->OriginalVerticesArena = AllocArenaFromStore(ArenaStore, Megabytes(128));
+ LeftClick->OriginalVerticesArena = AllocArenaFromStore(ArenaStore, Megabytes(128), MemoryTag_UI);
 }
 
 internal void
@@ -262,6 +262,8 @@ AllocArenaStore(void)
  arena *Arena = AllocArena(Megabytes(1));
  arena_store *ArenaStore = PushStruct(Arena, arena_store);
  ArenaStore->Arena = Arena;
+ ArenaStore->MaxIdleCommited = ArenaPoolDefaultMaxIdleCommited;
+ OS_MutexAlloc(&ArenaStore->Mutex);
  return ArenaStore;
 }
 
@@ -276,41 +278,183 @@ DeallocArenaStoreAndAllArenas(arena_store *ArenaStore)
    Node->Deallocated = true;
   }
  }
+ OS_MutexDealloc(&ArenaStore->Mutex);
  DeallocArena(ArenaStore->Arena);
 }
 
+internal u64
+ArenaPoolReserveFromSizeClass(u32 SizeClass)
+{
+ u64 Reserve = (Cast(u64)1 << (ArenaPoolMinReserveLog2 + SizeClass));
+ return Reserve;
+}
+
+internal u32
+ArenaPoolSizeClassFromReserve(u64 Reserve)
+{
+ u32 SizeClass = 0;
+ while (ArenaPoolReserveFromSizeClass(SizeClass) < Reserve)
+ {
+  ++SizeClass;
+ }
+ Assert(SizeClass < ArenaPoolSizeClassCount);
+ return SizeClass;
+}
+
+// NOTE(hbr): Arena capacity is its reserve plus header page, that is less than twice
+// the reserve, so the largest class fitting in the capacity is the one it came from
+internal u32
+ArenaPoolSizeClassFromArena(arena *Arena)
+{
+ u32 SizeClass = 0;
+ while (SizeClass + 1 < ArenaPoolSizeClassCount &&
+        ArenaPoolReserveFromSizeClass(SizeClass + 1) <= Arena->Capacity)
+ {
+  ++SizeClass;
+ }
+ return SizeClass;
+}
+
 internal arena *
-AllocArenaFromStore(arena_store *ArenaStore, u64 ReserveButNotCommit)
+AllocArenaFromStore(arena_store *ArenaStore, u64 ReserveButNotCommit, memory_tag Tag)
 {
- arena_node *Node = PushStruct(ArenaStore->Arena, arena_node);
- arena *Arena = AllocArena(ReserveButNotCommit);
- Node->Arena = Arena;
- QueuePush(ArenaStore->Head, ArenaStore->Tail, Node);
+ OS_MutexLock(&ArenaStore->Mutex);
+ 
+ u32 SizeClass = ArenaPoolSizeClassFromReserve(ReserveButNotCommit);
+ arena_pool *Pool = ArenaStore->Pools + SizeClass;
+ arena_pool_stats *Stats = &Pool->Stats;
+ 
+ arena *Arena = 0;
+ arena_pool_entry *Entry = Pool->Idle;
+ if (Entry)
+ {
+  StackPop(Pool->Idle);
+  Arena = Entry->Arena;
+  StackPush(ArenaStore->FreeEntry, Entry);
+  
+  --Stats->IdleCount;
+  Stats->IdleCommited -= Arena->Commited;
+  ArenaStore->IdleCommited -= Arena->Commited;
+  ++Stats->ReuseCount;
+ }
+ else
+ {
+  arena_node *Node = PushStruct(ArenaStore->Arena, arena_node);
+  Arena = AllocArena(ArenaPoolReserveFromSizeClass(SizeClass));
+  Node->Arena = Arena;
+  QueuePush(ArenaStore->Head, ArenaStore->Tail, Node);
+ }
+ Arena->Tag = Tag;
+ Arena->PeakUsed = 0;
+ ++Stats->LiveCount;
+ ++Stats->AllocCount;
+ 
+ OS_MutexUnlock(&ArenaStore->Mutex);
+ 
  return Arena;
 }
 
 internal void
 DeallocArenaFromStore(arena_store *ArenaStore, arena *Arena)
 {
- b32 Deallocated = false;
- ListIter(Node, ArenaStore->Head, arena_node)
+ OS_MutexLock(&ArenaStore->Mutex);
+ 
+ // NOTE(hbr): Blocks chained on overflow don't have size class, give them back right away
+ DeallocArena(Arena->Next);
+ Arena->Next = 0;
+ ClearArena(Arena);
+ Arena->Tag = MemoryTag_Pooled;
+ 
+ u32 SizeClass = ArenaPoolSizeClassFromArena(Arena);
+ arena_pool *Pool = ArenaStore->Pools + SizeClass;
+ arena_pool_stats *Stats = &Pool->Stats;
+ 
+ arena_pool_entry *Entry = ArenaStore->FreeEntry;
+ if (Entry)
+ {
+  StackPop(ArenaStore->FreeEntry);
+ }
+ else
+ {
+  Entry = PushStructNonZero(ArenaStore->Arena, arena_pool_entry);
+ }
+ Entry->Arena = Arena;
+ StackPush(Pool->Idle, Entry);
+ 
+ Assert(Stats->LiveCount > 0);
+ --Stats->LiveCount;
+ ++Stats->IdleCount;
+ Stats->IdleCommited += Arena->Commited;
+ ArenaStore->IdleCommited += Arena->Commited;
+ b32 OverBudget = (ArenaStore->IdleCommited > ArenaStore->MaxIdleCommited);
+ 
+ OS_MutexUnlock(&ArenaStore->Mutex);
+ 
+ if (OverBudget)
+ {
+  TrimArenaStore(ArenaStore, ArenaStore->MaxIdleCommited / 2);
+ }
+}
+
+// NOTE(hbr): Arena that most owners never need, allocated the first time it is asked for
+internal arena *
+EnsureArenaFromStore(arena_store *ArenaStore, arena **Arena, u64 ReserveButNotCommit, memory_tag Tag)
+{
+ if (!*Arena)
+ {
+  *Arena = AllocArenaFromStore(ArenaStore, ReserveButNotCommit, Tag);
+ }
+ return *Arena;
+}
+
+internal void
+DeallocArenaFromStoreIfAllocated(arena_store *ArenaStore, arena **Arena)
+{
+ if (*Arena)
+ {
+  DeallocArenaFromStore(ArenaStore, *Arena);
+  *Arena = 0;
+ }
+}
+
+// NOTE(hbr): Decommits idle arenas, biggest size classes first, until no more than
+// [MaxIdleCommited] bytes stay commited. They keep their address space and stay pooled.
+internal void
+TrimArenaStore(arena_store *ArenaStore, u64 MaxIdleCommited)
+{
+ OS_MutexLock(&ArenaStore->Mutex);
+ 
+ for (u32 SizeClass = ArenaPoolSizeClassCount;
+      SizeClass > 0 && ArenaStore->IdleCommited > MaxIdleCommited;
+      --SizeClass)
  {
-  if (Node->Arena == Arena)
+  arena_pool *Pool = ArenaStore->Pools + (SizeClass - 1);
+  arena_pool_stats *Stats = &Pool->Stats;
+  for (arena_pool_entry *Entry = Pool->Idle;
+       Entry && ArenaStore->IdleCommited > MaxIdleCommited;
+       Entry = Entry->Next)
   {
-   DeallocArena(Arena);
-   Node->Deallocated = true;
-   Deallocated = true;
-   break;
+   arena *Arena = Entry->Arena;
+   u64 CommitedBefore = Arena->Commited;
+   DecommitArena(Arena);
+   u64 Decommited = CommitedBefore - Arena->Commited;
+   if (Decommited)
+   {
+    Stats->IdleCommited -= Decommited;
+    ArenaStore->IdleCommited -= Decommited;
+    ++Stats->DecommitCount;
+   }
   }
  }
- Assert(Deallocated);
+ 
+ OS_MutexUnlock(&ArenaStore->Mutex);
 }
 
 internal void
 InitProjectChangeRequestState(arena_store *ArenaStore,
                               project_change_request_state *State)
 {
- State->Arena = AllocArenaFromStore(ArenaStore, Megabytes(1));
+ State->Arena = AllocArenaFromStore(ArenaStore, Megabytes(1), MemoryTag_UI);
 }
 
 internal void
@@ -321,6 +465,8 @@ AllocEditorResources(editor *Editor)
  
  if (Editor->ArenaStore)
  {
+  // NOTE(hbr): Curves recomputed in the background still use their arenas
+  Platform.WorkQueueCompleteAllWork(Editor->LowPriorityQueue);
   DeallocArenaStoreAndAllArenas(Editor->ArenaStore);
   StructZero(Editor);
  }
@@ -328,7 +474,7 @@ AllocEditorResources(editor *Editor)
  arena_store *ArenaStore = AllocArenaStore();
  Editor->PersistentState = Persistent;
  Editor->ArenaStore = ArenaStore;
- Editor->Arena = AllocArenaFromStore(ArenaStore, Gigabytes(64));
+ Editor->Arena = AllocArenaFromStore(ArenaStore, Gigabytes(64), MemoryTag_Editor);
  Editor->LowPriorityQueue = Memory->LowPriorityQueue;
  Editor->HighPriorityQueue = Memory->HighPriorityQueue;
  Editor->RendererQueue = Memory->RendererQueue;
@@ -336,9 +482,11 @@ AllocEditorResources(editor *Editor)
  Editor->CurvePointsStore = AllocCurvePointsStore(ArenaStore);
  Editor->EntityStore = AllocEntityStore(ArenaStore, Memory->MaxTextureCount, Memory->MaxBufferCount);
  Editor->ThreadTaskMemoryStore = AllocThreadTaskMemoryStore(ArenaStore);
+ Editor->CurveRecomputeBatch = AllocCurveRecomputeBatch(ArenaStore);
+ Editor->CurveEvalCache = AllocCurveEvalCache(ArenaStore);
  Editor->ImageLoadingStore = AllocImageLoadingStore(ArenaStore);
- Editor->ProjectFilePathArena = AllocArenaFromStore(ArenaStore, Megabytes(1));
- Editor->NotificationsArena = AllocArenaFromStore(ArenaStore, Megabytes(1));
+ Editor->ProjectFilePathArena = AllocArenaFromStore(ArenaStore, Megabytes(1), MemoryTag_UI);
+ Editor->NotificationsArena = AllocArenaFromStore(ArenaStore, Megabytes(1), MemoryTag_UI);
  
  InitEditorCtx(Editor->ArenaStore,
                Editor->RendererQueue,
@@ -347,8 +495,11 @@ AllocEditorResources(editor *Editor)
                Editor->ImageLoadingStore,
                Editor->StrStore,
                Editor->CurvePointsStore,
+               Editor->CurveRecomputeBatch,
+               Editor->CurveEvalCache,
                Editor->LowPriorityQueue,
-               Editor->HighPriorityQueue);
+               Editor->HighPriorityQueue,
+               &Editor->PersistentState.EvalCalibration);
  
  InitLeftClickState(&Editor->LeftClick, ArenaStore);
  InitVisualProfiler(&Editor->Profiler, Memory->Profiler);
@@ -578,8 +729,9 @@ AllocEntityInternal(entity_store *Store, b32 DontTrack, entity *From)
  // NOTE(hbr): It shouldn't really matter anyway that we allocate arenas even for
  // entities other than curves.
  Curve->Points = AllocCurvePointsFromStore(GetCtx()->CurvePointsStore);
- Curve->ComputeArena = AllocArenaFromStore(GetCtx()->ArenaStore, Megabytes(32));
- Curve->DegreeReduction.Arena = AllocArenaFromStore(GetCtx()->ArenaStore, Megabytes(32));
+ Curve->ComputeArena = AllocArenaFromStore(GetCtx()->ArenaStore, Megabytes(32), MemoryTag_CurveCompute);
+ Curve->DegreeReduction.Arena = AllocArenaFromStore(GetCtx()->ArenaStore, Megabytes(32), MemoryTag_CurveCaches);
+ // NOTE(hbr): Caches and async recompute arenas are allocated on first use, only some curves need them
  
  if (!DontTrack)
  {
@@ -613,6 +765,7 @@ LoadProjectFromFile(editor *Editor, string FilePath)
      Header.Version == EditorVersion)
  {
   DeserializeStruct(&Deserial, &SerializableState);
+  SanitizeLoadedDebugVars(&SerializableState.DEBUG_Vars);
   
   AllocEditorResources(Editor);
   InitEditor(Editor, SerializableState, true, FilePath);
@@ -665,6 +818,7 @@ LoadProjectFromFile(editor *Editor, string FilePath)
    SetOrAllocCurvePointsOfId(CurvePointsStore, Id, Points);
   }
   
+  BeginCurveRecomputeBatch();
   ForEachIndex(EntityIndex, Header.EntityCount)
   {
    entity Serialized = {};
@@ -690,6 +844,7 @@ LoadProjectFromFile(editor *Editor, string FilePath)
     case Entity_Count: InvalidPath;
    }
   }
+  EndCurveRecomputeBatch();
   
   Success = true;
  }
@@ -739,7 +894,7 @@ SaveProjectIntoFile(editor *Editor, string FilePath)
       ++CurvePointsIndex)
  {
   curve_points_id Id = CurvePointsIdFromIndex(CurvePointsIndex);
-  curve_points_static *Points = CurvePointsFromId(CurvePointsStore, Id);
+  curve_points *Points = CurvePointsFromId(CurvePointsStore, Id);
   SerializeStruct(Temp.Arena, &Data, &Points->ControlPointCount);
   SerializeArray(Temp.Arena, &Data, Points->ControlPoints, Points->ControlPointCount);
   SerializeArray(Temp.Arena, &Data, Points->ControlPointWeights, Points->ControlPointCount);
@@ -828,7 +983,7 @@ SplitCurveOnControlPoint(editor *Editor, entity *Entity)
  {
   temp_arena Temp = TempArena(0);
   
-  curve_points_static *Points = CurvePointsFromId(GetCtx()->CurvePointsStore, Curve->Points);
+  curve_points *Points = CurvePointsFromId(GetCtx()->CurvePointsStore, Curve->Points);
   
   u32 SelectedIndex = IndexFromControlPointHandle(Curve->SelectedControlPoint);
   u32 HeadPointCount = SelectedIndex + 1;
@@ -884,9 +1039,9 @@ ElevateBezierCurveDegree(editor *Editor, entity *Entity)
  Assert(IsRegularBezierCurve(Curve));
  entity_with_modify_witness Witness = BeginEntityModify(Entity);
  curve_points_store *CurvePointsStore = Editor->CurvePointsStore;
- curve_points_static *Points = CurvePointsFromId(CurvePointsStore, Curve->Points);
+ curve_points *Points = CurvePointsFromId(CurvePointsStore, Curve->Points);
  u32 PointCount = Points->ControlPointCount;
- begin_modify_curve_points_static_tracked_result BeginModify = BeginModifyCurvePointsTracked(Editor, &Witness, PointCount + 1, ModifyCurvePointsWhichPoints_ControlPointsAndWeights);
+ begin_modify_curve_points_tracked_result BeginModify = BeginModifyCurvePointsTracked(Editor, &Witness, PointCount + 1, ModifyCurvePointsWhichPoints_ControlPointsAndWeights);
  curve_points_modify_handle ModifyPoints = BeginModify.ModifyPoints;
  tracked_action *ModifyAction = BeginModify.ModifyAction;
  if (ModifyPoints.PointCount == PointCount + 1)
@@ -909,28 +1064,28 @@ CopyLineVertices(arena *Arena, vertex_array Vertices)
  return Result;
 }
 
-internal curve_points_static *
+internal curve_points *
 AllocCurvePoints(editor *Editor)
 {
- curve_points_static_node *Node = Editor->FreeCurvePointsNode;
+ curve_points_node *Node = Editor->FreeCurvePointsNode;
  if (Node)
  {
   StackPop(Editor->FreeCurvePointsNode);
  }
  else
  {
-  Node = PushStructNonZero(Editor->Arena, curve_points_static_node);
+  Node = PushStructNonZero(Editor->Arena, curve_points_node);
  }
- curve_points_static *Points = &Node->Points;
- // NOTE(hbr): Don't [StructZero] because it is a big struct and it's not necessary
- Points->ControlPointCount = 0;
+ curve_points *Points = &Node->Points;
+ StructZero(Points);
  return Points;
 }
 
 internal void
-DeallocCurvePoints(editor *Editor, curve_points_static *Points)
+DeallocCurvePoints(editor *Editor, curve_points *Points)
 {
- curve_points_static_node *Node = ContainerOf(Points, curve_points_static_node, Points);
+ ReleaseCurvePointsToStore(Editor->CurvePointsStore, Points);
+ curve_points_node *Node = ContainerOf(Points, curve_points_node, Points);
  StackPush(Editor->FreeCurvePointsNode, Node);
 }
 
@@ -949,7 +1104,7 @@ PerformBezierCurveSplit(editor *Editor, entity *Entity)
  curve *Curve = SafeGetCurve(Entity);
  point_tracking_along_curve_state *Tracking = &Curve->PointTracking;
  
- curve_points_static *Points = CurvePointsFromId(GetCtx()->CurvePointsStore, Curve->Points);
+ curve_points *Points = CurvePointsFromId(GetCtx()->CurvePointsStore, Curve->Points);
  u32 ControlPointCount = Points->ControlPointCount;
  
  Assert(Tracking->Type == PointTrackingAlongCurve_BezierCurveSplit);
@@ -1035,7 +1190,7 @@ MaybeReverseCurvePoints(entity *Entity)
  if (IsCurveReversed(Entity))
  {
   curve *Curve = SafeGetCurve(Entity);
-  curve_points_static *Points = GetCurvePoints(Curve);
+  curve_points *Points = GetCurvePoints(Curve);
   ArrayReverse(Points->ControlPoints,       Points->ControlPointCount, v2);
   ArrayReverse(Points->ControlPointWeights, Points->ControlPointCount, f32);
   ArrayReverse(Points->CubicBezierPoints,   Points->ControlPointCount, cubic_bezier_point);
@@ -1657,21 +1812,21 @@ EndControlPointMove(editor *Editor, tracked_action *MoveAction)
  FinishPendingAction(Editor, Group, MoveAction, Cancel);
 }
 
-internal begin_modify_curve_points_static_tracked_result
+internal begin_modify_curve_points_tracked_result
 BeginModifyCurvePointsTracked(editor *Editor,
                               entity_with_modify_witness *Entity,
                               u32 RequestedPointCount,
-                              modify_curve_points_static_which_points Which)
+                              modify_curve_points_which_points Which)
 {
  action_tracking_group *Group = GetPendingActionTrackingGroup(Editor);
  tracked_action *Action = NextTrackedActionFromGroup(Editor, Group, true);
  Action->Type = TrackedAction_ModifyCurvePoints;
  Action->Entity = MakeEntityHandle(Entity->Entity);
- curve_points_static *CurvePoints = AllocCurvePoints(Editor);
- CopyCurvePointsFromCurve(SafeGetCurve(Entity->Entity), CurvePointsDynamicFromStatic(CurvePoints));
+ curve_points *CurvePoints = AllocCurvePoints(Editor);
+ CopyCurvePointsFromCurve(SafeGetCurve(Entity->Entity), CurvePoints);
  Action->CurvePoints = CurvePoints;
  curve_points_modify_handle Handle = BeginModifyCurvePoints(Entity, RequestedPointCount, Which);
- begin_modify_curve_points_static_tracked_result Result = {};
+ begin_modify_curve_points_tracked_result Result = {};
  Result.ModifyPoints = Handle;
  Result.ModifyAction = Action;
  return Result;
@@ -1688,8 +1843,8 @@ EndModifyCurvePointsTracked(editor *Editor,
  entity *Entity = EntityFromHandle(ModifyAction->Entity);
  if (Entity)
  {
-  curve_points_static *CurvePoints = AllocCurvePoints(Editor);
-  CopyCurvePointsFromCurve(SafeGetCurve(Entity), CurvePointsDynamicFromStatic(CurvePoints));
+  curve_points *CurvePoints = AllocCurvePoints(Editor);
+  CopyCurvePointsFromCurve(SafeGetCurve(Entity), CurvePoints);
   ModifyAction->FinalCurvePoints = CurvePoints;
   Cancel = false;
  }
@@ -1699,8 +1854,8 @@ EndModifyCurvePointsTracked(editor *Editor,
 internal void
 SetCurvePointsTracked(editor *Editor, entity_with_modify_witness *Entity, curve_points_handle Points)
 {
- begin_modify_curve_points_static_tracked_result Modify = BeginModifyCurvePointsTracked(Editor, Entity, Points.ControlPointCount,
-                                                                                        ModifyCurvePointsWhichPoints_ControlPointsAndWeightsAndCubicBeziers);
+ begin_modify_curve_points_tracked_result Modify = BeginModifyCurvePointsTracked(Editor, Entity, Points.ControlPointCount,
+                                                                                 ModifyCurvePointsWhichPoints_ControlPointsAndWeightsAndCubicBeziers);
  curve_points_modify_handle ModifyPoints = Modify.ModifyPoints;
  tracked_action *ModifyAction = Modify.ModifyAction;
  SetCurvePoints(Entity, Points);
@@ -1819,6 +1974,7 @@ Undo(editor *Editor)
   --Batch->ActionTrackingGroupIndex;
   action_tracking_group *Group = Batch->ActionTrackingGroups + Batch->ActionTrackingGroupIndex;
   
+  BeginCurveRecomputeBatch();
   ListIterRev(Action, Group->ActionsTail, tracked_action)
   {
    b32 AllowDeactived = (Action->Type == TrackedAction_RemoveEntity);
@@ -1862,13 +2018,14 @@ Undo(editor *Editor)
      }break;
      
      case TrackedAction_ModifyCurvePoints: {
-      curve_points_static *Points = Action->CurvePoints;
-      SetCurvePoints(&Witness, CurvePointsHandleFromCurvePointsStatic(Points));
+      curve_points *Points = Action->CurvePoints;
+      SetCurvePoints(&Witness, CurvePointsHandleFromCurvePoints(Points));
      }break;
     }
     EndEntityModify(Witness);
    }
   }
+  EndCurveRecomputeBatch();
  }
 }
 
@@ -1882,6 +2039,7 @@ Redo(editor *Editor)
   action_tracking_group *Group = Batch->ActionTrackingGroups + Batch->ActionTrackingGroupIndex;
   ++Batch->ActionTrackingGroupIndex;
   
+  BeginCurveRecomputeBatch();
   ListIter(Action, Group->ActionsHead, tracked_action)
   {
    b32 AllowDeactived = (Action->Type == TrackedAction_AddEntity);
@@ -1923,13 +2081,14 @@ Redo(editor *Editor)
      }break;
      
      case TrackedAction_ModifyCurvePoints: {
-      curve_points_static *Points = Action->FinalCurvePoints;
-      SetCurvePoints(&Witness, CurvePointsHandleFromCurvePointsStatic(Points));
+      curve_points *Points = Action->FinalCurvePoints;
+      SetCurvePoints(&Witness, CurvePointsHandleFromCurvePoints(Points));
      }break;
     }
     EndEntityModify(Witness);
    }
   }
+  EndCurveRecomputeBatch();
  }
 }
 
@@ -1990,12 +2149,12 @@ AllocEntityStore(arena_store *ArenaStore,
                  u32 MaxTextureCount,
                  u32 MaxBufferCount)
 {
- arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1));
+ arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1), MemoryTag_Entities);
  entity_store *Store = PushStruct(Arena, entity_store);
  Store->Arena = Arena;
  ForEachElement(Index, Store->ByTypeArenas)
  {
-  Store->ByTypeArenas[Index] = AllocArenaFromStore(ArenaStore, Megabytes(1));
+  Store->ByTypeArenas[Index] = AllocArenaFromStore(ArenaStore, Megabytes(1), MemoryTag_Entities);
  }
  Store->TextureCount = MaxTextureCount;
  Store->TextureHandleRefCount = PushArray(Arena, MaxTextureCount, b32);
@@ -2007,7 +2166,7 @@ AllocEntityStore(arena_store *ArenaStore,
 internal curve_points_store *
 AllocCurvePointsStore(arena_store *ArenaStore)
 {
- arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1));
+ arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1), MemoryTag_CurvePoints);
  curve_points_store *Store = PushStruct(Arena, curve_points_store);
  Store->Arena = Arena;
  Store->ArenaStore = ArenaStore;
@@ -2042,13 +2201,14 @@ AllocCurvePointsFromStore(curve_points_store *Store)
  if (Store->Count >= Store->Capacity)
  {
   u32 NewCapacity = Max(Store->Count + 1, 2 * Store->Capacity);
-  curve_points_static *NewCurvePoints = PushArrayNonZero(Store->Arena, NewCapacity, curve_points_static);
+  curve_points *NewCurvePoints = PushArrayNonZero(Store->Arena, NewCapacity, curve_points);
   ArrayCopy(NewCurvePoints, Store->CurvePoints, Store->Count);
   Store->CurvePoints = NewCurvePoints;
   Store->Capacity = NewCapacity;
  }
  Assert(Store->Count < Store->Capacity);
  u32 Index = Store->Count++;
+ StructZero(Store->CurvePoints + Index);
  curve_points_id Id = CurvePointsIdFromIndex(Index);
  return Id;
 }
@@ -2064,16 +2224,130 @@ SetOrAllocCurvePointsOfId(curve_points_store *Store,
   curve_points_id AllocatedId = AllocCurvePointsFromStore(Store);
   Assert(CurvePointsIdMatch(Id, AllocatedId));
  }
- curve_points_static *Dst = CurvePointsFromId(Store, Id);
- CopyCurvePoints(CurvePointsDynamicFromStatic(Dst), Points);
+ curve_points *Dst = CurvePointsFromId(Store, Id);
+ SetCurvePointsInStore(Store, Dst, Points);
+}
+
+internal u32
+CurvePointsCapacityFromSizeClass(u32 SizeClass)
+{
+ u32 Capacity = (1u << (CurvePointsMinCapacityLog2 + SizeClass));
+ return Capacity;
+}
+
+internal u32
+CurvePointsSizeClassFromCapacity(u32 Capacity)
+{
+ u32 SizeClass = 0;
+ while (CurvePointsCapacityFromSizeClass(SizeClass) < Capacity)
+ {
+  ++SizeClass;
+ }
+ Assert(SizeClass < CurvePointsSizeClassCount);
+ return SizeClass;
+}
+
+internal curve_points_block *
+AllocCurvePointsBlock(curve_points_store *Store, u32 SizeClass)
+{
+ curve_points_block *Block = Store->FreeBlocks[SizeClass];
+ if (Block)
+ {
+  StackPop(Store->FreeBlocks[SizeClass]);
+ }
+ else
+ {
+  u32 Capacity = CurvePointsCapacityFromSizeClass(SizeClass);
+  arena *Arena = Store->Arena;
+  Block = PushStructNonZero(Arena, curve_points_block);
+  Block->SizeClass = SizeClass;
+  Block->Capacity = Capacity;
+  Block->ControlPoints = PushArrayNonZero(Arena, Capacity, v2);
+  Block->ControlPointWeights = PushArrayNonZero(Arena, Capacity, f32);
+  Block->CubicBezierPoints = PushArrayNonZero(Arena, Capacity, cubic_bezier_point);
+  Block->BSplineKnots = PushArrayNonZero(Arena, CurvePointsKnotCapacity(Capacity), f32);
+ }
+ return Block;
+}
+
+internal void
+ReserveCurvePointsInStore(curve_points_store *Store, curve_points *Points, u32 ControlPointCount, u32 BSplineKnotCount)
+{
+ u32 RequiredCapacity = Max(ControlPointCount, (BSplineKnotCount + 1) / 2);
+ if (RequiredCapacity > Points->Capacity)
+ {
+  // NOTE(hbr): Copies pushed onto an arena are sized once and can't grow
+  Assert(Points->Block || Points->Capacity == 0);
+  
+  u32 SizeClass = CurvePointsSizeClassFromCapacity(Max(RequiredCapacity, 2 * Points->Capacity));
+  curve_points_block *Block = AllocCurvePointsBlock(Store, SizeClass);
+  
+  // NOTE(hbr): Knots past [BSplineKnotCount] might still be in use, move everything
+  u32 OldCapacity = Points->Capacity;
+  ArrayCopy(Block->ControlPoints, Points->ControlPoints, OldCapacity);
+  ArrayCopy(Block->ControlPointWeights, Points->ControlPointWeights, OldCapacity);
+  ArrayCopy(Block->CubicBezierPoints, Points->CubicBezierPoints, OldCapacity);
+  ArrayCopy(Block->BSplineKnots, Points->BSplineKnots, CurvePointsKnotCapacity(OldCapacity));
+  
+  if (Points->Block)
+  {
+   StackPush(Store->FreeBlocks[Points->Block->SizeClass], Points->Block);
+  }
+  
+  Points->Capacity = Block->Capacity;
+  Points->ControlPoints = Block->ControlPoints;
+  Points->ControlPointWeights = Block->ControlPointWeights;
+  Points->CubicBezierPoints = Block->CubicBezierPoints;
+  Points->BSplineKnots = Block->BSplineKnots;
+  Points->Block = Block;
+ }
+}
+
+internal void
+ReleaseCurvePointsToStore(curve_points_store *Store, curve_points *Points)
+{
+ curve_points_block *Block = Points->Block;
+ if (Block)
+ {
+  StackPush(Store->FreeBlocks[Block->SizeClass], Block);
+ }
+ StructZero(Points);
+}
+
+internal void
+SetCurvePointsInStore(curve_points_store *Store, curve_points *Dst, curve_points_handle Src)
+{
+ ReserveCurvePointsInStore(Store, Dst, Src.ControlPointCount, Src.BSplineKnotCount);
+ CopyCurvePoints(CurvePointsDynamicFromCurvePoints(Dst), Src);
+}
+
+internal void
+CopyCurvePointsToArena(arena *Arena, curve_points *Dst, curve_points_handle Src)
+{
+ u32 Capacity = Max(Src.ControlPointCount, (Src.BSplineKnotCount + 1) / 2);
+ StructZero(Dst);
+ Dst->Capacity = Capacity;
+ Dst->ControlPoints = PushArrayNonZero(Arena, Capacity, v2);
+ Dst->ControlPointWeights = PushArrayNonZero(Arena, Capacity, f32);
+ Dst->CubicBezierPoints = PushArrayNonZero(Arena, Capacity, cubic_bezier_point);
+ Dst->BSplineKnots = PushArrayNonZero(Arena, CurvePointsKnotCapacity(Capacity), f32);
+ CopyCurvePoints(CurvePointsDynamicFromCurvePoints(Dst), Src);
+}
+
+internal u64
+CurvePointsSizeFromCapacity(u32 Capacity)
+{
+ u64 Size = (Cast(u64)Capacity * (SizeOf(v2) + SizeOf(f32) + SizeOf(cubic_bezier_point)) +
+             Cast(u64)CurvePointsKnotCapacity(Capacity) * SizeOf(f32));
+ return Size;
 }
 
-internal curve_points_static *
+internal curve_points *
 CurvePointsFromId(curve_points_store *Store, curve_points_id Id)
 {
  u32 Index = IndexFromCurvePointsId(Id);
  Assert(Index < Store->Count);
- curve_points_static *Points = Store->CurvePoints + Index;
+ curve_points *Points = Store->CurvePoints + Index;
  return Points;
 }
 
@@ -2092,8 +2366,16 @@ DeallocEntity(entity_store *Store, entity *Entity)
  curve *Curve = &Entity->Curve;
  image *Image = &Entity->Image;
  
+ WaitForCurveAsyncRecompute(Curve);
+ 
  DeallocArenaFromStore(GetCtx()->ArenaStore, Curve->ComputeArena);
  DeallocArenaFromStore(GetCtx()->ArenaStore, Curve->DegreeReduction.Arena);
+ DeallocArenaFromStoreIfAllocated(GetCtx()->ArenaStore, &Curve->NURBS_Extraction.Arena);
+ DeallocArenaFromStoreIfAllocated(GetCtx()->ArenaStore, &Curve->BasisCache.Arena);
+ DeallocArenaFromStoreIfAllocated(GetCtx()->ArenaStore, &Curve->LOD.Arena);
+ DeallocArenaFromStoreIfAllocated(GetCtx()->ArenaStore, &Curve->AsyncRecompute.SnapshotArena);
+ DeallocArenaFromStoreIfAllocated(GetCtx()->ArenaStore, &Curve->AsyncRecompute.BackArena);
+ ReleaseCurvePointsToStore(GetCtx()->CurvePointsStore, CurvePointsFromId(GetCtx()->CurvePointsStore, Curve->Points));
  DeallocStringFromStore(GetCtx()->StrStore, Curve->ParametricResources.X_Equation.Equation);
  DeallocStringFromStore(GetCtx()->StrStore, Curve->ParametricResources.Y_Equation.Equation);
  
@@ -2102,6 +2384,7 @@ DeallocEntity(entity_store *Store, entity *Entity)
  DeallocTextureHandle(Store, Image->TextureHandle);
  
  DeactiveEntity(Store, Entity);
+ Entity->InternalFlags &= ~EntityInternalFlag_RecomputeQueued;
  
  entity_list_node *Node = ContainerOf(Entity, entity_list_node, Entity);
  StackPush(Store->Free, Node);
@@ -2180,7 +2463,7 @@ EntityArrayFromType(entity_store *Store, entity_type Type)
 internal thread_task_memory_store *
 AllocThreadTaskMemoryStore(arena_store *ArenaStore)
 {
- arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1));
+ arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1), MemoryTag_Tasks);
  thread_task_memory_store *Store = PushStruct(Arena, thread_task_memory_store);
  Store->Arena = Arena;
  Store->ArenaStore = ArenaStore;
@@ -2200,7 +2483,7 @@ BeginThreadTaskMemory(thread_task_memory_store *Store)
   Task = PushStructNonZero(Store->Arena, thread_task_memory);
  }
  StructZero(Task);
- Task->Arena = AllocArenaFromStore(Store->ArenaStore, Gigabytes(1));
+ Task->Arena = AllocArenaFromStore(Store->ArenaStore, Gigabytes(1), MemoryTag_Tasks);
  return Task;
 }
 
@@ -2211,10 +2494,82 @@ EndThreadTaskMemory(thread_task_memory_store *Store, thread_task_memory *Task)
  StackPush(Store->Free, Task);
 }
 
+internal curve_recompute_batch *
+AllocCurveRecomputeBatch(arena_store *ArenaStore)
+{
+ arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1), MemoryTag_CurveRecomputeBatch);
+ curve_recompute_batch *Batch = PushStruct(Arena, curve_recompute_batch);
+ Batch->Arena = Arena;
+ return Batch;
+}
+
+internal void
+BeginCurveRecomputeBatch(void)
+{
+ curve_recompute_batch *Batch = GetCtx()->CurveRecomputeBatch;
+ if (Batch->Depth == 0)
+ {
+  Batch->Temp = BeginTemp(Batch->Arena);
+ }
+ ++Batch->Depth;
+}
+
+internal void
+QueueCurveRecompute(curve_recompute_batch *Batch, entity *Entity)
+{
+ // NOTE(hbr): The same curve is often modified many times within one batch, queue it only once
+ if (!(Entity->InternalFlags & EntityInternalFlag_RecomputeQueued))
+ {
+  curve_recompute_batch_node *Node = PushStructNonZero(Batch->Arena, curve_recompute_batch_node);
+  Node->Entity = Entity;
+  StackPush(Batch->Head, Node);
+  ++Batch->Count;
+  Entity->InternalFlags |= EntityInternalFlag_RecomputeQueued;
+ }
+}
+
+internal void
+EndCurveRecomputeBatch(void)
+{
+ curve_recompute_batch *Batch = GetCtx()->CurveRecomputeBatch;
+ Assert(Batch->Depth > 0);
+ --Batch->Depth;
+ if (Batch->Depth == 0)
+ {
+  curve **Curves = PushArrayNonZero(Batch->Arena, Batch->Count, curve *);
+  u32 CurveCount = 0;
+  ListIter(Node, Batch->Head, curve_recompute_batch_node)
+  {
+   entity *Entity = Node->Entity;
+   // NOTE(hbr): Deallocated entities clear the flag, they have nothing to recompute anymore
+   if (Entity->InternalFlags & EntityInternalFlag_RecomputeQueued)
+   {
+    Entity->InternalFlags &= ~EntityInternalFlag_RecomputeQueued;
+    WaitForCurveAsyncRecompute(&Entity->Curve);
+    Curves[CurveCount++] = &Entity->Curve;
+   }
+  }
+  
+  // NOTE(hbr): Batches are opened every frame, most of them end up empty
+  if (CurveCount > 0)
+  {
+   RecomputeCurves(CurveCount, Curves);
+   ForEachIndex(CurveIndex, CurveCount)
+   {
+    MarkCurveRecomputed(ContainerOf(Curves[CurveIndex], entity, Curve));
+   }
+  }
+  
+  Batch->Head = 0;
+  Batch->Count = 0;
+  EndTemp(Batch->Temp);
+ }
+}
+
 internal image_loading_store *
 AllocImageLoadingStore(arena_store *ArenaStore)
 {
- arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1));
+ arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1), MemoryTag_Tasks);
  image_loading_store *Store = PushStruct(Arena, image_loading_store);
  Store->Arena = Arena;
  Store->ArenaStore = ArenaStore;
@@ -2242,7 +2597,7 @@ BeginAsyncImageLoadingTask(image_loading_store *Store)
  }
  StructZero(Task);
  
- Task->Arena = AllocArenaFromStore(Store->ArenaStore, Gigabytes(1));
+ Task->Arena = AllocArenaFromStore(Store->ArenaStore, Gigabytes(1), MemoryTag_Tasks);
  DLLPushBack(Store->Head, Store->Tail, Task);
  
  return Task;
@@ -2361,7 +2716,7 @@ CheckCollisionWithEntities(editor *Editor, v2 AtP, f32 Tolerance)
      curve *Curve = &Entity->Curve;
      curve_params *Params = &Curve->Params;
      curve_points_store *CurvePointsStore = Editor->CurvePointsStore;
-     curve_points_static *Points = CurvePointsFromId(CurvePointsStore, Curve->Points);
+     curve_points *Points = CurvePointsFromId(CurvePointsStore, Curve->Points);
      v2 *ControlPoints = Points->ControlPoints;
      u32 ControlPointCount = Points->ControlPointCount;
      v2 *BSplinePartitionKnots = Curve->BSplinePartitionKnots;
@@ -2523,7 +2878,8 @@ CheckCollisionWithEntities(editor *Editor, v2 AtP, f32 Tolerance)
      
      if (AreBSplineKnotsVisible(Curve))
      {
-      u32 PartitionSize = GetBSplineParams(Curve).KnotParams.PartitionSize;
+      // NOTE(hbr): Computed knots might lag behind params while curve recomputes in the background
+      u32 PartitionSize = Min(Curve->BSplinePartitionKnotCount, GetBSplineParams(Curve).KnotParams.PartitionSize);
       v2 *PartitionKnotPoints = BSplinePartitionKnots;
       point_draw_info KnotPointInfo = GetBSplinePartitionKnotPointDrawInfo(Entity);
       f32 MinSignedDistance = F32_INF;
@@ -2582,106 +2938,396 @@ CheckCollisionWithEntities(editor *Editor, v2 AtP, f32 Tolerance)
  return Result;
 }
 
-inline internal entity_snapshot_for_merging
-MakeEntitySnapshotForMerging(entity *Entity)
+internal f32
+MegabytesFromSize(u64 Size)
 {
- entity_snapshot_for_merging Result = {};
- Result.Entity = Entity;
- if (Entity)
- {
-  Result.XForm = Entity->XForm;
-  Result.Flags = Entity->Flags;
-  Result.Version = Entity->Version;
- }
+ f32 Result = Cast(f32)Size / Megabytes(1);
  return Result;
 }
 
-inline internal b32
-EntityModified(entity_snapshot_for_merging Versioned, entity *Entity)
+internal void
+AccumulateArenaUsage(memory_tag_usage *TagUsage, arena_usage ArenaUsage)
 {
- b32 Result = false;
- if (Versioned.Entity != Entity ||
-     (Entity && (!StructsEqual(&Entity->XForm, &Versioned.XForm) ||
-                 !StructsEqual(&Entity->Flags, &Versioned.Flags) ||
-                 !StructsEqual(&Entity->Version, &Versioned.Version))))
- {
-  Result = true;
- }
- return Result;
+ ++TagUsage->ArenaCount;
+ TagUsage->Usage.Used += ArenaUsage.Used;
+ TagUsage->Usage.PeakUsed += ArenaUsage.PeakUsed;
+ TagUsage->Usage.Commited += ArenaUsage.Commited;
+ TagUsage->Usage.Reserved += ArenaUsage.Reserved;
+ TagUsage->Usage.BlockCount += ArenaUsage.BlockCount;
 }
 
-inline internal entity_handle
-MakeEntityHandle(entity *Entity)
+internal void
+AccumulateTrackedCurvePoints(memory_usage *Usage, curve_points *Points)
 {
- entity_handle Handle = {};
- if (Entity)
+ if (Points)
  {
-  Handle.Entity = Entity;
-  Handle.Generation = Entity->Generation;
+  ++Usage->CurvePointsUndoCount;
+  Usage->CurvePointsUndoSize += CurvePointsSizeFromCapacity(Points->Capacity);
  }
- return Handle;
 }
 
-internal entity_handle
-EntityHandleZero(void)
+internal void
+AccumulateActionTrackingGroupMemory(memory_usage *Usage, action_tracking_group *Group)
 {
- entity_handle Handle = {};
- return Handle;
+ ++Usage->UndoGroupCount;
+ ListIter(Action, Group->ActionsHead, tracked_action)
+ {
+  ++Usage->UndoActionCount;
+  Usage->UndoSize += SizeOf(tracked_action);
+  AccumulateTrackedCurvePoints(Usage, Action->CurvePoints);
+  AccumulateTrackedCurvePoints(Usage, Action->FinalCurvePoints);
+ }
 }
 
-inline internal entity *
-EntityFromHandle(entity_handle Handle, b32 AllowDeactived)
+// NOTE(hbr): Only reads bookkeeping, safe to call every frame. Arenas written by
+// background threads (async recompute, task arenas) might be slightly out of date.
+internal memory_usage
+ComputeMemoryUsage(editor *Editor)
 {
- entity *Entity = 0;
- if (Handle.Entity &&
-     (Handle.Generation == Handle.Entity->Generation))
+ memory_usage Usage = {};
+ 
+ //- arenas by owner
+ arena_store *ArenaStore = Editor->ArenaStore;
+ OS_MutexLock(&ArenaStore->Mutex);
+ ListIter(Node, ArenaStore->Head, arena_node)
  {
-  Entity = Handle.Entity;
+  if (!Node->Deallocated)
+  {
+   arena *Arena = Node->Arena;
+   u32 Tag = (Arena->Tag < MemoryTag_Count ? Arena->Tag : MemoryTag_Untagged);
+   arena_usage ArenaUsage = GetArenaUsage(Arena);
+   
+   AccumulateArenaUsage(Usage.Tags + Tag, ArenaUsage);
+   AccumulateArenaUsage(&Usage.Total, ArenaUsage);
+  }
  }
- if (AllowDeactived &&
-     (Entity == 0) &&
-     (Handle.Entity->InternalFlags & EntityInternalFlag_Deactivated) &&
-     (Handle.Generation + 1 == Handle.Entity->Generation))
+ ForEachIndex(SizeClass, ArenaPoolSizeClassCount)
  {
-  Entity = Handle.Entity;
+  Usage.Pools[SizeClass] = ArenaStore->Pools[SizeClass].Stats;
  }
- return Entity;
-}
-
-internal inline f32
-GetCurvePartVisibilityZOffset(curve_part_visibility Part)
-{
- Assert(Part < CurvePartVisibility_Count);
- f32 Result = Cast(f32)(CurvePartVisibility_Count-1 - Part) / CurvePartVisibility_Count;
- return Result;
-}
-
-inline internal curve *
-SafeGetCurve(entity *Entity)
-{
- Assert(Entity->Type == Entity_Curve);
- return &Entity->Curve;
-}
-
-inline internal image *
-SafeGetImage(entity *Entity)
-{
- Assert(Entity->Type == Entity_Image);
- return &Entity->Image;
+ Usage.PoolIdleCommited = ArenaStore->IdleCommited;
+ Usage.PoolMaxIdleCommited = ArenaStore->MaxIdleCommited;
+ OS_MutexUnlock(&ArenaStore->Mutex);
+ 
+ //- curve points blocks
+ curve_points_store *PointsStore = Editor->CurvePointsStore;
+ ForEachIndex(PointsIndex, PointsStore->Count)
+ {
+  curve_points *Points = PointsStore->CurvePoints + PointsIndex;
+  if (Points->Block)
+  {
+   ++Usage.CurvePointsLiveCount;
+   Usage.CurvePointsLiveSize += CurvePointsSizeFromCapacity(Points->Capacity);
+  }
+ }
+ ForEachIndex(SizeClass, CurvePointsSizeClassCount)
+ {
+  ListIter(Block, PointsStore->FreeBlocks[SizeClass], curve_points_block)
+  {
+   ++Usage.CurvePointsFreeBlockCount;
+   Usage.CurvePointsFreeBlockSize += CurvePointsSizeFromCapacity(Block->Capacity);
+  }
+ }
+ 
+ //- undo/redo history
+ action_tracking_group_batch *FirstBatch = Editor->CurrentActionTrackingGroupBatch;
+ while (FirstBatch && FirstBatch->Prev)
+ {
+  FirstBatch = FirstBatch->Prev;
+ }
+ ListIter(Batch, FirstBatch, action_tracking_group_batch)
+ {
+  ++Usage.UndoBatchCount;
+  Usage.UndoSize += SizeOf(action_tracking_group_batch);
+  ForEachIndex(GroupIndex, Batch->ActionTrackingGroupCount)
+  {
+   AccumulateActionTrackingGroupMemory(&Usage, Batch->ActionTrackingGroups + GroupIndex);
+  }
+ }
+ if (Editor->IsPendingActionTrackingGroup)
+ {
+  AccumulateActionTrackingGroupMemory(&Usage, &Editor->PendingActionTrackingGroup);
+ }
+ 
+ //- outside of arena store
+ renderer_transfer_queue *Queue = Editor->RendererQueue;
+ if (Queue)
+ {
+  Usage.RendererTransferMemorySize = Queue->TransferMemorySize;
+  Usage.RendererTransferPendingCount = Queue->OpCount;
+ }
+ if (Editor->Profiler.Profiler)
+ {
+  Usage.ProfilerSize = SizeOf(profiler);
+ }
+ 
+ return Usage;
 }
 
-inline internal control_point_handle
-ControlPointHandleFromIndex(u32 Index)
+internal u64
+UsedArenaSize(arena *Arena)
 {
- control_point_handle Handle = {};
- Handle.Index = Index + 1;
- return Handle;
+ u64 Size = 0;
+ if (Arena)
+ {
+  Size = GetArenaUsage(Arena).Used;
+ }
+ return Size;
 }
 
-inline internal u32
-IndexFromControlPointHandle(control_point_handle Handle)
+internal entity_memory_usage_array
+ComputeEntityMemoryUsage(arena *Arena, entity_store *Store, entity_memory_sort SortBy)
 {
- u32 Result = 0;
+ entity_array Entities = AllEntityArrayFromStore(Store);
+ entity_memory_usage_array Result = {};
+ Result.Count = Entities.Count;
+ Result.Entities = PushArrayNonZero(Arena, Entities.Count, entity_memory_usage);
+ 
+ temp_arena Temp = BeginTemp(Arena);
+ entity_memory_usage *Unsorted = PushArrayNonZero(Temp.Arena, Entities.Count, entity_memory_usage);
+ sort_entry_array SortArray = AllocSortEntryArray(Temp.Arena, Entities.Count, SortOrder_Descending);
+ ForEachIndex(EntityIndex, Entities.Count)
+ {
+  entity *Entity = Entities.Entities[EntityIndex];
+  entity_memory_usage *Usage = Unsorted + EntityIndex;
+  StructZero(Usage);
+  Usage->Entity = Entity;
+  
+  u64 *Sizes = Usage->Sizes;
+  switch (Entity->Type)
+  {
+   case Entity_Curve: {
+    curve *Curve = &Entity->Curve;
+    Sizes[EntityMemorySort_Points] = CurvePointsSizeFromCapacity(GetCurvePoints(Curve)->Capacity);
+    Sizes[EntityMemorySort_Compute] = UsedArenaSize(Curve->ComputeArena);
+    Sizes[EntityMemorySort_Caches] = (UsedArenaSize(Curve->DegreeReduction.Arena) +
+                                      UsedArenaSize(Curve->NURBS_Extraction.Arena) +
+                                      UsedArenaSize(Curve->BasisCache.Arena) +
+                                      UsedArenaSize(Curve->LOD.Arena));
+    Sizes[EntityMemorySort_Async] = (UsedArenaSize(Curve->AsyncRecompute.SnapshotArena) +
+                                     UsedArenaSize(Curve->AsyncRecompute.BackArena));
+   }break;
+   
+   case Entity_Image: {
+    image *Image = &Entity->Image;
+    Sizes[EntityMemorySort_Texture] = Cast(u64)Image->OriginalWidth * Image->OriginalHeight * 4;
+   }break;
+   
+   case Entity_Count: InvalidPath; break;
+  }
+  for (u32 SizeIndex = EntityMemorySort_Total + 1;
+       SizeIndex < EntityMemorySort_Count;
+       ++SizeIndex)
+  {
+   Sizes[EntityMemorySort_Total] += Sizes[SizeIndex];
+  }
+  
+  AddSortEntry(&SortArray, Cast(f32)Sizes[SortBy], Cast(u32)EntityIndex);
+ }
+ Sort(SortArray.Entries, SortArray.Count, SortFlag_Stable);
+ 
+ ForEachIndex(EntryIndex, SortArray.Count)
+ {
+  Result.Entities[EntryIndex] = Unsorted[SortArray.Entries[EntryIndex].Index];
+ }
+ EndTemp(Temp);
+ 
+ return Result;
+}
+
+internal string_list
+MemoryUsageReport(arena *Arena, memory_usage *Usage, entity_memory_usage_array Entities)
+{
+ string_list List = {};
+ 
+ StrListPushF(Arena, &List, "%-24s %8s %10s %10s %10s %10s", "Owner", "Arenas", "Used MB", "Peak MB", "Commit MB", "Reserve MB");
+ ForEachIndex(Tag, MemoryTag_Count + 1)
+ {
+  b32 IsTotal = (Tag == MemoryTag_Count);
+  memory_tag_usage *TagUsage = (IsTotal ? &Usage->Total : Usage->Tags + Tag);
+  string Name = (IsTotal ? StrLit("Total") : MemoryTagNames[Tag]);
+  StrListPushF(Arena, &List, "%-24S %8u %10.2f %10.2f %10.2f %10.2f",
+               Name, TagUsage->ArenaCount,
+               MegabytesFromSize(TagUsage->Usage.Used),
+               MegabytesFromSize(TagUsage->Usage.PeakUsed),
+               MegabytesFromSize(TagUsage->Usage.Commited),
+               MegabytesFromSize(TagUsage->Usage.Reserved));
+ }
+ StrListPushF(Arena, &List, "");
+ 
+ StrListPushF(Arena, &List, "%-24s %u (%.2f MB)", "Curve points live", Usage->CurvePointsLiveCount, MegabytesFromSize(Usage->CurvePointsLiveSize));
+ StrListPushF(Arena, &List, "%-24s %u (%.2f MB)", "Curve points in undo", Usage->CurvePointsUndoCount, MegabytesFromSize(Usage->CurvePointsUndoSize));
+ StrListPushF(Arena, &List, "%-24s %u (%.2f MB)", "Curve points free", Usage->CurvePointsFreeBlockCount, MegabytesFromSize(Usage->CurvePointsFreeBlockSize));
+ StrListPushF(Arena, &List, "%-24s %u batches, %u groups, %u actions (%.2f MB)", "Undo history",
+              Usage->UndoBatchCount, Usage->UndoGroupCount, Usage->UndoActionCount, MegabytesFromSize(Usage->UndoSize));
+ StrListPushF(Arena, &List, "%-24s %.2f MB, %u pending", "Renderer transfer", MegabytesFromSize(Usage->RendererTransferMemorySize), Usage->RendererTransferPendingCount);
+ StrListPushF(Arena, &List, "%-24s %.2f MB", "Profiler", MegabytesFromSize(Usage->ProfilerSize));
+ StrListPushF(Arena, &List, "%-24s %.2f / %.2f MB", "Pool idle commited", MegabytesFromSize(Usage->PoolIdleCommited), MegabytesFromSize(Usage->PoolMaxIdleCommited));
+ StrListPushF(Arena, &List, "");
+ 
+ StrListPushF(Arena, &List, "%-12s %8s %8s %8s %8s %8s", "Pool reserve", "Live", "Idle", "Allocs", "Reuses", "Decommit");
+ ForEachIndex(SizeClass, ArenaPoolSizeClassCount)
+ {
+  arena_pool_stats *Stats = Usage->Pools + SizeClass;
+  if (Stats->AllocCount)
+  {
+   StrListPushF(Arena, &List, "%9u MB %8u %8u %8u %8u %8u",
+                Cast(u32)(ArenaPoolReserveFromSizeClass(Cast(u32)SizeClass) / Megabytes(1)),
+                Stats->LiveCount, Stats->IdleCount, Stats->AllocCount, Stats->ReuseCount, Stats->DecommitCount);
+  }
+ }
+ StrListPushF(Arena, &List, "");
+ 
+ StrListPushF(Arena, &List, "%-24s %10s %10s %10s %10s %10s %10s", "Entity",
+              "Total KB", "Points KB", "Compute KB", "Caches KB", "Async KB", "Texture KB");
+ ForEachIndex(EntityIndex, Entities.Count)
+ {
+  entity_memory_usage *Entity = Entities.Entities + EntityIndex;
+  u64 *Sizes = Entity->Sizes;
+  StrListPushF(Arena, &List, "%-24S %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f",
+               GetEntityName(Entity->Entity),
+               Cast(f32)Sizes[EntityMemorySort_Total] / Kilobytes(1),
+               Cast(f32)Sizes[EntityMemorySort_Points] / Kilobytes(1),
+               Cast(f32)Sizes[EntityMemorySort_Compute] / Kilobytes(1),
+               Cast(f32)Sizes[EntityMemorySort_Caches] / Kilobytes(1),
+               Cast(f32)Sizes[EntityMemorySort_Async] / Kilobytes(1),
+               Cast(f32)Sizes[EntityMemorySort_Texture] / Kilobytes(1));
+ }
+ 
+ return List;
+}
+
+internal void
+DumpMemoryUsageSnapshot(editor *Editor)
+{
+ temp_arena Temp = TempArena(0);
+ 
+ memory_usage Usage = ComputeMemoryUsage(Editor);
+ entity_memory_usage_array Entities = ComputeEntityMemoryUsage(Temp.Arena, Editor->EntityStore, Editor->MemorySort);
+ string_list Report = MemoryUsageReport(Temp.Arena, &Usage, Entities);
+ 
+ string_list_join_options Opts = {};
+ Opts.Sep = StrLit("\n");
+ string Joined = StrListJoin(Temp.Arena, &Report, Opts);
+ 
+ os_info Info = Platform.GetPlatformInfo();
+ string EditorAppDir = PathConcat(Temp.Arena, Info.AppDir, EditorAppName);
+ string FileName = StrF(Temp.Arena, "memory-%lu.txt", OS_ReadOSTimer());
+ string FilePath = PathConcat(Temp.Arena, EditorAppDir, FileName);
+ 
+ if (OS_WriteDataToFile(FilePath, Joined))
+ {
+  AddNotificationF(Editor, Notification_Success, "memory snapshot saved into \"%S\"", FilePath);
+ }
+ else
+ {
+  AddNotificationF(Editor, Notification_Error, "failed to save memory snapshot into \"%S\"", FilePath);
+ }
+ 
+ EndTemp(Temp);
+}
+
+
+inline internal entity_snapshot_for_merging
+MakeEntitySnapshotForMerging(entity *Entity)
+{
+ entity_snapshot_for_merging Result = {};
+ Result.Entity = Entity;
+ if (Entity)
+ {
+  Result.XForm = Entity->XForm;
+  Result.Flags = Entity->Flags;
+  Result.Version = Entity->Version;
+ }
+ return Result;
+}
+
+inline internal b32
+EntityModified(entity_snapshot_for_merging Versioned, entity *Entity)
+{
+ b32 Result = false;
+ if (Versioned.Entity != Entity ||
+     (Entity && (!StructsEqual(&Entity->XForm, &Versioned.XForm) ||
+                 !StructsEqual(&Entity->Flags, &Versioned.Flags) ||
+                 !StructsEqual(&Entity->Version, &Versioned.Version))))
+ {
+  Result = true;
+ }
+ return Result;
+}
+
+inline internal entity_handle
+MakeEntityHandle(entity *Entity)
+{
+ entity_handle Handle = {};
+ if (Entity)
+ {
+  Handle.Entity = Entity;
+  Handle.Generation = Entity->Generation;
+ }
+ return Handle;
+}
+
+internal entity_handle
+EntityHandleZero(void)
+{
+ entity_handle Handle = {};
+ return Handle;
+}
+
+inline internal entity *
+EntityFromHandle(entity_handle Handle, b32 AllowDeactived)
+{
+ entity *Entity = 0;
+ if (Handle.Entity &&
+     (Handle.Generation == Handle.Entity->Generation))
+ {
+  Entity = Handle.Entity;
+ }
+ if (AllowDeactived &&
+     (Entity == 0) &&
+     (Handle.Entity->InternalFlags & EntityInternalFlag_Deactivated) &&
+     (Handle.Generation + 1 == Handle.Entity->Generation))
+ {
+  Entity = Handle.Entity;
+ }
+ return Entity;
+}
+
+internal inline f32
+GetCurvePartVisibilityZOffset(curve_part_visibility Part)
+{
+ Assert(Part < CurvePartVisibility_Count);
+ f32 Result = Cast(f32)(CurvePartVisibility_Count-1 - Part) / CurvePartVisibility_Count;
+ return Result;
+}
+
+inline internal curve *
+SafeGetCurve(entity *Entity)
+{
+ Assert(Entity->Type == Entity_Curve);
+ return &Entity->Curve;
+}
+
+inline internal image *
+SafeGetImage(entity *Entity)
+{
+ Assert(Entity->Type == Entity_Image);
+ return &Entity->Image;
+}
+
+inline internal control_point_handle
+ControlPointHandleFromIndex(u32 Index)
+{
+ control_point_handle Handle = {};
+ Handle.Index = Index + 1;
+ return Handle;
+}
+
+inline internal u32
+IndexFromControlPointHandle(control_point_handle Handle)
+{
+ u32 Result = 0;
  if (!ControlPointHandleMatch(Handle, ControlPointHandleZero()))
  {
   Result = Handle.Index - 1;
@@ -2804,7 +3450,7 @@ GetCubicBezierPoint(curve *Curve, cubic_bezier_point_handle Point)
 {
  v2 Result = {};
  u32 Index = IndexFromCubicBezierPointHandle(Point);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  if (Index < 3 * Points->ControlPointCount)
  {
   v2 *Beziers = Cast(v2 *)Points->CubicBezierPoints;
@@ -2818,7 +3464,7 @@ GetControlPointP(curve *Curve, control_point_handle Point)
 {
  v2 Result = {};
  u32 Index = IndexFromControlPointHandle(Point);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  if (Index < Points->ControlPointCount)
  {
   Result = Points->ControlPoints[Index];
@@ -2839,8 +3485,32 @@ ControlPointIndexFromCurveSampleIndex(curve *Curve, u32 CurveSampleIndex)
 {
  Assert(!IsCurveTotalSamplesMode(Curve));
  control_point_handle Control = ControlPointHandleZero();
- u32 Index = SafeDiv0(CurveSampleIndex, Curve->Params.SamplesPerControlPoint);
- curve_points_static *Points = GetCurvePoints(Curve);
+ u32 Index = 0;
+ if (IsCurveAdaptiveSamplingMode(Curve))
+ {
+  // NOTE(hbr): Find the last segment that starts at or before this sample
+  u32 *SegmentSampleIndices = Curve->SegmentSampleIndices;
+  u32 Lo = 0;
+  u32 Hi = Curve->SegmentSampleIndexCount;
+  while (Hi - Lo > 1)
+  {
+   u32 Mid = (Lo + Hi) / 2;
+   if (SegmentSampleIndices[Mid] <= CurveSampleIndex)
+   {
+    Lo = Mid;
+   }
+   else
+   {
+    Hi = Mid;
+   }
+  }
+  Index = Lo;
+ }
+ else
+ {
+  Index = SafeDiv0(CurveSampleIndex, Curve->Params.SamplesPerControlPoint);
+ }
+ curve_points *Points = GetCurvePoints(Curve);
  Assert(Index < Points->ControlPointCount);
  Index = ClampTop(Index, Points->ControlPointCount - 1);
  Control = ControlPointHandleFromIndex(Index);
@@ -2965,7 +3635,7 @@ NextCubicBezierPoint(curve *Curve, cubic_bezier_point_handle *Point)
 {
  b32 Result = false;
  u32 Index = IndexFromCubicBezierPointHandle(*Point);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  if (Index + 1 < 3 * Points->ControlPointCount)
  {
   *Point = CubicBezierPointHandleFromIndex(Index + 1);
@@ -3052,85 +3722,294 @@ IsCurveTotalSamplesMode(curve *Curve)
  return Result;
 }
 
-inline internal b32
-IsCurve(entity *Entity)
+internal b32
+IsCurveAdaptiveSamplingMode(curve *Curve)
 {
- b32 Result = (Entity->Type == Entity_Curve);
+ b32 Result = Curve->Params.AdaptiveSampling.Enabled;
  return Result;
 }
 
-internal b32
-IsCurveReversed(entity *Entity)
+// NOTE(hbr): Tolerance is given in world space (or pixels), but samples are computed
+// in curve's local space, so undo entity scale. Pixels are converted using the zoom
+// at the time of recompute, see AdaptiveWorldUnitsPerPixel.
+internal f32
+CurveAdaptiveSamplingLocalTolerance(curve *Curve)
 {
- curve *Curve = SafeGetCurve(Entity);
- b32 Result = (UsesControlPoints(Curve) && (Entity->Flags & EntityFlag_CurveAppendFront));
- return Result;
+ curve_adaptive_sampling_params *Adaptive = &Curve->Params.AdaptiveSampling;
+ f32 Tolerance = Adaptive->Tolerance;
+ switch (Adaptive->Unit)
+ {
+  case CurveSamplingTolerance_Pixels: {Tolerance *= Curve->AdaptiveWorldUnitsPerPixel;}break;
+  case CurveSamplingTolerance_World: {}break;
+  case CurveSamplingTolerance_Count: InvalidPath;
+ }
+ 
+ entity *Entity = ContainerOf(Curve, entity, Curve);
+ scale2d Scale = Entity->XForm.Scale;
+ f32 MaxScale = Max(Abs(Scale.X), Abs(Scale.Y));
+ Tolerance = SafeDiv0(Tolerance, MaxScale);
+ 
+ return Tolerance;
 }
 
-internal b32
-IsRegularBezierCurve(curve *Curve)
+internal f32
+CurveSampleFraction(curve *Curve, u32 CurveSampleIndex)
 {
- b32 Result = (Curve->Params.Type == Curve_Bezier && Curve->Params.Bezier == Bezier_Rational);
- return Result;
+ f32 Fraction = 0.0f;
+ u32 SampleCount = Curve->CurveSampleCount;
+ if (IsCurveAdaptiveSamplingMode(Curve))
+ {
+  // NOTE(hbr): Samples are not spread evenly, use their parameter instead
+  if (SampleCount > 0)
+  {
+   f32 *Ts = Curve->Ts;
+   Fraction = SafeDiv0(Ts[CurveSampleIndex] - Ts[0], Ts[SampleCount - 1] - Ts[0]);
+  }
+ }
+ else
+ {
+  Fraction = SafeDiv0(Cast(f32)CurveSampleIndex, (SampleCount - 1));
+ }
+ 
+ return Fraction;
 }
 
+// NOTE(hbr): Curves whose CalcCurve keeps the Ts it evaluated at (see CalcBezierRational,
+// NURBS case of CalcCurve). Every recompute path has to agree on this, CurveSampleT and
+// arc length lookups depend on it.
 internal b32
-AreBSplineKnotsVisible(curve *Curve)
+CurveKeepsSampleTs(curve *Curve)
 {
- b32 Result = (Curve->Params.Type == Curve_NURBS && Curve->Params.DrawParams.BSplineKnots.Enabled);
+ curve_params *Params = &Curve->Params;
+ b32 Result = (Params->Type == Curve_NURBS ||
+               (Params->Type == Curve_Bezier && Params->Bezier == Bezier_Rational));
  return Result;
 }
 
-internal curve_merge_compatibility
-AreCurvesCompatibleForMerging(curve *Curve0, curve *Curve1, curve_merge_method Method)
+// NOTE(hbr): Parameter the sample was evaluated at. Only some curves keep their Ts around,
+// the others are sampled evenly so the fraction is good enough.
+internal f32
+CurveSampleT(curve *Curve, u32 CurveSampleIndex)
 {
- b32 Compatible = false;
- string WhyIncompatible = NilStr;
- 
- curve_params *Params0 = &Curve0->Params;
- curve_params *Params1 = &Curve1->Params;
- 
- string IncompatibleTypes = StrLit("cannot merge curves of different types");
- 
-#define Concat_C0_G1_Str " can only be merged using [Concat], [C0] or [G1] methods"
-#define Concat_Str       " can only be merged using [Concat] method"
- 
- b32 Concat_C0_G1 = (Method == CurveMerge_Concat ||
-                     Method == CurveMerge_C0 ||
-                     Method == CurveMerge_G1);
- b32 Concat = (Method == CurveMerge_Concat);
- 
- if (Params0->Type == Params1->Type)
+ f32 T = 0.0f;
+ if (Curve->Ts)
  {
-  switch (Params0->Type)
+  T = Curve->Ts[CurveSampleIndex];
+ }
+ else
+ {
+  T = SafeDiv0(Cast(f32)CurveSampleIndex, (Curve->CurveSampleCount - 1));
+ }
+ return T;
+}
+
+// NOTE(hbr): Last sample evaluated at or before T, or the first one if there is none
+internal u32
+CurveSampleIndexAtT(curve *Curve, f32 T)
+{
+ u32 Lo = 0;
+ u32 Hi = Curve->CurveSampleCount;
+ while (Hi - Lo > 1)
+ {
+  u32 Mid = (Lo + Hi) / 2;
+  if (CurveSampleT(Curve, Mid) <= T)
   {
-   case Curve_Polynomial: {
-    if (Concat_C0_G1) Compatible = true;
-    else WhyIncompatible = StrLit("polynomial curves" Concat_C0_G1_Str);
-   }break;
-   
-   case Curve_CubicSpline: {
-    if (Params0->CubicSpline == Params1->CubicSpline)
-    {
-     if (Concat_C0_G1) Compatible = true;
-     else WhyIncompatible = StrLit("cubic spline curves" Concat_C0_G1_Str);
-    }
-    else
-    {
-     WhyIncompatible = IncompatibleTypes;
-    }
-   }break;
-   
-   case Curve_Bezier: {
-    if (Params0->Bezier == Params1->Bezier)
-    {
-     switch (Params0->Bezier)
-     {
-      case Bezier_Rational: {Compatible = true;}break;
-      case Bezier_CubicSpline: {
-       if (Concat_C0_G1) Compatible = true;
-       else WhyIncompatible = StrLit("cubic bezier curves" Concat_C0_G1_Str);
-      }break;
+   Lo = Mid;
+  }
+  else
+  {
+   Hi = Mid;
+  }
+ }
+ return Lo;
+}
+
+internal f32
+CurveArcLengthAtT(curve *Curve, f32 T)
+{
+ f32 Distance = 0.0f;
+ curve_arc_length_table *Table = &Curve->ArcLength;
+ if (Table->Count >= 2)
+ {
+  u32 Index = ClampTop(CurveSampleIndexAtT(Curve, T), Table->Count - 2);
+  f32 T0 = CurveSampleT(Curve, Index);
+  f32 T1 = CurveSampleT(Curve, Index + 1);
+  f32 Fraction = Clamp01(SafeDiv0(T - T0, T1 - T0));
+  Distance = Lerp(Table->Lengths[Index], Table->Lengths[Index + 1], Fraction);
+ }
+ return Distance;
+}
+
+struct curve_arc_length_position
+{
+ // NOTE(hbr): Position between sample Index and Index+1
+ u32 Index;
+ f32 Fraction;
+};
+internal curve_arc_length_position
+CurveArcLengthPosition(curve_arc_length_table *Table, f32 Distance, curve_arc_length_cursor *Cursor)
+{
+ curve_arc_length_position Result = {};
+ u32 Count = Table->Count;
+ f32 *Lengths = Table->Lengths;
+ if (Count >= 2)
+ {
+  Distance = Clamp(Distance, 0.0f, Table->TotalLength);
+  
+  u32 Index = 0;
+  if (Cursor)
+  {
+   Index = ClampTop(Cursor->Index, Count - 2);
+   while (Index > 0 && Lengths[Index] > Distance)
+   {
+    --Index;
+   }
+   while (Index + 2 < Count && Lengths[Index + 1] < Distance)
+   {
+    ++Index;
+   }
+   Cursor->Index = Index;
+  }
+  else
+  {
+   u32 Lo = 0;
+   u32 Hi = Count - 1;
+   while (Hi - Lo > 1)
+   {
+    u32 Mid = (Lo + Hi) / 2;
+    if (Lengths[Mid] <= Distance)
+    {
+     Lo = Mid;
+    }
+    else
+    {
+     Hi = Mid;
+    }
+   }
+   Index = Lo;
+  }
+  
+  Result.Index = Index;
+  Result.Fraction = Clamp01(SafeDiv0(Distance - Lengths[Index], Lengths[Index + 1] - Lengths[Index]));
+ }
+ 
+ return Result;
+}
+
+internal f32
+CurveTAtArcLength(curve *Curve, f32 Distance, curve_arc_length_cursor *Cursor)
+{
+ f32 T = 0.0f;
+ curve_arc_length_table *Table = &Curve->ArcLength;
+ if (Table->Count >= 2)
+ {
+  curve_arc_length_position At = CurveArcLengthPosition(Table, Distance, Cursor);
+  T = Lerp(CurveSampleT(Curve, At.Index), CurveSampleT(Curve, At.Index + 1), At.Fraction);
+ }
+ else if (Table->Count == 1)
+ {
+  T = CurveSampleT(Curve, 0);
+ }
+ return T;
+}
+
+internal v2
+CurvePointAtArcLength(curve *Curve, f32 Distance, curve_arc_length_cursor *Cursor)
+{
+ v2 P = {};
+ curve_arc_length_table *Table = &Curve->ArcLength;
+ v2 *Samples = Curve->CurveSamples;
+ if (Table->Count >= 2)
+ {
+  curve_arc_length_position At = CurveArcLengthPosition(Table, Distance, Cursor);
+  P = Lerp(Samples[At.Index], Samples[At.Index + 1], At.Fraction);
+ }
+ else if (Table->Count == 1)
+ {
+  P = Samples[0];
+ }
+ return P;
+}
+
+inline internal b32
+IsCurve(entity *Entity)
+{
+ b32 Result = (Entity->Type == Entity_Curve);
+ return Result;
+}
+
+internal b32
+IsCurveReversed(entity *Entity)
+{
+ curve *Curve = SafeGetCurve(Entity);
+ b32 Result = (UsesControlPoints(Curve) && (Entity->Flags & EntityFlag_CurveAppendFront));
+ return Result;
+}
+
+internal b32
+IsRegularBezierCurve(curve *Curve)
+{
+ b32 Result = (Curve->Params.Type == Curve_Bezier && Curve->Params.Bezier == Bezier_Rational);
+ return Result;
+}
+
+internal b32
+AreBSplineKnotsVisible(curve *Curve)
+{
+ b32 Result = (Curve->Params.Type == Curve_NURBS && Curve->Params.DrawParams.BSplineKnots.Enabled);
+ return Result;
+}
+
+internal curve_merge_compatibility
+AreCurvesCompatibleForMerging(curve *Curve0, curve *Curve1, curve_merge_method Method)
+{
+ b32 Compatible = false;
+ string WhyIncompatible = NilStr;
+ 
+ curve_params *Params0 = &Curve0->Params;
+ curve_params *Params1 = &Curve1->Params;
+ 
+ string IncompatibleTypes = StrLit("cannot merge curves of different types");
+ 
+#define Concat_C0_G1_Str " can only be merged using [Concat], [C0] or [G1] methods"
+#define Concat_Str       " can only be merged using [Concat] method"
+ 
+ b32 Concat_C0_G1 = (Method == CurveMerge_Concat ||
+                     Method == CurveMerge_C0 ||
+                     Method == CurveMerge_G1);
+ b32 Concat = (Method == CurveMerge_Concat);
+ 
+ if (Params0->Type == Params1->Type)
+ {
+  switch (Params0->Type)
+  {
+   case Curve_Polynomial: {
+    if (Concat_C0_G1) Compatible = true;
+    else WhyIncompatible = StrLit("polynomial curves" Concat_C0_G1_Str);
+   }break;
+   
+   case Curve_CubicSpline: {
+    if (Params0->CubicSpline == Params1->CubicSpline)
+    {
+     if (Concat_C0_G1) Compatible = true;
+     else WhyIncompatible = StrLit("cubic spline curves" Concat_C0_G1_Str);
+    }
+    else
+    {
+     WhyIncompatible = IncompatibleTypes;
+    }
+   }break;
+   
+   case Curve_Bezier: {
+    if (Params0->Bezier == Params1->Bezier)
+    {
+     switch (Params0->Bezier)
+     {
+      case Bezier_Rational: {Compatible = true;}break;
+      case Bezier_CubicSpline: {
+       if (Concat_C0_G1) Compatible = true;
+       else WhyIncompatible = StrLit("cubic bezier curves" Concat_C0_G1_Str);
+      }break;
       case Bezier_Count: InvalidPath;
      }
     }
@@ -3202,7 +4081,7 @@ GetCurveControlPointDrawInfo(entity *Entity, control_point_handle Point)
  u32 Index = IndexFromControlPointHandle(Point);
  
  point_draw_info Result = GetEntityPointDrawInfo(Entity, Params->DrawParams.Points.Radius, Params->DrawParams.Points.Color);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  
  if (( (Entity->Flags & EntityFlag_CurveAppendFront) && Index == 0) ||
      (!(Entity->Flags & EntityFlag_CurveAppendFront) && Index == Points->ControlPointCount-1))
@@ -3298,14 +4177,14 @@ CurvePointsHandleZero(void)
 }
 
 internal curve_points_handle
-CurvePointsHandleFromCurvePointsStatic(curve_points_static *Static)
-{
- curve_points_handle Handle = MakeCurvePointsHandle(Static->ControlPointCount,
-                                                    Static->ControlPoints,
-                                                    Static->ControlPointWeights,
-                                                    Static->CubicBezierPoints,
-                                                    Static->BSplineKnotCount,
-                                                    Static->BSplineKnots);
+CurvePointsHandleFromCurvePoints(curve_points *Points)
+{
+ curve_points_handle Handle = MakeCurvePointsHandle(Points->ControlPointCount,
+                                                    Points->ControlPoints,
+                                                    Points->ControlPointWeights,
+                                                    Points->CubicBezierPoints,
+                                                    Points->BSplineKnotCount,
+                                                    Points->BSplineKnots);
  return Handle;
 }
 
@@ -3332,16 +4211,16 @@ MakeCurvePointsDynamic(u32 *ControlPointCount,
 }
 
 internal curve_points_dynamic
-CurvePointsDynamicFromStatic(curve_points_static *Static)
-{
- curve_points_dynamic Dynamic = MakeCurvePointsDynamic(&Static->ControlPointCount,
-                                                       Static->ControlPoints,
-                                                       Static->ControlPointWeights,
-                                                       Static->CubicBezierPoints,
-                                                       CURVE_POINTS_STATIC_MAX_CONTROL_POINT_COUNT,
-                                                       &Static->BSplineKnotCount,
-                                                       Static->BSplineKnots,
-                                                       MAX_B_SPLINE_KNOT_COUNT);
+CurvePointsDynamicFromCurvePoints(curve_points *Points)
+{
+ curve_points_dynamic Dynamic = MakeCurvePointsDynamic(&Points->ControlPointCount,
+                                                       Points->ControlPoints,
+                                                       Points->ControlPointWeights,
+                                                       Points->CubicBezierPoints,
+                                                       Points->Capacity,
+                                                       &Points->BSplineKnotCount,
+                                                       Points->BSplineKnots,
+                                                       CurvePointsKnotCapacity(Points->Capacity));
  return Dynamic;
 }
 
@@ -3350,7 +4229,7 @@ GetCurveControlPointInWorldSpace(entity *Entity, control_point_handle Point)
 {
  curve *Curve = SafeGetCurve(Entity);
  u32 Index = IndexFromControlPointHandle(Point);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  
  v2 P = LocalToWorldEntityPosition(Entity, Points->ControlPoints[Index]);
  f32 Weight = Points->ControlPointWeights[Index];
@@ -3366,10 +4245,10 @@ GetCurveControlPointInWorldSpace(entity *Entity, control_point_handle Point)
 }
 
 internal void
-CopyCurvePointsFromCurve(curve *Curve, curve_points_dynamic Dst)
+CopyCurvePointsFromCurve(curve *Curve, curve_points *Dst)
 {
- curve_points_static *Points = GetCurvePoints(Curve);
- CopyCurvePoints(Dst, CurvePointsHandleFromCurvePointsStatic(Points));
+ curve_points *Points = GetCurvePoints(Curve);
+ SetCurvePointsInStore(GetCtx()->CurvePointsStore, Dst, CurvePointsHandleFromCurvePoints(Points));
 }
 
 internal void
@@ -3386,6 +4265,46 @@ CopyCurvePoints(curve_points_dynamic Dst, curve_points_handle Src)
  ArrayCopy(Dst.BSplineKnots, Src.BSplineKnots, CopyKnots);
 }
 
+internal rect2
+CurveSamplesAABB(curve *Curve)
+{
+ rect2 AABB = EmptyAABB();
+ u32 SampleCount = Curve->CurveSampleCount;
+ v2 *Samples = Curve->CurveSamples;
+ u32 SampleIndex = 0;
+ while (SampleIndex + 8 < SampleCount)
+ {
+  AddPointAABB(&AABB, Samples[SampleIndex + 0]);
+  AddPointAABB(&AABB, Samples[SampleIndex + 1]);
+  AddPointAABB(&AABB, Samples[SampleIndex + 2]);
+  AddPointAABB(&AABB, Samples[SampleIndex + 3]);
+  AddPointAABB(&AABB, Samples[SampleIndex + 4]);
+  AddPointAABB(&AABB, Samples[SampleIndex + 5]);
+  AddPointAABB(&AABB, Samples[SampleIndex + 6]);
+  AddPointAABB(&AABB, Samples[SampleIndex + 7]);
+  SampleIndex += 8;
+ }
+ while (SampleIndex < SampleCount)
+ {
+  AddPointAABB(&AABB, Samples[SampleIndex]);
+  ++SampleIndex;
+ }
+ return AABB;
+}
+
+internal rect2
+LocalToWorldEntityAABB(entity *Entity, rect2 AABB)
+{
+ rect2_corners AABB_Corners = AABBCorners(AABB);
+ rect2 AABB_Transformed = EmptyAABB();
+ ForEachEnumVal(Corner, Corner_Count, corner)
+ {
+  v2 P = LocalToWorldEntityPosition(Entity, AABB_Corners.Corners[Corner]);
+  AddPointAABB(&AABB_Transformed, P);
+ }
+ return AABB_Transformed;
+}
+
 internal rect2
 EntityAABB(entity *Entity)
 {
@@ -3393,27 +4312,7 @@ EntityAABB(entity *Entity)
  switch (Entity->Type)
  {
   case Entity_Curve: {
-   curve *Curve = &Entity->Curve;
-   u32 SampleCount = Curve->CurveSampleCount;
-   v2 *Samples = Curve->CurveSamples;
-   u32 SampleIndex = 0;
-   while (SampleIndex + 8 < SampleCount)
-   {
-    AddPointAABB(&AABB, Samples[SampleIndex + 0]);
-    AddPointAABB(&AABB, Samples[SampleIndex + 1]);
-    AddPointAABB(&AABB, Samples[SampleIndex + 2]);
-    AddPointAABB(&AABB, Samples[SampleIndex + 3]);
-    AddPointAABB(&AABB, Samples[SampleIndex + 4]);
-    AddPointAABB(&AABB, Samples[SampleIndex + 5]);
-    AddPointAABB(&AABB, Samples[SampleIndex + 6]);
-    AddPointAABB(&AABB, Samples[SampleIndex + 7]);
-    SampleIndex += 8;
-   }
-   while (SampleIndex < SampleCount)
-   {
-    AddPointAABB(&AABB, Samples[SampleIndex]);
-    ++SampleIndex;
-   }
+   AABB = CurveSamplesAABB(&Entity->Curve);
   } break;
   
   case Entity_Image: {
@@ -3428,15 +4327,156 @@ EntityAABB(entity *Entity)
   case Entity_Count: InvalidPath; break;
  }
  
- rect2_corners AABB_Corners = AABBCorners(AABB);
- rect2 AABB_Transformed = EmptyAABB();
- ForEachEnumVal(Corner, Corner_Count, corner)
+ rect2 AABB_Transformed = LocalToWorldEntityAABB(Entity, AABB);
+ 
+ return AABB_Transformed;
+}
+
+// NOTE(hbr): Backs NURBS extraction, basis and LOD caches
+internal arena *
+CurveCacheArena(arena **Arena)
+{
+ arena *Result = EnsureArenaFromStore(GetCtx()->ArenaStore, Arena, Megabytes(32), MemoryTag_CurveCaches);
+ return Result;
+}
+
+// NOTE(hbr): Every edit bumps entity version and every background result landing
+// bumps front version, levels made before either are stale.
+internal void
+ValidateCurveLOD(entity *Entity)
+{
+ curve *Curve = &Entity->Curve;
+ curve_lod_cache *LOD = &Curve->LOD;
+ u32 FrontVersion = Curve->AsyncRecompute.FrontVersion;
+ if (!LOD->Valid ||
+     LOD->EntityVersion != Entity->Version ||
+     LOD->FrontVersion != FrontVersion)
  {
-  v2 P = LocalToWorldEntityPosition(Entity, AABB_Corners.Corners[Corner]);
-  AddPointAABB(&AABB_Transformed, P);
+  ClearArena(CurveCacheArena(&LOD->Arena));
+  ArrayZero(LOD->Levels, ArrayCount(LOD->Levels));
+  LOD->LocalAABB = CurveSamplesAABB(Curve);
+  LOD->EntityVersion = Entity->Version;
+  LOD->FrontVersion = FrontVersion;
+  LOD->Valid = true;
+ }
+}
+
+internal b32
+IsCurveSampledForZoom(curve *Curve)
+{
+ b32 Result = (IsCurveAdaptiveSamplingMode(Curve) &&
+               Curve->Params.AdaptiveSampling.Unit == CurveSamplingTolerance_Pixels);
+ return Result;
+}
+
+// NOTE(hbr): Samples closer to each other on screen than that are not worth drawing
+#define CurveLODMinSampleSpacingInPixels 2.0f
+
+// NOTE(hbr): Coarsest level that still keeps samples at least CurveLODMinSampleSpacingInPixels
+// apart on screen. Curves sampled for the current zoom already are as dense as they need to
+// be, curves entirely off screen take the coarsest level.
+internal u32
+PickCurveLODLevel(entity *Entity, render_group *RenderGroup)
+{
+ u32 Level = 0;
+ curve *Curve = &Entity->Curve;
+ u32 SampleCount = Curve->CurveSampleCount;
+ if (!IsCurveSampledForZoom(Curve) && SampleCount > 2)
+ {
+  ValidateCurveLOD(Entity);
+  
+  rect2 AABB = LocalToWorldEntityAABB(Entity, Curve->LOD.LocalAABB);
+  rect2_corners Corners = AABBCorners(AABB);
+  rect2 ClipAABB = EmptyAABB();
+  ForEachEnumVal(Corner, Corner_Count, corner)
+  {
+   AddPointAABB(&ClipAABB, RenderGroup->ProjXForm.Forward * Corners.Corners[Corner]);
+  }
+  b32 OnScreen = (ClipAABB.Min.X <= 1.0f && ClipAABB.Max.X >= -1.0f &&
+                  ClipAABB.Min.Y <= 1.0f && ClipAABB.Max.Y >= -1.0f);
+  
+  if (OnScreen)
+  {
+   scale2d Scale = Entity->XForm.Scale;
+   f32 MaxScale = Max(Abs(Scale.X), Abs(Scale.Y));
+   f32 WorldUnitsPerPixel = PixelLengthToWorldSpace(RenderGroup, 1.0f);
+   f32 LengthInPixels = SafeDiv0(Curve->ArcLength.TotalLength * MaxScale, WorldUnitsPerPixel);
+   f32 SampleSpacing = LengthInPixels / (SampleCount - 1);
+   while (Level + 1 < CurveLODLevelCount &&
+          SampleSpacing * (1 << (Level + 1)) <= CurveLODMinSampleSpacingInPixels)
+   {
+    ++Level;
+   }
+  }
+  else
+  {
+   Level = CurveLODLevelCount - 1;
+  }
  }
  
- return AABB_Transformed;
+ return Level;
+}
+
+internal vertex_array
+CurveLODVertices(entity *Entity, u32 Level)
+{
+ curve *Curve = &Entity->Curve;
+ vertex_array Result = Curve->CurveVertices;
+ if (Level > 0)
+ {
+  ValidateCurveLOD(Entity);
+  curve_lod_level *LODLevel = Curve->LOD.Levels + Level;
+  if (!LODLevel->Computed)
+  {
+   ProfileFunctionBegin();
+   temp_arena Temp = TempArena(0);
+   
+   u32 Stride = (1 << Level);
+   u32 SampleCount = Curve->CurveSampleCount;
+   v2 *Samples = Curve->CurveSamples;
+   v2 *Points = PushArrayNonZero(Temp.Arena, SampleCount / Stride + 2, v2);
+   u32 PointCount = 0;
+   for (u32 SampleIndex = 0;
+        SampleIndex < SampleCount;
+        SampleIndex += Stride)
+   {
+    Points[PointCount++] = Samples[SampleIndex];
+   }
+   // NOTE(hbr): Curve has to end where it ends
+   if ((SampleCount - 1) % Stride != 0)
+   {
+    Points[PointCount++] = Samples[SampleCount - 1];
+   }
+   
+   LODLevel->Vertices = StrokeTessellate_CustomWithoutOverlap(Curve->LOD.Arena, PointCount, Points,
+                                                              Curve->Params.DrawParams.Line.Width,
+                                                              IsCurveLooped(Curve));
+   LODLevel->Computed = true;
+   
+   EndTemp(Temp);
+   ProfileEnd();
+  }
+  Result = LODLevel->Vertices;
+ }
+ 
+ return Result;
+}
+
+// NOTE(hbr): Tolerance in pixels was converted to world units with the zoom at the time of
+// sampling. Once the zoom is off by more than that factor, samples are too dense or too sparse.
+#define CurveRetessellateZoomFactor 2.0f
+
+internal b32
+ShouldRetessellateCurveForZoom(curve *Curve, f32 WorldUnitsPerPixel)
+{
+ b32 Result = false;
+ f32 SampledWorldUnitsPerPixel = Curve->AdaptiveWorldUnitsPerPixel;
+ if (IsCurveSampledForZoom(Curve) && SampledWorldUnitsPerPixel > 0.0f)
+ {
+  f32 Ratio = WorldUnitsPerPixel / SampledWorldUnitsPerPixel;
+  Result = (Ratio * CurveRetessellateZoomFactor < 1.0f || Ratio > CurveRetessellateZoomFactor);
+ }
+ return Result;
 }
 
 internal b_spline_params
@@ -3532,7 +4572,7 @@ TranslateCurvePointTo(entity_with_modify_witness *EntityWitness,
  u32 ControlPointIndex = 0;
  if (IndexFromControlPointHandleSafe(ControlPoint, &ControlPointIndex))
  {
-  curve_points_static *Points = GetCurvePoints(Curve);
+  curve_points *Points = GetCurvePoints(Curve);
   
   if (ControlPointIndex < Points->ControlPointCount)
   {
@@ -3582,7 +4622,7 @@ TranslateCurvePointTo(entity_with_modify_witness *EntityWitness,
    *TranslatePoint = LocalP;
   }
   
-  MarkEntityModified(EntityWitness);
+  MarkEntityControlPointModified(EntityWitness, ControlPointIndex);
  }
 }
 
@@ -3610,13 +4650,13 @@ SelectControlPointFromCurvePoint(curve *Curve, curve_point_handle CurvePoint)
 internal void
 MaybeRecomputeCurveBSplineKnots(curve *Curve, b32 ForceRecompute)
 {
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  u32 ControlPointCount = Points->ControlPointCount;
  curve_params *CurveParams = &Curve->Params;
  b_spline_params *RequestedBSplineParams = &CurveParams->BSpline;
  
  b_spline_knot_params FixedBSplineKnotParams = BSplineKnotParamsFromDegree(RequestedBSplineParams->KnotParams.Degree, ControlPointCount);
- Assert(FixedBSplineKnotParams.KnotCount <= MAX_B_SPLINE_KNOT_COUNT);
+ Assert(FixedBSplineKnotParams.KnotCount <= CurvePointsKnotCapacity(Points->Capacity));
  b_spline_params FixedBSplineParams = {};
  FixedBSplineParams.Partition = RequestedBSplineParams->Partition;
  FixedBSplineParams.KnotParams = FixedBSplineKnotParams;
@@ -3672,7 +4712,7 @@ RemoveControlPoint(entity_with_modify_witness *EntityWitness, control_point_hand
  entity *Entity = EntityWitness->Entity;
  curve *Curve = SafeGetCurve(Entity);
  u32 Index = IndexFromControlPointHandle(Point);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  
  if (Index < Points->ControlPointCount)
  {
@@ -3723,7 +4763,7 @@ IsControlPointSelected(curve *Curve)
      !ControlPointHandleMatch(Curve->SelectedControlPoint, ControlPointHandleZero()))
  {
   u32 Index = IndexFromControlPointHandle(Curve->SelectedControlPoint);
-  curve_points_static *Points = GetCurvePoints(Curve);
+  curve_points *Points = GetCurvePoints(Curve);
   Result = (Index < Points->ControlPointCount);
  }
  return Result;
@@ -3741,7 +4781,7 @@ AppendControlPoint(entity_with_modify_witness *EntityWitness, v2 P)
  else
  {
   curve *Curve = SafeGetCurve(Entity);
-  curve_points_static *Points = GetCurvePoints(Curve);
+  curve_points *Points = GetCurvePoints(Curve);
   InsertAt = Points->ControlPointCount;
  }
  control_point_handle Result = InsertControlPoint(EntityWitness, MakeControlPoint(P), InsertAt);
@@ -3755,7 +4795,7 @@ SetControlPoint(entity_with_modify_witness *Witness, control_point_handle Handle
  curve *Curve = SafeGetCurve(Entity);
  
  u32 I = IndexFromControlPointHandle(Handle);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  
  u32 N = Points->ControlPointCount;
  v2 *P = Points->ControlPoints;
@@ -3798,13 +4838,12 @@ InsertControlPoint(entity_with_modify_witness *EntityWitness, control_point Poin
  control_point_handle Result = {};
  entity *Entity = EntityWitness->Entity;
  curve *Curve = SafeGetCurve(Entity);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  
- if (Curve &&
-     Points->ControlPointCount < CURVE_POINTS_STATIC_MAX_CONTROL_POINT_COUNT &&
-     At <= Points->ControlPointCount)
+ if (Curve && At <= Points->ControlPointCount)
  {
   Assert(UsesControlPoints(Curve));
+  ReserveCurvePointsInStore(GetCtx()->CurvePointsStore, Points, Points->ControlPointCount + 1, 0);
   
   control_point_handle Handle = ControlPointHandleFromIndex(At);
   u32 N = Points->ControlPointCount;
@@ -3845,8 +4884,8 @@ SetCurvePoints(entity_with_modify_witness *EntityWitness, curve_points_handle Ne
 {
  entity *Entity = EntityWitness->Entity;
  curve *Curve = SafeGetCurve(Entity);
- curve_points_static *Points = GetCurvePoints(Curve);
- CopyCurvePoints(CurvePointsDynamicFromStatic(Points), NewPoints);
+ curve_points *Points = GetCurvePoints(Curve);
+ SetCurvePointsInStore(GetCtx()->CurvePointsStore, Points, NewPoints);
  DeselectControlPoint(Curve);
  MarkEntityModified(EntityWitness);
 }
@@ -3993,8 +5032,8 @@ InitEntityFromEntity(entity_with_modify_witness *DstWitness, entity *Src, b32 Co
    }
    InitParametricCurveResources(&DstCurve->ParametricResources, &SrcCurve->ParametricResources);
    DstCurve->PointTracking = SrcCurve->PointTracking;
-   curve_points_static *SrcPoints = GetCurvePoints(SrcCurve);
-   SetCurvePoints(DstWitness, CurvePointsHandleFromCurvePointsStatic(SrcPoints));
+   curve_points *SrcPoints = GetCurvePoints(SrcCurve);
+   SetCurvePoints(DstWitness, CurvePointsHandleFromCurvePoints(SrcPoints));
    SelectControlPoint(DstCurve, SrcCurve->SelectedControlPoint);
   }break;
   
@@ -4020,23 +5059,37 @@ SetControlPoint(entity_with_modify_witness *EntityWitness, control_point_handle
  {
   curve *Curve = SafeGetCurve(Entity);
   u32 Index = IndexFromControlPointHandle(Handle);
-  curve_points_static *Points = GetCurvePoints(Curve);
+  curve_points *Points = GetCurvePoints(Curve);
   Points->ControlPointWeights[Index] = Weight;
-  MarkEntityModified(EntityWitness);
+  MarkEntityControlPointModified(EntityWitness, Index);
+ }
+}
+
+internal void
+SetControlPointWeight(entity_with_modify_witness *EntityWitness, control_point_handle Handle, f32 Weight)
+{
+ if (!ControlPointHandleMatch(Handle, ControlPointHandleZero()))
+ {
+  curve *Curve = SafeGetCurve(EntityWitness->Entity);
+  u32 Index = IndexFromControlPointHandle(Handle);
+  curve_points *Points = GetCurvePoints(Curve);
+  Points->ControlPointWeights[Index] = Weight;
+  // NOTE(hbr): Weight only pulls the curve, curves with local support redo just the part around it
+  MarkEntityControlPointModified(EntityWitness, Index);
  }
 }
 
 internal curve_points_modify_handle
-BeginModifyCurvePoints(entity_with_modify_witness *EntityWitness, u32 RequestedPointCount, modify_curve_points_static_which_points Which)
+BeginModifyCurvePoints(entity_with_modify_witness *EntityWitness, u32 RequestedPointCount, modify_curve_points_which_points Which)
 {
  curve_points_modify_handle Result = {};
  
  entity *Entity = EntityWitness->Entity;
  curve *Curve = SafeGetCurve(Entity);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
+ ReserveCurvePointsInStore(GetCtx()->CurvePointsStore, Points, RequestedPointCount, 0);
  Result.Curve = Curve;
- u32 ActualPointCount = Min(RequestedPointCount, CURVE_POINTS_STATIC_MAX_CONTROL_POINT_COUNT);
- Result.PointCount = ActualPointCount;
+ Result.PointCount = RequestedPointCount;
  Result.ControlPoints = Points->ControlPoints;
  Result.Weights = Points->ControlPointWeights;
  Result.CubicBeziers = Points->CubicBezierPoints;
@@ -4053,7 +5106,7 @@ EndModifyCurvePoints(curve_points_modify_handle Handle)
 {
  curve *Curve = Handle.Curve;
  curve_params *CurveParams = &Curve->Params;
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  Points->ControlPointCount = Handle.PointCount;
  if (Handle.Which <= ModifyCurvePointsWhichPoints_ControlPointsOnly)
  {
@@ -4118,7 +5171,7 @@ SetTrackingPointFraction(entity_with_modify_witness *EntityWitness, f32 Fraction
  curve *Curve = SafeGetCurve(Entity);
  point_tracking_along_curve_state *Tracking = &Curve->PointTracking;
  Tracking->Fraction = Clamp01(Fraction);
- MarkEntityModified(EntityWitness);
+ MarkCurveRecomputeStages(EntityWitness, CurveRecomputeStage_PointTracking);
 }
 
 internal void
@@ -4128,7 +5181,7 @@ SetBSplineKnotPoint(entity_with_modify_witness *EntityWitness,
 {
  entity *Entity = EntityWitness->Entity;
  curve *Curve = SafeGetCurve(Entity);
- curve_points_static *Points = GetCurvePoints(Curve);
+ curve_points *Points = GetCurvePoints(Curve);
  b_spline_knot_params KnotParams = GetBSplineParams(Curve).KnotParams;
  f32 *Knots = Points->BSplineKnots;
  u32 KnotIndex = KnotIndexFromBSplineKnotHandle(Knot);
@@ -4152,7 +5205,9 @@ SetBSplineKnotPoint(entity_with_modify_witness *EntityWitness,
    Knots[Index] = Max(KnotFraction, Knots[Index]);
   }
   Knots[KnotIndex] = KnotFraction;
-  MarkEntityModified(EntityWitness);
+  // NOTE(hbr): Knots don't move control points, polyline and hulls stay, but samples
+  // have to be evaluated again
+  MarkCurveRecomputeStages(EntityWitness, CurveRecomputeStage_Samples);
  }
 }
 
@@ -4224,239 +5279,74 @@ GetCubicBezierCurveSegment(cubic_bezier_point *BezierPoints, u32 PointCount, u32
  return Result;
 }
 
+// NOTE(hbr): Every compute waits only for its own group, so different computes can share
+// high priority queue. Curves recomputed in the background (see curve_async_recompute) still
+// evaluate all the blocks in place on low priority thread, to not steal workers from the
+// recomputes that the user is waiting for.
+global thread_static b32 GlobalThreadComputesInPlace;
+
+internal work_queue *
+CurveComputeQueue(void)
+{
+ work_queue *Queue = (GlobalThreadComputesInPlace ? 0 : GetCtx()->HighPriorityQueue);
+ return Queue;
+}
+
 internal void
-CalcBarycentricPolynomial(v2 *Controls, u32 PointCount, point_spacing PointSpacing, f32 *Ti,
-                          u32 SampleCount, v2 *OutSamples,
-                          f32 Min_T, f32 Max_T, u32 SamplesPerControlPoint)
+ComputeQueueAddEntry(work_queue *Queue, work_queue_group *Group, work_queue_func *Func, void *UserData)
 {
- if (PointCount > 0)
+ if (Queue)
  {
-  temp_arena Temp = TempArena(0);
-  
-  f32 *Omega = PushArrayNonZero(Temp.Arena, PointCount, f32);
-  switch (PointSpacing)
-  {
-   case PointSpacing_Equidistant: {
-    // NOTE(hbr): Equidistant version doesn't seem to work properly (precision problems)
-    BarycentricOmega(Omega, Ti, PointCount);
-   } break;
-   case PointSpacing_Chebychev: {
-    BarycentricOmegaChebychev(Omega, PointCount);
-   } break;
-   
-   case PointSpacing_Count: InvalidPath;
-  }
-  
-  points_soa SOA = SplitPointsIntoComponents(Temp.Arena, Controls, PointCount);
-  
-  // TODO(hbr): This is kinda of awful, refactor this
-  v2 *Out = OutSamples;
-  for (u32 PointIndex = 1;
-       PointIndex < PointCount;
-       ++PointIndex)
-  {
-   f32 Min_TT = Ti[PointIndex - 1];
-   f32 Max_TT = Ti[PointIndex - 0];
-   f32 Delta_TT = (Max_TT - Min_TT) / SamplesPerControlPoint;
-   f32 TT = Min_TT;
-   for (u32 SampleIndex = 0;
-        SampleIndex < SamplesPerControlPoint;
-        ++SampleIndex)
-   {
-    f32 X = BarycentricEvaluate(TT, Omega, Ti, SOA.Xs, PointCount);
-    f32 Y = BarycentricEvaluate(TT, Omega, Ti, SOA.Ys, PointCount);
-    *Out++ = V2(X, Y);
-    TT += Delta_TT;
-   }
-  }
-  *Out++ = Controls[PointCount - 1];
-  
-  EndTemp(Temp);
+  Platform.WorkQueueAddGroupEntry(Queue, Group, Func, UserData);
  }
-}
-
-internal void
-CalcNewtonPolynomial(v2 *Controls, u32 PointCount, f32 *Ti,
-                     u32 SampleCount, v2 *OutSamples,
-                     f32 Min_T, f32 Max_T, u32 SamplesPerControlPoint)
-{
- if (PointCount > 0)
+ else
  {
-  temp_arena Temp = TempArena(0);
-  
-  points_soa SOA = SplitPointsIntoComponents(Temp.Arena, Controls, PointCount);
-  
-  f32 *Beta_X = PushArrayNonZero(Temp.Arena, PointCount, f32);
-  f32 *Beta_Y = PushArrayNonZero(Temp.Arena, PointCount, f32);
-  NewtonBetaFast(Beta_X, Ti, SOA.Xs, PointCount);
-  NewtonBetaFast(Beta_Y, Ti, SOA.Ys, PointCount);
-  
-  // TODO(hbr): This is kinda of awful, refactor this
-  v2 *Out = OutSamples;
-  for (u32 PointIndex = 1;
-       PointIndex < PointCount;
-       ++PointIndex)
-  {
-   f32 Min_TT = Ti[PointIndex - 1];
-   f32 Max_TT = Ti[PointIndex - 0];
-   f32 Delta_TT = (Max_TT - Min_TT) / SamplesPerControlPoint;
-   f32 TT = Min_TT;
-   for (u32 SampleIndex = 0;
-        SampleIndex < SamplesPerControlPoint;
-        ++SampleIndex)
-   {
-    f32 X = NewtonEvaluate(TT, Beta_X, Ti, PointCount);
-    f32 Y = NewtonEvaluate(TT, Beta_Y, Ti, PointCount);
-    *Out++ = V2(X, Y);
-    TT += Delta_TT;
-   }
-  }
-  *Out++ = Controls[PointCount - 1];
-  
-  EndTemp(Temp);
+  Func(UserData);
  }
 }
 
+// NOTE(hbr): Submits Count consecutive entries of UserDataSize bytes each with a single wakeup
 internal void
-CalcPolynomial(v2 *Controls, u32 PointCount,
-               polynomial_interpolation_params Polynomial,
-               u32 SampleCount, v2 *OutSamples,
-               u32 SamplesPerControlPoint)
+ComputeQueueAddEntries(work_queue *Queue, work_queue_group *Group, work_queue_func *Func, void *UserData, u32 UserDataSize, u32 Count)
 {
- temp_arena Temp = TempArena(0);
- 
- point_spacing PointSpacing = Polynomial.PointSpacing;
- 
- f32 *Ti = PushArrayNonZero(Temp.Arena, PointCount, f32);
- switch (PointSpacing)
- {
-  case PointSpacing_Equidistant: { EquidistantPoints(Ti, PointCount, 0.0f, 1.0f); } break;
-  case PointSpacing_Chebychev:   { ChebyshevPoints(Ti, PointCount);   } break;
-  case PointSpacing_Count: InvalidPath;
- }
- 
- f32 Min_T = 0;
- f32 Max_T = 0;
- if (PointCount > 0)
+ if (Queue)
  {
-  Min_T = Ti[0];
-  Max_T = Ti[PointCount - 1];
+  Platform.WorkQueueAddGroupEntries(Queue, Group, Func, UserData, UserDataSize, Count);
  }
- 
- switch (Polynomial.Type)
+ else
  {
-  case PolynomialInterpolation_Barycentric: {CalcBarycentricPolynomial(Controls, PointCount, PointSpacing, Ti, SampleCount, OutSamples, Min_T, Max_T, SamplesPerControlPoint);}break;
-  case PolynomialInterpolation_Newton:      {CalcNewtonPolynomial(Controls, PointCount, Ti, SampleCount, OutSamples, Min_T, Max_T, SamplesPerControlPoint);}break;
-  case PolynomialInterpolation_Count: InvalidPath;
+  ForEachIndex(Index, Count)
+  {
+   Func(Cast(u8 *)UserData + Index * UserDataSize);
+  }
  }
- 
- EndTemp(Temp);
 }
 
 internal void
-CalcCubicSpline_Scalar(f32 *Xs,
-                       f32 *Ys,
-                       u32 PointCount,
-                       f32 *Ti,
-                       f32 *Mx,
-                       f32 *My,
-                       u32 SampleCount,
-                       f32 *Ts,
-                       v2 *OutSamples)
+ComputeQueueCompleteGroup(work_queue *Queue, work_queue_group *Group)
 {
- ForEachIndex(SampleIndex, SampleCount)
+ if (Queue)
  {
-  f32 T = Ts[SampleIndex];
-  f32 X = CubicSplineEvaluateScalar(T, Mx, Ti, Xs, PointCount);
-  f32 Y = CubicSplineEvaluateScalar(T, My, Ti, Ys, PointCount);
-  OutSamples[SampleIndex] = V2(X, Y);
+  Platform.WorkQueueCompleteGroup(Queue, Group);
  }
 }
 
+// NOTE(hbr): Splits [0, Count) across the compute queue, see WorkQueueParallelFor.
+// Zero grain picks one automatically.
 internal void
-CalcCubicSpline_ScalarWithBinarySearch(f32 *Xs,
-                                       f32 *Ys,
-                                       u32 PointCount,
-                                       f32 *Ti,
-                                       f32 *Mx,
-                                       f32 *My,
-                                       u32 SampleCount,
-                                       f32 *Ts,
-                                       v2 *OutSamples)
+ParallelFor(u32 Count, u32 Grain, parallel_for_func *Func, void *UserData)
 {
- ForEachIndex(SampleIndex, SampleCount)
+ work_queue *Queue = CurveComputeQueue();
+ if (Queue)
  {
-  f32 T = Ts[SampleIndex];
-  f32 X = CubicSplineEvaluateScalarWithBinarySearch(T, Mx, Ti, Xs, PointCount);
-  f32 Y = CubicSplineEvaluateScalarWithBinarySearch(T, My, Ti, Ys, PointCount);
-  OutSamples[SampleIndex] = V2(X, Y);
+  Platform.WorkQueueParallelFor(Queue, Count, Grain, Func, UserData);
  }
-}
-
-internal void
-CalcCubicSpline_ScalarWithConstantSearch(f32 *Xs,
-                                         f32 *Ys,
-                                         u32 PointCount,
-                                         f32 *Ti,
-                                         f32 *Mx,
-                                         f32 *My,
-                                         u32 SampleCount,
-                                         f32 *Ts,
-                                         v2 *OutSamples)
-{
- cubic_spline_evaluate_iterator Itx = {}, Ity = {};
- ForEachIndex(SampleIndex, SampleCount)
+ else if (Count)
  {
-  f32 T = Ts[SampleIndex];
-  f32 X = CubicSplineEvaluateScalarWithConstantSearch(T, Mx, Ti, Xs, PointCount, &Itx);
-  f32 Y = CubicSplineEvaluateScalarWithConstantSearch(T, My, Ti, Ys, PointCount, &Ity);
-  OutSamples[SampleIndex] = V2(X, Y);
+  Func(UserData, 0, Count);
  }
 }
 
-struct calc_cubic_spline_work
-{
- f32 *Xs;
- f32 *Ys;
- u32 PointCount;
- f32 *Ti;
- f32 *Mx;
- f32 *My;
- u32 SampleCount;
- f32 *Ts;
- v2 *OutSamples;
-};
-
-internal void
-CalcCubicSpline_Scalar_Work(void *UserData)
-{
- calc_cubic_spline_work *Work = Cast(calc_cubic_spline_work *)UserData;
- CalcCubicSpline_Scalar(Work->Xs,
-                        Work->Ys,
-                        Work->PointCount,
-                        Work->Ti,
-                        Work->Mx,
-                        Work->My,
-                        Work->SampleCount,
-                        Work->Ts,
-                        Work->OutSamples);
-}
-
-internal void
-CalcCubicSpline_ScalarWithBinarySearch_Work(void *UserData)
-{
- calc_cubic_spline_work *Work = Cast(calc_cubic_spline_work *)UserData;
- CalcCubicSpline_ScalarWithBinarySearch(Work->Xs,
-                                        Work->Ys,
-                                        Work->PointCount,
-                                        Work->Ti,
-                                        Work->Mx,
-                                        Work->My,
-                                        Work->SampleCount,
-                                        Work->Ts,
-                                        Work->OutSamples);
-}
-
 struct work_queue_blocks
 {
  u32 BlockCount;
@@ -4466,7 +5356,7 @@ internal work_queue_blocks
 WorkQueueCalculateBlocks(work_queue *WorkQueue, u32 ComputeCount, u32 RequestBlockSize)
 {
  u32 RequestBlockCount = (ComputeCount + RequestBlockSize - 1) / RequestBlockSize;
- u32 FreeEntries = Platform.WorkQueueFreeEntryCount(WorkQueue);
+ u32 FreeEntries = (WorkQueue ? Platform.WorkQueueFreeEntryCount(WorkQueue) : 1);
  u32 ActualBlockCount = Min(RequestBlockCount, FreeEntries);
  u32 ActualBlockSize = SafeDiv0(ComputeCount + ActualBlockCount - 1, ActualBlockCount);
  
@@ -4479,206 +5369,210 @@ WorkQueueCalculateBlocks(work_queue *WorkQueue, u32 ComputeCount, u32 RequestBlo
  return Result;
 }
 
-internal void
-CalcCubicSpline_MultiThreaded(f32 *Xs,
-                              f32 *Ys,
-                              u32 PointCount,
-                              f32 *Ti,
-                              f32 *Mx,
-                              f32 *My,
-                              u32 SampleCount,
-                              f32 *Ts,
-                              v2 *OutSamples,
-                              work_queue_func *EvalWorkFunc)
+internal curve_eval_calibration
+DefaultCurveEvalCalibration(void)
+{
+ curve_eval_calibration Result = {};
+ instruction_set_flags Flags = Platform.InstructionSetSupport();
+ 
+ // NOTE(hbr): These were selected experimentally on a single machine. They are used
+ // only until calibration on the host finishes.
+ if (0) {}
+ else if (Flags & InstructionSet_AVX512) Result.Bezier.Method = Bezier_Eval_AVX512;
+ else if (Flags & InstructionSet_AVX2) Result.Bezier.Method = Bezier_Eval_AVX2;
+ else if (Flags & InstructionSet_SSE) Result.Bezier.Method = Bezier_Eval_SSE;
+ else Result.Bezier.Method = Bezier_Eval_Scalar;
+ Result.Bezier.BlockSize = 200;
+ 
+ if (0) {}
+ else if (Flags & InstructionSet_AVX512) Result.NURBS.Method = NURBS_Eval_Extracted_AVX512;
+ else if (Flags & InstructionSet_AVX2) Result.NURBS.Method = NURBS_Eval_Extracted_AVX2;
+ else if (Flags & InstructionSet_SSE) Result.NURBS.Method = NURBS_Eval_Extracted_SSE;
+ else Result.NURBS.Method = NURBS_Eval_Extracted_Scalar;
+ // NOTE(hbr): With Bezier extraction it's O(m) Horner per sample, no longer O(m^2) Cox-de Boor,
+ // so blocks can be as big as for other curves.
+ Result.NURBS.BlockSize = 200;
+ 
+ if (0) {}
+ else if (Flags & InstructionSet_AVX512) Result.CubicSpline.Method = CubicSpline_Eval_AVX512;
+ else if (Flags & InstructionSet_AVX2) Result.CubicSpline.Method = CubicSpline_Eval_AVX2;
+ else if (Flags & InstructionSet_SSE) Result.CubicSpline.Method = CubicSpline_Eval_SSE;
+ else Result.CubicSpline.Method = CubicSpline_Eval_ScalarWithBinarySearch;
+ Result.CubicSpline.BlockSize = 256;
+ 
+ if (0) {}
+ else if (Flags & InstructionSet_AVX512) Result.Polynomial.Method = Polynomial_Eval_AVX512;
+ else if (Flags & InstructionSet_AVX2) Result.Polynomial.Method = Polynomial_Eval_AVX2;
+ else if (Flags & InstructionSet_SSE) Result.Polynomial.Method = Polynomial_Eval_SSE;
+ else Result.Polynomial.Method = Polynomial_Eval_Scalar;
+ // NOTE(hbr): Polynomial evaluation is O(n) per sample, same as Bezier
+ Result.Polynomial.BlockSize = 200;
+ 
+ return Result;
+}
+
+internal curve_eval_calibration
+CurrentCurveEvalCalibration(void)
 {
- ProfileFunctionBegin();
+ curve_eval_calibration Result = {};
+ curve_eval_calibration *Calibration = GetCtx()->EvalCalibration;
+ if (Calibration && Calibration->Calibrated)
+ {
+  Result = *Calibration;
+ }
+ else
+ {
+  Result = DefaultCurveEvalCalibration();
+ }
  
- temp_arena Temp = TempArena(0);
- work_queue *WorkQueue = GetCtx()->HighPriorityQueue;
+ return Result;
+}
+
+internal curve_eval_kernel
+ResolveCurveEvalKernel(curve_eval_kernel const *Kernels, u32 Method, u32 AdaptiveMethod, curve_eval_tuning Tuning)
+{
+ curve_eval_kernel Kernel = Kernels[Method];
+ if (Method == AdaptiveMethod)
+ {
+  Kernel.EvalWorkFunc = Kernels[Tuning.Method].EvalWorkFunc;
+  Kernel.RequiredInstructionSets = Kernels[Tuning.Method].RequiredInstructionSets;
+ }
+ Kernel.BlockSize = Tuning.BlockSize;
+ 
+ return Kernel;
+}
+
+internal u32
+ResolveCurveEvalMethod(u32 Method, u32 AdaptiveMethod, curve_eval_tuning Tuning)
+{
+ u32 Result = (Method == AdaptiveMethod ? Tuning.Method : Method);
+ return Result;
+}
+
+internal b32
+IsCurveEvalKernelSupported(curve_eval_kernel Kernel, instruction_set_flags Flags)
+{
+ b32 Result = ((Kernel.RequiredInstructionSets & Flags) == Kernel.RequiredInstructionSets);
+ return Result;
+}
+
+struct polynomial_eval_input
+{
+ polynomial_interpolation_type Type;
+ u32 PointCount;
+ f32 *Ti;
+ f32 *Xs;
+ f32 *Ys;
+ 
+ // NOTE(hbr): Barycentric form
+ f32 *Omega;
+ 
+ // NOTE(hbr): Newton form
+ f32 *Beta_X;
+ f32 *Beta_Y;
+};
+
+internal polynomial_eval_input
+MakePolynomialEvalInput(arena *Arena, v2 *Controls, u32 PointCount, polynomial_interpolation_params Polynomial)
+{
+ polynomial_eval_input Poly = {};
+ Poly.Type = Polynomial.Type;
+ Poly.PointCount = PointCount;
  
- // NOTE(hbr): 256 selected experimentally
- work_queue_blocks Blocks = WorkQueueCalculateBlocks(WorkQueue, SampleCount, 256);
- u32 BlockCount = Blocks.BlockCount;
- u32 BlockSize = Blocks.BlockSize;
- u32 SamplesLeft = SampleCount;
- f32 *TsAt = Ts;
- v2 *OutSamplesAt = OutSamples;
+ point_spacing PointSpacing = Polynomial.PointSpacing;
+ Poly.Ti = PushArrayNonZero(Arena, PointCount, f32);
+ switch (PointSpacing)
+ {
+  case PointSpacing_Equidistant: { EquidistantPoints(Poly.Ti, PointCount, 0.0f, 1.0f); } break;
+  case PointSpacing_Chebychev:   { ChebyshevPoints(Poly.Ti, PointCount);   } break;
+  case PointSpacing_Count: InvalidPath;
+ }
  
- calc_cubic_spline_work *Works = PushArray(Temp.Arena, BlockCount, calc_cubic_spline_work);
+ points_soa SOA = SplitPointsIntoComponents(Arena, Controls, PointCount);
+ Poly.Xs = SOA.Xs;
+ Poly.Ys = SOA.Ys;
  
- ForEachIndex(BlockIndex, BlockCount)
+ switch (Poly.Type)
  {
-  u32 BlockSampleCount = Min(SamplesLeft, BlockSize);
-  
-  calc_cubic_spline_work *Work = Works + BlockIndex;
-  Work->Xs = Xs;
-  Work->Ys = Ys;
-  Work->PointCount = PointCount;
-  Work->Ti = Ti;
-  Work->Mx = Mx;
-  Work->My = My;
-  Work->SampleCount = BlockSampleCount;
-  Work->Ts = TsAt;
-  Work->OutSamples = OutSamplesAt;
+  case PolynomialInterpolation_Barycentric: {
+   Poly.Omega = PushArrayNonZero(Arena, PointCount, f32);
+   switch (PointSpacing)
+   {
+    case PointSpacing_Equidistant: {
+     // NOTE(hbr): Equidistant version doesn't seem to work properly (precision problems)
+     BarycentricOmega(Poly.Omega, Poly.Ti, PointCount);
+    } break;
+    case PointSpacing_Chebychev: {
+     BarycentricOmegaChebychev(Poly.Omega, PointCount);
+    } break;
+    
+    case PointSpacing_Count: InvalidPath;
+   }
+  }break;
   
-  Platform.WorkQueueAddEntry(WorkQueue, EvalWorkFunc, Work);
+  case PolynomialInterpolation_Newton: {
+   Poly.Beta_X = PushArrayNonZero(Arena, PointCount, f32);
+   Poly.Beta_Y = PushArrayNonZero(Arena, PointCount, f32);
+   NewtonBetaFast(Poly.Beta_X, Poly.Ti, Poly.Xs, PointCount);
+   NewtonBetaFast(Poly.Beta_Y, Poly.Ti, Poly.Ys, PointCount);
+  }break;
   
-  TsAt += BlockSampleCount;
-  OutSamplesAt += BlockSampleCount;
-  SamplesLeft -= BlockSampleCount;
+  case PolynomialInterpolation_Count: InvalidPath;
  }
  
- Platform.WorkQueueCompleteAllWork(WorkQueue);
- 
- EndTemp(Temp);
- 
- ProfileEnd();
+ return Poly;
 }
 
 internal void
-CalcCubicSpline(v2 *Controls,
-                u32 PointCount,
-                cubic_spline_type Spline,
-                u32 SampleCount,
-                v2 *OutSamples)
+CalcPolynomial_Scalar(polynomial_eval_input *Poly, u32 SampleCount, f32 *Ts, v2 *OutSamples)
 {
- ProfileFunctionBegin();
- 
- if (PointCount > 0)
+ ForEachIndex(SampleIndex, SampleCount)
  {
-  temp_arena Temp = TempArena(0);
-  
-  if (Spline == CubicSpline_Periodic)
+  f32 T = Ts[SampleIndex];
+  f32 X = 0.0f;
+  f32 Y = 0.0f;
+  switch (Poly->Type)
   {
-   v2 *OriginalControls = Controls;
+   case PolynomialInterpolation_Barycentric: {
+    X = BarycentricEvaluate(T, Poly->Omega, Poly->Ti, Poly->Xs, Poly->PointCount);
+    Y = BarycentricEvaluate(T, Poly->Omega, Poly->Ti, Poly->Ys, Poly->PointCount);
+   }break;
    
-   Controls = PushArrayNonZero(Temp.Arena, PointCount + 1, v2);
-   ArrayCopy(Controls, OriginalControls, PointCount);
-   Controls[PointCount] = OriginalControls[0];
+   case PolynomialInterpolation_Newton: {
+    X = NewtonEvaluate(T, Poly->Beta_X, Poly->Ti, Poly->PointCount);
+    Y = NewtonEvaluate(T, Poly->Beta_Y, Poly->Ti, Poly->PointCount);
+   }break;
    
-   ++PointCount;
+   case PolynomialInterpolation_Count: InvalidPath;
   }
+  OutSamples[SampleIndex] = V2(X, Y);
+ }
+}
+
+internal void
+CalcPolynomial_SSE(polynomial_eval_input *Poly, u32 SampleCount, f32 *Ts, v2 *OutSamples)
+{
+ u32 Blocks = (SampleCount + 3) / 4;
+ u32 I = 0;
+ while (Blocks--)
+ {
+  f32 T4[4] = {};
+  for (u32 J = 0; J < 4; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    T4[J] = Ts[I + J];
+   }
+  }
+  v2 Out4[4] = {};
   
-  f32 *Ti = PushArrayNonZero(Temp.Arena, PointCount, f32);
-  EquidistantPoints(Ti, PointCount, 0.0f, 1.0f);
-  
-  points_soa SOA = SplitPointsIntoComponents(Temp.Arena, Controls, PointCount);
-  
-  f32 *Mx = PushArrayNonZero(Temp.Arena, PointCount, f32);
-  f32 *My = PushArrayNonZero(Temp.Arena, PointCount, f32);
-  switch (Spline)
+  switch (Poly->Type)
   {
-   case CubicSpline_Natural: {
-    CubicSplineNaturalM(Mx, Ti, SOA.Xs, PointCount);
-    CubicSplineNaturalM(My, Ti, SOA.Ys, PointCount);
-   } break;
-   
-   case CubicSpline_Periodic: {
-    switch (DEBUG_Vars->CubicSplinePeriodicM_EvalMethod)
-    {
-     case CubicSplinePeriodicM_Eval_Base: {
-      CubicSplinePeriodicM(Mx, Ti, SOA.Xs, PointCount);
-      CubicSplinePeriodicM(My, Ti, SOA.Ys, PointCount);
-     }break;
-     
-     case CubicSplinePeriodicM_Eval_Optimized: {
-      CubicSplinePeriodicM_Optimized(Mx, Ti, SOA.Xs, PointCount);
-      CubicSplinePeriodicM_Optimized(My, Ti, SOA.Ys, PointCount);
-     }break;
-     
-     case CubicSplinePeriodicM_Eval_Count: InvalidPath;
-    }
-   } break;
-   
-   case CubicSpline_Count: InvalidPath;
+   case PolynomialInterpolation_Barycentric: {BarycentricEvaluateSSE(T4, Poly->Omega, Poly->Ti, Poly->Xs, Poly->Ys, Poly->PointCount, Out4);}break;
+   case PolynomialInterpolation_Newton: {NewtonEvaluateSSE(T4, Poly->Beta_X, Poly->Beta_Y, Poly->Ti, Poly->PointCount, Out4);}break;
+   case PolynomialInterpolation_Count: InvalidPath;
   }
   
-  f32 T = Ti[0];
-  f32 Delta_T = (Ti[PointCount - 1] - Ti[0]) / (SampleCount - 1);
-  f32 *Ts = PushArrayNonZero(Temp.Arena, SampleCount, f32);
-  ForEachIndex(SampleIndex, SampleCount)
-  {
-   Ts[SampleIndex] = T;
-   T += Delta_T;
-  }
-  
-  ProfileBlock("CalcCubicSpline - Samples Block")
-  {
-   switch (DEBUG_Vars->CubicSpline_EvalMethod)
-   {
-    case CubicSpline_Eval_Scalar: {
-     CalcCubicSpline_Scalar(SOA.Xs, SOA.Ys, PointCount, Ti, Mx, My, SampleCount, Ts, OutSamples);
-    }break;
-    
-    case CubicSpline_Eval_ScalarWithBinarySearch: {
-     CalcCubicSpline_ScalarWithBinarySearch(SOA.Xs, SOA.Ys, PointCount, Ti, Mx, My, SampleCount, Ts, OutSamples);
-    }break;
-    
-    case CubicSpline_Eval_ScalarWithConstantSearch: {
-     CalcCubicSpline_ScalarWithConstantSearch(SOA.Xs, SOA.Ys, PointCount, Ti, Mx, My, SampleCount, Ts, OutSamples);
-    }break;
-    
-    case CubicSpline_Eval_Scalar_MultiThreaded: {
-     CalcCubicSpline_MultiThreaded(SOA.Xs, SOA.Ys, PointCount, Ti, Mx, My, SampleCount, Ts, OutSamples, CalcCubicSpline_Scalar_Work);
-    }break;
-    
-    case CubicSpline_Eval_ScalarWithBinarySearch_MultiThreaded: {
-     CalcCubicSpline_MultiThreaded(SOA.Xs, SOA.Ys, PointCount, Ti, Mx, My, SampleCount, Ts, OutSamples, CalcCubicSpline_ScalarWithBinarySearch_Work);
-    }break;
-    
-    case CubicSpline_Eval_Count: InvalidPath;
-   }
-  }
-  
-  EndTemp(Temp);
- }
- 
- ProfileEnd();
-}
-
-internal void
-CalcBezierRational_Scalar(v2 *Controls,
-                          f32 *Weights,
-                          u32 PointCount,
-                          u32 SampleCount,
-                          f32 *Ts,
-                          v2 *OutSamples)
-{
- ForEachIndex(SampleIndex, SampleCount)
- {
-  f32 T = Ts[SampleIndex];
-  OutSamples[SampleIndex] = BezierCurveRationalEvaluateScalar(T, Controls, Weights, PointCount);
- }
-}
-
-internal void
-CalcBezierRational_SSE(v2 *Controls,
-                       f32 *Weights,
-                       u32 PointCount,
-                       u32 SampleCount,
-                       f32 *Ts,
-                       v2 *OutSamples)
-{
- u32 Blocks = (SampleCount + 3) / 4;
- u32 I = 0;
- while (Blocks--)
- {
-  f32 T4[4] = {};
-  for (u32 J = 0; J < 4; ++J)
-  {
-   if (I + J < SampleCount)
-   {
-    T4[J] = Ts[I + J];
-   }
-  }
-  v2 Out4[4] = {};
-  
-  BezierCurveRationalEvaluateSSE(T4,
-                                 Controls,
-                                 Weights,
-                                 PointCount,
-                                 Out4);
-  
   for (u32 J = 0; J < 4; ++J)
   {
    if (I + J < SampleCount)
@@ -4692,12 +5586,7 @@ CalcBezierRational_SSE(v2 *Controls,
 }
 
 internal void
-CalcBezierRational_AVX2(v2 *Controls,
-                        f32 *Weights,
-                        u32 PointCount,
-                        u32 SampleCount,
-                        f32 *Ts,
-                        v2 *OutSamples)
+CalcPolynomial_AVX2(polynomial_eval_input *Poly, u32 SampleCount, f32 *Ts, v2 *OutSamples)
 {
  u32 Blocks = (SampleCount + 7) / 8;
  u32 I = 0;
@@ -4713,11 +5602,12 @@ CalcBezierRational_AVX2(v2 *Controls,
   }
   v2 Out8[8] = {};
   
-  BezierCurveRationalEvaluateAVX2(T8,
-                                  Controls,
-                                  Weights,
-                                  PointCount,
-                                  Out8);
+  switch (Poly->Type)
+  {
+   case PolynomialInterpolation_Barycentric: {BarycentricEvaluateAVX2(T8, Poly->Omega, Poly->Ti, Poly->Xs, Poly->Ys, Poly->PointCount, Out8);}break;
+   case PolynomialInterpolation_Newton: {NewtonEvaluateAVX2(T8, Poly->Beta_X, Poly->Beta_Y, Poly->Ti, Poly->PointCount, Out8);}break;
+   case PolynomialInterpolation_Count: InvalidPath;
+  }
   
   for (u32 J = 0; J < 8; ++J)
   {
@@ -4732,12 +5622,7 @@ CalcBezierRational_AVX2(v2 *Controls,
 }
 
 internal void
-CalcBezierRational_AVX512(v2 *Controls,
-                          f32 *Weights,
-                          u32 PointCount,
-                          u32 SampleCount,
-                          f32 *Ts,
-                          v2 *OutSamples)
+CalcPolynomial_AVX512(polynomial_eval_input *Poly, u32 SampleCount, f32 *Ts, v2 *OutSamples)
 {
  u32 Blocks = (SampleCount + 15) / 16;
  u32 I = 0;
@@ -4753,11 +5638,12 @@ CalcBezierRational_AVX512(v2 *Controls,
   }
   v2 Out16[16] = {};
   
-  BezierCurveRational_Evaluate_AVX512(T16,
-                                      Controls,
-                                      Weights,
-                                      PointCount,
-                                      Out16);
+  switch (Poly->Type)
+  {
+   case PolynomialInterpolation_Barycentric: {BarycentricEvaluateAVX512(T16, Poly->Omega, Poly->Ti, Poly->Xs, Poly->Ys, Poly->PointCount, Out16);}break;
+   case PolynomialInterpolation_Newton: {NewtonEvaluateAVX512(T16, Poly->Beta_X, Poly->Beta_Y, Poly->Ti, Poly->PointCount, Out16);}break;
+   case PolynomialInterpolation_Count: InvalidPath;
+  }
   
   for (u32 J = 0; J < 16; ++J)
   {
@@ -4771,324 +5657,259 @@ CalcBezierRational_AVX512(v2 *Controls,
  }
 }
 
-struct calc_bezier_rational_work
+struct calc_polynomial_work
 {
- v2 *Controls;
- f32 *Weights;
- u32 PointCount;
+ polynomial_eval_input *Poly;
  u32 SampleCount;
  f32 *Ts;
  v2 *OutSamples;
 };
 
 internal void
-CalcBezierRational_Scalar_Work(void *UserData)
+CalcPolynomial_Scalar_Work(void *UserData)
 {
- calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
- CalcBezierRational_Scalar(Work->Controls,
-                           Work->Weights,
-                           Work->PointCount,
-                           Work->SampleCount,
-                           Work->Ts,
-                           Work->OutSamples);
+ calc_polynomial_work *Work = Cast(calc_polynomial_work *)UserData;
+ CalcPolynomial_Scalar(Work->Poly, Work->SampleCount, Work->Ts, Work->OutSamples);
 }
 
 internal void
-CalcBezierRational_SSE_Work(void *UserData)
+CalcPolynomial_SSE_Work(void *UserData)
 {
- calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
- CalcBezierRational_SSE(Work->Controls,
-                        Work->Weights,
-                        Work->PointCount,
-                        Work->SampleCount,
-                        Work->Ts,
-                        Work->OutSamples);
+ calc_polynomial_work *Work = Cast(calc_polynomial_work *)UserData;
+ CalcPolynomial_SSE(Work->Poly, Work->SampleCount, Work->Ts, Work->OutSamples);
 }
 
 internal void
-CalcBezierRational_AVX2_Work(void *UserData)
+CalcPolynomial_AVX2_Work(void *UserData)
 {
- calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
- CalcBezierRational_AVX2(Work->Controls,
-                         Work->Weights,
-                         Work->PointCount,
-                         Work->SampleCount,
-                         Work->Ts,
-                         Work->OutSamples);
+ calc_polynomial_work *Work = Cast(calc_polynomial_work *)UserData;
+ CalcPolynomial_AVX2(Work->Poly, Work->SampleCount, Work->Ts, Work->OutSamples);
 }
 
 internal void
-CalcBezierRational_AVX512_Work(void *UserData)
+CalcPolynomial_AVX512_Work(void *UserData)
 {
- calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
- CalcBezierRational_AVX512(Work->Controls,
-                           Work->Weights,
-                           Work->PointCount,
-                           Work->SampleCount,
-                           Work->Ts,
-                           Work->OutSamples);
+ calc_polynomial_work *Work = Cast(calc_polynomial_work *)UserData;
+ CalcPolynomial_AVX512(Work->Poly, Work->SampleCount, Work->Ts, Work->OutSamples);
 }
 
+struct calc_polynomial_parallel
+{
+ calc_polynomial_work Work;
+ work_queue_func *EvalWorkFunc;
+};
+
 internal void
-CalcBezierRational_MultiThreaded(v2 *Controls,
-                                 f32 *Weights,
-                                 u32 PointCount,
-                                 u32 SampleCount,
-                                 f32 *Ts,
-                                 v2 *OutSamples,
-                                 work_queue_func *EvalWorkFunc)
+CalcPolynomial_ParallelFor(void *UserData, u32 Begin, u32 End)
 {
- temp_arena Temp = TempArena(0);
- work_queue *WorkQueue = GetCtx()->HighPriorityQueue;
- 
- // NOTE(hbr): BlockSize found experimentally
- work_queue_blocks Blocks = WorkQueueCalculateBlocks(WorkQueue, SampleCount, 200);
- u32 BlockCount = Blocks.BlockCount;
- u32 BlockSize = Blocks.BlockSize;
- u32 SamplesLeft = SampleCount;
- f32 *TsAt = Ts;
- v2 *OutSamplesAt = OutSamples;
- 
- calc_bezier_rational_work *Works = PushArray(Temp.Arena, BlockCount, calc_bezier_rational_work);
- 
- ForEachIndex(BlockIndex, BlockCount)
- {
-  u32 BlockSampleCount = Min(SamplesLeft, BlockSize);
-  
-  calc_bezier_rational_work *Work = Works + BlockIndex;
-  Work->Controls = Controls;
-  Work->Weights = Weights;
-  Work->PointCount = PointCount;
-  Work->SampleCount = BlockSampleCount;
-  Work->Ts = TsAt;
-  Work->OutSamples = OutSamplesAt;
-  
-  Platform.WorkQueueAddEntry(WorkQueue, EvalWorkFunc, Work);
-  
-  TsAt += BlockSampleCount;
-  OutSamplesAt += BlockSampleCount;
-  SamplesLeft -= BlockSampleCount;
- }
- 
- Assert(SamplesLeft == 0);
- 
- Platform.WorkQueueCompleteAllWork(WorkQueue);
- 
- EndTemp(Temp);
+ calc_polynomial_parallel *Parallel = Cast(calc_polynomial_parallel *)UserData;
+ calc_polynomial_work Work = Parallel->Work;
+ Work.SampleCount = End - Begin;
+ Work.Ts += Begin;
+ Work.OutSamples += Begin;
+ Parallel->EvalWorkFunc(&Work);
 }
 
 internal void
-CalcBezierRational(curve *Curve,
-                   v2 *Controls,
-                   f32 *Weights,
-                   u32 PointCount,
-                   u32 SampleCount,
-                   v2 *OutSamples)
+CalcPolynomial_MultiThreaded(polynomial_eval_input *Poly,
+                             u32 SampleCount,
+                             f32 *Ts,
+                             v2 *OutSamples,
+                             work_queue_func *EvalWorkFunc,
+                             u32 Grain)
+{
+ calc_polynomial_parallel Parallel = {};
+ Parallel.Work.Poly = Poly;
+ Parallel.Work.Ts = Ts;
+ Parallel.Work.OutSamples = OutSamples;
+ Parallel.EvalWorkFunc = EvalWorkFunc;
+ 
+ ParallelFor(SampleCount, Grain, CalcPolynomial_ParallelFor, &Parallel);
+}
+
+global read_only curve_eval_kernel PolynomialEvalKernels[] = {
+ {CalcPolynomial_Scalar_Work, false, 0},
+ {CalcPolynomial_SSE_Work, false, InstructionSet_SSE},
+ {CalcPolynomial_AVX2_Work, false, InstructionSet_AVX2},
+ {CalcPolynomial_AVX512_Work, false, InstructionSet_AVX512},
+ {CalcPolynomial_SSE_Work, true, InstructionSet_SSE},
+ {CalcPolynomial_AVX2_Work, true, InstructionSet_AVX2},
+ {CalcPolynomial_AVX512_Work, true, InstructionSet_AVX512},
+ {0, true, 0}, // NOTE(hbr): Adaptive, resolved from calibration
+};
+StaticAssert(ArrayCount(PolynomialEvalKernels) == Polynomial_Eval_Count, PolynomialEvalKernels_AllDefined);
+
+internal curve_eval_kernel
+PolynomialEvalKernel(polynomial_eval_method Method)
 {
- ProfileFunctionBegin();
- 
- temp_arena Temp = TempArena(0);
- 
- arena *ComputeArena = Curve->ComputeArena;
- f32 T = 0.0f;
- // NOTE(hbr): We assume the interval is always [0,1]
- f32 Delta_T = 1.0f / (SampleCount - 1);
- f32 *Ts = PushArrayNonZero(ComputeArena, SampleCount, f32);
- ForEachIndex(SampleIndex, SampleCount)
+ curve_eval_calibration Calibration = CurrentCurveEvalCalibration();
+ curve_eval_kernel Kernel = ResolveCurveEvalKernel(PolynomialEvalKernels, Method, Polynomial_Eval_Adaptive_MultiThreaded, Calibration.Polynomial);
+ return Kernel;
+}
+
+internal void
+CalcPolynomialWithKernel(polynomial_eval_input *Poly,
+                         u32 SampleCount,
+                         f32 *Ts,
+                         v2 *OutSamples,
+                         curve_eval_kernel Kernel)
+{
+ if (Kernel.MultiThreaded)
  {
-  Ts[SampleIndex] = T;
-  T += Delta_T;
+  CalcPolynomial_MultiThreaded(Poly, SampleCount, Ts, OutSamples, Kernel.EvalWorkFunc, Kernel.BlockSize);
  }
- Curve->Ts = Ts;
- 
- switch (DEBUG_Vars->Bezier_EvalMethod)
+ else
  {
-  case Bezier_Eval_Scalar: {
-   CalcBezierRational_Scalar(Controls, Weights, PointCount, SampleCount, Ts, OutSamples);
-  }break;
-  
-  case Bezier_Eval_SSE: {
-   CalcBezierRational_SSE(Controls, Weights, PointCount, SampleCount, Ts, OutSamples);
-  }break;
-  
-  case Bezier_Eval_AVX2: {
-   CalcBezierRational_AVX2(Controls, Weights, PointCount, SampleCount, Ts, OutSamples);
-  }break;
-  
-  case Bezier_Eval_AVX512: {
-   CalcBezierRational_AVX512(Controls, Weights, PointCount, SampleCount, Ts, OutSamples);
-  }break;
-  
-  case Bezier_Eval_SSE_MultiThreaded: {
-   CalcBezierRational_MultiThreaded(Controls, Weights, PointCount, SampleCount, Ts, OutSamples, CalcBezierRational_SSE_Work);
-  }break;
-  
-  case Bezier_Eval_AVX2_MultiThreaded: {
-   CalcBezierRational_MultiThreaded(Controls, Weights, PointCount, SampleCount, Ts, OutSamples, CalcBezierRational_AVX2_Work);
-  }break;
-  
-  case Bezier_Eval_AVX512_MultiThreaded: {
-   CalcBezierRational_MultiThreaded(Controls, Weights, PointCount, SampleCount, Ts, OutSamples, CalcBezierRational_AVX512_Work);
-  }break;
-  
-  case Bezier_Eval_Adaptive_MultiThreaded: {
-   work_queue_func *EvalFunc = 0;
-   
-   instruction_set_flags Flags = Platform.InstructionSetSupport();
-   if (0) {}
-   else if (Flags & InstructionSet_AVX512) EvalFunc = CalcBezierRational_AVX512_Work;
-   else if (Flags & InstructionSet_AVX2) EvalFunc = CalcBezierRational_AVX2_Work;
-   else if (Flags & InstructionSet_SSE) EvalFunc = CalcBezierRational_SSE_Work;
-   else EvalFunc = CalcBezierRational_Scalar_Work;
-   
-   CalcBezierRational_MultiThreaded(Controls, Weights, PointCount, SampleCount, Ts, OutSamples, EvalFunc);
-  }break;
-  
-  case Bezier_Eval_Count: InvalidPath;
+  calc_polynomial_work Work = {};
+  Work.Poly = Poly;
+  Work.SampleCount = SampleCount;
+  Work.Ts = Ts;
+  Work.OutSamples = OutSamples;
+  Kernel.EvalWorkFunc(&Work);
  }
- 
- EndTemp(Temp);
- 
- ProfileEnd();
 }
 
+// NOTE(hbr): Samples are spread evenly between every two consecutive nodes,
+// (PointCount-1)*SamplesPerControlPoint of them, without the last node.
 internal void
-CalcBezierCubicSpline(cubic_bezier_point *Beziers, u32 PointCount,
-                      u32 SampleCount, v2 *OutSamples)
+PolynomialSampleTs(f32 *Ti, u32 PointCount, u32 SamplesPerControlPoint, f32 *OutTs)
 {
- if (PointCount > 0)
+ f32 *TsAt = OutTs;
+ for (u32 PointIndex = 1;
+      PointIndex < PointCount;
+      ++PointIndex)
  {
-  f32 T = 0.0f;
-  f32 Delta_T = 1.0f / (SampleCount - 1);
-  
+  f32 Min_TT = Ti[PointIndex - 1];
+  f32 Max_TT = Ti[PointIndex - 0];
+  f32 Delta_TT = (Max_TT - Min_TT) / SamplesPerControlPoint;
+  f32 TT = Min_TT;
   for (u32 SampleIndex = 0;
-       SampleIndex < SampleCount;
+       SampleIndex < SamplesPerControlPoint;
        ++SampleIndex)
   {
-   f32 Expanded_T = (PointCount - 1) * T;
-   u32 SegmentIndex = Cast(u32)Expanded_T;
-   f32 Segment_T = Expanded_T - SegmentIndex;
-   
-   Assert(SegmentIndex < PointCount);
-   Assert(0.0f <= Segment_T && Segment_T <= 1.0f);
-   
-   cubic_bezier_curve_segment Segment = GetCubicBezierCurveSegment(Beziers, PointCount, SegmentIndex);
-   OutSamples[SampleIndex] = BezierCurveEvaluate(Segment_T, Segment.Points, Segment.PointCount);
-   
-   T += Delta_T;
+   *TsAt++ = TT;
+   TT += Delta_TT;
   }
  }
 }
 
-inline internal u32
-PartitionKnotIndexToKnotIndex(u32 PartitionKnotIndex, b_spline_knot_params KnotParams)
-{
- Assert(PartitionKnotIndex < KnotParams.PartitionSize);
- u32 Result = PartitionKnotIndex + KnotParams.Degree;
- return Result;
-}
-
 internal void
-CalcNURBS_ScalarUsingBSplineEvaluate(v2 *Controls,
-                                     f32 *Weights,
-                                     b_spline_knot_params KnotParams,
-                                     f32 *Knots,
-                                     u32 SampleCount,
-                                     f32 *Ts,
-                                     v2 *OutSamples)
+CalcPolynomial(v2 *Controls, u32 PointCount,
+               polynomial_interpolation_params Polynomial,
+               u32 SampleCount, v2 *OutSamples,
+               u32 SamplesPerControlPoint)
 {
  ProfileFunctionBegin();
  
- for (u32 SampleIndex = 0;
-      SampleIndex < SampleCount;
-      ++SampleIndex)
+ if (PointCount > 0)
  {
-  f32 T = Ts[SampleIndex];
-  OutSamples[SampleIndex] = BSplineEvaluate(T, Controls, KnotParams, Knots);
- }
- 
- ProfileEnd();
-}
-
+  temp_arena Temp = TempArena(0);
+  
+  polynomial_eval_input Poly = MakePolynomialEvalInput(Temp.Arena, Controls, PointCount, Polynomial);
+  f32 *Ti = Poly.Ti;
+  
+  // NOTE(hbr): The last sample is exactly the last control point
+  u32 EvalSampleCount = (PointCount - 1) * SamplesPerControlPoint;
+  Assert(EvalSampleCount < SampleCount);
+  f32 *Ts = PushArrayNonZero(Temp.Arena, EvalSampleCount, f32);
+  PolynomialSampleTs(Ti, PointCount, SamplesPerControlPoint, Ts);
+  
+  curve_eval_kernel Kernel = PolynomialEvalKernel(DEBUG_Vars->Polynomial_EvalMethod);
+  CalcPolynomialWithKernel(&Poly, EvalSampleCount, Ts, OutSamples, Kernel);
+  OutSamples[EvalSampleCount] = Controls[PointCount - 1];
+  
+  EndTemp(Temp);
+ }
+ 
+ ProfileEnd();
+}
+
 internal void
-CalcNURBS_Scalar(v2 *Controls,
-                 f32 *Weights,
-                 b_spline_knot_params KnotParams,
-                 f32 *Knots,
-                 u32 SampleCount,
-                 f32 *Ts,
-                 v2 *OutSamples)
+CalcCubicSpline_Scalar(f32 *Xs,
+                       f32 *Ys,
+                       u32 PointCount,
+                       f32 *Ti,
+                       f32 *Mx,
+                       f32 *My,
+                       u32 SampleCount,
+                       f32 *Ts,
+                       v2 *OutSamples)
 {
- for (u32 SampleIndex = 0;
-      SampleIndex < SampleCount;
-      ++SampleIndex)
+ ForEachIndex(SampleIndex, SampleCount)
  {
   f32 T = Ts[SampleIndex];
-  OutSamples[SampleIndex] = NURBS_EvaluateScalar(T, Controls, Weights, KnotParams, Knots);
+  f32 X = CubicSplineEvaluateScalar(T, Mx, Ti, Xs, PointCount);
+  f32 Y = CubicSplineEvaluateScalar(T, My, Ti, Ys, PointCount);
+  OutSamples[SampleIndex] = V2(X, Y);
  }
 }
 
+internal void
+CalcCubicSpline_ScalarWithBinarySearch(f32 *Xs,
+                                       f32 *Ys,
+                                       u32 PointCount,
+                                       f32 *Ti,
+                                       f32 *Mx,
+                                       f32 *My,
+                                       u32 SampleCount,
+                                       f32 *Ts,
+                                       v2 *OutSamples)
+{
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  f32 T = Ts[SampleIndex];
+  f32 X = CubicSplineEvaluateScalarWithBinarySearch(T, Mx, Ti, Xs, PointCount);
+  f32 Y = CubicSplineEvaluateScalarWithBinarySearch(T, My, Ti, Ys, PointCount);
+  OutSamples[SampleIndex] = V2(X, Y);
+ }
+}
 
 internal void
-CalcNURBS_ScalarButUsingSSE(v2 *Controls,
-                            f32 *Weights,
-                            b_spline_knot_params KnotParams,
-                            f32 *Knots,
-                            u32 SampleCount,
-                            f32 *Ts,
-                            v2 *OutSamples)
+CalcCubicSpline_ScalarWithConstantSearch(f32 *Xs,
+                                         f32 *Ys,
+                                         u32 PointCount,
+                                         f32 *Ti,
+                                         f32 *Mx,
+                                         f32 *My,
+                                         u32 SampleCount,
+                                         f32 *Ts,
+                                         v2 *OutSamples)
 {
- for (u32 SampleIndex = 0;
-      SampleIndex < SampleCount;
-      ++SampleIndex)
+ cubic_spline_evaluate_iterator Itx = {}, Ity = {};
+ ForEachIndex(SampleIndex, SampleCount)
  {
   f32 T = Ts[SampleIndex];
-  f32 T4[4] = {};
-  T4[0] = T;
-  v2 Out4[4] = {};
-  
-  NURBS_EvaluateSSE(Controls,
-                    Weights,
-                    KnotParams.PartitionSize - 1,
-                    KnotParams.Degree,
-                    Knots,
-                    T4,
-                    Out4);
-  
-  OutSamples[SampleIndex] = Out4[0];
+  f32 X = CubicSplineEvaluateScalarWithConstantSearch(T, Mx, Ti, Xs, PointCount, &Itx);
+  f32 Y = CubicSplineEvaluateScalarWithConstantSearch(T, My, Ti, Ys, PointCount, &Ity);
+  OutSamples[SampleIndex] = V2(X, Y);
  }
 }
 
 internal void
-CalcNURBS_SSE(v2 *Controls,
-              f32 *Weights,
-              b_spline_knot_params KnotParams,
-              f32 *Knots,
-              u32 SampleCount,
-              f32 *Ts,
-              v2 *OutSamples)
+CalcCubicSpline_SSE(f32 *Xs,
+                    f32 *Ys,
+                    u32 PointCount,
+                    f32 *Ti,
+                    f32 *Mx,
+                    f32 *My,
+                    u32 SampleCount,
+                    f32 *Ts,
+                    v2 *OutSamples)
 {
+ cubic_spline_evaluate_iterator It = {};
  u32 Blocks = (SampleCount + 3) / 4;
  u32 I = 0;
  while (Blocks--)
  {
+  // NOTE(hbr): Pad with the last sample instead of zeros, Ts have to stay sorted
   f32 T4[4] = {};
   for (u32 J = 0; J < 4; ++J)
   {
-   if (I + J < SampleCount)
-   {
-    T4[J] = Ts[I + J];
-   }
+   T4[J] = Ts[Min(I + J, SampleCount - 1)];
   }
   v2 Out4[4] = {};
   
-  NURBS_EvaluateSSE(Controls,
-                    Weights,
-                    KnotParams.PartitionSize - 1,
-                    KnotParams.Degree,
-                    Knots,
-                    T4,
-                    Out4);
+  CubicSplineEvaluateSSE(T4, Mx, My, Ti, Xs, Ys, PointCount, &It, Out4);
   
   for (u32 J = 0; J < 4; ++J)
   {
@@ -5103,35 +5924,30 @@ CalcNURBS_SSE(v2 *Controls,
 }
 
 internal void
-CalcNURBS_AVX2(v2 *Controls,
-               f32 *Weights,
-               b_spline_knot_params KnotParams,
-               f32 *Knots,
-               u32 SampleCount,
-               f32 *Ts,
-               v2 *OutSamples)
+CalcCubicSpline_AVX2(f32 *Xs,
+                     f32 *Ys,
+                     u32 PointCount,
+                     f32 *Ti,
+                     f32 *Mx,
+                     f32 *My,
+                     u32 SampleCount,
+                     f32 *Ts,
+                     v2 *OutSamples)
 {
+ cubic_spline_evaluate_iterator It = {};
  u32 Blocks = (SampleCount + 7) / 8;
  u32 I = 0;
  while (Blocks--)
  {
+  // NOTE(hbr): Pad with the last sample instead of zeros, Ts have to stay sorted
   f32 T8[8] = {};
   for (u32 J = 0; J < 8; ++J)
   {
-   if (I + J < SampleCount)
-   {
-    T8[J] = Ts[I + J];
-   }
+   T8[J] = Ts[Min(I + J, SampleCount - 1)];
   }
   v2 Out8[8] = {};
   
-  NURBS_EvaluateAVX2(Controls,
-                     Weights,
-                     KnotParams.PartitionSize - 1,
-                     KnotParams.Degree,
-                     Knots,
-                     T8,
-                     Out8);
+  CubicSplineEvaluateAVX2(T8, Mx, My, Ti, Xs, Ys, PointCount, &It, Out8);
   
   for (u32 J = 0; J < 8; ++J)
   {
@@ -5145,473 +5961,4017 @@ CalcNURBS_AVX2(v2 *Controls,
  }
 }
 
-struct calc_nurbs_work
+internal void
+CalcCubicSpline_AVX512(f32 *Xs,
+                       f32 *Ys,
+                       u32 PointCount,
+                       f32 *Ti,
+                       f32 *Mx,
+                       f32 *My,
+                       u32 SampleCount,
+                       f32 *Ts,
+                       v2 *OutSamples)
 {
- v2 *Controls;
- f32 *Weights;
- b_spline_knot_params KnotParams;
- f32 *Knots;
+ cubic_spline_evaluate_iterator It = {};
+ u32 Blocks = (SampleCount + 15) / 16;
+ u32 I = 0;
+ while (Blocks--)
+ {
+  // NOTE(hbr): Pad with the last sample instead of zeros, Ts have to stay sorted
+  f32 T16[16] = {};
+  for (u32 J = 0; J < 16; ++J)
+  {
+   T16[J] = Ts[Min(I + J, SampleCount - 1)];
+  }
+  v2 Out16[16] = {};
+  
+  CubicSplineEvaluateAVX512(T16, Mx, My, Ti, Xs, Ys, PointCount, &It, Out16);
+  
+  for (u32 J = 0; J < 16; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    OutSamples[I + J] = Out16[J];
+   }
+  }
+  
+  I += 16;
+ }
+}
+
+struct calc_cubic_spline_work
+{
+ f32 *Xs;
+ f32 *Ys;
+ u32 PointCount;
+ f32 *Ti;
+ f32 *Mx;
+ f32 *My;
  u32 SampleCount;
  f32 *Ts;
  v2 *OutSamples;
 };
 
 internal void
-CalcNURBS_Scalar_Work(void *UserData)
+CalcCubicSpline_Scalar_Work(void *UserData)
 {
- calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
- CalcNURBS_Scalar(Work->Controls,
-                  Work->Weights,
-                  Work->KnotParams,
-                  Work->Knots,
-                  Work->SampleCount,
-                  Work->Ts,
-                  Work->OutSamples);
+ calc_cubic_spline_work *Work = Cast(calc_cubic_spline_work *)UserData;
+ CalcCubicSpline_Scalar(Work->Xs,
+                        Work->Ys,
+                        Work->PointCount,
+                        Work->Ti,
+                        Work->Mx,
+                        Work->My,
+                        Work->SampleCount,
+                        Work->Ts,
+                        Work->OutSamples);
 }
 
 internal void
-CalcNURBS_SSE_Work(void *UserData)
+CalcCubicSpline_ScalarWithBinarySearch_Work(void *UserData)
 {
- calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
- CalcNURBS_SSE(Work->Controls,
-               Work->Weights,
-               Work->KnotParams,
-               Work->Knots,
-               Work->SampleCount,
-               Work->Ts,
-               Work->OutSamples);
+ calc_cubic_spline_work *Work = Cast(calc_cubic_spline_work *)UserData;
+ CalcCubicSpline_ScalarWithBinarySearch(Work->Xs,
+                                        Work->Ys,
+                                        Work->PointCount,
+                                        Work->Ti,
+                                        Work->Mx,
+                                        Work->My,
+                                        Work->SampleCount,
+                                        Work->Ts,
+                                        Work->OutSamples);
 }
 
 internal void
-CalcNURBS_AVX2_Work(void *UserData)
+CalcCubicSpline_ScalarWithConstantSearch_Work(void *UserData)
 {
- calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
- CalcNURBS_AVX2(Work->Controls,
-                Work->Weights,
-                Work->KnotParams,
-                Work->Knots,
-                Work->SampleCount,
-                Work->Ts,
-                Work->OutSamples);
+ calc_cubic_spline_work *Work = Cast(calc_cubic_spline_work *)UserData;
+ CalcCubicSpline_ScalarWithConstantSearch(Work->Xs,
+                                          Work->Ys,
+                                          Work->PointCount,
+                                          Work->Ti,
+                                          Work->Mx,
+                                          Work->My,
+                                          Work->SampleCount,
+                                          Work->Ts,
+                                          Work->OutSamples);
 }
 
 internal void
-CalcNURBS_MultiThreaded(v2 *Controls,
-                        f32 *Weights,
-                        b_spline_knot_params KnotParams,
-                        f32 *Knots,
-                        u32 SampleCount,
-                        f32 *Ts,
-                        v2 *OutSamples,
-                        work_queue_func *CalcNURBS_Work)
+CalcCubicSpline_SSE_Work(void *UserData)
 {
- temp_arena Temp = TempArena(0);
- work_queue *WorkQueue = GetCtx()->HighPriorityQueue;
- 
- // NOTE(hbr): Experimentally found that 100 is the fastest here. It seems "low" because
- // NURBS evaluation algorithm has O(m^2) complexity, so there is quite a bit of work
- // done there.
- work_queue_blocks Blocks = WorkQueueCalculateBlocks(WorkQueue, SampleCount, 100);
- u32 BlockCount = Blocks.BlockCount;
- u32 BlockSize = Blocks.BlockSize;
- u32 SamplesLeft = SampleCount;
- f32 *TsAt = Ts;
- v2 *OutSamplesAt = OutSamples;
- 
- calc_nurbs_work *Works = PushArray(Temp.Arena, BlockCount, calc_nurbs_work);
- 
- ForEachIndex(BlockIndex, BlockCount)
- {
-  u32 BlockSampleCount = Min(SamplesLeft, BlockSize);
-  
-  calc_nurbs_work *Work = Works + BlockIndex;
-  Work->Controls = Controls;
-  Work->Weights = Weights;
-  Work->KnotParams = KnotParams;
-  Work->Knots = Knots;
-  Work->SampleCount = BlockSampleCount;
-  Work->Ts = TsAt;
-  Work->OutSamples = OutSamplesAt;
-  
-  Platform.WorkQueueAddEntry(WorkQueue, CalcNURBS_Work, Work);
-  
-  TsAt += BlockSampleCount;
-  OutSamplesAt += BlockSampleCount;
-  SamplesLeft -= BlockSampleCount;
- }
- 
- Assert(SamplesLeft == 0);
- 
- Platform.WorkQueueCompleteAllWork(WorkQueue);
- 
- EndTemp(Temp);
+ calc_cubic_spline_work *Work = Cast(calc_cubic_spline_work *)UserData;
+ CalcCubicSpline_SSE(Work->Xs,
+                     Work->Ys,
+                     Work->PointCount,
+                     Work->Ti,
+                     Work->Mx,
+                     Work->My,
+                     Work->SampleCount,
+                     Work->Ts,
+                     Work->OutSamples);
 }
 
 internal void
-CalcNURBS(v2 *Controls,
-          f32 *Weights,
-          b_spline_knot_params KnotParams,
-          f32 *Knots,
-          u32 SampleCount,
-          f32 *Ts,
-          v2 *OutSamples)
+CalcCubicSpline_AVX2_Work(void *UserData)
 {
- ProfileFunctionBegin();
- 
- switch (DEBUG_Vars->NURBS_EvalMethod)
- {
-  case NURBS_Eval_Scalar_UsingBSplineEvaluate: {
-   CalcNURBS_ScalarUsingBSplineEvaluate(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples);
-  }break;
-  
-  case NURBS_Eval_Scalar: {
-   CalcNURBS_Scalar(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples);
-  }break;
+ calc_cubic_spline_work *Work = Cast(calc_cubic_spline_work *)UserData;
+ CalcCubicSpline_AVX2(Work->Xs,
+                      Work->Ys,
+                      Work->PointCount,
+                      Work->Ti,
+                      Work->Mx,
+                      Work->My,
+                      Work->SampleCount,
+                      Work->Ts,
+                      Work->OutSamples);
+}
+
+internal void
+CalcCubicSpline_AVX512_Work(void *UserData)
+{
+ calc_cubic_spline_work *Work = Cast(calc_cubic_spline_work *)UserData;
+ CalcCubicSpline_AVX512(Work->Xs,
+                        Work->Ys,
+                        Work->PointCount,
+                        Work->Ti,
+                        Work->Mx,
+                        Work->My,
+                        Work->SampleCount,
+                        Work->Ts,
+                        Work->OutSamples);
+}
+
+struct calc_cubic_spline_parallel
+{
+ calc_cubic_spline_work Work;
+ work_queue_func *EvalWorkFunc;
+};
+
+internal void
+CalcCubicSpline_ParallelFor(void *UserData, u32 Begin, u32 End)
+{
+ calc_cubic_spline_parallel *Parallel = Cast(calc_cubic_spline_parallel *)UserData;
+ calc_cubic_spline_work Work = Parallel->Work;
+ Work.SampleCount = End - Begin;
+ Work.Ts += Begin;
+ Work.OutSamples += Begin;
+ Parallel->EvalWorkFunc(&Work);
+}
+
+internal void
+CalcCubicSpline_MultiThreaded(f32 *Xs,
+                              f32 *Ys,
+                              u32 PointCount,
+                              f32 *Ti,
+                              f32 *Mx,
+                              f32 *My,
+                              u32 SampleCount,
+                              f32 *Ts,
+                              v2 *OutSamples,
+                              work_queue_func *EvalWorkFunc,
+                              u32 Grain)
+{
+ ProfileFunctionBegin();
+ 
+ calc_cubic_spline_parallel Parallel = {};
+ Parallel.Work.Xs = Xs;
+ Parallel.Work.Ys = Ys;
+ Parallel.Work.PointCount = PointCount;
+ Parallel.Work.Ti = Ti;
+ Parallel.Work.Mx = Mx;
+ Parallel.Work.My = My;
+ Parallel.Work.Ts = Ts;
+ Parallel.Work.OutSamples = OutSamples;
+ Parallel.EvalWorkFunc = EvalWorkFunc;
+ 
+ ParallelFor(SampleCount, Grain, CalcCubicSpline_ParallelFor, &Parallel);
+ 
+ ProfileEnd();
+}
+
+global read_only curve_eval_kernel CubicSplineEvalKernels[] = {
+ {CalcCubicSpline_Scalar_Work, false, 0},
+ {CalcCubicSpline_ScalarWithBinarySearch_Work, false, 0},
+ {CalcCubicSpline_ScalarWithConstantSearch_Work, false, 0},
+ {CalcCubicSpline_Scalar_Work, true, 0},
+ {CalcCubicSpline_ScalarWithBinarySearch_Work, true, 0},
+ {0, true, 0}, // NOTE(hbr): Adaptive, resolved from calibration
+ {CalcCubicSpline_SSE_Work, false, InstructionSet_SSE},
+ {CalcCubicSpline_AVX2_Work, false, InstructionSet_AVX2},
+ {CalcCubicSpline_AVX512_Work, false, InstructionSet_AVX512},
+ {CalcCubicSpline_SSE_Work, true, InstructionSet_SSE},
+ {CalcCubicSpline_AVX2_Work, true, InstructionSet_AVX2},
+ {CalcCubicSpline_AVX512_Work, true, InstructionSet_AVX512},
+};
+StaticAssert(ArrayCount(CubicSplineEvalKernels) == CubicSpline_Eval_Count, CubicSplineEvalKernels_AllDefined);
+
+internal curve_eval_kernel
+CubicSplineEvalKernel(cubic_spline_eval_method Method)
+{
+ curve_eval_calibration Calibration = CurrentCurveEvalCalibration();
+ curve_eval_kernel Kernel = ResolveCurveEvalKernel(CubicSplineEvalKernels, Method, CubicSpline_Eval_Adaptive_MultiThreaded, Calibration.CubicSpline);
+ return Kernel;
+}
+
+internal void
+CalcCubicSplineWithKernel(f32 *Xs,
+                          f32 *Ys,
+                          u32 PointCount,
+                          f32 *Ti,
+                          f32 *Mx,
+                          f32 *My,
+                          u32 SampleCount,
+                          f32 *Ts,
+                          v2 *OutSamples,
+                          curve_eval_kernel Kernel)
+{
+ if (Kernel.MultiThreaded)
+ {
+  CalcCubicSpline_MultiThreaded(Xs, Ys, PointCount, Ti, Mx, My, SampleCount, Ts, OutSamples, Kernel.EvalWorkFunc, Kernel.BlockSize);
+ }
+ else
+ {
+  calc_cubic_spline_work Work = {};
+  Work.Xs = Xs;
+  Work.Ys = Ys;
+  Work.PointCount = PointCount;
+  Work.Ti = Ti;
+  Work.Mx = Mx;
+  Work.My = My;
+  Work.SampleCount = SampleCount;
+  Work.Ts = Ts;
+  Work.OutSamples = OutSamples;
+  Kernel.EvalWorkFunc(&Work);
+ }
+}
+
+struct cubic_spline_eval_input
+{
+ u32 PointCount;
+ f32 *Ti;
+ f32 *Xs;
+ f32 *Ys;
+ f32 *Mx;
+ f32 *My;
+};
+
+internal cubic_spline_eval_input
+MakeCubicSplineEvalInput(arena *Arena, v2 *Controls, u32 PointCount, cubic_spline_type Spline)
+{
+ cubic_spline_eval_input Input = {};
+ 
+ if (Spline == CubicSpline_Periodic)
+ {
+  v2 *OriginalControls = Controls;
+  
+  Controls = PushArrayNonZero(Arena, PointCount + 1, v2);
+  ArrayCopy(Controls, OriginalControls, PointCount);
+  Controls[PointCount] = OriginalControls[0];
+  
+  ++PointCount;
+ }
+ 
+ f32 *Ti = PushArrayNonZero(Arena, PointCount, f32);
+ EquidistantPoints(Ti, PointCount, 0.0f, 1.0f);
+ 
+ points_soa SOA = SplitPointsIntoComponents(Arena, Controls, PointCount);
+ 
+ f32 *Mx = PushArrayNonZero(Arena, PointCount, f32);
+ f32 *My = PushArrayNonZero(Arena, PointCount, f32);
+ switch (Spline)
+ {
+  case CubicSpline_Natural: {
+   CubicSplineNaturalM(Mx, Ti, SOA.Xs, PointCount);
+   CubicSplineNaturalM(My, Ti, SOA.Ys, PointCount);
+  } break;
+  
+  case CubicSpline_Periodic: {
+   switch (DEBUG_Vars->CubicSplinePeriodicM_EvalMethod)
+   {
+    case CubicSplinePeriodicM_Eval_Base: {
+     CubicSplinePeriodicM(Mx, Ti, SOA.Xs, PointCount);
+     CubicSplinePeriodicM(My, Ti, SOA.Ys, PointCount);
+    }break;
+    
+    case CubicSplinePeriodicM_Eval_Optimized: {
+     CubicSplinePeriodicM_Optimized(Mx, Ti, SOA.Xs, PointCount);
+     CubicSplinePeriodicM_Optimized(My, Ti, SOA.Ys, PointCount);
+    }break;
+    
+    case CubicSplinePeriodicM_Eval_Count: InvalidPath;
+   }
+  } break;
+  
+  case CubicSpline_Count: InvalidPath;
+ }
+ 
+ Input.PointCount = PointCount;
+ Input.Ti = Ti;
+ Input.Xs = SOA.Xs;
+ Input.Ys = SOA.Ys;
+ Input.Mx = Mx;
+ Input.My = My;
+ 
+ return Input;
+}
+
+internal void
+CalcCubicSpline(v2 *Controls,
+                u32 PointCount,
+                cubic_spline_type Spline,
+                u32 SampleCount,
+                v2 *OutSamples)
+{
+ ProfileFunctionBegin();
+ 
+ if (PointCount > 0)
+ {
+  temp_arena Temp = TempArena(0);
+  
+  cubic_spline_eval_input Spl = MakeCubicSplineEvalInput(Temp.Arena, Controls, PointCount, Spline);
+  f32 *Ti = Spl.Ti;
+  
+  f32 T = Ti[0];
+  f32 Delta_T = (Ti[Spl.PointCount - 1] - Ti[0]) / (SampleCount - 1);
+  f32 *Ts = PushArrayNonZero(Temp.Arena, SampleCount, f32);
+  ForEachIndex(SampleIndex, SampleCount)
+  {
+   Ts[SampleIndex] = T;
+   T += Delta_T;
+  }
+  
+  ProfileBlock("CalcCubicSpline - Samples Block")
+  {
+   curve_eval_kernel Kernel = CubicSplineEvalKernel(DEBUG_Vars->CubicSpline_EvalMethod);
+   CalcCubicSplineWithKernel(Spl.Xs, Spl.Ys, Spl.PointCount, Ti, Spl.Mx, Spl.My, SampleCount, Ts, OutSamples, Kernel);
+  }
+  
+  EndTemp(Temp);
+ }
+ 
+ ProfileEnd();
+}
+
+internal void
+CalcBezierRational_Scalar(v2 *Controls,
+                          f32 *Weights,
+                          u32 PointCount,
+                          u32 SampleCount,
+                          f32 *Ts,
+                          v2 *OutSamples)
+{
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  f32 T = Ts[SampleIndex];
+  OutSamples[SampleIndex] = BezierCurveRationalEvaluateScalar(T, Controls, Weights, PointCount);
+ }
+}
+
+internal void
+CalcBezierRational_SSE(v2 *Controls,
+                       f32 *Weights,
+                       u32 PointCount,
+                       u32 SampleCount,
+                       f32 *Ts,
+                       v2 *OutSamples)
+{
+ u32 Blocks = (SampleCount + 3) / 4;
+ u32 I = 0;
+ while (Blocks--)
+ {
+  f32 T4[4] = {};
+  for (u32 J = 0; J < 4; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    T4[J] = Ts[I + J];
+   }
+  }
+  v2 Out4[4] = {};
+  
+  BezierCurveRationalEvaluateSSE(T4,
+                                 Controls,
+                                 Weights,
+                                 PointCount,
+                                 Out4);
+  
+  for (u32 J = 0; J < 4; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    OutSamples[I + J] = Out4[J];
+   }
+  }
+  
+  I += 4;
+ }
+}
+
+internal void
+CalcBezierRational_AVX2(v2 *Controls,
+                        f32 *Weights,
+                        u32 PointCount,
+                        u32 SampleCount,
+                        f32 *Ts,
+                        v2 *OutSamples)
+{
+ u32 Blocks = (SampleCount + 7) / 8;
+ u32 I = 0;
+ while (Blocks--)
+ {
+  f32 T8[8] = {};
+  for (u32 J = 0; J < 8; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    T8[J] = Ts[I + J];
+   }
+  }
+  v2 Out8[8] = {};
+  
+  BezierCurveRationalEvaluateAVX2(T8,
+                                  Controls,
+                                  Weights,
+                                  PointCount,
+                                  Out8);
+  
+  for (u32 J = 0; J < 8; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    OutSamples[I + J] = Out8[J];
+   }
+  }
+  
+  I += 8;
+ }
+}
+
+internal void
+CalcBezierRational_AVX512(v2 *Controls,
+                          f32 *Weights,
+                          u32 PointCount,
+                          u32 SampleCount,
+                          f32 *Ts,
+                          v2 *OutSamples)
+{
+ u32 Blocks = (SampleCount + 15) / 16;
+ u32 I = 0;
+ while (Blocks--)
+ {
+  f32 T16[16] = {};
+  for (u32 J = 0; J < 16; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    T16[J] = Ts[I + J];
+   }
+  }
+  v2 Out16[16] = {};
+  
+  BezierCurveRational_Evaluate_AVX512(T16,
+                                      Controls,
+                                      Weights,
+                                      PointCount,
+                                      Out16);
+  
+  for (u32 J = 0; J < 16; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    OutSamples[I + J] = Out16[J];
+   }
+  }
+  
+  I += 16;
+ }
+}
+
+internal void
+CalcBezierRational_ForwardDifferencing(v2 *Controls,
+                                       f32 *Weights,
+                                       u32 PointCount,
+                                       u32 SampleCount,
+                                       f32 *Ts,
+                                       v2 *OutSamples)
+{
+ if (SampleCount > 0)
+ {
+  // NOTE(hbr): Ts are evenly spaced, so only the first and the step matter. Work queue
+  // blocks anchor at their own first sample.
+  f32 T0 = Ts[0];
+  f32 Delta_T = SafeDiv0(Ts[SampleCount - 1] - T0, Cast(f32)(SampleCount - 1));
+  BezierCurveRationalForwardDifferences(T0, Delta_T, SampleCount, Controls, Weights, PointCount, OutSamples);
+ }
+}
+
+internal void
+CalcBezierRational_F64_Scalar(v2 *Controls,
+                              f32 *Weights,
+                              u32 PointCount,
+                              u32 SampleCount,
+                              f32 *Ts,
+                              v2 *OutSamples)
+{
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  f32 T = Ts[SampleIndex];
+  OutSamples[SampleIndex] = BezierCurveRationalEvaluateF64(T, Controls, Weights, PointCount);
+ }
+}
+
+internal void
+CalcBezierRational_F64_AVX2(v2 *Controls,
+                            f32 *Weights,
+                            u32 PointCount,
+                            u32 SampleCount,
+                            f32 *Ts,
+                            v2 *OutSamples)
+{
+ u32 Blocks = (SampleCount + 3) / 4;
+ u32 I = 0;
+ while (Blocks--)
+ {
+  f32 T4[4] = {};
+  for (u32 J = 0; J < 4; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    T4[J] = Ts[I + J];
+   }
+  }
+  v2 Out4[4] = {};
+  
+  BezierCurveRationalEvaluateF64_AVX2(T4, Controls, Weights, PointCount, Out4);
+  
+  for (u32 J = 0; J < 4; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    OutSamples[I + J] = Out4[J];
+   }
+  }
+  
+  I += 4;
+ }
+}
+
+internal void
+CalcBezierRational_F64_AVX512(v2 *Controls,
+                              f32 *Weights,
+                              u32 PointCount,
+                              u32 SampleCount,
+                              f32 *Ts,
+                              v2 *OutSamples)
+{
+ u32 Blocks = (SampleCount + 7) / 8;
+ u32 I = 0;
+ while (Blocks--)
+ {
+  f32 T8[8] = {};
+  for (u32 J = 0; J < 8; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    T8[J] = Ts[I + J];
+   }
+  }
+  v2 Out8[8] = {};
+  
+  BezierCurveRationalEvaluateF64_AVX512(T8, Controls, Weights, PointCount, Out8);
+  
+  for (u32 J = 0; J < 8; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    OutSamples[I + J] = Out8[J];
+   }
+  }
+  
+  I += 8;
+ }
+}
+
+internal void
+CalcBezierRational_Compensated(v2 *Controls,
+                               f32 *Weights,
+                               u32 PointCount,
+                               u32 SampleCount,
+                               f32 *Ts,
+                               v2 *OutSamples)
+{
+ temp_arena Temp = TempArena(0);
+ 
+ f32 *Scratch = PushArrayNonZero(Temp.Arena, 2 * PointCount, f32);
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  f32 T = Ts[SampleIndex];
+  OutSamples[SampleIndex] = BezierCurveRationalEvaluateCompensated(T, Controls, Weights, PointCount, Scratch);
+ }
+ 
+ EndTemp(Temp);
+}
+
+struct calc_bezier_rational_work
+{
+ v2 *Controls;
+ f32 *Weights;
+ u32 PointCount;
+ u32 SampleCount;
+ f32 *Ts;
+ v2 *OutSamples;
+};
+
+internal void
+CalcBezierRational_Scalar_Work(void *UserData)
+{
+ calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
+ CalcBezierRational_Scalar(Work->Controls,
+                           Work->Weights,
+                           Work->PointCount,
+                           Work->SampleCount,
+                           Work->Ts,
+                           Work->OutSamples);
+}
+
+internal void
+CalcBezierRational_SSE_Work(void *UserData)
+{
+ calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
+ CalcBezierRational_SSE(Work->Controls,
+                        Work->Weights,
+                        Work->PointCount,
+                        Work->SampleCount,
+                        Work->Ts,
+                        Work->OutSamples);
+}
+
+internal void
+CalcBezierRational_AVX2_Work(void *UserData)
+{
+ calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
+ CalcBezierRational_AVX2(Work->Controls,
+                         Work->Weights,
+                         Work->PointCount,
+                         Work->SampleCount,
+                         Work->Ts,
+                         Work->OutSamples);
+}
+
+internal void
+CalcBezierRational_AVX512_Work(void *UserData)
+{
+ calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
+ CalcBezierRational_AVX512(Work->Controls,
+                           Work->Weights,
+                           Work->PointCount,
+                           Work->SampleCount,
+                           Work->Ts,
+                           Work->OutSamples);
+}
+
+internal void
+CalcBezierRational_ForwardDifferencing_Work(void *UserData)
+{
+ calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
+ CalcBezierRational_ForwardDifferencing(Work->Controls,
+                                        Work->Weights,
+                                        Work->PointCount,
+                                        Work->SampleCount,
+                                        Work->Ts,
+                                        Work->OutSamples);
+}
+
+internal void
+CalcBezierRational_F64_Scalar_Work(void *UserData)
+{
+ calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
+ CalcBezierRational_F64_Scalar(Work->Controls,
+                               Work->Weights,
+                               Work->PointCount,
+                               Work->SampleCount,
+                               Work->Ts,
+                               Work->OutSamples);
+}
+
+internal void
+CalcBezierRational_F64_AVX2_Work(void *UserData)
+{
+ calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
+ CalcBezierRational_F64_AVX2(Work->Controls,
+                             Work->Weights,
+                             Work->PointCount,
+                             Work->SampleCount,
+                             Work->Ts,
+                             Work->OutSamples);
+}
+
+internal void
+CalcBezierRational_F64_AVX512_Work(void *UserData)
+{
+ calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
+ CalcBezierRational_F64_AVX512(Work->Controls,
+                               Work->Weights,
+                               Work->PointCount,
+                               Work->SampleCount,
+                               Work->Ts,
+                               Work->OutSamples);
+}
+
+internal void
+CalcBezierRational_Compensated_Work(void *UserData)
+{
+ calc_bezier_rational_work *Work = Cast(calc_bezier_rational_work *)UserData;
+ CalcBezierRational_Compensated(Work->Controls,
+                                Work->Weights,
+                                Work->PointCount,
+                                Work->SampleCount,
+                                Work->Ts,
+                                Work->OutSamples);
+}
+
+struct calc_bezier_rational_parallel
+{
+ calc_bezier_rational_work Work;
+ work_queue_func *EvalWorkFunc;
+};
+
+internal void
+CalcBezierRational_ParallelFor(void *UserData, u32 Begin, u32 End)
+{
+ calc_bezier_rational_parallel *Parallel = Cast(calc_bezier_rational_parallel *)UserData;
+ calc_bezier_rational_work Work = Parallel->Work;
+ Work.SampleCount = End - Begin;
+ Work.Ts += Begin;
+ Work.OutSamples += Begin;
+ Parallel->EvalWorkFunc(&Work);
+}
+
+internal void
+CalcBezierRational_MultiThreaded(v2 *Controls,
+                                 f32 *Weights,
+                                 u32 PointCount,
+                                 u32 SampleCount,
+                                 f32 *Ts,
+                                 v2 *OutSamples,
+                                 work_queue_func *EvalWorkFunc,
+                                 u32 Grain)
+{
+ calc_bezier_rational_parallel Parallel = {};
+ Parallel.Work.Controls = Controls;
+ Parallel.Work.Weights = Weights;
+ Parallel.Work.PointCount = PointCount;
+ Parallel.Work.Ts = Ts;
+ Parallel.Work.OutSamples = OutSamples;
+ Parallel.EvalWorkFunc = EvalWorkFunc;
+ 
+ ParallelFor(SampleCount, Grain, CalcBezierRational_ParallelFor, &Parallel);
+}
+
+global read_only curve_eval_kernel BezierRationalEvalKernels[] = {
+ {CalcBezierRational_Scalar_Work, false, 0},
+ {CalcBezierRational_SSE_Work, false, InstructionSet_SSE},
+ {CalcBezierRational_AVX2_Work, false, InstructionSet_AVX2},
+ {CalcBezierRational_AVX512_Work, false, InstructionSet_AVX512},
+ {CalcBezierRational_SSE_Work, true, InstructionSet_SSE},
+ {CalcBezierRational_AVX2_Work, true, InstructionSet_AVX2},
+ {CalcBezierRational_AVX512_Work, true, InstructionSet_AVX512},
+ {0, true, 0}, // NOTE(hbr): Adaptive, resolved from calibration
+ {CalcBezierRational_ForwardDifferencing_Work, false, 0, true},
+ {CalcBezierRational_ForwardDifferencing_Work, true, 0, true},
+};
+StaticAssert(ArrayCount(BezierRationalEvalKernels) == Bezier_Eval_Count, BezierRationalEvalKernels_AllDefined);
+
+internal curve_eval_kernel
+BezierRationalEvalKernel(bezier_eval_method Method)
+{
+ curve_eval_calibration Calibration = CurrentCurveEvalCalibration();
+ curve_eval_kernel Kernel = ResolveCurveEvalKernel(BezierRationalEvalKernels, Method, Bezier_Eval_Adaptive_MultiThreaded, Calibration.Bezier);
+ return Kernel;
+}
+
+// NOTE(hbr): Ordered from the fastest, first supported one is picked
+global read_only curve_eval_kernel BezierRationalF64EvalKernels[] = {
+ {CalcBezierRational_F64_AVX512_Work, true, InstructionSet_AVX512},
+ {CalcBezierRational_F64_AVX2_Work, true, InstructionSet_AVX2},
+ {CalcBezierRational_F64_Scalar_Work, true, 0},
+};
+
+internal curve_eval_kernel
+BezierRationalPrecisionEvalKernel(curve_eval_precision Precision)
+{
+ curve_eval_kernel Kernel = {};
+ switch (Precision)
+ {
+  case CurveEvalPrecision_F32: {Kernel = BezierRationalEvalKernel(DEBUG_Vars->Bezier_EvalMethod);}break;
+  
+  case CurveEvalPrecision_F64: {
+   instruction_set_flags Flags = Platform.InstructionSetSupport();
+   ForEachElement(KernelIndex, BezierRationalF64EvalKernels)
+   {
+    curve_eval_kernel Candidate = BezierRationalF64EvalKernels[KernelIndex];
+    if (IsCurveEvalKernelSupported(Candidate, Flags))
+    {
+     Kernel = Candidate;
+     break;
+    }
+   }
+  }break;
+  
+  case CurveEvalPrecision_Compensated: {
+   curve_eval_kernel Compensated = {CalcBezierRational_Compensated_Work, true, 0};
+   Kernel = Compensated;
+  }break;
+  
+  case CurveEvalPrecision_Count: InvalidPath;
+ }
+ 
+ if (Precision != CurveEvalPrecision_F32)
+ {
+  // NOTE(hbr): These are O(n) (or O(n^2) for compensated) per sample like the f32 ones,
+  // so reuse their calibrated block size
+  Kernel.BlockSize = CurrentCurveEvalCalibration().Bezier.BlockSize;
+ }
+ 
+ return Kernel;
+}
+
+internal void
+CalcBezierRationalWithKernel(v2 *Controls,
+                             f32 *Weights,
+                             u32 PointCount,
+                             u32 SampleCount,
+                             f32 *Ts,
+                             v2 *OutSamples,
+                             curve_eval_kernel Kernel)
+{
+ if (Kernel.MultiThreaded)
+ {
+  CalcBezierRational_MultiThreaded(Controls, Weights, PointCount, SampleCount, Ts, OutSamples, Kernel.EvalWorkFunc, Kernel.BlockSize);
+ }
+ else
+ {
+  calc_bezier_rational_work Work = {};
+  Work.Controls = Controls;
+  Work.Weights = Weights;
+  Work.PointCount = PointCount;
+  Work.SampleCount = SampleCount;
+  Work.Ts = Ts;
+  Work.OutSamples = OutSamples;
+  Kernel.EvalWorkFunc(&Work);
+ }
+}
+
+internal void
+CalcBezierRational(curve *Curve,
+                   v2 *Controls,
+                   f32 *Weights,
+                   u32 PointCount,
+                   u32 SampleCount,
+                   v2 *OutSamples)
+{
+ ProfileFunctionBegin();
+ 
+ temp_arena Temp = TempArena(0);
+ 
+ arena *ComputeArena = Curve->ComputeArena;
+ f32 T = 0.0f;
+ // NOTE(hbr): We assume the interval is always [0,1]
+ f32 Delta_T = 1.0f / (SampleCount - 1);
+ f32 *Ts = PushArrayNonZero(ComputeArena, SampleCount, f32);
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  Ts[SampleIndex] = T;
+  T += Delta_T;
+ }
+ if (SampleCount > 0)
+ {
+  // NOTE(hbr): Accumulated Delta_T overshoots 1 - pin the end so both the full
+  // kernel and the cached basis land exactly on the last control point.
+  Ts[SampleCount - 1] = 1.0f;
+ }
+ Curve->Ts = Ts;
+ 
+ curve_eval_kernel Kernel = BezierRationalPrecisionEvalKernel(Curve->Params.BezierPrecision);
+ CalcBezierRationalWithKernel(Controls, Weights, PointCount, SampleCount, Ts, OutSamples, Kernel);
+ 
+ EndTemp(Temp);
+ 
+ ProfileEnd();
+}
+
+internal void
+CalcBezierCubicSpline(cubic_bezier_point *Beziers, u32 PointCount,
+                      u32 SampleCount, v2 *OutSamples)
+{
+ if (PointCount > 0)
+ {
+  f32 Delta_T = 1.0f / (SampleCount - 1);
+  f32 Segment_Delta_T = (PointCount - 1) * Delta_T;
+  
+  bezier_eval_method EvalMethod = DEBUG_Vars->Bezier_EvalMethod;
+  b32 ForwardDifferencing = (EvalMethod == Bezier_Eval_ForwardDifferencing ||
+                             EvalMethod == Bezier_Eval_ForwardDifferencing_MultiThreaded);
+  cubic_forward_differences FD = {};
+  u32 AnchorSegmentIndex = U32_MAX;
+  u32 AnchorSampleIndex = 0;
+  
+  for (u32 SampleIndex = 0;
+       SampleIndex < SampleCount;
+       ++SampleIndex)
+  {
+   // NOTE(hbr): Not accumulated, so that sample I is exactly at I/(SampleCount-1) and can
+   // be re-evaluated on its own, see RecomputeCurveControlPointRange
+   f32 T = SampleIndex * Delta_T;
+   f32 Expanded_T = (PointCount - 1) * T;
+   u32 SegmentIndex = Cast(u32)Expanded_T;
+   f32 Segment_T = Expanded_T - SegmentIndex;
+   
+   Assert(SegmentIndex < PointCount);
+   Assert(0.0f <= Segment_T && Segment_T <= 1.0f);
+   
+   cubic_bezier_curve_segment Segment = GetCubicBezierCurveSegment(Beziers, PointCount, SegmentIndex);
+   if (ForwardDifferencing && Segment.PointCount == 4)
+   {
+    // NOTE(hbr): Reanchor at every segment start and periodically within the segment
+    if (SegmentIndex != AnchorSegmentIndex ||
+        SampleIndex - AnchorSampleIndex >= BezierForwardDifferencesReanchorInterval)
+    {
+     v2 *P = Segment.Points;
+     v2 C0 = P[0];
+     v2 C1 = 3 * (P[1] - P[0]);
+     v2 C2 = 3 * (P[0] - 2 * P[1] + P[2]);
+     v2 C3 = P[3] - P[0] + 3 * (P[1] - P[2]);
+     f32 C[4][3] = {
+      {C0.X, C0.Y}, {C1.X, C1.Y}, {C2.X, C2.Y}, {C3.X, C3.Y},
+     };
+     FD = CubicForwardDifferencesInit(C, 2, Segment_T, Segment_Delta_T);
+     AnchorSegmentIndex = SegmentIndex;
+     AnchorSampleIndex = SampleIndex;
+    }
+    
+    OutSamples[SampleIndex] = V2(FD.F[0], FD.F[1]);
+    CubicForwardDifferencesStep(&FD);
+   }
+   else
+   {
+    OutSamples[SampleIndex] = BezierCurveEvaluate(Segment_T, Segment.Points, Segment.PointCount);
+   }
+  }
+ }
+}
+
+inline internal u32
+PartitionKnotIndexToKnotIndex(u32 PartitionKnotIndex, b_spline_knot_params KnotParams)
+{
+ Assert(PartitionKnotIndex < KnotParams.PartitionSize);
+ u32 Result = PartitionKnotIndex + KnotParams.Degree;
+ return Result;
+}
+
+internal void
+CalcNURBS_ScalarUsingBSplineEvaluate(v2 *Controls,
+                                     f32 *Weights,
+                                     b_spline_knot_params KnotParams,
+                                     f32 *Knots,
+                                     u32 SampleCount,
+                                     f32 *Ts,
+                                     v2 *OutSamples)
+{
+ ProfileFunctionBegin();
+ 
+ for (u32 SampleIndex = 0;
+      SampleIndex < SampleCount;
+      ++SampleIndex)
+ {
+  f32 T = Ts[SampleIndex];
+  OutSamples[SampleIndex] = BSplineEvaluate(T, Controls, KnotParams, Knots);
+ }
+ 
+ ProfileEnd();
+}
+
+internal void
+CalcNURBS_Scalar(v2 *Controls,
+                 f32 *Weights,
+                 b_spline_knot_params KnotParams,
+                 f32 *Knots,
+                 u32 SampleCount,
+                 f32 *Ts,
+                 v2 *OutSamples)
+{
+ for (u32 SampleIndex = 0;
+      SampleIndex < SampleCount;
+      ++SampleIndex)
+ {
+  f32 T = Ts[SampleIndex];
+  OutSamples[SampleIndex] = NURBS_EvaluateScalar(T, Controls, Weights, KnotParams, Knots);
+ }
+}
+
+
+internal void
+CalcNURBS_ScalarButUsingSSE(v2 *Controls,
+                            f32 *Weights,
+                            b_spline_knot_params KnotParams,
+                            f32 *Knots,
+                            u32 SampleCount,
+                            f32 *Ts,
+                            v2 *OutSamples)
+{
+ for (u32 SampleIndex = 0;
+      SampleIndex < SampleCount;
+      ++SampleIndex)
+ {
+  f32 T = Ts[SampleIndex];
+  f32 T4[4] = {};
+  T4[0] = T;
+  v2 Out4[4] = {};
+  
+  NURBS_EvaluateSSE(Controls,
+                    Weights,
+                    KnotParams.PartitionSize - 1,
+                    KnotParams.Degree,
+                    Knots,
+                    T4,
+                    Out4);
+  
+  OutSamples[SampleIndex] = Out4[0];
+ }
+}
+
+internal void
+CalcNURBS_SSE(v2 *Controls,
+              f32 *Weights,
+              b_spline_knot_params KnotParams,
+              f32 *Knots,
+              u32 SampleCount,
+              f32 *Ts,
+              v2 *OutSamples)
+{
+ u32 Blocks = (SampleCount + 3) / 4;
+ u32 I = 0;
+ while (Blocks--)
+ {
+  f32 T4[4] = {};
+  for (u32 J = 0; J < 4; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    T4[J] = Ts[I + J];
+   }
+  }
+  v2 Out4[4] = {};
+  
+  NURBS_EvaluateSSE(Controls,
+                    Weights,
+                    KnotParams.PartitionSize - 1,
+                    KnotParams.Degree,
+                    Knots,
+                    T4,
+                    Out4);
+  
+  for (u32 J = 0; J < 4; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    OutSamples[I + J] = Out4[J];
+   }
+  }
+  
+  I += 4;
+ }
+}
+
+internal void
+CalcNURBS_AVX2(v2 *Controls,
+               f32 *Weights,
+               b_spline_knot_params KnotParams,
+               f32 *Knots,
+               u32 SampleCount,
+               f32 *Ts,
+               v2 *OutSamples)
+{
+ u32 Blocks = (SampleCount + 7) / 8;
+ u32 I = 0;
+ while (Blocks--)
+ {
+  f32 T8[8] = {};
+  for (u32 J = 0; J < 8; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    T8[J] = Ts[I + J];
+   }
+  }
+  v2 Out8[8] = {};
+  
+  NURBS_EvaluateAVX2(Controls,
+                     Weights,
+                     KnotParams.PartitionSize - 1,
+                     KnotParams.Degree,
+                     Knots,
+                     T8,
+                     Out8);
+  
+  for (u32 J = 0; J < 8; ++J)
+  {
+   if (I + J < SampleCount)
+   {
+    OutSamples[I + J] = Out8[J];
+   }
+  }
+  
+  I += 8;
+ }
+}
+
+internal void
+CalcNURBS_Extracted_Scalar(v2 *Controls,
+                           f32 *Weights,
+                           b_spline_knot_params KnotParams,
+                           f32 *Knots,
+                           nurbs_bezier_extraction *Extraction,
+                           u32 SampleCount,
+                           f32 *Ts,
+                           v2 *OutSamples)
+{
+ if (Extraction->Extracted)
+ {
+  nurbs_extraction_iterator It = {};
+  for (u32 SampleIndex = 0;
+       SampleIndex < SampleCount;
+       ++SampleIndex)
+  {
+   OutSamples[SampleIndex] = NURBS_EvaluateExtractedScalar(Ts[SampleIndex], Extraction, &It);
+  }
+ }
+ else
+ {
+  CalcNURBS_Scalar(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples);
+ }
+}
+
+// NOTE(hbr): Pads the tail with the last sample, so that span lookup stays monotone
+#define CalcNURBS_ExtractedLanes(LaneCount, EvaluateLanes) \
+ do { \
+  nurbs_extraction_iterator It = {}; \
+  u32 Blocks = (SampleCount + (LaneCount - 1)) / LaneCount; \
+  u32 I = 0; \
+  while (Blocks--) \
+  { \
+   f32 TLanes[LaneCount]; \
+   for (u32 J = 0; J < LaneCount; ++J) \
+   { \
+    TLanes[J] = Ts[Min(I + J, SampleCount - 1)]; \
+   } \
+   v2 OutLanes[LaneCount]; \
+   EvaluateLanes(TLanes, Extraction, &It, OutLanes); \
+   for (u32 J = 0; J < LaneCount && I + J < SampleCount; ++J) \
+   { \
+    OutSamples[I + J] = OutLanes[J]; \
+   } \
+   I += LaneCount; \
+  } \
+ } while (0)
+
+internal void
+CalcNURBS_Extracted_SSE(v2 *Controls,
+                        f32 *Weights,
+                        b_spline_knot_params KnotParams,
+                        f32 *Knots,
+                        nurbs_bezier_extraction *Extraction,
+                        u32 SampleCount,
+                        f32 *Ts,
+                        v2 *OutSamples)
+{
+ if (Extraction->Extracted)
+ {
+  CalcNURBS_ExtractedLanes(4, NURBS_EvaluateExtractedSSE);
+ }
+ else
+ {
+  CalcNURBS_SSE(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples);
+ }
+}
+
+internal void
+CalcNURBS_Extracted_AVX2(v2 *Controls,
+                         f32 *Weights,
+                         b_spline_knot_params KnotParams,
+                         f32 *Knots,
+                         nurbs_bezier_extraction *Extraction,
+                         u32 SampleCount,
+                         f32 *Ts,
+                         v2 *OutSamples)
+{
+ if (Extraction->Extracted)
+ {
+  CalcNURBS_ExtractedLanes(8, NURBS_EvaluateExtractedAVX2);
+ }
+ else
+ {
+  CalcNURBS_AVX2(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples);
+ }
+}
+
+internal void
+CalcNURBS_Extracted_AVX512(v2 *Controls,
+                           f32 *Weights,
+                           b_spline_knot_params KnotParams,
+                           f32 *Knots,
+                           nurbs_bezier_extraction *Extraction,
+                           u32 SampleCount,
+                           f32 *Ts,
+                           v2 *OutSamples)
+{
+ if (Extraction->Extracted)
+ {
+  CalcNURBS_ExtractedLanes(16, NURBS_EvaluateExtractedAVX512);
+ }
+ else
+ {
+  // NOTE(hbr): There is no AVX512 Cox-de Boor, AVX512 implies AVX2 anyway
+  CalcNURBS_AVX2(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples);
+ }
+}
+
+struct calc_nurbs_work
+{
+ v2 *Controls;
+ f32 *Weights;
+ b_spline_knot_params KnotParams;
+ f32 *Knots;
+ nurbs_bezier_extraction *Extraction;
+ u32 SampleCount;
+ f32 *Ts;
+ v2 *OutSamples;
+};
+
+internal void
+CalcNURBS_Scalar_Work(void *UserData)
+{
+ calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
+ CalcNURBS_Scalar(Work->Controls,
+                  Work->Weights,
+                  Work->KnotParams,
+                  Work->Knots,
+                  Work->SampleCount,
+                  Work->Ts,
+                  Work->OutSamples);
+}
+
+internal void
+CalcNURBS_ScalarUsingBSplineEvaluate_Work(void *UserData)
+{
+ calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
+ CalcNURBS_ScalarUsingBSplineEvaluate(Work->Controls,
+                                      Work->Weights,
+                                      Work->KnotParams,
+                                      Work->Knots,
+                                      Work->SampleCount,
+                                      Work->Ts,
+                                      Work->OutSamples);
+}
+
+internal void
+CalcNURBS_ScalarButUsingSSE_Work(void *UserData)
+{
+ calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
+ CalcNURBS_ScalarButUsingSSE(Work->Controls,
+                             Work->Weights,
+                             Work->KnotParams,
+                             Work->Knots,
+                             Work->SampleCount,
+                             Work->Ts,
+                             Work->OutSamples);
+}
+
+internal void
+CalcNURBS_SSE_Work(void *UserData)
+{
+ calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
+ CalcNURBS_SSE(Work->Controls,
+               Work->Weights,
+               Work->KnotParams,
+               Work->Knots,
+               Work->SampleCount,
+               Work->Ts,
+               Work->OutSamples);
+}
+
+internal void
+CalcNURBS_AVX2_Work(void *UserData)
+{
+ calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
+ CalcNURBS_AVX2(Work->Controls,
+                Work->Weights,
+                Work->KnotParams,
+                Work->Knots,
+                Work->SampleCount,
+                Work->Ts,
+                Work->OutSamples);
+}
+
+internal void
+CalcNURBS_Extracted_Scalar_Work(void *UserData)
+{
+ calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
+ CalcNURBS_Extracted_Scalar(Work->Controls,
+                            Work->Weights,
+                            Work->KnotParams,
+                            Work->Knots,
+                            Work->Extraction,
+                            Work->SampleCount,
+                            Work->Ts,
+                            Work->OutSamples);
+}
+
+internal void
+CalcNURBS_Extracted_SSE_Work(void *UserData)
+{
+ calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
+ CalcNURBS_Extracted_SSE(Work->Controls,
+                         Work->Weights,
+                         Work->KnotParams,
+                         Work->Knots,
+                         Work->Extraction,
+                         Work->SampleCount,
+                         Work->Ts,
+                         Work->OutSamples);
+}
+
+internal void
+CalcNURBS_Extracted_AVX2_Work(void *UserData)
+{
+ calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
+ CalcNURBS_Extracted_AVX2(Work->Controls,
+                          Work->Weights,
+                          Work->KnotParams,
+                          Work->Knots,
+                          Work->Extraction,
+                          Work->SampleCount,
+                          Work->Ts,
+                          Work->OutSamples);
+}
+
+internal void
+CalcNURBS_Extracted_AVX512_Work(void *UserData)
+{
+ calc_nurbs_work *Work = Cast(calc_nurbs_work *)UserData;
+ CalcNURBS_Extracted_AVX512(Work->Controls,
+                            Work->Weights,
+                            Work->KnotParams,
+                            Work->Knots,
+                            Work->Extraction,
+                            Work->SampleCount,
+                            Work->Ts,
+                            Work->OutSamples);
+}
+
+struct calc_nurbs_parallel
+{
+ calc_nurbs_work Work;
+ work_queue_func *EvalWorkFunc;
+};
+
+internal void
+CalcNURBS_ParallelFor(void *UserData, u32 Begin, u32 End)
+{
+ calc_nurbs_parallel *Parallel = Cast(calc_nurbs_parallel *)UserData;
+ calc_nurbs_work Work = Parallel->Work;
+ Work.SampleCount = End - Begin;
+ Work.Ts += Begin;
+ Work.OutSamples += Begin;
+ Parallel->EvalWorkFunc(&Work);
+}
+
+internal void
+CalcNURBS_MultiThreaded(v2 *Controls,
+                        f32 *Weights,
+                        b_spline_knot_params KnotParams,
+                        f32 *Knots,
+                        nurbs_bezier_extraction *Extraction,
+                        u32 SampleCount,
+                        f32 *Ts,
+                        v2 *OutSamples,
+                        work_queue_func *CalcNURBS_Work,
+                        u32 Grain)
+{
+ calc_nurbs_parallel Parallel = {};
+ Parallel.Work.Controls = Controls;
+ Parallel.Work.Weights = Weights;
+ Parallel.Work.KnotParams = KnotParams;
+ Parallel.Work.Knots = Knots;
+ Parallel.Work.Extraction = Extraction;
+ Parallel.Work.Ts = Ts;
+ Parallel.Work.OutSamples = OutSamples;
+ Parallel.EvalWorkFunc = CalcNURBS_Work;
+ 
+ ParallelFor(SampleCount, Grain, CalcNURBS_ParallelFor, &Parallel);
+}
+
+global read_only curve_eval_kernel NURBS_EvalKernels[] = {
+ {CalcNURBS_ScalarUsingBSplineEvaluate_Work, false, 0},
+ {CalcNURBS_Scalar_Work, false, 0},
+ {CalcNURBS_ScalarButUsingSSE_Work, false, InstructionSet_SSE},
+ {CalcNURBS_SSE_Work, false, InstructionSet_SSE},
+ {CalcNURBS_AVX2_Work, false, InstructionSet_AVX2},
+ {CalcNURBS_SSE_Work, true, InstructionSet_SSE},
+ {CalcNURBS_AVX2_Work, true, InstructionSet_AVX2},
+ {0, true, 0}, // NOTE(hbr): Adaptive, resolved from calibration
+ {CalcNURBS_Extracted_Scalar_Work, false, 0},
+ {CalcNURBS_Extracted_SSE_Work, false, InstructionSet_SSE},
+ {CalcNURBS_Extracted_AVX2_Work, false, InstructionSet_AVX2},
+ {CalcNURBS_Extracted_AVX512_Work, false, InstructionSet_AVX512},
+ {CalcNURBS_Extracted_SSE_Work, true, InstructionSet_SSE},
+ {CalcNURBS_Extracted_AVX2_Work, true, InstructionSet_AVX2},
+ {CalcNURBS_Extracted_AVX512_Work, true, InstructionSet_AVX512},
+};
+StaticAssert(ArrayCount(NURBS_EvalKernels) == NURBS_Eval_Count, NURBS_EvalKernels_AllDefined);
+
+internal curve_eval_kernel
+NURBS_EvalKernel(nurbs_eval_method Method)
+{
+ curve_eval_calibration Calibration = CurrentCurveEvalCalibration();
+ curve_eval_kernel Kernel = ResolveCurveEvalKernel(NURBS_EvalKernels, Method, NURBS_Eval_Adaptive_MultiThreaded, Calibration.NURBS);
+ return Kernel;
+}
+
+internal void
+CalcNURBSWithKernel(v2 *Controls,
+                    f32 *Weights,
+                    b_spline_knot_params KnotParams,
+                    f32 *Knots,
+                    nurbs_bezier_extraction *Extraction,
+                    u32 SampleCount,
+                    f32 *Ts,
+                    v2 *OutSamples,
+                    curve_eval_kernel Kernel)
+{
+ if (Kernel.MultiThreaded)
+ {
+  CalcNURBS_MultiThreaded(Controls, Weights, KnotParams, Knots, Extraction, SampleCount, Ts, OutSamples, Kernel.EvalWorkFunc, Kernel.BlockSize);
+ }
+ else
+ {
+  calc_nurbs_work Work = {};
+  Work.Controls = Controls;
+  Work.Weights = Weights;
+  Work.KnotParams = KnotParams;
+  Work.Knots = Knots;
+  Work.Extraction = Extraction;
+  Work.SampleCount = SampleCount;
+  Work.Ts = Ts;
+  Work.OutSamples = OutSamples;
+  Kernel.EvalWorkFunc(&Work);
+ }
+}
+
+internal void
+CalcNURBS(v2 *Controls,
+          f32 *Weights,
+          b_spline_knot_params KnotParams,
+          f32 *Knots,
+          nurbs_bezier_extraction *Extraction,
+          u32 SampleCount,
+          f32 *Ts,
+          v2 *OutSamples)
+{
+ ProfileFunctionBegin();
+ 
+ curve_eval_kernel Kernel = NURBS_EvalKernel(DEBUG_Vars->NURBS_EvalMethod);
+ CalcNURBSWithKernel(Controls, Weights, KnotParams, Knots, Extraction, SampleCount, Ts, OutSamples, Kernel);
+ 
+ ProfileEnd();
+}
+
+struct curve_eval_calibration_input
+{
+ u32 PointCount;
+ v2 *Controls;
+ f32 *Weights;
+ f32 *Xs;
+ f32 *Ys;
+ f32 *Ti;
+ f32 *Mx;
+ f32 *My;
+ b_spline_knot_params KnotParams;
+ f32 *Knots;
+ nurbs_bezier_extraction NURBS_Extraction;
+ polynomial_eval_input Polynomial;
+ 
+ u32 SampleCount;
+ f32 *Ts;
+ v2 *OutSamples;
+};
+typedef void curve_eval_calibration_func(curve_eval_calibration_input *Input, curve_eval_kernel Kernel);
+
+internal void
+CalibrationEval_Bezier(curve_eval_calibration_input *Input, curve_eval_kernel Kernel)
+{
+ CalcBezierRationalWithKernel(Input->Controls, Input->Weights, Input->PointCount,
+                              Input->SampleCount, Input->Ts, Input->OutSamples, Kernel);
+}
+
+internal void
+CalibrationEval_NURBS(curve_eval_calibration_input *Input, curve_eval_kernel Kernel)
+{
+ CalcNURBSWithKernel(Input->Controls, Input->Weights, Input->KnotParams, Input->Knots, &Input->NURBS_Extraction,
+                     Input->SampleCount, Input->Ts, Input->OutSamples, Kernel);
+}
+
+internal void
+CalibrationEval_Polynomial(curve_eval_calibration_input *Input, curve_eval_kernel Kernel)
+{
+ CalcPolynomialWithKernel(&Input->Polynomial, Input->SampleCount, Input->Ts, Input->OutSamples, Kernel);
+}
+
+internal void
+CalibrationEval_CubicSpline(curve_eval_calibration_input *Input, curve_eval_kernel Kernel)
+{
+ CalcCubicSplineWithKernel(Input->Xs, Input->Ys, Input->PointCount, Input->Ti, Input->Mx, Input->My,
+                           Input->SampleCount, Input->Ts, Input->OutSamples, Kernel);
+}
+
+internal curve_eval_calibration_input
+MakeCurveEvalCalibrationInput(arena *Arena, u32 PointCount, u32 MaxSampleCount, f32 MinT, f32 MaxT)
+{
+ curve_eval_calibration_input Input = {};
+ Input.PointCount = PointCount;
+ Input.Controls = PushArrayNonZero(Arena, PointCount, v2);
+ Input.Weights = PushArrayNonZero(Arena, PointCount, f32);
+ Input.Xs = PushArrayNonZero(Arena, PointCount, f32);
+ Input.Ys = PushArrayNonZero(Arena, PointCount, f32);
+ Input.Ti = PushArrayNonZero(Arena, PointCount, f32);
+ Input.Mx = PushArray(Arena, PointCount, f32);
+ Input.My = PushArray(Arena, PointCount, f32);
+ ForEachIndex(PointIndex, PointCount)
+ {
+  f32 Fraction = Cast(f32)PointIndex / (PointCount - 1);
+  f32 Angle = 2*PiF32 * Fraction;
+  v2 P = V2(CosF32(Angle), SinF32(Angle));
+  Input.Controls[PointIndex] = P;
+  Input.Weights[PointIndex] = 1.0f + 0.5f * (PointIndex & 1);
+  Input.Xs[PointIndex] = P.X;
+  Input.Ys[PointIndex] = P.Y;
+  Input.Ti[PointIndex] = Lerp(MinT, MaxT, Fraction);
+ }
+ 
+ Input.SampleCount = MaxSampleCount;
+ Input.Ts = PushArrayNonZero(Arena, MaxSampleCount, f32);
+ Input.OutSamples = PushArrayNonZero(Arena, MaxSampleCount, v2);
+ ForEachIndex(SampleIndex, MaxSampleCount)
+ {
+  Input.Ts[SampleIndex] = Lerp(MinT, MaxT, Cast(f32)SampleIndex / (MaxSampleCount - 1));
+ }
+ 
+ return Input;
+}
+
+internal u64
+MeasureCurveEvalKernel(curve_eval_calibration_func *Eval, curve_eval_calibration_input *Input,
+                       curve_eval_kernel Kernel, u32 SampleCount)
+{
+ u32 MaxSampleCount = Input->SampleCount;
+ Input->SampleCount = SampleCount;
+ 
+ // NOTE(hbr): One warmup run, then take the best out of a few, to filter out noise
+ // from other processes and from page faults on the first touch of OutSamples.
+ Eval(Input, Kernel);
+ u64 BestTSC = U64_MAX;
+ ForEachIndex(RepeatIndex, 3)
+ {
+  u64 BeginTSC = OS_ReadCPUTimer();
+  Eval(Input, Kernel);
+  u64 ElapsedTSC = OS_ReadCPUTimer() - BeginTSC;
+  BestTSC = Min(BestTSC, ElapsedTSC);
+ }
+ 
+ Input->SampleCount = MaxSampleCount;
+ 
+ return BestTSC;
+}
+
+internal curve_eval_tuning
+CalibrateCurveEvalKernels(curve_eval_calibration_func *Eval, curve_eval_calibration_input *Input,
+                          curve_eval_kernel const *Kernels, u32 KernelCount, curve_eval_tuning Default)
+{
+ curve_eval_tuning Result = Default;
+ instruction_set_flags Flags = Platform.InstructionSetSupport();
+ 
+ // NOTE(hbr): Pick the fastest kernel first, single-threaded, so that thread scheduling
+ // doesn't affect the choice.
+ u64 BestTSC = U64_MAX;
+ ForEachIndex(Method, KernelCount)
+ {
+  curve_eval_kernel Kernel = Kernels[Method];
+  // NOTE(hbr): Approximate kernels trade accuracy for speed, so they have to be chosen
+  // explicitly, never by calibration.
+  if (Kernel.EvalWorkFunc && !Kernel.MultiThreaded && !Kernel.Approximate &&
+      IsCurveEvalKernelSupported(Kernel, Flags))
+  {
+   u64 TSC = MeasureCurveEvalKernel(Eval, Input, Kernel, 2048);
+   if (TSC < BestTSC)
+   {
+    BestTSC = TSC;
+    Result.Method = Cast(u32)Method;
+   }
+  }
+ }
+ 
+ // NOTE(hbr): Then find the block size for that kernel when spread across work queue.
+ // Too small and queue overhead dominates, too big and threads starve at the end.
+ curve_eval_kernel Kernel = Kernels[Result.Method];
+ Kernel.MultiThreaded = true;
+ u32 BlockSizes[] = {32, 64, 128, 256, 512, 1024, 2048};
+ BestTSC = U64_MAX;
+ ForEachElement(BlockSizeIndex, BlockSizes)
+ {
+  Kernel.BlockSize = BlockSizes[BlockSizeIndex];
+  u64 TSC = MeasureCurveEvalKernel(Eval, Input, Kernel, Input->SampleCount);
+  if (TSC < BestTSC)
+  {
+   BestTSC = TSC;
+   Result.BlockSize = Kernel.BlockSize;
+  }
+ }
+ 
+ return Result;
+}
+
+internal void
+CalibrateCurveEvaluation(curve_eval_calibration *Calibration)
+{
+ ProfileFunctionBegin();
+ 
+ temp_arena Temp = TempArena(0);
+ curve_eval_calibration Default = DefaultCurveEvalCalibration();
+ u32 SampleCount = 16384;
+ 
+ {
+  curve_eval_calibration_input Input = MakeCurveEvalCalibrationInput(Temp.Arena, 32, SampleCount, 0.0f, 1.0f);
+  Calibration->Bezier = CalibrateCurveEvalKernels(CalibrationEval_Bezier, &Input, BezierRationalEvalKernels, Bezier_Eval_Count, Default.Bezier);
+ }
+ 
+ {
+  curve_eval_calibration_input Input = MakeCurveEvalCalibrationInput(Temp.Arena, 64, SampleCount, 0.0f, 1.0f);
+  Calibration->CubicSpline = CalibrateCurveEvalKernels(CalibrationEval_CubicSpline, &Input, CubicSplineEvalKernels, CubicSpline_Eval_Count, Default.CubicSpline);
+ }
+ 
+ {
+  b_spline_knot_params KnotParams = BSplineKnotParamsFromDegree(3, 64);
+  curve_eval_calibration_input Input = MakeCurveEvalCalibrationInput(Temp.Arena, 64, SampleCount, KnotParams.A, KnotParams.B);
+  Input.KnotParams = KnotParams;
+  Input.Knots = PushArrayNonZero(Temp.Arena, KnotParams.KnotCount, f32);
+  BSplineBaseKnots(KnotParams, Input.Knots);
+  BSplineKnotsNaturalExtension(KnotParams, Input.Knots);
+  Input.NURBS_Extraction = NURBS_BezierExtraction(Temp.Arena, Input.Controls, Input.Weights, KnotParams, Input.Knots);
+  Calibration->NURBS = CalibrateCurveEvalKernels(CalibrationEval_NURBS, &Input, NURBS_EvalKernels, NURBS_Eval_Count, Default.NURBS);
+ }
+ 
+ {
+  // NOTE(hbr): Calibrate barycentric form only, it is the one used for high degree
+  // Chebyshev interpolants and Newton form has the same O(n) per sample cost.
+  polynomial_interpolation_params Params = {PolynomialInterpolation_Barycentric, PointSpacing_Chebychev};
+  curve_eval_calibration_input Input = MakeCurveEvalCalibrationInput(Temp.Arena, 32, SampleCount, -1.0f, 1.0f);
+  Input.Polynomial = MakePolynomialEvalInput(Temp.Arena, Input.Controls, Input.PointCount, Params);
+  Calibration->Polynomial = CalibrateCurveEvalKernels(CalibrationEval_Polynomial, &Input, PolynomialEvalKernels, Polynomial_Eval_Count, Default.Polynomial);
+ }
+ 
+ Calibration->Calibrated = true;
+ 
+ EndTemp(Temp);
+ 
+ ProfileEnd();
+}
+
+internal void
+CalcParametricCurveField(arena *Arena,
+                         parametric_curve_field *Field,
+                         b32 IsVar,
+                         u32 VarCount,
+                         string *VarNames,
+                         f32 *VarValues)
+{
+ StructZero(&Field->Cached);
+ 
+ string Equation = StringFromStringId(GetCtx()->StrStore, Field->Equation);
+ 
+ if (IsVar)
+ {
+  if (Field->EquationOrDragFloatMode_Equation)
+  {
+   parametric_equation_eval_result Eval = ParametricEquationEval(Arena, Equation, VarCount, VarNames, VarValues);
+   Field->Cached.EvalValue = Eval.Value;
+   Field->Cached.EvalFail = Eval.Fail;
+   Field->Cached.EvalErrorMessage = Eval.ErrorMessage;
+  }
+ }
+ else
+ {
+  parametric_equation_parse_result Parse = ParametricEquationParse(Arena, Equation, VarCount, VarNames, VarValues);
+  Field->Cached.EvalExpr = Parse.ParsedExpr;
+  Field->Cached.EvalFail = Parse.Fail;
+  Field->Cached.EvalErrorMessage = Parse.ErrorMessage;
+ }
+}
+
+internal f32
+ParametricCurveVarValue(parametric_curve_field *Var)
+{
+ f32 Value = 0;
+ if (Var->EquationOrDragFloatMode_Equation)
+ {
+  Value = Var->Cached.EvalValue;
+ }
+ else
+ {
+  Value = Var->DragValue;
+ }
+ return Value;
+}
+
+internal void
+CalcParametric_SingleThreaded(parametric_equation_expr *X_Expr,
+                              parametric_equation_expr *Y_Expr,
+                              u32 SampleCount,
+                              f32 *Ts,
+                              v2 *OutSamples)
+{
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  f32 T = Ts[SampleIndex];
+  
+  f32 X = ParametricEquationEvalWithT(X_Expr, T);
+  f32 Y = ParametricEquationEvalWithT(Y_Expr, T);
+  
+  OutSamples[SampleIndex] = V2(X, Y);
+ }
+}
+
+struct calc_parametric_work
+{
+ parametric_equation_expr *X_Expr;
+ parametric_equation_expr *Y_Expr;
+ f32 *Ts;
+ v2 *OutSamples;
+};
+
+internal void
+CalcParametric_ParallelFor(void *UserData, u32 Begin, u32 End)
+{
+ calc_parametric_work *Work = Cast(calc_parametric_work *)UserData;
+ CalcParametric_SingleThreaded(Work->X_Expr, Work->Y_Expr, End - Begin, Work->Ts + Begin, Work->OutSamples + Begin);
+}
+
+internal void
+CalcParametric_MultiThreaded(parametric_equation_expr *X_Expr,
+                             parametric_equation_expr *Y_Expr,
+                             u32 SampleCount,
+                             f32 *Ts,
+                             v2 *OutSamples)
+{
+ ProfileFunctionBegin();
+ 
+ calc_parametric_work Work = {};
+ Work.X_Expr = X_Expr;
+ Work.Y_Expr = Y_Expr;
+ Work.Ts = Ts;
+ Work.OutSamples = OutSamples;
+ 
+ // NOTE(hbr): Expression cost per sample isn't calibrated, let the queue pick the grain
+ ParallelFor(SampleCount, 0, CalcParametric_ParallelFor, &Work);
+ 
+ ProfileEnd();
+}
+
+struct parametric_eval_input
+{
+ parametric_equation_expr *X_Expr;
+ parametric_equation_expr *Y_Expr;
+ f32 MinT;
+ f32 MaxT;
+};
+
+internal parametric_eval_input
+MakeParametricEvalInput(arena *Arena, parametric_curve_resources *Parametric)
+{
+ parametric_eval_input Input = {};
+ 
+ temp_arena Temp = TempArena(Arena);
+ 
+ u32 MaxVarCount = ArrayCount(Parametric->AdditionalVars);
+ u32 VarCount = 0;
+ string *VarNames = PushArray(Temp.Arena, MaxVarCount, string);
+ f32 *VarValues = PushArray(Temp.Arena, MaxVarCount, f32);
+ 
+ ForEachElement(AdditionalVarIndex, Parametric->AdditionalVars)
+ {
+  parametric_curve_field *Var = Parametric->AdditionalVars + AdditionalVarIndex;
+  if (IsParametricCurveVarActive(Var))
+  {
+   string VarName = StringFromStringId(Var->VarName);
+   CalcParametricCurveField(Arena, Var, true, VarCount, VarNames, VarValues);
+   f32 VarValue = ParametricCurveVarValue(Var);
+   
+   Assert(VarCount < MaxVarCount);
+   VarNames[VarCount] = VarName;
+   VarValues[VarCount] = VarValue;
+   ++VarCount;
+  }
+ }
+ 
+ CalcParametricCurveField(Arena, &Parametric->X_Equation, false, VarCount, VarNames, VarValues);
+ CalcParametricCurveField(Arena, &Parametric->Y_Equation, false, VarCount, VarNames, VarValues);
+ 
+ Input.X_Expr = Parametric->X_Equation.Cached.EvalExpr;
+ Input.Y_Expr = Parametric->Y_Equation.Cached.EvalExpr;
+ 
+ CalcParametricCurveField(Arena, &Parametric->MinT_Var, true, VarCount, VarNames, VarValues);
+ CalcParametricCurveField(Arena, &Parametric->MaxT_Var, true, VarCount, VarNames, VarValues);
+ 
+ Input.MinT = ParametricCurveVarValue(&Parametric->MinT_Var);
+ Input.MaxT = ParametricCurveVarValue(&Parametric->MaxT_Var);
+ // NOTE(hbr): Adjust for safety
+ Input.MaxT = Max(Input.MinT, Input.MaxT);
+ 
+ EndTemp(Temp);
+ 
+ return Input;
+}
+
+internal void
+CalcParametric(arena *Arena,
+               parametric_curve_resources *Parametric,
+               u32 SampleCount, v2 *OutSamples)
+{
+ ProfileFunctionBegin();
+ 
+ parametric_eval_input Input = MakeParametricEvalInput(Arena, Parametric);
+ parametric_equation_expr *X_Expr = Input.X_Expr;
+ parametric_equation_expr *Y_Expr = Input.Y_Expr;
+ 
+ temp_arena Temp = TempArena(Arena);
+ 
+ f32 T = Input.MinT;
+ f32 DeltaT = (Input.MaxT - Input.MinT) / (SampleCount - 1);
+ f32 *Ts = PushArrayNonZero(Temp.Arena, SampleCount, f32);
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  Ts[SampleIndex] = T;
+  T += DeltaT;
+ }
+ 
+ switch (DEBUG_Vars->Parametric_EvalMethod)
+ {
+  case Parametric_Eval_SingleThreaded: {
+   CalcParametric_SingleThreaded(X_Expr, Y_Expr, SampleCount, Ts, OutSamples);
+  }break;
+  
+  case Parametric_Eval_MultiThreaded: {
+   CalcParametric_MultiThreaded(X_Expr, Y_Expr, SampleCount, Ts, OutSamples);
+  }break;
+  
+  case Parametric_Eval_Count: InvalidPath;
+ }
+ 
+ EndTemp(Temp);
+ 
+ ProfileEnd();
+}
+
+internal nurbs_bezier_extraction *
+MaybeRecomputeCurveNURBS_Extraction(curve *Curve, b_spline_knot_params KnotParams)
+{
+ curve_points *Points = GetCurvePoints(Curve);
+ u32 ControlCount = Points->ControlPointCount;
+ curve_nurbs_extraction_cache *Cache = &Curve->NURBS_Extraction;
+ 
+ b32 Changed = (!StructsEqual(&Cache->KnotParams, &KnotParams) ||
+                Cache->ControlCount != ControlCount ||
+                !MemoryEqual(Cache->Controls, Points->ControlPoints, ControlCount * SizeOf(Cache->Controls[0])) ||
+                !MemoryEqual(Cache->Weights, Points->ControlPointWeights, ControlCount * SizeOf(Cache->Weights[0])) ||
+                !MemoryEqual(Cache->Knots, Points->BSplineKnots, KnotParams.KnotCount * SizeOf(Cache->Knots[0])));
+ if (Changed)
+ {
+  ProfileBlock("NURBS Bezier Extraction")
+  {
+   arena *Arena = CurveCacheArena(&Cache->Arena);
+   ClearArena(Arena);
+   
+   Cache->KnotParams = KnotParams;
+   Cache->ControlCount = ControlCount;
+   Cache->Controls = PushArrayNonZero(Arena, ControlCount, v2);
+   Cache->Weights = PushArrayNonZero(Arena, ControlCount, f32);
+   Cache->Knots = PushArrayNonZero(Arena, KnotParams.KnotCount, f32);
+   ArrayCopy(Cache->Controls, Points->ControlPoints, ControlCount);
+   ArrayCopy(Cache->Weights, Points->ControlPointWeights, ControlCount);
+   ArrayCopy(Cache->Knots, Points->BSplineKnots, KnotParams.KnotCount);
+   
+   Cache->Extraction = NURBS_BezierExtraction(Arena, Cache->Controls, Cache->Weights, KnotParams, Cache->Knots);
+  }
+ }
+ 
+ return &Cache->Extraction;
+}
+
+internal nurbs_bezier_extraction *
+PrepareCurveNURBS(curve *Curve, b_spline_knot_params *OutKnotParams)
+{
+ curve_points *Points = GetCurvePoints(Curve);
+ 
+ MaybeRecomputeCurveBSplineKnots(Curve, false);
+ 
+ b_spline_knot_params KnotParams = GetBSplineParams(Curve).KnotParams;
+ f32 *BSplineKnots = Points->BSplineKnots;
+ u32 PartitionSize = KnotParams.PartitionSize;
+ Points->BSplineKnotCount = KnotParams.KnotCount;
+ nurbs_bezier_extraction *Extraction = MaybeRecomputeCurveNURBS_Extraction(Curve, KnotParams);
+ 
+ v2 *PartitionKnots = PushArrayNonZero(Curve->ComputeArena, PartitionSize, v2);
+ CalcNURBS(Points->ControlPoints,
+           Points->ControlPointWeights,
+           KnotParams,
+           BSplineKnots,
+           Extraction,
+           PartitionSize,
+           BSplineKnots + KnotParams.Degree,
+           PartitionKnots);
+ 
+ Curve->BSplinePartitionKnotCount = PartitionSize;
+ Curve->BSplinePartitionKnots = PartitionKnots;
+ *OutKnotParams = KnotParams;
+ 
+ return Extraction;
+}
+
+//- adaptive sampling
+#define CurveAdaptiveSamplingInitialSamplesPerSegment 4
+#define CurveAdaptiveSamplingParametricSegmentCount 64
+#define CurveAdaptiveSamplingMaxDepth 16
+#define CurveAdaptiveSamplingMaxSampleCount (1u << 18)
+
+// NOTE(hbr): Everything needed to evaluate curve at arbitrary Ts, in curve's native parameter.
+// Breaks are natural segment boundaries (nodes, knots, Bezier joints). They are always
+// sampled, so that subdivision can't skip over a segment that happens to have its
+// initial samples collinear.
+struct curve_sampler
+{
+ curve_type Type;
+ bezier_type Bezier;
+ curve_eval_kernel Kernel;
+ 
+ u32 PointCount;
+ v2 *Controls;
+ f32 *Weights;
+ cubic_bezier_point *Beziers;
+ polynomial_eval_input Polynomial;
+ cubic_spline_eval_input CubicSpline;
+ b_spline_knot_params KnotParams;
+ f32 *Knots;
+ nurbs_bezier_extraction *Extraction;
+ parametric_eval_input Parametric;
+ 
+ u32 BreakCount;
+ f32 *Breaks;
+};
+
+internal void
+CalcBezierCubicSplineAtTs(cubic_bezier_point *Beziers, u32 PointCount,
+                          u32 SampleCount, f32 *Ts, v2 *OutSamples)
+{
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  f32 Expanded_T = (PointCount - 1) * Ts[SampleIndex];
+  u32 SegmentIndex = Cast(u32)Expanded_T;
+  // NOTE(hbr): T == 1 lands exactly on the last point, evaluate it as the end of the last segment
+  SegmentIndex = Min(SegmentIndex, PointCount - 2);
+  f32 Segment_T = Expanded_T - SegmentIndex;
+  cubic_bezier_curve_segment Segment = GetCubicBezierCurveSegment(Beziers, PointCount, SegmentIndex);
+  OutSamples[SampleIndex] = BezierCurveEvaluate(Segment_T, Segment.Points, Segment.PointCount);
+ }
+}
+
+internal void
+EvalCurveSampler(curve_sampler *Sampler, u32 SampleCount, f32 *Ts, v2 *OutSamples)
+{
+ curve_eval_kernel Kernel = Sampler->Kernel;
+ switch (Sampler->Type)
+ {
+  case Curve_Polynomial: {CalcPolynomialWithKernel(&Sampler->Polynomial, SampleCount, Ts, OutSamples, Kernel);}break;
+  
+  case Curve_CubicSpline: {
+   cubic_spline_eval_input *Spl = &Sampler->CubicSpline;
+   CalcCubicSplineWithKernel(Spl->Xs, Spl->Ys, Spl->PointCount, Spl->Ti, Spl->Mx, Spl->My, SampleCount, Ts, OutSamples, Kernel);
+  }break;
+  
+  case Curve_Bezier: {
+   switch (Sampler->Bezier)
+   {
+    case Bezier_Rational: {CalcBezierRationalWithKernel(Sampler->Controls, Sampler->Weights, Sampler->PointCount, SampleCount, Ts, OutSamples, Kernel);}break;
+    case Bezier_CubicSpline: {CalcBezierCubicSplineAtTs(Sampler->Beziers, Sampler->PointCount, SampleCount, Ts, OutSamples);}break;
+    case Bezier_Count: InvalidPath;
+   }
+  }break;
+  
+  case Curve_NURBS: {
+   CalcNURBSWithKernel(Sampler->Controls, Sampler->Weights, Sampler->KnotParams, Sampler->Knots, Sampler->Extraction,
+                       SampleCount, Ts, OutSamples, Kernel);
+  }break;
+  
+  case Curve_Parametric: {CalcParametric_SingleThreaded(Sampler->Parametric.X_Expr, Sampler->Parametric.Y_Expr, SampleCount, Ts, OutSamples);}break;
+  
+  case Curve_Count: InvalidPath;
+ }
+}
+
+internal curve_sampler
+MakeCurveSampler(arena *Arena, curve *Curve)
+{
+ curve_sampler Sampler = {};
+ 
+ curve_points *Points = GetCurvePoints(Curve);
+ curve_params *Params = &Curve->Params;
+ u32 PointCount = Points->ControlPointCount;
+ 
+ Sampler.Type = Params->Type;
+ Sampler.Bezier = Params->Bezier;
+ Sampler.PointCount = PointCount;
+ Sampler.Controls = Points->ControlPoints;
+ Sampler.Weights = Points->ControlPointWeights;
+ Sampler.Beziers = Points->CubicBezierPoints;
+ 
+ // NOTE(hbr): Every work entry of the subdivision evaluates its own batch of midpoints,
+ // so kernels run single-threaded. Approximate kernels (forward differencing) assume
+ // evenly spaced Ts, fall back to the calibrated one.
+ curve_eval_kernel Kernel = {};
+ switch (Params->Type)
+ {
+  case Curve_Polynomial: {
+   Kernel = PolynomialEvalKernel(DEBUG_Vars->Polynomial_EvalMethod);
+   if (PointCount > 0)
+   {
+    Sampler.Polynomial = MakePolynomialEvalInput(Arena, Points->ControlPoints, PointCount, Params->Polynomial);
+    Sampler.BreakCount = PointCount;
+    Sampler.Breaks = Sampler.Polynomial.Ti;
+   }
+  }break;
+  
+  case Curve_CubicSpline: {
+   Kernel = CubicSplineEvalKernel(DEBUG_Vars->CubicSpline_EvalMethod);
+   if (PointCount > 0)
+   {
+    Sampler.CubicSpline = MakeCubicSplineEvalInput(Arena, Points->ControlPoints, PointCount, Params->CubicSpline);
+    Sampler.BreakCount = Sampler.CubicSpline.PointCount;
+    Sampler.Breaks = Sampler.CubicSpline.Ti;
+   }
+  }break;
+  
+  case Curve_Bezier: {
+   Kernel = BezierRationalPrecisionEvalKernel(Params->BezierPrecision);
+   if (Kernel.Approximate)
+   {
+    Kernel = BezierRationalEvalKernel(Bezier_Eval_Adaptive_MultiThreaded);
+   }
+   if (PointCount > 0)
+   {
+    Sampler.BreakCount = PointCount;
+    Sampler.Breaks = PushArrayNonZero(Arena, PointCount, f32);
+    EquidistantPoints(Sampler.Breaks, PointCount, 0.0f, 1.0f);
+   }
+  }break;
+  
+  case Curve_NURBS: {
+   Kernel = NURBS_EvalKernel(DEBUG_Vars->NURBS_EvalMethod);
+   b_spline_knot_params KnotParams = {};
+   Sampler.Extraction = PrepareCurveNURBS(Curve, &KnotParams);
+   Sampler.KnotParams = KnotParams;
+   Sampler.Knots = Points->BSplineKnots;
+   Sampler.BreakCount = KnotParams.PartitionSize;
+   Sampler.Breaks = Points->BSplineKnots + KnotParams.Degree;
+  }break;
+  
+  case Curve_Parametric: {
+   Sampler.Parametric = MakeParametricEvalInput(Curve->ComputeArena, &Curve->ParametricResources);
+   Sampler.BreakCount = CurveAdaptiveSamplingParametricSegmentCount + 1;
+   Sampler.Breaks = PushArrayNonZero(Arena, Sampler.BreakCount, f32);
+   EquidistantPoints(Sampler.Breaks, Sampler.BreakCount, Sampler.Parametric.MinT, Sampler.Parametric.MaxT);
+  }break;
+  
+  case Curve_Count: InvalidPath;
+ }
+ Kernel.MultiThreaded = false;
+ Sampler.Kernel = Kernel;
+ 
+ return Sampler;
+}
+
+struct curve_adaptive_sampling_work
+{
+ curve_sampler *Sampler;
+ f32 ToleranceSquared;
+ u32 Count;
+ // NOTE(hbr): When Intervals is null, just evaluate Ts into Samples. Otherwise
+ // evaluate midpoints of [Ts[I], Ts[I+1]] for every interval I and decide whether to split it.
+ u32 *Intervals;
+ f32 *Ts;
+ v2 *Samples;
+ f32 *MidTs;
+ v2 *MidSamples;
+ b32 *Split;
+};
+
+internal void
+CurveAdaptiveSampling_Work(void *UserData)
+{
+ curve_adaptive_sampling_work *Work = Cast(curve_adaptive_sampling_work *)UserData;
+ if (Work->Intervals)
+ {
+  ForEachIndex(Index, Work->Count)
+  {
+   u32 I = Work->Intervals[Index];
+   Work->MidTs[Index] = 0.5f * (Work->Ts[I] + Work->Ts[I + 1]);
+  }
+  
+  EvalCurveSampler(Work->Sampler, Work->Count, Work->MidTs, Work->MidSamples);
+  
+  ForEachIndex(Index, Work->Count)
+  {
+   u32 I = Work->Intervals[Index];
+   f32 MidT = Work->MidTs[Index];
+   f32 ErrorSquared = PointSegmentDistanceSquared(Work->MidSamples[Index], Work->Samples[I], Work->Samples[I + 1]);
+   // NOTE(hbr): Stop at f32 resolution of T, there is nothing more to subdivide
+   b32 Representable = (MidT != Work->Ts[I] && MidT != Work->Ts[I + 1]);
+   Work->Split[Index] = (Representable && ErrorSquared > Work->ToleranceSquared);
+  }
+ }
+ else
+ {
+  EvalCurveSampler(Work->Sampler, Work->Count, Work->Ts, Work->Samples);
+ }
+}
+
+internal u32
+CurveSamplerBlockSize(curve_sampler *Sampler)
+{
+ curve_eval_calibration Calibration = CurrentCurveEvalCalibration();
+ u32 BlockSize = 256;
+ switch (Sampler->Type)
+ {
+  case Curve_Polynomial: {BlockSize = Calibration.Polynomial.BlockSize;}break;
+  case Curve_CubicSpline: {BlockSize = Calibration.CubicSpline.BlockSize;}break;
+  case Curve_Bezier: {BlockSize = Calibration.Bezier.BlockSize;}break;
+  case Curve_NURBS: {BlockSize = Calibration.NURBS.BlockSize;}break;
+  case Curve_Parametric: {}break;
+  case Curve_Count: InvalidPath;
+ }
+ BlockSize = Max(BlockSize, 1u);
+ 
+ return BlockSize;
+}
+
+internal void
+CurveAdaptiveSampling_ParallelFor(void *UserData, u32 Begin, u32 End)
+{
+ curve_adaptive_sampling_work *Template = Cast(curve_adaptive_sampling_work *)UserData;
+ curve_adaptive_sampling_work Work = *Template;
+ Work.Count = End - Begin;
+ if (Template->Intervals)
+ {
+  Work.Intervals = Template->Intervals + Begin;
+  Work.MidTs = Template->MidTs + Begin;
+  Work.MidSamples = Template->MidSamples + Begin;
+  Work.Split = Template->Split + Begin;
+ }
+ else
+ {
+  Work.Ts = Template->Ts + Begin;
+  Work.Samples = Template->Samples + Begin;
+ }
+ CurveAdaptiveSampling_Work(&Work);
+}
+
+internal void
+CurveAdaptiveSampling_MultiThreaded(curve_adaptive_sampling_work Template, u32 Count)
+{
+ // NOTE(hbr): Midpoint evaluation costs the same as regular evaluation, reuse its block size
+ u32 Grain = CurveSamplerBlockSize(Template.Sampler);
+ ParallelFor(Count, Grain, CurveAdaptiveSampling_ParallelFor, &Template);
+}
+
+struct curve_adaptive_samples
+{
+ u32 SampleCount;
+ v2 *Samples;
+ f32 *Ts;
+ u32 SegmentCount;
+ u32 *SegmentSampleIndices;
+};
+
+// NOTE(hbr): Start with a few samples per segment, then split every interval whose
+// midpoint is further than Tolerance from the chord, level by level. Every level
+// evaluates all of its midpoints at once, spread across work queue.
+internal curve_adaptive_samples
+CalcCurveAdaptive(arena *Arena, curve *Curve, f32 Tolerance)
+{
+ ProfileFunctionBegin();
+ 
+ curve_adaptive_samples Result = {};
+ temp_arena Temp = TempArena(Arena);
+ 
+ curve_sampler Sampler = MakeCurveSampler(Temp.Arena, Curve);
+ u32 BreakCount = Sampler.BreakCount;
+ u32 SegmentCount = (BreakCount > 0 ? BreakCount - 1 : 0);
+ 
+ u32 SampleCount = 0;
+ f32 *Ts = 0;
+ v2 *Samples = 0;
+ u32 *SegmentSampleIndices = PushArrayNonZero(Temp.Arena, SegmentCount, u32);
+ if (BreakCount > 0)
+ {
+  u32 PerSegment = CurveAdaptiveSamplingInitialSamplesPerSegment;
+  SampleCount = SegmentCount * PerSegment + 1;
+  Ts = PushArrayNonZero(Temp.Arena, SampleCount, f32);
+  Samples = PushArrayNonZero(Temp.Arena, SampleCount, v2);
+  ForEachIndex(SegmentIndex, SegmentCount)
+  {
+   f32 A = Sampler.Breaks[SegmentIndex];
+   f32 B = Sampler.Breaks[SegmentIndex + 1];
+   SegmentSampleIndices[SegmentIndex] = Cast(u32)SegmentIndex * PerSegment;
+   ForEachIndex(Index, PerSegment)
+   {
+    Ts[SegmentIndex * PerSegment + Index] = Lerp(A, B, Cast(f32)Index / PerSegment);
+   }
+  }
+  Ts[SampleCount - 1] = Sampler.Breaks[BreakCount - 1];
+  
+  curve_adaptive_sampling_work Work = {};
+  Work.Sampler = &Sampler;
+  Work.Ts = Ts;
+  Work.Samples = Samples;
+  CurveAdaptiveSampling_MultiThreaded(Work, SampleCount);
+ }
+ 
+ u32 IntervalCount = (SampleCount > 0 ? SampleCount - 1 : 0);
+ u32 *Intervals = PushArrayNonZero(Temp.Arena, IntervalCount, u32);
+ ForEachIndex(IntervalIndex, IntervalCount)
+ {
+  Intervals[IntervalIndex] = Cast(u32)IntervalIndex;
+ }
+ 
+ f32 ToleranceSquared = Sqr(Max(Tolerance, 0.0f));
+ for (u32 Depth = 0;
+      Depth < CurveAdaptiveSamplingMaxDepth && IntervalCount > 0;
+      ++Depth)
+ {
+  f32 *MidTs = PushArrayNonZero(Temp.Arena, IntervalCount, f32);
+  v2 *MidSamples = PushArrayNonZero(Temp.Arena, IntervalCount, v2);
+  b32 *Split = PushArrayNonZero(Temp.Arena, IntervalCount, b32);
+  
+  curve_adaptive_sampling_work Work = {};
+  Work.Sampler = &Sampler;
+  Work.ToleranceSquared = ToleranceSquared;
+  Work.Intervals = Intervals;
+  Work.Ts = Ts;
+  Work.Samples = Samples;
+  Work.MidTs = MidTs;
+  Work.MidSamples = MidSamples;
+  Work.Split = Split;
+  CurveAdaptiveSampling_MultiThreaded(Work, IntervalCount);
+  
+  u32 SplitCount = 0;
+  ForEachIndex(IntervalIndex, IntervalCount)
+  {
+   SplitCount += (Split[IntervalIndex] ? 1 : 0);
+  }
+  if (SplitCount == 0 || SampleCount + SplitCount > CurveAdaptiveSamplingMaxSampleCount)
+  {
+   break;
+  }
+  
+  // NOTE(hbr): Merge midpoints in. Intervals are sorted, so it is a single pass.
+  u32 NewSampleCount = SampleCount + SplitCount;
+  f32 *NewTs = PushArrayNonZero(Temp.Arena, NewSampleCount, f32);
+  v2 *NewSamples = PushArrayNonZero(Temp.Arena, NewSampleCount, v2);
+  u32 *NewIntervals = PushArrayNonZero(Temp.Arena, 2 * SplitCount, u32);
+  u32 NewIntervalCount = 0;
+  u32 NewIndex = 0;
+  u32 IntervalIndex = 0;
+  u32 SegmentIndex = 0;
+  ForEachIndex(SampleIndex, SampleCount)
+  {
+   while (SegmentIndex < SegmentCount && SegmentSampleIndices[SegmentIndex] == SampleIndex)
+   {
+    SegmentSampleIndices[SegmentIndex++] = NewIndex;
+   }
+   
+   NewTs[NewIndex] = Ts[SampleIndex];
+   NewSamples[NewIndex] = Samples[SampleIndex];
+   ++NewIndex;
+   
+   if (IntervalIndex < IntervalCount && Intervals[IntervalIndex] == SampleIndex)
+   {
+    if (Split[IntervalIndex])
+    {
+     NewIntervals[NewIntervalCount++] = NewIndex - 1;
+     NewIntervals[NewIntervalCount++] = NewIndex;
+     NewTs[NewIndex] = MidTs[IntervalIndex];
+     NewSamples[NewIndex] = MidSamples[IntervalIndex];
+     ++NewIndex;
+    }
+    ++IntervalIndex;
+   }
+  }
+  Assert(NewIndex == NewSampleCount);
+  
+  SampleCount = NewSampleCount;
+  Ts = NewTs;
+  Samples = NewSamples;
+  IntervalCount = NewIntervalCount;
+  Intervals = NewIntervals;
+ }
+ 
+ Result.SampleCount = SampleCount;
+ Result.Samples = PushArrayNonZero(Arena, SampleCount, v2);
+ Result.Ts = PushArrayNonZero(Arena, SampleCount, f32);
+ Result.SegmentCount = SegmentCount;
+ Result.SegmentSampleIndices = PushArrayNonZero(Arena, SegmentCount, u32);
+ ArrayCopy(Result.Samples, Samples, SampleCount);
+ ArrayCopy(Result.Ts, Ts, SampleCount);
+ ArrayCopy(Result.SegmentSampleIndices, SegmentSampleIndices, SegmentCount);
+ 
+ EndTemp(Temp);
+ 
+ ProfileEnd();
+ 
+ return Result;
+}
+
+internal void
+CalcCurve(curve *Curve, u32 SampleCount, v2 *OutSamples)
+{
+ ProfileFunctionBegin();
+ 
+ temp_arena Temp = TempArena(0);
+ 
+ curve_points *Points = GetCurvePoints(Curve);
+ u32 PointCount = Points->ControlPointCount;
+ v2 *Controls = Points->ControlPoints;
+ f32 *Weights = Points->ControlPointWeights;
+ cubic_bezier_point *Beziers = Points->CubicBezierPoints;
+ curve_params *Params = &Curve->Params;
+ f32 *BSplineKnots = Points->BSplineKnots;
+ u32 SamplesPerControlPoint = Params->SamplesPerControlPoint;
+ parametric_curve_resources *Parametric = &Curve->ParametricResources;
+ arena *ComputeArena = Curve->ComputeArena;
+ 
+ switch (Params->Type)
+ {
+  case Curve_Polynomial: {CalcPolynomial(Controls, PointCount, Params->Polynomial, SampleCount, OutSamples, SamplesPerControlPoint);} break;
+  case Curve_CubicSpline: {CalcCubicSpline(Controls, PointCount, Params->CubicSpline, SampleCount, OutSamples);} break;
+  
+  case Curve_Bezier: {
+   switch (Params->Bezier)
+   {
+    case Bezier_Rational: {CalcBezierRational(Curve, Controls, Weights, PointCount, SampleCount, OutSamples);}break;
+    case Bezier_CubicSpline: {CalcBezierCubicSpline(Beziers, PointCount, SampleCount, OutSamples);}break;
+    case Bezier_Count: InvalidPath;
+   }
+  } break;
+  
+  case Curve_NURBS: {
+   b_spline_knot_params KnotParams = {};
+   nurbs_bezier_extraction *Extraction = PrepareCurveNURBS(Curve, &KnotParams);
+   u32 PartitionSize = KnotParams.PartitionSize;
+   u32 Degree = KnotParams.Degree;
+   
+   f32 *Ts = PushArrayNonZero(ComputeArena, SampleCount, f32);
+   // NOTE(hbr): Calculate sample point fractions
+   {
+    u32 SegmentCount = PartitionSize - 1;
+    u32 SamplesPerSegment = (SampleCount - 1) / SegmentCount;
+    u32 SampleIndex = 0;
+    f32 *Knot_Ts = BSplineKnots + Degree;
+    
+    for (u32 I = 0;
+         I < SegmentCount;
+         ++I)
+    {
+     f32 A = Knot_Ts[I];
+     f32 B = Knot_Ts[I+1];
+     
+     // NOTE(hbr): Start every segment at its knot, carrying T over the whole curve
+     // drifts past KnotParams.B, where evaluation is undefined
+     f32 T = A;
+     f32 Delta_T = (B - A) / SamplesPerSegment;
+     ForEachIndex(J, SamplesPerSegment)
+     {
+      Ts[SampleIndex++] = T;
+      T += Delta_T;
+     }
+     
+    }
+    
+    // NOTE(hbr): Pure safety, make sure we end at KnotParams.B
+    if (SampleIndex < SampleCount)
+    {
+     while (SampleIndex < SampleCount)
+     {
+      Ts[SampleIndex++] = KnotParams.B;
+     }
+    }
+    else
+    {
+     if (SampleCount > 0)
+     {
+      Ts[SampleCount - 1] = KnotParams.B;
+     }
+    }
+    
+    Curve->Ts = Ts;
+   }
+   
+   CalcNURBS(Controls,
+             Weights,
+             KnotParams,
+             BSplineKnots,
+             Extraction,
+             SampleCount,
+             Ts,
+             OutSamples);
+  }break;
+  
+  case Curve_Parametric: {CalcParametric(ComputeArena, Parametric, SampleCount, OutSamples);}break;
+  
+  case Curve_Count: InvalidPath;
+ }
+ 
+ EndTemp(Temp);
+ 
+ ProfileEnd();
+}
+
+internal u32
+CurveUniformSampleCount(curve *Curve)
+{
+ u32 SampleCount = 0;
+ if (IsCurveTotalSamplesMode(Curve))
+ {
+  SampleCount = Curve->Params.TotalSamples;
+ }
+ else
+ {
+  u32 ControlCount = GetControlPointCount(Curve);
+  u32 ControlCountWithLooped = (IsCurveLooped(Curve) ? ControlCount + 1 : ControlCount);
+  if (ControlCountWithLooped > 0)
+  {
+   SampleCount = (ControlCountWithLooped - 1) * Curve->Params.SamplesPerControlPoint + 1;
+  }
+ }
+ 
+ return SampleCount;
+}
+
+#define CurveArcLengthBlockSize 4096
+
+struct curve_arc_length_work
+{
+ v2 *Samples;
+ f32 *Lengths;
+ u32 Begin;
+ u32 End;
+ f32 Offset;
+};
+
+internal void
+CurveArcLengthScan_Work(void *UserData)
+{
+ curve_arc_length_work *Work = Cast(curve_arc_length_work *)UserData;
+ v2 *Samples = Work->Samples;
+ f32 *Lengths = Work->Lengths;
+ f32 Sum = 0.0f;
+ for (u32 Index = Work->Begin;
+      Index < Work->End;
+      ++Index)
+ {
+  if (Index > 0)
+  {
+   Sum += Norm(Samples[Index] - Samples[Index - 1]);
+  }
+  Lengths[Index] = Sum;
+ }
+}
+
+internal void
+CurveArcLengthOffset_Work(void *UserData)
+{
+ curve_arc_length_work *Work = Cast(curve_arc_length_work *)UserData;
+ for (u32 Index = Work->Begin;
+      Index < Work->End;
+      ++Index)
+ {
+  Work->Lengths[Index] += Work->Offset;
+ }
+}
+
+// NOTE(hbr): Parallel prefix sum of sample-to-sample distances. Every block sums its own
+// part first, then block totals are scanned serially and added back to later blocks.
+internal curve_arc_length_table
+CalcCurveArcLengthTable(arena *Arena, u32 SampleCount, v2 *Samples)
+{
+ ProfileFunctionBegin();
+ 
+ curve_arc_length_table Table = {};
+ Table.Count = SampleCount;
+ Table.Lengths = PushArrayNonZero(Arena, SampleCount, f32);
+ 
+ if (SampleCount > 0)
+ {
+  temp_arena Temp = TempArena(Arena);
+  work_queue *WorkQueue = CurveComputeQueue();
+  work_queue_group Group = {};
+  
+  work_queue_blocks Blocks = WorkQueueCalculateBlocks(WorkQueue, SampleCount, CurveArcLengthBlockSize);
+  u32 BlockCount = Blocks.BlockCount;
+  u32 BlockSize = Blocks.BlockSize;
+  
+  curve_arc_length_work *Works = PushArray(Temp.Arena, BlockCount, curve_arc_length_work);
+  ForEachIndex(BlockIndex, BlockCount)
+  {
+   curve_arc_length_work *Work = Works + BlockIndex;
+   Work->Samples = Samples;
+   Work->Lengths = Table.Lengths;
+   Work->Begin = Cast(u32)BlockIndex * BlockSize;
+   Work->End = Min(Work->Begin + BlockSize, SampleCount);
+  }
+  
+  if (BlockCount > 1)
+  {
+   ComputeQueueAddEntries(WorkQueue, &Group, CurveArcLengthScan_Work, Works, SizeOf(Works[0]), BlockCount);
+   ComputeQueueCompleteGroup(WorkQueue, &Group);
+   
+   f32 Offset = 0.0f;
+   ForEachIndex(BlockIndex, BlockCount)
+   {
+    curve_arc_length_work *Work = Works + BlockIndex;
+    Work->Offset = Offset;
+    Offset += Table.Lengths[Work->End - 1];
+   }
+   
+   ComputeQueueAddEntries(WorkQueue, &Group, CurveArcLengthOffset_Work, Works + 1, SizeOf(Works[0]), BlockCount - 1);
+   ComputeQueueCompleteGroup(WorkQueue, &Group);
+  }
+  else
+  {
+   CurveArcLengthScan_Work(Works);
+  }
+  
+  Table.TotalLength = Table.Lengths[SampleCount - 1];
+  
+  EndTemp(Temp);
+ }
+ 
+ ProfileEnd();
+ 
+ return Table;
+}
+
+// NOTE(hbr): Allocates what point tracking is computed into. The computation itself then
+// doesn't touch compute arena and can run on any thread.
+internal void
+AllocCurvePointTracking(curve *Curve)
+{
+ arena *ComputeArena = Curve->ComputeArena;
+ point_tracking_along_curve_state *Tracking = &Curve->PointTracking;
+ if (IsCurveEligibleForPointTracking(Curve))
+ {
+  if (Tracking->Type == PointTrackingAlongCurve_DeCasteljauVisualization)
+  {
+   u32 IterationCount = GetCurvePoints(Curve)->ControlPointCount;
+   u32 TotalPointCount = DeCasteljauTotalPointCount(IterationCount);
+   all_de_casteljau_intermediate_results *Intermediate = &Tracking->Intermediate;
+   Intermediate->P = PushArrayNonZero(ComputeArena, TotalPointCount, v2);
+   Intermediate->W = PushArrayNonZero(ComputeArena, TotalPointCount, f32);
+   
+   vertex_array *LineVerticesPerIteration = PushArray(ComputeArena, IterationCount, vertex_array);
+   ForEachIndex(Iteration, IterationCount)
+   {
+    u32 MaxVertexCount = StrokeTessellateMaxVertexCount(IterationCount - Cast(u32)Iteration, false);
+    LineVerticesPerIteration[Iteration].Vertices = PushArrayNonZero(ComputeArena, MaxVertexCount, v2);
+   }
+   Tracking->LineVerticesPerIteration = LineVerticesPerIteration;
+  }
+ }
+ else
+ {
+  Tracking->Type = PointTrackingAlongCurve_None;
+ }
+}
+
+internal void
+CalcCurvePointTracking(curve *Curve)
+{
+ curve_points *Points = GetCurvePoints(Curve);
+ u32 ControlCount = Points->ControlPointCount;
+ v2 *Controls = Points->ControlPoints;
+ f32 *Weights = Points->ControlPointWeights;
+ f32 LineWidth = Curve->Params.DrawParams.Line.Width;
+ 
+ point_tracking_along_curve_state *Tracking = &Curve->PointTracking;
+ if (Tracking->Type != PointTrackingAlongCurve_None)
+ {
+  f32 Fraction = Tracking->Fraction;
   
-  case NURBS_Eval_ScalarButUsingSSE: {
-   CalcNURBS_ScalarButUsingSSE(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples);
+  v2 LocalSpaceTrackedPoint = BezierCurveRationalEvaluateScalar(Fraction, Controls, Weights, ControlCount);
+  Tracking->LocalSpaceTrackedPoint = LocalSpaceTrackedPoint;
+  
+  if (Tracking->Type == PointTrackingAlongCurve_DeCasteljauVisualization)
+  {
+   all_de_casteljau_intermediate_results Intermediate = DeCasteljauAlgorithmInto(Fraction, Controls, Weights, ControlCount,
+                                                                                 Tracking->Intermediate.P, Tracking->Intermediate.W);
+   vertex_array *LineVerticesPerIteration = Tracking->LineVerticesPerIteration;
+   
+   u32 IterationPointsOffset = 0;
+   for (u32 Iteration = 0;
+        Iteration < Intermediate.IterationCount;
+        ++Iteration)
+   {
+    u32 CurrentIterationPointCount = Intermediate.IterationCount - Iteration;
+    LineVerticesPerIteration[Iteration] = StrokeTessellate_CustomWithoutOverlapInto(LineVerticesPerIteration[Iteration].Vertices,
+                                                                                    CurrentIterationPointCount,
+                                                                                    Intermediate.P + IterationPointsOffset,
+                                                                                    LineWidth,
+                                                                                    false, 0);
+    IterationPointsOffset += CurrentIterationPointCount;
+   }
+   
+   Tracking->Intermediate = Intermediate;
+   Tracking->LocalSpaceTrackedPoint = Intermediate.P[Intermediate.TotalPointCount - 1];
+  }
+ }
+}
+
+internal void
+RecomputeCurvePointTracking(curve *Curve)
+{
+ ProfileFunctionBegin();
+ AllocCurvePointTracking(Curve);
+ CalcCurvePointTracking(Curve);
+ ProfileEnd();
+}
+
+enum curve_recompute_task_type
+{
+ CurveRecomputeTask_Stroke,
+ CurveRecomputeTask_ConvexHull,
+ CurveRecomputeTask_BSplineConvexHulls,
+ CurveRecomputeTask_PointTracking,
+};
+
+// NOTE(hbr): Node of RecomputeCurveFromSamples graph, none of them depends on another.
+// Everything a task writes is allocated upfront, temporary memory comes from the scratch
+// of the thread that runs it.
+struct curve_recompute_task
+{
+ curve_recompute_task_type Type;
+ 
+ u32 PointCount;
+ v2 *Points;
+ f32 Width;
+ b32 Loop;
+ v2 *Vertices;
+ u32 *VertexOffsets;
+ v2 *HullPoints;
+ u32 HullPointCount;
+ vertex_array Result;
+ 
+ b_spline_convex_hull *BSplineHulls;
+ u32 Degree;
+ u32 BSplineHullBegin;
+ u32 BSplineHullEnd;
+ 
+ curve *Curve;
+};
+
+internal void
+RecomputeCurveTask_Work(void *UserData)
+{
+ curve_recompute_task *Task = Cast(curve_recompute_task *)UserData;
+ // NOTE(hbr): Might run on a worker thread, which can't use the profiler
+ b32 ProfilerWasDisabled = ProfilerIsDisabledOnThisThread();
+ ProfilerDisableOnThisThread();
+ 
+ switch (Task->Type)
+ {
+  case CurveRecomputeTask_Stroke: {
+   Task->Result = StrokeTessellate_CustomWithoutOverlapInto(Task->Vertices, Task->PointCount, Task->Points,
+                                                            Task->Width, Task->Loop, Task->VertexOffsets);
   }break;
   
-  case NURBS_Eval_SSE: {
-   CalcNURBS_SSE(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples);
+  case CurveRecomputeTask_ConvexHull: {
+   Task->HullPointCount = CalcConvexHull(Task->PointCount, Task->Points, Task->HullPoints);
+   Task->Result = StrokeTessellate_CustomWithoutOverlapInto(Task->Vertices, Task->HullPointCount, Task->HullPoints,
+                                                            Task->Width, true, 0);
   }break;
   
-  case NURBS_Eval_AVX2: {
-   CalcNURBS_AVX2(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples);
+  case CurveRecomputeTask_BSplineConvexHulls: {
+   // NOTE(hbr): Hull I is made of controls [I, I+Degree]
+   for (u32 HullIndex = Task->BSplineHullBegin;
+        HullIndex < Task->BSplineHullEnd;
+        ++HullIndex)
+   {
+    b_spline_convex_hull *Hull = Task->BSplineHulls + HullIndex;
+    Hull->PointCount = CalcConvexHull(Task->Degree + 1, Task->Points + HullIndex, Hull->Points);
+    Hull->Vertices = StrokeTessellate_CustomWithoutOverlapInto(Hull->Vertices.Vertices, Hull->PointCount, Hull->Points,
+                                                               Task->Width, true, 0);
+   }
   }break;
   
-  case NURBS_Eval_SSE_MultiThreaded: {
-   CalcNURBS_MultiThreaded(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples, CalcNURBS_SSE_Work);
+  case CurveRecomputeTask_PointTracking: {
+   CalcCurvePointTracking(Task->Curve);
   }break;
+ }
+ 
+ if (!ProfilerWasDisabled)
+ {
+  ProfilerEnableOnThisThread();
+ }
+}
+
+#define CurveRecomputeBSplineHullsPerTask 64
+
+internal void
+RecomputeCurveFromSamples(curve *Curve, u32 SampleCount, v2 *Samples, curve_eval_cache_entry *Cached)
+{
+ ProfileFunctionBegin();
+ 
+ temp_arena Temp = TempArena(0);
+ 
+ curve_params *Params = &Curve->Params;
+ curve_draw_params *DrawParams = &Params->DrawParams;
+ arena *ComputeArena = Curve->ComputeArena;
+ curve_points *Points = GetCurvePoints(Curve);
+ u32 ControlCount = Points->ControlPointCount;
+ v2 *Controls = Points->ControlPoints;
+ work_queue *WorkQueue = CurveComputeQueue();
+ work_queue_group Group = {};
+ 
+ // NOTE(hbr): Fans out on its own, the rest of the graph starts after it
+ curve_arc_length_table ArcLength = CalcCurveArcLengthTable(ComputeArena, SampleCount, Samples);
+ 
+ // NOTE(hbr): Every task is queued as soon as what it writes is allocated. Only this thread
+ // allocates from compute arena. Strokes and hulls keep their vertex offsets and room for
+ // the worst case, so that RecomputeCurveControlPointRange and RecomputeCurveStages can
+ // update them in place.
+ b32 Looped = IsCurveLooped(Curve);
+ curve_recompute_task *CurveStroke = PushStruct(Temp.Arena, curve_recompute_task);
+ CurveStroke->Type = CurveRecomputeTask_Stroke;
+ CurveStroke->PointCount = SampleCount;
+ CurveStroke->Points = Samples;
+ CurveStroke->Width = DrawParams->Line.Width;
+ CurveStroke->Loop = Looped;
+ CurveStroke->VertexOffsets = (Looped ? 0 : PushArrayNonZero(ComputeArena, SampleCount, u32));
+ CurveStroke->Vertices = PushArrayNonZero(ComputeArena, StrokeTessellateMaxVertexCount(SampleCount, Looped), v2);
+ if (Cached && Cached->LineWidth == CurveStroke->Width)
+ {
+  vertex_array Stroke = Cached->CurveVertices;
+  ArrayCopy(CurveStroke->Vertices, Stroke.Vertices, Stroke.VertexCount);
+  if (CurveStroke->VertexOffsets)
+  {
+   ArrayCopy(CurveStroke->VertexOffsets, Cached->CurveVertexOffsets, SampleCount);
+  }
+  CurveStroke->Result = Stroke;
+  CurveStroke->Result.Vertices = CurveStroke->Vertices;
+ }
+ else
+ {
+  ComputeQueueAddEntry(WorkQueue, &Group, RecomputeCurveTask_Work, CurveStroke);
+ }
+ 
+ curve_recompute_task *PolylineStroke = PushStruct(Temp.Arena, curve_recompute_task);
+ PolylineStroke->Type = CurveRecomputeTask_Stroke;
+ PolylineStroke->PointCount = ControlCount;
+ PolylineStroke->Points = Controls;
+ PolylineStroke->Width = DrawParams->Polyline.Width;
+ PolylineStroke->VertexOffsets = PushArrayNonZero(ComputeArena, ControlCount, u32);
+ PolylineStroke->Vertices = PushArrayNonZero(ComputeArena, StrokeTessellateMaxVertexCount(ControlCount, false), v2);
+ ComputeQueueAddEntry(WorkQueue, &Group, RecomputeCurveTask_Work, PolylineStroke);
+ 
+ curve_recompute_task *ConvexHull = PushStruct(Temp.Arena, curve_recompute_task);
+ ConvexHull->Type = CurveRecomputeTask_ConvexHull;
+ ConvexHull->PointCount = ControlCount;
+ ConvexHull->Points = Controls;
+ ConvexHull->Width = DrawParams->ConvexHull.Width;
+ ConvexHull->HullPoints = PushArrayNonZero(ComputeArena, ControlCount, v2);
+ ConvexHull->Vertices = PushArrayNonZero(ComputeArena, StrokeTessellateMaxVertexCount(ControlCount, true), v2);
+ ComputeQueueAddEntry(WorkQueue, &Group, RecomputeCurveTask_Work, ConvexHull);
+ 
+ u32 BSplineConvexHullCount = 0;
+ b_spline_convex_hull *BSplineConvexHulls = 0;
+ u32 BSplineDegree = 0;
+ if (IsBSplineCurve(Curve))
+ {
+  BSplineDegree = GetBSplineParams(Curve).KnotParams.Degree;
+  Assert(BSplineDegree <= ControlCount);
+  BSplineConvexHullCount = ControlCount - BSplineDegree;
+  BSplineConvexHulls = PushArray(ComputeArena, BSplineConvexHullCount, b_spline_convex_hull);
+  u32 HullPointCount = BSplineDegree + 1;
+  u32 HullMaxVertexCount = StrokeTessellateMaxVertexCount(HullPointCount, true);
+  ForEachIndex(HullIndex, BSplineConvexHullCount)
+  {
+   b_spline_convex_hull *Hull = BSplineConvexHulls + HullIndex;
+   Hull->Points = PushArray(ComputeArena, HullPointCount, v2);
+   Hull->Vertices.Vertices = PushArrayNonZero(ComputeArena, HullMaxVertexCount, v2);
+  }
+ }
+ 
+ // NOTE(hbr): Has to be the last thing in compute arena, see ComputeArenaMark
+ Curve->PointTracking.ComputeArenaMark = BeginTemp(ComputeArena);
+ AllocCurvePointTracking(Curve);
+ curve_recompute_task *PointTracking = PushStruct(Temp.Arena, curve_recompute_task);
+ PointTracking->Type = CurveRecomputeTask_PointTracking;
+ PointTracking->Curve = Curve;
+ ComputeQueueAddEntry(WorkQueue, &Group, RecomputeCurveTask_Work, PointTracking);
+ 
+ // NOTE(hbr): Last, so that blocks are spread over the entries left in the queue
+ if (BSplineConvexHullCount > 0)
+ {
+  work_queue_blocks Blocks = WorkQueueCalculateBlocks(WorkQueue, BSplineConvexHullCount, CurveRecomputeBSplineHullsPerTask);
+  curve_recompute_task *HullTasks = PushArray(Temp.Arena, Blocks.BlockCount, curve_recompute_task);
+  ForEachIndex(BlockIndex, Blocks.BlockCount)
+  {
+   curve_recompute_task *Task = HullTasks + BlockIndex;
+   Task->Type = CurveRecomputeTask_BSplineConvexHulls;
+   Task->Points = Controls;
+   Task->Width = DrawParams->BSplinePartialConvexHull.Width;
+   Task->BSplineHulls = BSplineConvexHulls;
+   Task->Degree = BSplineDegree;
+   Task->BSplineHullBegin = Cast(u32)BlockIndex * Blocks.BlockSize;
+   Task->BSplineHullEnd = Min(Task->BSplineHullBegin + Blocks.BlockSize, BSplineConvexHullCount);
+  }
+  ComputeQueueAddEntries(WorkQueue, &Group, RecomputeCurveTask_Work, HullTasks, SizeOf(HullTasks[0]), Blocks.BlockCount);
+ }
+ 
+ ComputeQueueCompleteGroup(WorkQueue, &Group);
+ 
+ Curve->CurveSampleCount = SampleCount;
+ Curve->CurveSamples = Samples;
+ Curve->ArcLength = ArcLength;
+ Curve->CurveVertices = CurveStroke->Result;
+ Curve->CurveVertexOffsets = CurveStroke->VertexOffsets;
+ Curve->PolylineVertices = PolylineStroke->Result;
+ Curve->PolylinePointCount = ControlCount;
+ Curve->PolylineVertexOffsets = PolylineStroke->VertexOffsets;
+ Curve->ConvexHullPoints = ConvexHull->HullPoints;
+ Curve->ConvexHullCount = ConvexHull->HullPointCount;
+ Curve->ConvexHullVertices = ConvexHull->Result;
+ Curve->BSplineConvexHullCount = BSplineConvexHullCount;
+ Curve->BSplineConvexHulls = BSplineConvexHulls;
+ 
+ EndTemp(Temp);
+ 
+ ProfileEnd();
+}
+
+internal curve_eval_cache *
+AllocCurveEvalCache(arena_store *ArenaStore)
+{
+ arena *Arena = AllocArenaFromStore(ArenaStore, Megabytes(1), MemoryTag_CurveEvalCache);
+ curve_eval_cache *Cache = PushStruct(Arena, curve_eval_cache);
+ Cache->Arena = Arena;
+ Cache->ArenaStore = ArenaStore;
+ curve_eval_cache_entry *Entries = PushArray(Arena, CurveEvalCacheMaxEntryCount, curve_eval_cache_entry);
+ ForEachIndex(EntryIndex, CurveEvalCacheMaxEntryCount)
+ {
+  StackPush(Cache->Free, Entries + EntryIndex);
+ }
+ return Cache;
+}
+
+// NOTE(hbr): Cache belongs to the main thread, curves recomputed in the background
+// are added once they land, see ApplyCurveAsyncRecompute.
+internal curve_eval_cache *
+CurveEvalCacheOnThisThread(void)
+{
+ curve_eval_cache *Cache = (GlobalThreadComputesInPlace ? 0 : GetCtx()->CurveEvalCache);
+ return Cache;
+}
+
+// NOTE(hbr): Evaluation fixes up some of its inputs on the way (knots, pixel size adaptive
+// tolerance is converted with), do it upfront so that the key describes what is evaluated.
+internal void
+PrepareCurveForEval(curve *Curve)
+{
+ if (Curve->Params.Type == Curve_NURBS)
+ {
+  MaybeRecomputeCurveBSplineKnots(Curve, false);
+  GetCurvePoints(Curve)->BSplineKnotCount = GetBSplineParams(Curve).KnotParams.KnotCount;
+ }
+ if (IsCurveAdaptiveSamplingMode(Curve))
+ {
+  Curve->AdaptiveWorldUnitsPerPixel = GetCtx()->WorldUnitsPerPixel;
+ }
+}
+
+struct curve_eval_cache_key_header
+{
+ curve_type Type;
+ polynomial_interpolation_params Polynomial;
+ cubic_spline_type CubicSpline;
+ bezier_type Bezier;
+ curve_eval_precision BezierPrecision;
+ b_spline_params BSpline;
+ u32 SamplesPerControlPoint;
+ u32 TotalSamples;
+ b32 AdaptiveSampling;
+ f32 AdaptiveLocalTolerance;
+ u32 ControlPointCount;
+ u32 BSplineKnotCount;
+ // NOTE(hbr): Methods are not bit-identical (forward differencing, SIMD paths), so samples
+ // computed with one selection must not be served after DEBUG_Vars or calibration picks another
+ u32 EvalMethod;
+ u32 CubicSplinePeriodicM_EvalMethod;
+};
+
+// NOTE(hbr): Called twice, first without Data just to count the size
+struct curve_eval_cache_key_writer
+{
+ u8 *Data;
+ u64 Size;
+};
+
+internal void
+WriteCurveEvalCacheKeyData(curve_eval_cache_key_writer *Writer, void *Data, u64 Size)
+{
+ if (Writer->Data)
+ {
+  MemoryCopy(Writer->Data + Writer->Size, Data, Size);
+ }
+ Writer->Size += Size;
+}
+
+internal void
+WriteCurveEvalCacheKeyString(curve_eval_cache_key_writer *Writer, string Str)
+{
+ WriteCurveEvalCacheKeyData(Writer, &Str.Count, SizeOf(Str.Count));
+ WriteCurveEvalCacheKeyData(Writer, Str.Data, Str.Count);
+}
+
+internal void
+WriteCurveEvalCacheKeyParametricField(curve_eval_cache_key_writer *Writer, parametric_curve_field *Field)
+{
+ WriteCurveEvalCacheKeyData(Writer, &Field->EquationOrDragFloatMode_Equation, SizeOf(Field->EquationOrDragFloatMode_Equation));
+ WriteCurveEvalCacheKeyData(Writer, &Field->DragValue, SizeOf(Field->DragValue));
+ WriteCurveEvalCacheKeyString(Writer, StringFromStringId(Field->VarName));
+ WriteCurveEvalCacheKeyString(Writer, StringFromStringId(Field->Equation));
+}
+
+// NOTE(hbr): Adaptive methods are resolved to the calibrated kernel, the same way CalcCurve resolves them
+internal u32
+CurveEffectiveEvalMethod(curve *Curve)
+{
+ curve_params *Params = &Curve->Params;
+ curve_eval_calibration Calibration = CurrentCurveEvalCalibration();
+ 
+ u32 Result = 0;
+ switch (Params->Type)
+ {
+  case Curve_Polynomial: {
+   Result = ResolveCurveEvalMethod(DEBUG_Vars->Polynomial_EvalMethod, Polynomial_Eval_Adaptive_MultiThreaded, Calibration.Polynomial);
+  } break;
   
-  case NURBS_Eval_AVX2_MultiThreaded: {
-   CalcNURBS_MultiThreaded(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples, CalcNURBS_AVX2_Work);
-  }break;
+  case Curve_CubicSpline: {
+   Result = ResolveCurveEvalMethod(DEBUG_Vars->CubicSpline_EvalMethod, CubicSpline_Eval_Adaptive_MultiThreaded, Calibration.CubicSpline);
+  } break;
   
-  case NURBS_Eval_Adaptive_MultiThreaded: {
-   work_queue_func *EvalFunc = 0;
-   
-   instruction_set_flags Flags = Platform.InstructionSetSupport();
-   if (0) {}
-   else if (Flags & InstructionSet_AVX2) EvalFunc = CalcNURBS_AVX2_Work;
-   else if (Flags & InstructionSet_SSE) EvalFunc = CalcNURBS_SSE_Work;
-   else EvalFunc = CalcNURBS_Scalar_Work;
-   
-   CalcNURBS_MultiThreaded(Controls, Weights, KnotParams, Knots, SampleCount, Ts, OutSamples, EvalFunc);
-  }break;
+  case Curve_Bezier: {
+   Result = ResolveCurveEvalMethod(DEBUG_Vars->Bezier_EvalMethod, Bezier_Eval_Adaptive_MultiThreaded, Calibration.Bezier);
+  } break;
   
-  case NURBS_Eval_Count: InvalidPath;
+  case Curve_NURBS: {
+   Result = ResolveCurveEvalMethod(DEBUG_Vars->NURBS_EvalMethod, NURBS_Eval_Adaptive_MultiThreaded, Calibration.NURBS);
+  } break;
+  
+  case Curve_Parametric: {
+   Result = DEBUG_Vars->Parametric_EvalMethod;
+  } break;
+  
+  case Curve_Count: InvalidPath;
  }
  
- ProfileEnd();
+ return Result;
 }
 
 internal void
-CalcParametricCurveField(arena *Arena,
-                         parametric_curve_field *Field,
-                         b32 IsVar,
-                         u32 VarCount,
-                         string *VarNames,
-                         f32 *VarValues)
+WriteCurveEvalCacheKey(curve_eval_cache_key_writer *Writer, curve *Curve)
 {
- StructZero(&Field->Cached);
+ curve_params *Params = &Curve->Params;
+ curve_points *Points = GetCurvePoints(Curve);
+ u32 PointCount = Points->ControlPointCount;
+ b32 IsNURBS = (Params->Type == Curve_NURBS);
+ 
+ curve_eval_cache_key_header Header = {};
+ StructZero(&Header);
+ Header.Type = Params->Type;
+ Header.Polynomial = Params->Polynomial;
+ Header.CubicSpline = Params->CubicSpline;
+ Header.Bezier = Params->Bezier;
+ Header.BezierPrecision = Params->BezierPrecision;
+ Header.BSpline = Params->BSpline;
+ Header.SamplesPerControlPoint = Params->SamplesPerControlPoint;
+ Header.TotalSamples = Params->TotalSamples;
+ Header.AdaptiveSampling = IsCurveAdaptiveSamplingMode(Curve);
+ Header.AdaptiveLocalTolerance = (Header.AdaptiveSampling ? CurveAdaptiveSamplingLocalTolerance(Curve) : 0.0f);
+ Header.ControlPointCount = PointCount;
+ Header.BSplineKnotCount = (IsNURBS ? Points->BSplineKnotCount : 0);
+ Header.EvalMethod = CurveEffectiveEvalMethod(Curve);
+ Header.CubicSplinePeriodicM_EvalMethod = (Params->Type == Curve_CubicSpline ? DEBUG_Vars->CubicSplinePeriodicM_EvalMethod : 0);
+ WriteCurveEvalCacheKeyData(Writer, &Header, SizeOf(Header));
+ 
+ WriteCurveEvalCacheKeyData(Writer, Points->ControlPoints, PointCount * SizeOf(Points->ControlPoints[0]));
+ WriteCurveEvalCacheKeyData(Writer, Points->ControlPointWeights, PointCount * SizeOf(Points->ControlPointWeights[0]));
+ WriteCurveEvalCacheKeyData(Writer, Points->CubicBezierPoints, PointCount * SizeOf(Points->CubicBezierPoints[0]));
+ WriteCurveEvalCacheKeyData(Writer, Points->BSplineKnots, Header.BSplineKnotCount * SizeOf(Points->BSplineKnots[0]));
+ 
+ if (Params->Type == Curve_Parametric)
+ {
+  parametric_curve_resources *Parametric = &Curve->ParametricResources;
+  WriteCurveEvalCacheKeyParametricField(Writer, &Parametric->MinT_Var);
+  WriteCurveEvalCacheKeyParametricField(Writer, &Parametric->MaxT_Var);
+  WriteCurveEvalCacheKeyParametricField(Writer, &Parametric->X_Equation);
+  WriteCurveEvalCacheKeyParametricField(Writer, &Parametric->Y_Equation);
+  ForEachElement(VarIndex, Parametric->AdditionalVars)
+  {
+   parametric_curve_field *Var = Parametric->AdditionalVars + VarIndex;
+   if (IsParametricCurveVarActive(Var))
+   {
+    WriteCurveEvalCacheKeyParametricField(Writer, Var);
+   }
+  }
+ }
+}
+
+// NOTE(hbr): Curve has to be prepared for evaluation, see PrepareCurveForEval
+internal curve_eval_cache_key
+MakeCurveEvalCacheKey(arena *Arena, curve *Curve)
+{
+ curve_eval_cache_key_writer Writer = {};
+ WriteCurveEvalCacheKey(&Writer, Curve);
+ u64 Size = Writer.Size;
  
- string Equation = StringFromStringId(GetCtx()->StrStore, Field->Equation);
+ Writer.Data = PushArrayNonZero(Arena, Size, u8);
+ Writer.Size = 0;
+ WriteCurveEvalCacheKey(&Writer, Curve);
+ Assert(Writer.Size == Size);
  
- if (IsVar)
+ // NOTE(hbr): FNV-1a
+ u64 Hash = 14695981039346656037ull;
+ ForEachIndex(ByteIndex, Size)
  {
-  if (Field->EquationOrDragFloatMode_Equation)
+  Hash ^= Writer.Data[ByteIndex];
+  Hash *= 1099511628211ull;
+ }
+ 
+ curve_eval_cache_key Key = {};
+ Key.Hash = Hash;
+ Key.Size = Size;
+ Key.Data = Writer.Data;
+ 
+ return Key;
+}
+
+internal curve_eval_cache_entry *
+FindCurveEvalCacheEntry(curve_eval_cache *Cache, curve_eval_cache_key Key)
+{
+ curve_eval_cache_entry *Result = 0;
+ for (curve_eval_cache_entry *Entry = Cache->Buckets[Key.Hash % CurveEvalCacheBucketCount];
+      Entry;
+      Entry = Entry->HashNext)
+ {
+  if (Entry->Key.Hash == Key.Hash &&
+      Entry->Key.Size == Key.Size &&
+      MemoryEqual(Entry->Key.Data, Key.Data, Key.Size))
   {
-   parametric_equation_eval_result Eval = ParametricEquationEval(Arena, Equation, VarCount, VarNames, VarValues);
-   Field->Cached.EvalValue = Eval.Value;
-   Field->Cached.EvalFail = Eval.Fail;
-   Field->Cached.EvalErrorMessage = Eval.ErrorMessage;
+   Result = Entry;
+   break;
+  }
+ }
+ return Result;
+}
+
+internal curve_eval_cache_entry *
+CurveEvalCacheLookup(curve_eval_cache *Cache, curve_eval_cache_key Key)
+{
+ curve_eval_cache_entry *Entry = FindCurveEvalCacheEntry(Cache, Key);
+ if (Entry)
+ {
+  ++Cache->HitCount;
+  DLLRemove(Cache->Head, Cache->Tail, Entry);
+  DLLPushFront(Cache->Head, Cache->Tail, Entry);
+ }
+ else
+ {
+  ++Cache->MissCount;
+ }
+ return Entry;
+}
+
+internal void
+EvictCurveEvalCacheEntry(curve_eval_cache *Cache, curve_eval_cache_entry *Entry)
+{
+ curve_eval_cache_entry **Link = Cache->Buckets + (Entry->Key.Hash % CurveEvalCacheBucketCount);
+ while (*Link != Entry)
+ {
+  Link = &(*Link)->HashNext;
+ }
+ *Link = Entry->HashNext;
+ DLLRemove(Cache->Head, Cache->Tail, Entry);
+ 
+ ClearArena(Entry->Arena);
+ Cache->TotalSize -= Entry->Size;
+ --Cache->EntryCount;
+ StackPush(Cache->Free, Entry);
+}
+
+internal void
+CurveEvalCacheInsert(curve_eval_cache *Cache, curve_eval_cache_key Key, curve *Curve)
+{
+ u32 SampleCount = Curve->CurveSampleCount;
+ u32 SegmentCount = Curve->SegmentSampleIndexCount;
+ u32 KnotCount = (Curve->Params.Type == Curve_NURBS ? Curve->BSplinePartitionKnotCount : 0);
+ vertex_array Stroke = Curve->CurveVertices;
+ u64 Size = (Key.Size +
+             SampleCount * SizeOf(v2) +
+             (Curve->Ts ? SampleCount * SizeOf(f32) : 0) +
+             SegmentCount * SizeOf(u32) +
+             KnotCount * SizeOf(v2) +
+             Stroke.VertexCount * SizeOf(v2) +
+             (Curve->CurveVertexOffsets ? SampleCount * SizeOf(u32) : 0));
+ 
+ // NOTE(hbr): One huge curve shouldn't flush everything else
+ if (Size <= CurveEvalCacheMaxSize / 4 && !FindCurveEvalCacheEntry(Cache, Key))
+ {
+  while (Cache->Tail &&
+         (Cache->EntryCount == CurveEvalCacheMaxEntryCount ||
+          Cache->TotalSize + Size > CurveEvalCacheMaxSize))
+  {
+   EvictCurveEvalCacheEntry(Cache, Cache->Tail);
+  }
+  
+  curve_eval_cache_entry *Entry = Cache->Free;
+  StackPop(Cache->Free);
+  arena *Arena = Entry->Arena;
+  if (!Arena)
+  {
+   Arena = AllocArenaFromStore(Cache->ArenaStore, Megabytes(64), MemoryTag_CurveEvalCache);
+  }
+  StructZero(Entry);
+  Entry->Arena = Arena;
+  Entry->Size = Size;
+  
+  Entry->Key = Key;
+  Entry->Key.Data = PushArrayNonZero(Arena, Key.Size, u8);
+  ArrayCopy(Entry->Key.Data, Key.Data, Key.Size);
+  
+  Entry->SampleCount = SampleCount;
+  Entry->Samples = PushArrayNonZero(Arena, SampleCount, v2);
+  ArrayCopy(Entry->Samples, Curve->CurveSamples, SampleCount);
+  if (Curve->Ts)
+  {
+   Entry->Ts = PushArrayNonZero(Arena, SampleCount, f32);
+   ArrayCopy(Entry->Ts, Curve->Ts, SampleCount);
+  }
+  Entry->SegmentSampleIndexCount = SegmentCount;
+  Entry->SegmentSampleIndices = PushArrayNonZero(Arena, SegmentCount, u32);
+  ArrayCopy(Entry->SegmentSampleIndices, Curve->SegmentSampleIndices, SegmentCount);
+  Entry->BSplinePartitionKnotCount = KnotCount;
+  Entry->BSplinePartitionKnots = PushArrayNonZero(Arena, KnotCount, v2);
+  ArrayCopy(Entry->BSplinePartitionKnots, Curve->BSplinePartitionKnots, KnotCount);
+  
+  Entry->LineWidth = Curve->Params.DrawParams.Line.Width;
+  Entry->CurveVertices = Stroke;
+  Entry->CurveVertices.Vertices = PushArrayNonZero(Arena, Stroke.VertexCount, v2);
+  ArrayCopy(Entry->CurveVertices.Vertices, Stroke.Vertices, Stroke.VertexCount);
+  if (Curve->CurveVertexOffsets)
+  {
+   Entry->CurveVertexOffsets = PushArrayNonZero(Arena, SampleCount, u32);
+   ArrayCopy(Entry->CurveVertexOffsets, Curve->CurveVertexOffsets, SampleCount);
   }
+  
+  curve_eval_cache_entry **Bucket = Cache->Buckets + (Key.Hash % CurveEvalCacheBucketCount);
+  Entry->HashNext = *Bucket;
+  *Bucket = Entry;
+  DLLPushFront(Cache->Head, Cache->Tail, Entry);
+  Cache->TotalSize += Size;
+  ++Cache->EntryCount;
+ }
+}
+
+internal b32
+IsCurveInEvalCache(curve *Curve)
+{
+ b32 Result = false;
+ curve_eval_cache *Cache = CurveEvalCacheOnThisThread();
+ if (Cache)
+ {
+  temp_arena Temp = TempArena(0);
+  PrepareCurveForEval(Curve);
+  curve_eval_cache_key Key = MakeCurveEvalCacheKey(Temp.Arena, Curve);
+  Result = (FindCurveEvalCacheEntry(Cache, Key) != 0);
+  EndTemp(Temp);
+ }
+ return Result;
+}
+
+internal void
+RecomputeCurveFromEvalCache(curve *Curve, curve_eval_cache_entry *Entry)
+{
+ ProfileFunctionBegin();
+ 
+ arena *ComputeArena = Curve->ComputeArena;
+ ClearArena(ComputeArena);
+ 
+ u32 SampleCount = Entry->SampleCount;
+ v2 *Samples = PushArrayNonZero(ComputeArena, SampleCount, v2);
+ ArrayCopy(Samples, Entry->Samples, SampleCount);
+ Curve->Ts = 0;
+ if (Entry->Ts)
+ {
+  Curve->Ts = PushArrayNonZero(ComputeArena, SampleCount, f32);
+  ArrayCopy(Curve->Ts, Entry->Ts, SampleCount);
+ }
+ Curve->SegmentSampleIndexCount = Entry->SegmentSampleIndexCount;
+ Curve->SegmentSampleIndices = PushArrayNonZero(ComputeArena, Entry->SegmentSampleIndexCount, u32);
+ ArrayCopy(Curve->SegmentSampleIndices, Entry->SegmentSampleIndices, Entry->SegmentSampleIndexCount);
+ Curve->BSplinePartitionKnotCount = Entry->BSplinePartitionKnotCount;
+ Curve->BSplinePartitionKnots = PushArrayNonZero(ComputeArena, Entry->BSplinePartitionKnotCount, v2);
+ ArrayCopy(Curve->BSplinePartitionKnots, Entry->BSplinePartitionKnots, Entry->BSplinePartitionKnotCount);
+ 
+ if (Curve->Params.Type == Curve_Parametric)
+ {
+  // NOTE(hbr): Parsed equations (and errors shown in UI) live in compute arena
+  MakeParametricEvalInput(ComputeArena, &Curve->ParametricResources);
+ }
+ 
+ RecomputeCurveFromSamples(Curve, SampleCount, Samples, Entry);
+ 
+ ProfileEnd();
+}
+
+// TODO(hbr): This function needs some serious refactoring.
+// First of all, don't break down all the "Compute" functions into hierarchical structure.
+// It's very fragile. It's just better (I think) to duplicate some code but have it more independent.
+// Second of all just refactor stupid code duplication here.
+// Basically inline everything and work your way up from there.
+// Then parallelize this heavily. I mean, we can unroll, we can simd, we can multithread this.
+internal void
+RecomputeCurveUncached(curve *Curve)
+{
+ ProfileFunctionBegin();
+ 
+ arena *ComputeArena = Curve->ComputeArena;
+ 
+ ClearArena(ComputeArena);
+ 
+ u32 SampleCount = 0;
+ v2 *Samples = 0;
+ Curve->SegmentSampleIndexCount = 0;
+ Curve->SegmentSampleIndices = 0;
+ if (IsCurveAdaptiveSamplingMode(Curve))
+ {
+  f32 Tolerance = CurveAdaptiveSamplingLocalTolerance(Curve);
+  curve_adaptive_samples Adaptive = CalcCurveAdaptive(ComputeArena, Curve, Tolerance);
+  SampleCount = Adaptive.SampleCount;
+  Samples = Adaptive.Samples;
+  Curve->Ts = Adaptive.Ts;
+  Curve->SegmentSampleIndexCount = Adaptive.SegmentCount;
+  Curve->SegmentSampleIndices = Adaptive.SegmentSampleIndices;
+ }
+ else
+ {
+  SampleCount = CurveUniformSampleCount(Curve);
+  Samples = PushArrayNonZero(ComputeArena, SampleCount, v2);
+  // NOTE(hbr): Only some curves keep their Ts, don't leave the previous ones dangling
+  Curve->Ts = 0;
+  CalcCurve(Curve, SampleCount, Samples);
+ }
+ 
+ RecomputeCurveFromSamples(Curve, SampleCount, Samples, 0);
+ 
+ ProfileEnd();
+}
+
+internal void
+RecomputeCurve(curve *Curve)
+{
+ temp_arena Temp = TempArena(0);
+ 
+ PrepareCurveForEval(Curve);
+ curve_eval_cache *Cache = CurveEvalCacheOnThisThread();
+ curve_eval_cache_key Key = {};
+ curve_eval_cache_entry *Cached = 0;
+ if (Cache)
+ {
+  Key = MakeCurveEvalCacheKey(Temp.Arena, Curve);
+  Cached = CurveEvalCacheLookup(Cache, Key);
+ }
+ 
+ if (Cached)
+ {
+  RecomputeCurveFromEvalCache(Curve, Cached);
  }
  else
  {
-  parametric_equation_parse_result Parse = ParametricEquationParse(Arena, Equation, VarCount, VarNames, VarValues);
-  Field->Cached.EvalExpr = Parse.ParsedExpr;
-  Field->Cached.EvalFail = Parse.Fail;
-  Field->Cached.EvalErrorMessage = Parse.ErrorMessage;
+  RecomputeCurveUncached(Curve);
+  if (Cache)
+  {
+   CurveEvalCacheInsert(Cache, Key, Curve);
+  }
  }
+ 
+ EndTemp(Temp);
 }
 
-internal f32
-ParametricCurveVarValue(parametric_curve_field *Var)
+// NOTE(hbr): Redo only the invalidated stages of already computed curve. Strokes are
+// redone into the buffers they already have, sized for the worst case at any width.
+internal void
+RecomputeCurveStages(curve *Curve, curve_recompute_stage_flags Stages)
 {
- f32 Value = 0;
- if (Var->EquationOrDragFloatMode_Equation)
+ if (Stages & CurveRecomputeStage_Samples)
  {
-  Value = Var->Cached.EvalValue;
+  RecomputeCurve(Curve);
  }
- else
+ else if (Stages)
  {
-  Value = Var->DragValue;
+  ProfileFunctionBegin();
+  
+  curve_draw_params *DrawParams = &Curve->Params.DrawParams;
+  curve_points *Points = GetCurvePoints(Curve);
+  
+  if (Stages & CurveRecomputeStage_CurveVertices)
+  {
+   Curve->CurveVertices = StrokeTessellate_CustomWithoutOverlapInto(Curve->CurveVertices.Vertices,
+                                                                    Curve->CurveSampleCount, Curve->CurveSamples,
+                                                                    DrawParams->Line.Width, IsCurveLooped(Curve),
+                                                                    Curve->CurveVertexOffsets);
+  }
+  
+  if (Stages & CurveRecomputeStage_PolylineVertices)
+  {
+   Curve->PolylineVertices = StrokeTessellate_CustomWithoutOverlapInto(Curve->PolylineVertices.Vertices,
+                                                                       Curve->PolylinePointCount, Points->ControlPoints,
+                                                                       DrawParams->Polyline.Width, false,
+                                                                       Curve->PolylineVertexOffsets);
+  }
+  
+  if (Stages & CurveRecomputeStage_ConvexHullVertices)
+  {
+   Curve->ConvexHullVertices = StrokeTessellate_CustomWithoutOverlapInto(Curve->ConvexHullVertices.Vertices,
+                                                                         Curve->ConvexHullCount, Curve->ConvexHullPoints,
+                                                                         DrawParams->ConvexHull.Width, true, 0);
+  }
+  
+  if (Stages & CurveRecomputeStage_BSplineConvexHulls)
+  {
+   ForEachIndex(HullIndex, Curve->BSplineConvexHullCount)
+   {
+    b_spline_convex_hull *Hull = Curve->BSplineConvexHulls + HullIndex;
+    Hull->Vertices = StrokeTessellate_CustomWithoutOverlapInto(Hull->Vertices.Vertices, Hull->PointCount, Hull->Points,
+                                                               DrawParams->BSplinePartialConvexHull.Width, true, 0);
+   }
+  }
+  
+  if (Stages & CurveRecomputeStage_PointTracking)
+  {
+   point_tracking_along_curve_state *Tracking = &Curve->PointTracking;
+   Assert(Tracking->ComputeArenaMark.Arena == Curve->ComputeArena);
+   EndTemp(Tracking->ComputeArenaMark);
+   RecomputeCurvePointTracking(Curve);
+  }
+  
+  ProfileEnd();
  }
- return Value;
 }
 
+#define CurveBasisCacheMaxSize Megabytes(24)
+
+// NOTE(hbr): Computed in log space, so that high degrees don't underflow
 internal void
-CalcParametric_SingleThreaded(parametric_equation_expr *X_Expr,
-                              parametric_equation_expr *Y_Expr,
-                              u32 SampleCount,
-                              f32 *Ts,
-                              v2 *OutSamples)
+CalcBernsteinBasis(u32 Degree, u32 SampleCount, f32 *Ts, f32 *OutBasis)
 {
  ForEachIndex(SampleIndex, SampleCount)
  {
-  f32 T = Ts[SampleIndex];
-  
-  f32 X = ParametricEquationEvalWithT(X_Expr, T);
-  f32 Y = ParametricEquationEvalWithT(Y_Expr, T);
-  
-  OutSamples[SampleIndex] = V2(X, Y);
+  f64 T = Ts[SampleIndex];
+  if (T <= 0.0 || T >= 1.0)
+  {
+   u32 Hit = (T <= 0.0 ? 0 : Degree);
+   for (u32 I = 0; I <= Degree; ++I)
+   {
+    OutBasis[I * SampleCount + SampleIndex] = (I == Hit ? 1.0f : 0.0f);
+   }
+  }
+  else
+  {
+   f64 LogT = LogF64(T);
+   f64 LogOneMinusT = LogF64(1.0 - T);
+   f64 LogBinomial = 0.0;
+   for (u32 I = 0; I <= Degree; ++I)
+   {
+    f64 LogB = LogBinomial + I * LogT + (Degree - I) * LogOneMinusT;
+    OutBasis[I * SampleCount + SampleIndex] = Cast(f32)ExpF64(LogB);
+    LogBinomial += LogF64(Cast(f64)(Degree - I) / (I + 1));
+   }
+  }
  }
 }
 
-struct calc_parametric_work
+internal void
+CalcLagrangeBasis(f32 *Omega, f32 *Ti, u32 PointCount, u32 SampleCount, f32 *Ts, f32 *OutBasis)
 {
- parametric_equation_expr *X_Expr;
- parametric_equation_expr *Y_Expr;
- u32 SampleCount;
- f32 *Ts;
- v2 *OutSamples;
-};
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  f32 T = Ts[SampleIndex];
+  u32 Hit = U32_MAX;
+  for (u32 I = 0;
+       I < PointCount;
+       ++I)
+  {
+   if (T == Ti[I])
+   {
+    Hit = I;
+   }
+  }
+  
+  if (Hit != U32_MAX)
+  {
+   ForEachIndex(I, PointCount)
+   {
+    OutBasis[I * SampleCount + SampleIndex] = (I == Hit ? 1.0f : 0.0f);
+   }
+  }
+  else
+  {
+   f64 Den = 0.0;
+   ForEachIndex(I, PointCount)
+   {
+    Den += Omega[I] / (Cast(f64)T - Ti[I]);
+   }
+   ForEachIndex(I, PointCount)
+   {
+    f64 Fraction = Omega[I] / (Cast(f64)T - Ti[I]);
+    OutBasis[I * SampleCount + SampleIndex] = Cast(f32)(Fraction / Den);
+   }
+  }
+ }
+}
 
 internal void
-CalcParametric_Work(void *UserData)
+AddCurveBasisColumn(curve_basis_cache *Cache, u32 PointIndex, f64 X, f64 Y, f64 W)
 {
- calc_parametric_work *Work = Cast(calc_parametric_work *)UserData;
- CalcParametric_SingleThreaded(Work->X_Expr, Work->Y_Expr, Work->SampleCount, Work->Ts, Work->OutSamples);
+ u32 SampleCount = Cache->SampleCount;
+ f32 *Column = Cache->Basis + Cast(u64)PointIndex * SampleCount;
+ f64 *SumX = Cache->SumX;
+ f64 *SumY = Cache->SumY;
+ f64 *SumW = Cache->SumW;
+ ForEachIndex(SampleIndex, SampleCount)
+ {
+  f64 B = Column[SampleIndex];
+  SumX[SampleIndex] += B * X;
+  SumY[SampleIndex] += B * Y;
+  SumW[SampleIndex] += B * W;
+ }
 }
 
-internal void
-CalcParametric_MultiThreaded(parametric_equation_expr *X_Expr,
-                             parametric_equation_expr *Y_Expr,
-                             u32 SampleCount,
-                             f32 *Ts,
-                             v2 *OutSamples)
+// NOTE(hbr): Brings rational Bezier or polynomial samples up to date with control points,
+// adding one basis column per moved point. The first call for given point count and
+// sample Ts has to build the basis, which costs about as much as evaluating the curve.
+// Returns false if the basis would be too big, samples are left untouched then.
+internal b32
+UpdateCurveSamplesWithBasis(curve *Curve)
 {
- ProfileFunctionBegin();
- 
- temp_arena Temp = TempArena(0);
- work_queue *WorkQueue = GetCtx()->HighPriorityQueue;
- 
- // NOTE(hbr): 256 selected experimentally
- work_queue_blocks Blocks = WorkQueueCalculateBlocks(WorkQueue, SampleCount, 256);
- u32 BlockCount = Blocks.BlockCount;
- u32 BlockSize = Blocks.BlockSize;
- u32 SamplesLeft = SampleCount;
- f32 *TsAt = Ts;
- v2 *OutSamplesAt = OutSamples;
- 
- calc_parametric_work *Works = PushArray(Temp.Arena, BlockCount, calc_parametric_work);
+ curve_params *Params = &Curve->Params;
+ curve_points *Points = GetCurvePoints(Curve);
+ u32 PointCount = Points->ControlPointCount;
+ v2 *Controls = Points->ControlPoints;
+ f32 *Weights = Points->ControlPointWeights;
+ u32 SampleCount = Curve->CurveSampleCount;
+ v2 *Samples = Curve->CurveSamples;
+ curve_basis_cache *Cache = &Curve->BasisCache;
+ b32 IsBezier = (Params->Type == Curve_Bezier);
  
- ForEachIndex(BlockIndex, BlockCount)
+ u64 Size = (Cast(u64)SampleCount * PointCount * SizeOf(f32) +
+             Cast(u64)SampleCount * (SizeOf(f32) + 3 * SizeOf(f64)) +
+             Cast(u64)PointCount * (SizeOf(v2) + SizeOf(f32)));
+ b32 Fits = (Size <= CurveBasisCacheMaxSize && PointCount >= 2 && SampleCount >= 2);
+ if (Fits)
  {
-  u32 BlockSampleCount = Min(SamplesLeft, BlockSize);
+  ProfileFunctionBegin();
+  
+  temp_arena Temp = TempArena(Cache->Arena);
+  
+  //- Ts samples are at
+  f32 *Ts = 0;
+  polynomial_eval_input Poly = {};
+  if (IsBezier)
+  {
+   Ts = Curve->Ts;
+  }
+  else
+  {
+   // NOTE(hbr): Basis doesn't depend on the form polynomial is evaluated in, barycentric is the handiest
+   polynomial_interpolation_params Polynomial = Params->Polynomial;
+   Polynomial.Type = PolynomialInterpolation_Barycentric;
+   Poly = MakePolynomialEvalInput(Temp.Arena, Controls, PointCount, Polynomial);
+   Ts = PushArrayNonZero(Temp.Arena, SampleCount, f32);
+   PolynomialSampleTs(Poly.Ti, PointCount, Params->SamplesPerControlPoint, Ts);
+   Ts[SampleCount - 1] = Poly.Ti[PointCount - 1];
+  }
+  
+  //- basis
+  if (Cache->Type != Params->Type ||
+      Cache->PointCount != PointCount ||
+      Cache->SampleCount != SampleCount ||
+      !MemoryEqual(Cache->Ts, Ts, SampleCount * SizeOf(Ts[0])))
+  {
+   arena *Arena = CurveCacheArena(&Cache->Arena);
+   ClearArena(Arena);
+   
+   Cache->Type = Params->Type;
+   Cache->PointCount = PointCount;
+   Cache->SampleCount = SampleCount;
+   Cache->Ts = PushArrayNonZero(Arena, SampleCount, f32);
+   Cache->Basis = PushArrayNonZero(Arena, Cast(u64)SampleCount * PointCount, f32);
+   Cache->SumsValid = false;
+   Cache->Controls = PushArrayNonZero(Arena, PointCount, v2);
+   Cache->Weights = PushArrayNonZero(Arena, PointCount, f32);
+   Cache->SumX = PushArrayNonZero(Arena, SampleCount, f64);
+   Cache->SumY = PushArrayNonZero(Arena, SampleCount, f64);
+   Cache->SumW = PushArrayNonZero(Arena, SampleCount, f64);
+   ArrayCopy(Cache->Ts, Ts, SampleCount);
+   
+   if (IsBezier)
+   {
+    CalcBernsteinBasis(PointCount - 1, SampleCount, Ts, Cache->Basis);
+   }
+   else
+   {
+    CalcLagrangeBasis(Poly.Omega, Poly.Ti, PointCount, SampleCount, Ts, Cache->Basis);
+   }
+  }
+  
+  //- sums
+  if (!Cache->SumsValid)
+  {
+   ForEachIndex(SampleIndex, SampleCount)
+   {
+    Cache->SumX[SampleIndex] = 0.0;
+    Cache->SumY[SampleIndex] = 0.0;
+    Cache->SumW[SampleIndex] = 0.0;
+   }
+  }
+  for (u32 PointIndex = 0;
+       PointIndex < PointCount;
+       ++PointIndex)
+  {
+   // NOTE(hbr): Polynomial doesn't care about weights
+   v2 P = Controls[PointIndex];
+   f32 W = (IsBezier ? Weights[PointIndex] : 1.0f);
+   v2 PrevP = Cache->Controls[PointIndex];
+   f32 PrevW = Cache->Weights[PointIndex];
+   if (!Cache->SumsValid)
+   {
+    AddCurveBasisColumn(Cache, PointIndex, W * P.X, W * P.Y, W);
+   }
+   else if (P != PrevP || W != PrevW)
+   {
+    AddCurveBasisColumn(Cache, PointIndex,
+                        Cast(f64)W * P.X - Cast(f64)PrevW * PrevP.X,
+                        Cast(f64)W * P.Y - Cast(f64)PrevW * PrevP.Y,
+                        Cast(f64)W - PrevW);
+   }
+   Cache->Controls[PointIndex] = P;
+   Cache->Weights[PointIndex] = W;
+  }
+  Cache->SumsValid = true;
   
-  calc_parametric_work *Work = Works + BlockIndex;
-  Work->X_Expr = X_Expr;
-  Work->Y_Expr = Y_Expr;
-  Work->SampleCount = BlockSampleCount;
-  Work->Ts = TsAt;
-  Work->OutSamples = OutSamplesAt;
+  //- samples
+  ForEachIndex(SampleIndex, SampleCount)
+  {
+   f64 X = Cache->SumX[SampleIndex];
+   f64 Y = Cache->SumY[SampleIndex];
+   if (IsBezier)
+   {
+    f64 W = Cache->SumW[SampleIndex];
+    X /= W;
+    Y /= W;
+   }
+   Samples[SampleIndex] = V2(Cast(f32)X, Cast(f32)Y);
+  }
   
-  Platform.WorkQueueAddEntry(WorkQueue, CalcParametric_Work, Work);
+  EndTemp(Temp);
   
-  TsAt += BlockSampleCount;
-  OutSamplesAt += BlockSampleCount;
-  SamplesLeft -= BlockSampleCount;
+  ProfileEnd();
  }
  
- Platform.WorkQueueCompleteAllWork(WorkQueue);
- 
- EndTemp(Temp);
- 
- ProfileEnd();
+ return Fits;
 }
 
-internal void
-CalcParametric(arena *Arena,
-               parametric_curve_resources *Parametric,
-               u32 SampleCount, v2 *OutSamples)
+// NOTE(hbr): NURBS and cubic Bezier spline have local support - control point only moves
+// the curve over a few spans around it. If only control points [ControlBegin, ControlEnd)
+// moved since the last full recompute, re-evaluate and re-tessellate just the affected
+// samples in place. Rational Bezier and polynomial move everywhere, but their samples are
+// updated with the cached basis, in O(samples) instead of O(samples * points).
+// Returns false if that is not possible, then full RecomputeCurve is needed.
+// Convex hull of all the control points is still recomputed fully and arc length table has
+// to shift its tail, both are much cheaper than evaluating the curve.
+internal b32
+RecomputeCurveControlPointRange(curve *Curve, u32 ControlBegin, u32 ControlEnd)
 {
- ProfileFunctionBegin();
+ curve_params *Params = &Curve->Params;
+ curve_points *Points = GetCurvePoints(Curve);
+ u32 ControlCount = Points->ControlPointCount;
+ v2 *Controls = Points->ControlPoints;
+ f32 *Weights = Points->ControlPointWeights;
+ u32 SampleCount = Curve->CurveSampleCount;
+ v2 *Samples = Curve->CurveSamples;
  
- temp_arena Temp = TempArena(Arena);
+ b32 IsNURBS = (Params->Type == Curve_NURBS);
+ b32 IsBezierSpline = (Params->Type == Curve_Bezier && Params->Bezier == Bezier_CubicSpline);
+ // NOTE(hbr): Point tracking is recomputed only by the full path
+ b32 IsLinear = ((Params->Type == Curve_Bezier && Params->Bezier == Bezier_Rational &&
+                  Curve->Ts != 0 && Curve->PointTracking.Type == PointTrackingAlongCurve_None) ||
+                 (Params->Type == Curve_Polynomial && !IsCurveTotalSamplesMode(Curve)));
  
- u32 MaxVarCount = ArrayCount(Parametric->AdditionalVars);
- u32 VarCount = 0;
- string *VarNames = PushArray(Temp.Arena, MaxVarCount, string);
- f32 *VarValues = PushArray(Temp.Arena, MaxVarCount, f32);
+ b32 Local = ((IsNURBS || IsBezierSpline || IsLinear) &&
+              !IsCurveAdaptiveSamplingMode(Curve) &&
+              ControlBegin < ControlEnd && ControlEnd <= ControlCount &&
+              ControlCount >= 2 &&
+              SampleCount >= 2 && SampleCount == CurveUniformSampleCount(Curve) &&
+              Curve->CurveVertexOffsets &&
+              Curve->PolylinePointCount == ControlCount);
  
- ForEachElement(AdditionalVarIndex, Parametric->AdditionalVars)
+ b_spline_knot_params KnotParams = {};
+ curve_nurbs_extraction_cache *Cache = &Curve->NURBS_Extraction;
+ if (Local && IsNURBS)
  {
-  parametric_curve_field *Var = Parametric->AdditionalVars + AdditionalVarIndex;
-  if (IsParametricCurveVarActive(Var))
+  // NOTE(hbr): Knots have to be exactly the ones everything was computed from
+  KnotParams = GetBSplineParams(Curve).KnotParams;
+  Local = (Curve->Ts != 0 &&
+           StructsEqual(&Curve->ComputedBSplineParams, &Params->BSpline) &&
+           StructsEqual(&Cache->KnotParams, &KnotParams) &&
+           Cache->ControlCount == ControlCount &&
+           Curve->BSplineConvexHullCount == ControlCount - KnotParams.Degree);
+ }
+ 
+ if (Local && IsLinear)
+ {
+  Local = UpdateCurveSamplesWithBasis(Curve);
+ }
+ 
+ if (Local)
+ {
+  ProfileFunctionBegin();
+  
+  temp_arena Temp = TempArena(Curve->ComputeArena);
+  
+  //- find affected samples
+  f32 BeginT = 0.0f;
+  f32 EndT = 0.0f;
+  if (IsLinear)
   {
-   string VarName = StringFromStringId(Var->VarName);
-   CalcParametricCurveField(Arena, Var, true, VarCount, VarNames, VarValues);
-   f32 VarValue = ParametricCurveVarValue(Var);
+   BeginT = -F32_INF;
+   EndT = F32_INF;
+  }
+  else if (IsNURBS)
+  {
+   // NOTE(hbr): Control I has support [Knots[I], Knots[I+Degree+1]]
+   f32 *Knots = Points->BSplineKnots;
+   BeginT = Knots[ControlBegin];
+   EndT = Knots[ControlEnd + KnotParams.Degree];
+  }
+  else
+  {
+   // NOTE(hbr): Control I moves the segments on both of its sides
+   f32 SegmentCount = Cast(f32)(ControlCount - 1);
+   BeginT = (ControlBegin > 0 ? (ControlBegin - 1) / SegmentCount : 0.0f);
+   EndT = Min(ControlEnd / SegmentCount, 1.0f);
+  }
+  u32 SampleBegin = CurveSampleIndexAtT(Curve, BeginT);
+  u32 SampleEnd = Min(CurveSampleIndexAtT(Curve, EndT) + 2, SampleCount);
+  u32 DirtySampleCount = SampleEnd - SampleBegin;
+  
+  //- re-evaluate them
+  if (IsLinear)
+  {
+   // NOTE(hbr): Already done by UpdateCurveSamplesWithBasis
+  }
+  else if (IsNURBS)
+  {
+   f32 *Knots = Points->BSplineKnots;
+   u32 Degree = KnotParams.Degree;
    
-   Assert(VarCount < MaxVarCount);
-   VarNames[VarCount] = VarName;
-   VarValues[VarCount] = VarValue;
-   ++VarCount;
+   ArrayCopy(Cache->Controls + ControlBegin, Controls + ControlBegin, ControlEnd - ControlBegin);
+   ArrayCopy(Cache->Weights + ControlBegin, Weights + ControlBegin, ControlEnd - ControlBegin);
+   NURBS_BezierExtractionUpdate(&Cache->Extraction, Cache->Controls, Cache->Weights, KnotParams, Cache->Knots, ControlBegin, ControlEnd);
+   
+   CalcNURBS(Controls, Weights, KnotParams, Knots, &Cache->Extraction,
+             DirtySampleCount, Curve->Ts + SampleBegin, Samples + SampleBegin);
+   
+   // NOTE(hbr): Partition knot J sits at Knots[Degree+J]
+   u32 KnotBegin = (ControlBegin > Degree ? ControlBegin - Degree : 0);
+   u32 KnotEnd = Min(ControlEnd + 1, KnotParams.PartitionSize);
+   if (KnotBegin < KnotEnd)
+   {
+    CalcNURBS(Controls, Weights, KnotParams, Knots, &Cache->Extraction,
+              KnotEnd - KnotBegin, Knots + Degree + KnotBegin, Curve->BSplinePartitionKnots + KnotBegin);
+   }
+  }
+  else
+  {
+   // NOTE(hbr): Exactly the Ts CalcBezierCubicSpline uses, otherwise the tiniest difference
+   // can flip the turn direction of almost straight stroke parts
+   f32 *Ts = PushArrayNonZero(Temp.Arena, DirtySampleCount, f32);
+   f32 Delta_T = 1.0f / (SampleCount - 1);
+   ForEachIndex(Index, DirtySampleCount)
+   {
+    Ts[Index] = (SampleBegin + Index) * Delta_T;
+   }
+   CalcBezierCubicSplineAtTs(Points->CubicBezierPoints, ControlCount, DirtySampleCount, Ts, Samples + SampleBegin);
+  }
+  
+  //- arc length
+  {
+   curve_arc_length_table *Table = &Curve->ArcLength;
+   f32 *Lengths = Table->Lengths;
+   u32 LengthBegin = Max(SampleBegin, 1);
+   u32 LengthEnd = Min(SampleEnd + 1, SampleCount);
+   f32 OldLength = Lengths[LengthEnd - 1];
+   for (u32 Index = LengthBegin;
+        Index < LengthEnd;
+        ++Index)
+   {
+    Lengths[Index] = Lengths[Index - 1] + Norm(Samples[Index] - Samples[Index - 1]);
+   }
+   f32 Delta = Lengths[LengthEnd - 1] - OldLength;
+   for (u32 Index = LengthEnd;
+        Index < SampleCount;
+        ++Index)
+   {
+    Lengths[Index] += Delta;
+   }
+   Table->TotalLength = Lengths[SampleCount - 1];
+  }
+  
+  //- strokes
+  StrokeRetessellateRange(&Curve->CurveVertices, Curve->CurveVertexOffsets,
+                          SampleCount, Samples, Params->DrawParams.Line.Width,
+                          SampleBegin, SampleEnd);
+  StrokeRetessellateRange(&Curve->PolylineVertices, Curve->PolylineVertexOffsets,
+                          ControlCount, Controls, Params->DrawParams.Polyline.Width,
+                          ControlBegin, ControlEnd);
+  
+  //- hulls
+  Curve->ConvexHullCount = CalcConvexHull(ControlCount, Controls, Curve->ConvexHullPoints);
+  Curve->ConvexHullVertices = StrokeTessellate_CustomWithoutOverlapInto(Curve->ConvexHullVertices.Vertices,
+                                                                        Curve->ConvexHullCount, Curve->ConvexHullPoints,
+                                                                        Params->DrawParams.ConvexHull.Width, true, 0);
+  if (IsNURBS)
+  {
+   // NOTE(hbr): Hull I is made of controls [I, I+Degree]
+   u32 Degree = KnotParams.Degree;
+   u32 HullBegin = (ControlBegin > Degree ? ControlBegin - Degree : 0);
+   u32 HullEnd = Min(ControlEnd, Curve->BSplineConvexHullCount);
+   for (u32 HullIndex = HullBegin;
+        HullIndex < HullEnd;
+        ++HullIndex)
+   {
+    b_spline_convex_hull *Hull = Curve->BSplineConvexHulls + HullIndex;
+    Hull->PointCount = CalcConvexHull(Degree + 1, Controls + HullIndex, Hull->Points);
+    Hull->Vertices = StrokeTessellate_CustomWithoutOverlapInto(Hull->Vertices.Vertices, Hull->PointCount, Hull->Points,
+                                                               Params->DrawParams.BSplinePartialConvexHull.Width, true, 0);
+   }
   }
+  
+  EndTemp(Temp);
+  
+  ProfileEnd();
  }
  
- CalcParametricCurveField(Arena, &Parametric->X_Equation, false, VarCount, VarNames, VarValues);
- CalcParametricCurveField(Arena, &Parametric->Y_Equation, false, VarCount, VarNames, VarValues);
- 
- parametric_equation_expr *X_Expr = Parametric->X_Equation.Cached.EvalExpr;
- parametric_equation_expr *Y_Expr = Parametric->Y_Equation.Cached.EvalExpr;
- 
- CalcParametricCurveField(Arena, &Parametric->MinT_Var, true, VarCount, VarNames, VarValues);
- CalcParametricCurveField(Arena, &Parametric->MaxT_Var, true, VarCount, VarNames, VarValues);
+ return Local;
+}
+
+
+// NOTE(hbr): The same parameters CalcCurve spreads its samples at. Polynomial and NURBS
+// put the same number of samples into every segment, the rest are spaced evenly.
+internal f32 *
+CurveUniformSampleTs(arena *Arena, curve_sampler *Sampler, u32 SampleCount)
+{
+ f32 *Ts = PushArrayNonZero(Arena, SampleCount, f32);
+ u32 BreakCount = Sampler->BreakCount;
+ f32 *Breaks = Sampler->Breaks;
+ if (SampleCount > 0 && BreakCount > 0)
+ {
+  f32 MinT = Breaks[0];
+  f32 MaxT = Breaks[BreakCount - 1];
+  if (Sampler->Type == Curve_Polynomial || Sampler->Type == Curve_NURBS)
+  {
+   u32 SegmentCount = BreakCount - 1;
+   u32 SamplesPerSegment = SafeDiv0(SampleCount - 1, SegmentCount);
+   u32 SampleIndex = 0;
+   ForEachIndex(SegmentIndex, SegmentCount)
+   {
+    f32 A = Breaks[SegmentIndex];
+    f32 B = Breaks[SegmentIndex + 1];
+    f32 Delta_T = (B - A) / SamplesPerSegment;
+    f32 T = A;
+    ForEachIndex(Index, SamplesPerSegment)
+    {
+     Ts[SampleIndex++] = T;
+     T += Delta_T;
+    }
+   }
+   while (SampleIndex < SampleCount)
+   {
+    Ts[SampleIndex++] = MaxT;
+   }
+  }
+  else
+  {
+   f32 T = MinT;
+   f32 Delta_T = SafeDiv0(MaxT - MinT, Cast(f32)(SampleCount - 1));
+   ForEachIndex(SampleIndex, SampleCount)
+   {
+    Ts[SampleIndex] = T;
+    T += Delta_T;
+   }
+   Ts[SampleCount - 1] = MaxT;
+  }
+ }
+ else
+ {
+  ArrayZero(Ts, SampleCount);
+ }
  
- f32 MinT = ParametricCurveVarValue(&Parametric->MinT_Var);
- f32 MaxT = ParametricCurveVarValue(&Parametric->MaxT_Var);
- // NOTE(hbr): Adjust for safety
- MaxT = Max(MinT, MaxT);
+ return Ts;
+}
+
+struct curve_recompute_batch_entry
+{
+ curve *Curve;
+ curve_eval_cache_key Key;
+ curve_sampler Sampler;
+ u32 SampleOffset;
+ u32 SampleCount;
+ f32 *Ts;
+ v2 *Samples;
+};
+
+struct curve_recompute_batch_work
+{
+ u32 EntryCount;
+ curve_recompute_batch_entry *Entries;
+ u32 Begin;
+ u32 End;
+};
+
+internal void
+RecomputeCurveBatch_Work(void *UserData)
+{
+ curve_recompute_batch_work *Work = Cast(curve_recompute_batch_work *)UserData;
+ curve_recompute_batch_entry *Entries = Work->Entries;
  
- f32 T = MinT;
- f32 DeltaT = (MaxT - MinT) / (SampleCount - 1);
- f32 *Ts = PushArrayNonZero(Temp.Arena, SampleCount, f32);
- ForEachIndex(SampleIndex, SampleCount)
+ // NOTE(hbr): Blocks are cut from samples of all curves laid out one after another, so
+ // a block can span several curves. Find the last curve starting at or before the block.
+ u32 Lo = 0;
+ u32 Hi = Work->EntryCount;
+ while (Hi - Lo > 1)
  {
-  Ts[SampleIndex] = T;
-  T += DeltaT;
+  u32 Mid = (Lo + Hi) / 2;
+  if (Entries[Mid].SampleOffset <= Work->Begin)
+  {
+   Lo = Mid;
+  }
+  else
+  {
+   Hi = Mid;
+  }
  }
  
- switch (DEBUG_Vars->Parametric_EvalMethod)
+ u32 At = Work->Begin;
+ for (u32 EntryIndex = Lo;
+      EntryIndex < Work->EntryCount && At < Work->End;
+      ++EntryIndex)
  {
-  case Parametric_Eval_SingleThreaded: {
-   CalcParametric_SingleThreaded(X_Expr, Y_Expr, SampleCount, Ts, OutSamples);
-  }break;
-  
-  case Parametric_Eval_MultiThreaded: {
-   CalcParametric_MultiThreaded(X_Expr, Y_Expr, SampleCount, Ts, OutSamples);
-  }break;
-  
-  case Parametric_Eval_Count: InvalidPath;
+  curve_recompute_batch_entry *Entry = Entries + EntryIndex;
+  u32 EntryEnd = Entry->SampleOffset + Entry->SampleCount;
+  if (At < EntryEnd)
+  {
+   u32 Local = At - Entry->SampleOffset;
+   u32 Count = Min(Work->End, EntryEnd) - At;
+   EvalCurveSampler(&Entry->Sampler, Count, Entry->Ts + Local, Entry->Samples + Local);
+   At += Count;
+  }
  }
- 
- EndTemp(Temp);
- 
- ProfileEnd();
 }
 
+// NOTE(hbr): Recomputing curves one by one waits on work queue at least once per curve,
+// and small curves don't even have enough samples to keep all threads busy. Here samples
+// of all curves are split into blocks together and work queue is waited on only once.
 internal void
-CalcCurve(curve *Curve, u32 SampleCount, v2 *OutSamples)
+RecomputeCurves(u32 CurveCount, curve **Curves)
 {
  ProfileFunctionBegin();
  
  temp_arena Temp = TempArena(0);
- 
- curve_points_static *Points = GetCurvePoints(Curve);
- u32 PointCount = Points->ControlPointCount;
- v2 *Controls = Points->ControlPoints;
- f32 *Weights = Points->ControlPointWeights;
- cubic_bezier_point *Beziers = Points->CubicBezierPoints;
- curve_params *Params = &Curve->Params;
- f32 *BSplineKnots = Points->BSplineKnots;
- u32 SamplesPerControlPoint = Params->SamplesPerControlPoint;
- parametric_curve_resources *Parametric = &Curve->ParametricResources;
- arena *ComputeArena = Curve->ComputeArena;
- 
- switch (Params->Type)
- {
-  case Curve_Polynomial: {CalcPolynomial(Controls, PointCount, Params->Polynomial, SampleCount, OutSamples, SamplesPerControlPoint);} break;
-  case Curve_CubicSpline: {CalcCubicSpline(Controls, PointCount, Params->CubicSpline, SampleCount, OutSamples);} break;
+ work_queue *WorkQueue = CurveComputeQueue();
+ work_queue_group Group = {};
+ 
+ curve_recompute_batch_entry *Entries = PushArrayNonZero(Temp.Arena, CurveCount, curve_recompute_batch_entry);
+ u32 EntryCount = 0;
+ u32 TotalSampleCount = 0;
+ u32 RequestBlockSize = U32_MAX;
+ curve_eval_cache *Cache = CurveEvalCacheOnThisThread();
+ ForEachIndex(CurveIndex, CurveCount)
+ {
+  curve *Curve = Curves[CurveIndex];
+  PrepareCurveForEval(Curve);
+  curve_eval_cache_key Key = {};
+  curve_eval_cache_entry *Cached = 0;
+  if (Cache)
+  {
+   Key = MakeCurveEvalCacheKey(Temp.Arena, Curve);
+   Cached = CurveEvalCacheLookup(Cache, Key);
+  }
   
-  case Curve_Bezier: {
-   switch (Params->Bezier)
+  if (Cached)
+  {
+   RecomputeCurveFromEvalCache(Curve, Cached);
+  }
+  else if (IsCurveAdaptiveSamplingMode(Curve))
+  {
+   // NOTE(hbr): Every subdivision level depends on the previous one, there is nothing to batch
+   RecomputeCurveUncached(Curve);
+   if (Cache)
    {
-    case Bezier_Rational: {CalcBezierRational(Curve, Controls, Weights, PointCount, SampleCount, OutSamples);}break;
-    case Bezier_CubicSpline: {CalcBezierCubicSpline(Beziers, PointCount, SampleCount, OutSamples);}break;
-    case Bezier_Count: InvalidPath;
+    CurveEvalCacheInsert(Cache, Key, Curve);
    }
-  } break;
-  
-  case Curve_NURBS: {
-   MaybeRecomputeCurveBSplineKnots(Curve, false);
-   
-   b_spline_knot_params KnotParams = GetBSplineParams(Curve).KnotParams;
-   u32 PartitionSize = KnotParams.PartitionSize;
-   u32 Degree = KnotParams.Degree;
-   Points->BSplineKnotCount = KnotParams.KnotCount;
-   
-   v2 *PartitionKnots = PushArrayNonZero(Curve->ComputeArena, PartitionSize, v2);
-   CalcNURBS(Controls,
-             Weights,
-             KnotParams,
-             BSplineKnots,
-             PartitionSize,
-             BSplineKnots + Degree,
-             PartitionKnots);
-   
-   Curve->BSplinePartitionKnots = PartitionKnots;
+  }
+  else
+  {
+   arena *ComputeArena = Curve->ComputeArena;
+   ClearArena(ComputeArena);
+   Curve->SegmentSampleIndexCount = 0;
+   Curve->SegmentSampleIndices = 0;
    
-   f32 *Ts = PushArrayNonZero(ComputeArena, SampleCount, f32);
-   // NOTE(hbr): Calculate sample point fractions
-   {
-    u32 SegmentCount = PartitionSize - 1;
-    u32 SamplesPerSegment = (SampleCount - 1) / SegmentCount;
-    u32 SampleIndex = 0;
-    f32 *Knot_Ts = BSplineKnots + Degree;
-    
-    f32 T = KnotParams.A;
-    
-    for (u32 I = 0;
-         I < SegmentCount;
-         ++I)
-    {
-     f32 A = Knot_Ts[I];
-     f32 B = Knot_Ts[I+1];
-     
-     f32 Delta_T = (B - A) / SamplesPerSegment;
-     ForEachIndex(J, SamplesPerSegment)
-     {
-      Ts[SampleIndex++] = T;
-      T += Delta_T;
-     }
-     
-    }
-    
-    // NOTE(hbr): Pure safety, make sure we end at KnotParams.B
-    if (SampleIndex < SampleCount)
-    {
-     while (SampleIndex < SampleCount)
-     {
-      Ts[SampleIndex++] = KnotParams.B;
-     }
-    }
-    else
-    {
-     if (SampleCount > 0)
-     {
-      Ts[SampleCount - 1] = KnotParams.B;
-     }
-    }
-    
-    Curve->Ts = Ts;
-   }
+   curve_recompute_batch_entry *Entry = Entries + EntryCount++;
+   Entry->Curve = Curve;
+   Entry->Key = Key;
+   Entry->Sampler = MakeCurveSampler(ComputeArena, Curve);
+   Entry->SampleOffset = TotalSampleCount;
+   Entry->SampleCount = CurveUniformSampleCount(Curve);
+   Entry->Ts = CurveUniformSampleTs(ComputeArena, &Entry->Sampler, Entry->SampleCount);
+   Entry->Samples = PushArrayNonZero(ComputeArena, Entry->SampleCount, v2);
+   Curve->Ts = (CurveKeepsSampleTs(Curve) ? Entry->Ts : 0);
    
-   CalcNURBS(Controls,
-             Weights,
-             KnotParams,
-             BSplineKnots,
-             SampleCount,
-             Ts,
-             OutSamples);
-  }break;
+   TotalSampleCount += Entry->SampleCount;
+   RequestBlockSize = Min(RequestBlockSize, CurveSamplerBlockSize(&Entry->Sampler));
+  }
+ }
+ 
+ if (TotalSampleCount > 0)
+ {
+  work_queue_blocks Blocks = WorkQueueCalculateBlocks(WorkQueue, TotalSampleCount, RequestBlockSize);
+  u32 BlockCount = Blocks.BlockCount;
+  u32 BlockSize = Blocks.BlockSize;
   
-  case Curve_Parametric: {CalcParametric(ComputeArena, Parametric, SampleCount, OutSamples);}break;
+  curve_recompute_batch_work *Works = PushArray(Temp.Arena, BlockCount, curve_recompute_batch_work);
+  u32 Begin = 0;
+  ForEachIndex(BlockIndex, BlockCount)
+  {
+   curve_recompute_batch_work *Work = Works + BlockIndex;
+   Work->EntryCount = EntryCount;
+   Work->Entries = Entries;
+   Work->Begin = Begin;
+   Work->End = Min(Begin + BlockSize, TotalSampleCount);
+   Begin = Work->End;
+  }
+  Assert(Begin == TotalSampleCount);
   
-  case Curve_Count: InvalidPath;
+  ComputeQueueAddEntries(WorkQueue, &Group, RecomputeCurveBatch_Work, Works, SizeOf(Works[0]), BlockCount);
+  ComputeQueueCompleteGroup(WorkQueue, &Group);
+ }
+ 
+ ForEachIndex(EntryIndex, EntryCount)
+ {
+  curve_recompute_batch_entry *Entry = Entries + EntryIndex;
+  curve *Curve = Entry->Curve;
+  RecomputeCurveFromSamples(Curve, Entry->SampleCount, Entry->Samples, 0);
+  if (Cache)
+  {
+   CurveEvalCacheInsert(Cache, Entry->Key, Curve);
+  }
  }
  
  EndTemp(Temp);
@@ -5619,135 +9979,241 @@ CalcCurve(curve *Curve, u32 SampleCount, v2 *OutSamples)
  ProfileEnd();
 }
 
-// TODO(hbr): This function needs some serious refactoring.
-// First of all, don't break down all the "Compute" functions into hierarchical structure.
-// It's very fragile. It's just better (I think) to duplicate some code but have it more independent.
-// Second of all just refactor stupid code duplication here.
-// Basically inline everything and work your way up from there.
-// Then parallelize this heavily. I mean, we can unroll, we can simd, we can multithread this.
+#define CurveAsyncRecomputeMinSampleCount 8192
+
+internal b32
+IsCurveAsyncRecomputeBusy(curve *Curve)
+{
+ curve_async_recompute *Async = &Curve->AsyncRecompute;
+ b32 Busy = (Async->Pending || Async->State != CurveAsyncRecompute_Idle);
+ return Busy;
+}
+
+internal b32
+ShouldRecomputeCurveAsync(curve *Curve)
+{
+ // NOTE(hbr): There has to be something to display until the first result lands
+ // NOTE(hbr): Curve seen before is just copied from cache, no need to wait for it
+ b32 Result = (DEBUG_Vars->AsyncCurveRecompute &&
+               Curve->CurveSamples != 0 &&
+               CurveUniformSampleCount(Curve) >= CurveAsyncRecomputeMinSampleCount &&
+               !IsCurveInEvalCache(Curve));
+ return Result;
+}
+
+struct curve_async_recompute_work
+{
+ curve_async_recompute *Async;
+ curve *Curve;
+ entity Snapshot;
+ curve_points Points;
+};
+
 internal void
-RecomputeCurve(curve *Curve)
+RecomputeCurveAsync_Work(void *UserData)
 {
- ProfileFunctionBegin();
+ curve_async_recompute_work *Work = Cast(curve_async_recompute_work *)UserData;
  
- curve_params *Params = &Curve->Params;
- arena *ComputeArena = Curve->ComputeArena;
- curve_points_static *Points = GetCurvePoints(Curve);
- u32 ControlCount = Points->ControlPointCount;
- v2 *Controls = Points->ControlPoints;
- f32 *Weights = Points->ControlPointWeights;
- f32 LineWidth = Params->DrawParams.Line.Width;
+ // NOTE(hbr): Main thread runs this itself when it waits for the recompute before it started,
+ // so leave its thread state as it was
+ b32 ComputedInPlace = GlobalThreadComputesInPlace;
+ b32 ProfilerDisabled = ProfilerIsDisabledOnThisThread();
+ GlobalThreadComputesInPlace = true;
+ ProfilerDisableOnThisThread();
  
- ClearArena(ComputeArena);
+ curve *Snapshot = &Work->Snapshot.Curve;
+ RecomputeCurve(Snapshot);
  
- u32 SampleCount = 0;
- if (IsCurveTotalSamplesMode(Curve))
+ // NOTE(hbr): Snapshot rebuilt caches in the arenas it shares with the curve, so the curve
+ // has to describe them the same way, whether this result lands or is dropped
+ Work->Curve->NURBS_Extraction = Snapshot->NURBS_Extraction;
+ Work->Curve->BasisCache = Snapshot->BasisCache;
+ 
+ GlobalThreadComputesInPlace = ComputedInPlace;
+ if (!ProfilerDisabled)
  {
-  SampleCount = Curve->Params.TotalSamples;
+  ProfilerEnableOnThisThread();
  }
- else
+ 
+ CompilerWriteBarrier;
+ Work->Async->State = CurveAsyncRecompute_Done;
+}
+
+internal void
+WaitForCurveAsyncRecompute(curve *Curve)
+{
+ curve_async_recompute *Async = &Curve->AsyncRecompute;
+ if (Async->State == CurveAsyncRecompute_Running)
  {
-  u32 ControlCountWithLooped = (IsCurveLooped(Curve) ? ControlCount + 1 : ControlCount);
-  if (ControlCountWithLooped > 0)
-  {
-   SampleCount = (ControlCountWithLooped - 1) * Params->SamplesPerControlPoint + 1;
-  }
+  Platform.WorkQueueCompleteGroup(GetCtx()->LowPriorityQueue, &Async->Group);
  }
- v2 *Samples = PushArrayNonZero(ComputeArena, SampleCount, v2);
- CalcCurve(Curve, SampleCount, Samples);
+ Assert(Async->State != CurveAsyncRecompute_Running);
+}
+
+internal void
+LaunchCurveAsyncRecompute(entity *Entity)
+{
+ curve *Curve = &Entity->Curve;
+ curve_async_recompute *Async = &Curve->AsyncRecompute;
+ Assert(Async->State == CurveAsyncRecompute_Idle);
+ 
+ // NOTE(hbr): Knots are edited from UI as well, fix them up here and not on the snapshot
+ if (Curve->Params.Type == Curve_NURBS)
+ {
+  MaybeRecomputeCurveBSplineKnots(Curve, false);
+  GetCurvePoints(Curve)->BSplineKnotCount = GetBSplineParams(Curve).KnotParams.KnotCount;
+  // NOTE(hbr): Snapshot rebuilds the extraction in this arena, have it before snapshot is taken
+  CurveCacheArena(&Curve->NURBS_Extraction.Arena);
+ }
+ 
+ arena *Arena = EnsureArenaFromStore(GetCtx()->ArenaStore, &Async->SnapshotArena, Megabytes(1), MemoryTag_CurveAsyncRecompute);
+ arena *BackArena = EnsureArenaFromStore(GetCtx()->ArenaStore, &Async->BackArena, Megabytes(32), MemoryTag_CurveAsyncRecompute);
+ ClearArena(Arena);
+ curve_async_recompute_work *Work = PushStructNonZero(Arena, curve_async_recompute_work);
+ Work->Async = Async;
+ Work->Curve = Curve;
+ Work->Snapshot = *Entity;
+ CopyCurvePointsToArena(Arena, &Work->Points, CurvePointsHandleFromCurvePoints(GetCurvePoints(Curve)));
+ 
+ // NOTE(hbr): Snapshot shares caches (NURBS extraction) with the curve. They are not touched
+ // from main thread until the recompute is done, see IsCurveAsyncRecomputeBusy, and
+ // RecomputeCurveAsync_Work hands them back to the curve before that.
+ curve *Snapshot = &Work->Snapshot.Curve;
+ Snapshot->SnapshotPoints = &Work->Points;
+ Snapshot->ComputeArena = BackArena;
  
- vertex_array CurveVertices = ComputeVerticesOfThickLine(ComputeArena, SampleCount, Samples, LineWidth, IsCurveLooped(Curve));
- vertex_array PolylineVertices = ComputeVerticesOfThickLine(ComputeArena, ControlCount, Controls, Params->DrawParams.Polyline.Width, false);
+ Async->Work = Work;
+ Async->Version = Entity->Version;
+ Async->Pending = false;
+ Async->State = CurveAsyncRecompute_Running;
  
- v2 *ConvexHullPoints = PushArrayNonZero(ComputeArena, ControlCount, v2);
- u32 ConvexHullCount = CalcConvexHull(ControlCount, Controls, ConvexHullPoints);
- vertex_array ConvexHullVertices = ComputeVerticesOfThickLine(ComputeArena, ConvexHullCount, ConvexHullPoints, Params->DrawParams.ConvexHull.Width, true);
+ Platform.WorkQueueAddGroupEntry(GetCtx()->LowPriorityQueue, &Async->Group, RecomputeCurveAsync_Work, Work);
+}
+
+internal void
+ApplyCurveAsyncRecompute(entity *Entity)
+{
+ curve *Curve = &Entity->Curve;
+ curve_async_recompute *Async = &Curve->AsyncRecompute;
+ curve *Snapshot = &Async->Work->Snapshot.Curve;
+ Assert(Snapshot->ComputeArena == Async->BackArena);
+ 
+ Swap(Curve->ComputeArena, Async->BackArena, arena *);
+ Curve->CurveSampleCount = Snapshot->CurveSampleCount;
+ Curve->CurveSamples = Snapshot->CurveSamples;
+ Curve->Ts = Snapshot->Ts;
+ Curve->SegmentSampleIndexCount = Snapshot->SegmentSampleIndexCount;
+ Curve->SegmentSampleIndices = Snapshot->SegmentSampleIndices;
+ Curve->AdaptiveWorldUnitsPerPixel = Snapshot->AdaptiveWorldUnitsPerPixel;
+ Curve->ArcLength = Snapshot->ArcLength;
+ Curve->ConvexHullCount = Snapshot->ConvexHullCount;
+ Curve->ConvexHullPoints = Snapshot->ConvexHullPoints;
+ Curve->CurveVertices = Snapshot->CurveVertices;
+ Curve->PolylineVertices = Snapshot->PolylineVertices;
+ Curve->ConvexHullVertices = Snapshot->ConvexHullVertices;
+ Curve->CurveVertexOffsets = Snapshot->CurveVertexOffsets;
+ Curve->PolylinePointCount = Snapshot->PolylinePointCount;
+ Curve->PolylineVertexOffsets = Snapshot->PolylineVertexOffsets;
+ Curve->BSplinePartitionKnotCount = Snapshot->BSplinePartitionKnotCount;
+ Curve->BSplinePartitionKnots = Snapshot->BSplinePartitionKnots;
+ Curve->BSplineConvexHullCount = Snapshot->BSplineConvexHullCount;
+ Curve->BSplineConvexHulls = Snapshot->BSplineConvexHulls;
  
  point_tracking_along_curve_state *Tracking = &Curve->PointTracking;
- if (IsCurveEligibleForPointTracking(Curve))
- {
-  if (Tracking->Type != PointTrackingAlongCurve_None)
+ point_tracking_along_curve_state *SnapshotTracking = &Snapshot->PointTracking;
+ Tracking->LocalSpaceTrackedPoint = SnapshotTracking->LocalSpaceTrackedPoint;
+ Tracking->Intermediate = SnapshotTracking->Intermediate;
+ Tracking->LineVerticesPerIteration = SnapshotTracking->LineVerticesPerIteration;
+ Tracking->ComputeArenaMark = SnapshotTracking->ComputeArenaMark;
+ if (Async->Version == Entity->Version)
+ {
+  // NOTE(hbr): Tracking is turned off when curve stopped being eligible for it
+  Tracking->Type = SnapshotTracking->Type;
+  
+  // NOTE(hbr): Only when nothing changed since the snapshot, its inputs are the curve's inputs then
+  curve_eval_cache *Cache = GetCtx()->CurveEvalCache;
+  if (Cache)
   {
-   f32 Fraction = Tracking->Fraction;
-   
-   v2 LocalSpaceTrackedPoint = BezierCurveRationalEvaluateScalar(Fraction, Controls, Weights, ControlCount);
-   Tracking->LocalSpaceTrackedPoint = LocalSpaceTrackedPoint;
-   
-   if (Tracking->Type == PointTrackingAlongCurve_DeCasteljauVisualization)
-   {
-    all_de_casteljau_intermediate_results Intermediate = DeCasteljauAlgorithm(ComputeArena, Fraction, Controls, Weights, ControlCount);
-    vertex_array *LineVerticesPerIteration = PushArray(ComputeArena, Intermediate.IterationCount, vertex_array);
-    
-    u32 IterationPointsOffset = 0;
-    for (u32 Iteration = 0;
-         Iteration < Intermediate.IterationCount;
-         ++Iteration)
-    {
-     u32 CurrentIterationPointCount = Intermediate.IterationCount - Iteration;
-     LineVerticesPerIteration[Iteration] = ComputeVerticesOfThickLine(ComputeArena,
-                                                                      CurrentIterationPointCount,
-                                                                      Intermediate.P + IterationPointsOffset,
-                                                                      LineWidth,
-                                                                      false);
-     IterationPointsOffset += CurrentIterationPointCount;
-    }
-    
-    Tracking->Intermediate = Intermediate;
-    Tracking->LineVerticesPerIteration = LineVerticesPerIteration;
-    Tracking->LocalSpaceTrackedPoint = Intermediate.P[Intermediate.TotalPointCount - 1];
-   }
+   temp_arena Temp = TempArena(0);
+   curve_eval_cache_key Key = MakeCurveEvalCacheKey(Temp.Arena, Snapshot);
+   CurveEvalCacheInsert(Cache, Key, Curve);
+   EndTemp(Temp);
   }
  }
- else
- {
-  Tracking->Type = PointTrackingAlongCurve_None;
- }
  
- u32 BSplineConvexHullCount = 0;
- b_spline_convex_hull *BSplineConvexHulls = 0;
- if (IsBSplineCurve(Curve))
+ Async->FrontVersion = Async->Version;
+}
+
+// NOTE(hbr): Called once per frame. Lands finished recomputes and launches the pending ones.
+// Result that is older than what is displayed (curve was recomputed synchronously in the
+// meantime) is stale and dropped. Result older than the entity itself is still landed,
+// otherwise curve edited continuously would never update, the next one catches up.
+internal void
+ProcessCurveAsyncRecomputes(editor *Editor)
+{
+ ProfileFunctionBegin();
+ 
+ entity_array Curves = EntityArrayFromType(Editor->EntityStore, Entity_Curve);
+ ForEachIndex(CurveIndex, Curves.Count)
  {
-  ProfileBlock("B-Spline Stuff in RecomputeCurve")
-  {   
-   b_spline_knot_params BSpline = GetBSplineParams(Curve).KnotParams;
-   u32 Degree = BSpline.Degree;
-   Assert(Degree <= ControlCount);
-   u32 ConvexHullCount = ControlCount - Degree;
-   b_spline_convex_hull *Hulls = PushArray(ComputeArena, ConvexHullCount, b_spline_convex_hull);
-   ForEachIndex(ConvexHullIndex, ConvexHullCount)
+  entity *Entity = Curves.Entities[CurveIndex];
+  curve_async_recompute *Async = &Entity->Curve.AsyncRecompute;
+  
+  if (Async->State == CurveAsyncRecompute_Done)
+  {
+   if (Async->Version > Async->FrontVersion)
    {
-    u32 PointCount = Degree + 1;
-    v2 *Points = PushArray(ComputeArena, PointCount, v2);
-    PointCount = CalcConvexHull(PointCount, Controls + ConvexHullIndex, Points);
-    vertex_array Vertices = ComputeVerticesOfThickLine(ComputeArena, PointCount, Points, Params->DrawParams.BSplinePartialConvexHull.Width, true);
-    b_spline_convex_hull *Hull = Hulls + ConvexHullIndex;
-    Hull->Points = Points;
-    Hull->Vertices = Vertices;
+    ApplyCurveAsyncRecompute(Entity);
    }
-   BSplineConvexHullCount = ConvexHullCount;
-   BSplineConvexHulls = Hulls;
+   Async->State = CurveAsyncRecompute_Idle;
+  }
+  
+  if (Async->State == CurveAsyncRecompute_Idle && Async->Pending)
+  {
+   LaunchCurveAsyncRecompute(Entity);
   }
  }
  
- Curve->CurveSampleCount = SampleCount;
- Curve->CurveSamples = Samples;
- Curve->CurveVertices = CurveVertices;
- Curve->PolylineVertices = PolylineVertices;
- Curve->ConvexHullPoints = ConvexHullPoints;
- Curve->ConvexHullCount = ConvexHullCount;
- Curve->ConvexHullVertices = ConvexHullVertices;
- Curve->BSplineConvexHullCount = BSplineConvexHullCount;
- Curve->BSplineConvexHulls = BSplineConvexHulls;
- 
  ProfileEnd();
 }
 
+// NOTE(hbr): Curve was just recomputed synchronously, whatever is in flight is stale now
+internal void
+MarkCurveRecomputed(entity *Entity)
+{
+ curve_async_recompute *Async = &Entity->Curve.AsyncRecompute;
+ Async->Pending = false;
+ Async->FrontVersion = Entity->Version;
+}
+
 internal void
 MarkEntityModified(entity_with_modify_witness *Witness)
 {
  Witness->Modified = true;
 }
 
+internal void
+MarkCurveRecomputeStages(entity_with_modify_witness *Witness, curve_recompute_stage_flags Stages)
+{
+ Witness->DirtyStages |= Stages;
+}
+
+internal void
+MarkEntityControlPointModified(entity_with_modify_witness *Witness, u32 ControlPointIndex)
+{
+ if (Witness->ControlPointsModified)
+ {
+  Witness->ModifiedControlPointBegin = Min(Witness->ModifiedControlPointBegin, ControlPointIndex);
+  Witness->ModifiedControlPointEnd = Max(Witness->ModifiedControlPointEnd, ControlPointIndex + 1);
+ }
+ else
+ {
+  Witness->ControlPointsModified = true;
+  Witness->ModifiedControlPointBegin = ControlPointIndex;
+  Witness->ModifiedControlPointEnd = ControlPointIndex + 1;
+ }
+}
+
 internal entity_with_modify_witness
 BeginEntityModify(entity *Entity)
 {
@@ -5760,16 +10226,48 @@ internal void
 EndEntityModify(entity_with_modify_witness Witness)
 {
  entity *Entity = Witness.Entity;
- if (Entity && Witness.Modified)
+ if (Entity && (Witness.Modified || Witness.ControlPointsModified || Witness.DirtyStages))
  {
+  b32 Recomputed = false;
   switch (Entity->Type)
   {
-   case Entity_Curve: {RecomputeCurve(&Entity->Curve);}break;
+   case Entity_Curve: {
+    curve *Curve = &Entity->Curve;
+    curve_recompute_batch *Batch = GetCtx()->CurveRecomputeBatch;
+    b32 Whole = (Witness.Modified || (Witness.DirtyStages & CurveRecomputeStage_Samples));
+    if (Batch && Batch->Depth > 0)
+    {
+     QueueCurveRecompute(Batch, Entity);
+    }
+    // NOTE(hbr): In place update assumes that displayed curve is the one right before this modification
+    else if (!Whole && !IsCurveAsyncRecomputeBusy(Curve) &&
+             (!Witness.ControlPointsModified ||
+              RecomputeCurveControlPointRange(Curve, Witness.ModifiedControlPointBegin, Witness.ModifiedControlPointEnd)))
+    {
+     RecomputeCurveStages(Curve, Witness.DirtyStages);
+     Recomputed = true;
+    }
+    else if (ShouldRecomputeCurveAsync(Curve))
+    {
+     Curve->AsyncRecompute.Pending = true;
+    }
+    else
+    {
+     WaitForCurveAsyncRecompute(Curve);
+     RecomputeCurve(Curve);
+     Recomputed = true;
+    }
+   }break;
    case Entity_Image: {}break;
    case Entity_Count: InvalidPath;
   }
   
   ++Entity->Version;
+  
+  if (Recomputed)
+  {
+   MarkCurveRecomputed(Entity);
+  }
  }
 }
 
@@ -5798,6 +10296,10 @@ DefaultCurveParams(void)
  
  Params.SamplesPerControlPoint = 50;
  Params.TotalSamples = 1000;
+ Params.BezierPrecision = CurveEvalPrecision_F32;
+ Params.AdaptiveSampling.Enabled = false;
+ Params.AdaptiveSampling.Tolerance = 0.25f;
+ Params.AdaptiveSampling.Unit = CurveSamplingTolerance_Pixels;
  
  return Params;
 }
@@ -5805,7 +10307,7 @@ DefaultCurveParams(void)
 internal string_store *
 AllocStringStore(arena_store *ArenaStore)
 {
- arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1));
+ arena *Arena = AllocArenaFromStore(ArenaStore, Gigabytes(1), MemoryTag_Strings);
  string_store *Store = PushStruct(Arena, string_store);
  Store->StrCache = AllocStringCache(Arena);
  Store->Arena = Arena;
@@ -97,6 +97,22 @@ global read_only string BezierNames[] = {
 };
 StaticAssert(ArrayCount(BezierNames) == Bezier_Count, BezierNamesDefined);
 
+// NOTE(hbr): Only rational Bezier curves for now, those are the ones that are evaluated
+// directly in Bernstein basis and lose precision quickly with degree.
+enum curve_eval_precision : u32
+{
+ CurveEvalPrecision_F32,
+ CurveEvalPrecision_F64,
+ CurveEvalPrecision_Compensated,
+ CurveEvalPrecision_Count,
+};
+global read_only string CurveEvalPrecisionNames[] = {
+ StrLitComp("Single (f32)"),
+ StrLitComp("Double (f64)"),
+ StrLitComp("Compensated"),
+};
+StaticAssert(ArrayCount(CurveEvalPrecisionNames) == CurveEvalPrecision_Count, CurveEvalPrecisionNamesDefined);
+
 enum b_spline_partition_type : u32
 {
  BSplinePartition_Natural,
@@ -111,6 +127,18 @@ global read_only string BSplinePartitionNames[] = {
 };
 StaticAssert(ArrayCount(BSplinePartitionNames) == BSplinePartition_Count, BSplinePartitionNamesDefined);
 
+enum curve_sampling_tolerance_unit : u32
+{
+ CurveSamplingTolerance_Pixels,
+ CurveSamplingTolerance_World,
+ CurveSamplingTolerance_Count,
+};
+global read_only string CurveSamplingToleranceUnitNames[] = {
+ StrLitComp("Pixels"),
+ StrLitComp("World"),
+};
+StaticAssert(ArrayCount(CurveSamplingToleranceUnitNames) == CurveSamplingTolerance_Count, CurveSamplingToleranceUnitNamesDefined);
+
 struct draw_params
 {
  b32 Enabled;
@@ -122,6 +150,15 @@ struct draw_params
  };
 };
 
+// NOTE(hbr): Instead of fixed number of samples, subdivide the curve until the distance
+// between every sample and the chord of its neighbours is within Tolerance.
+struct curve_adaptive_sampling_params
+{
+ b32 Enabled;
+ f32 Tolerance;
+ curve_sampling_tolerance_unit Unit;
+};
+
 struct b_spline_params
 {
  b_spline_partition_type Partition;
@@ -147,10 +184,12 @@ struct curve_params
  polynomial_interpolation_params Polynomial;
  cubic_spline_type CubicSpline;
  bezier_type Bezier;
+ curve_eval_precision BezierPrecision;
  b_spline_params BSpline;
  curve_draw_params DrawParams;
  u32 SamplesPerControlPoint;
  u32 TotalSamples;
+ curve_adaptive_sampling_params AdaptiveSampling;
  b32 SamplesVisible;
 };
 StaticAssert(SizeOf(MemberOf(curve_params, DrawParams)) ==
@@ -202,20 +241,40 @@ struct point_tracking_along_curve_state
  all_de_casteljau_intermediate_results Intermediate;
  v4 *IterationColors;
  vertex_array *LineVerticesPerIteration;
+ // NOTE(hbr): Tracking is pushed onto compute arena last, moving the tracked point
+ // rewinds to here instead of piling up intermediate results
+ temp_arena ComputeArenaMark;
+};
+
+// NOTE(hbr): B-spline has at most (ControlPointCount + Degree + 1) <= 2 * ControlPointCount knots
+#define CurvePointsKnotCapacity(Capacity) (2 * (Capacity))
+
+struct curve_points_block
+{
+ curve_points_block *Next;
+ u32 SizeClass;
+ u32 Capacity;
+ v2 *ControlPoints;
+ f32 *ControlPointWeights;
+ cubic_bezier_point *CubicBezierPoints;
+ f32 *BSplineKnots;
 };
 
-struct curve_points_static
+// NOTE(hbr): Arrays live in a block taken from curve_points_store, when they fill up
+// they move to a block twice as big. Copies pushed onto an arena have no block and
+// can't grow.
+struct curve_points
 {
  u32 ControlPointCount;
+ u32 Capacity;
+ v2 *ControlPoints;
+ f32 *ControlPointWeights;
+ cubic_bezier_point *CubicBezierPoints;
  
-#define CURVE_POINTS_STATIC_MAX_CONTROL_POINT_COUNT 1024
- v2 ControlPoints[CURVE_POINTS_STATIC_MAX_CONTROL_POINT_COUNT];
- f32 ControlPointWeights[CURVE_POINTS_STATIC_MAX_CONTROL_POINT_COUNT];
- cubic_bezier_point CubicBezierPoints[CURVE_POINTS_STATIC_MAX_CONTROL_POINT_COUNT];
- 
-#define MAX_B_SPLINE_KNOT_COUNT (2 * CURVE_POINTS_STATIC_MAX_CONTROL_POINT_COUNT)
  u32 BSplineKnotCount;
- f32 BSplineKnots[MAX_B_SPLINE_KNOT_COUNT];
+ f32 *BSplineKnots;
+ 
+ curve_points_block *Block;
 };
 
 struct curve_points_dynamic
@@ -533,6 +592,7 @@ StaticAssert(ArrayCount(ParametricCurvePredefinedExamples) == ParametricCurvePre
 
 struct b_spline_convex_hull
 {
+ u32 PointCount;
  v2 *Points;
  vertex_array Vertices;
 };
@@ -573,10 +633,100 @@ struct curve_degree_reduction
  f32 MiddlePointMix;
  
  arena *Arena;
- curve_points_static *OriginalCurvePoints;
+ curve_points *OriginalCurvePoints;
  vertex_array OriginalCurveVertices;
 };
 
+// NOTE(hbr): Extraction is rebuilt only when knots or control points actually change, so keep
+// a copy of what it was built from, RecomputeCurve is called for all sorts of other reasons.
+struct curve_nurbs_extraction_cache
+{
+ arena *Arena;
+ b_spline_knot_params KnotParams;
+ u32 ControlCount;
+ v2 *Controls;
+ f32 *Weights;
+ f32 *Knots;
+ nurbs_bezier_extraction Extraction;
+};
+
+// NOTE(hbr): Bezier and polynomial curve samples are linear in control points: Samples = Basis * Controls
+// (for rational Bezier both numerator and denominator are). Basis only depends on point count
+// and sample Ts, so moving one point only adds its column scaled by how much the point moved.
+struct curve_basis_cache
+{
+ arena *Arena;
+ curve_type Type;
+ u32 PointCount;
+ u32 SampleCount;
+ f32 *Ts;
+ f32 *Basis; // column-major, SampleCount values per control point
+ 
+ // NOTE(hbr): Sums are for Controls and Weights, updated along with them
+ b32 SumsValid;
+ v2 *Controls;
+ f32 *Weights;
+ f64 *SumX;
+ f64 *SumY;
+ f64 *SumW; // only Bezier, rational denominator
+};
+
+enum curve_async_recompute_state : u32
+{
+ CurveAsyncRecompute_Idle,
+ CurveAsyncRecompute_Running,
+ CurveAsyncRecompute_Done,
+};
+// NOTE(hbr): Heavy curves are recomputed on low priority thread, from a snapshot of the whole
+// entity, into BackArena. When done, BackArena and ComputeArena swap, so whatever is displayed
+// stays valid the whole time. There is at most one recompute in flight per curve, edits made
+// in the meantime mark it Pending and go with the next one.
+struct curve_async_recompute
+{
+ arena *SnapshotArena;
+ arena *BackArena;
+ curve_async_recompute_state volatile State;
+ b32 Pending;
+ u32 Version; // entity version the snapshot in flight was taken at
+ u32 FrontVersion; // entity version ComputeArena was computed at, older results are stale
+ struct curve_async_recompute_work *Work;
+ work_queue_group Group;
+};
+
+struct curve_arc_length_table
+{
+ u32 Count;
+ // NOTE(hbr): Length of the sample polyline from the first sample up to every sample,
+ // so Lengths[0] == 0 and Lengths[Count-1] == TotalLength.
+ f32 *Lengths;
+ f32 TotalLength;
+};
+// NOTE(hbr): Remembers where the previous arc length lookup landed. Lookups that move
+// only a little from query to query (animation, dashes) are then O(1) instead of O(log n).
+struct curve_arc_length_cursor
+{
+ u32 Index;
+};
+
+// NOTE(hbr): Curve line stroked from fewer samples, for when the curve is too small on screen
+// for all of them to matter. Level L keeps every 2^L-th sample, level 0 is CurveVertices itself.
+// Levels are stroked lazily, the first time the camera picks them, and live until the curve changes.
+#define CurveLODLevelCount 5
+struct curve_lod_level
+{
+ b32 Computed;
+ vertex_array Vertices;
+};
+struct curve_lod_cache
+{
+ arena *Arena;
+ b32 Valid;
+ u32 EntityVersion; // versions of entity and of what was displayed when levels were made
+ u32 FrontVersion;
+ rect2 LocalAABB;
+ curve_lod_level Levels[CurveLODLevelCount];
+};
+
 struct curve
 {
  curve_params Params; // used to compute curve shape from (might be still validated and not used "as-is")
@@ -589,17 +739,36 @@ struct curve
  
  // all points are in local space
  curve_points_id Points;
+ // NOTE(hbr): Only snapshots recomputed in the background have it, they are not in curve points store
+ curve_points *SnapshotPoints;
  
  arena *ComputeArena;
  u32 CurveSampleCount;
  v2 *CurveSamples;
  f32 *Ts;
+ // NOTE(hbr): Only with adaptive sampling - index of the first sample of every
+ // control point segment, because samples are no longer spread evenly.
+ u32 SegmentSampleIndexCount;
+ u32 *SegmentSampleIndices;
+ // NOTE(hbr): Only with adaptive sampling - pixel size the tolerance was converted with
+ f32 AdaptiveWorldUnitsPerPixel;
+ curve_arc_length_table ArcLength;
  u32 ConvexHullCount;
  v2 *ConvexHullPoints;
  vertex_array CurveVertices;
  vertex_array PolylineVertices;
  vertex_array ConvexHullVertices;
+ // NOTE(hbr): Index of the first vertex of every sample/control point, so that moving
+ // a control point can redo the strokes only around it. Zero when curve is looped.
+ u32 *CurveVertexOffsets;
+ u32 PolylinePointCount;
+ u32 *PolylineVertexOffsets;
+ u32 BSplinePartitionKnotCount;
  v2 *BSplinePartitionKnots;
+ curve_nurbs_extraction_cache NURBS_Extraction;
+ curve_basis_cache BasisCache;
+ curve_async_recompute AsyncRecompute;
+ curve_lod_cache LOD;
  u32 BSplineConvexHullCount;
  b_spline_convex_hull *BSplineConvexHulls;
 };
@@ -632,9 +801,24 @@ enum
 {
  EntityInternalFlag_Tracked = (1<<0),
  EntityInternalFlag_Deactivated = (1<<1),
+ EntityInternalFlag_RecomputeQueued = (1<<2),
 };
 typedef u32 entity_internal_flags;
 
+// NOTE(hbr): Parts of the computed curve that can be redone on their own. Samples are
+// the expensive part and everything else lives after them in compute arena, so
+// invalidating samples redoes the whole curve. The rest is redone in place.
+enum
+{
+ CurveRecomputeStage_Samples            = (1<<0),
+ CurveRecomputeStage_CurveVertices      = (1<<1),
+ CurveRecomputeStage_PolylineVertices   = (1<<2),
+ CurveRecomputeStage_ConvexHullVertices = (1<<3),
+ CurveRecomputeStage_BSplineConvexHulls = (1<<4),
+ CurveRecomputeStage_PointTracking      = (1<<5),
+};
+typedef u32 curve_recompute_stage_flags;
+
 struct entity
 {
  entity *Next;
@@ -660,6 +844,14 @@ struct entity_with_modify_witness
 {
  entity *Entity;
  b32 Modified;
+ // NOTE(hbr): Only control points [Begin, End) moved, curves with local support can
+ // then recompute just the part of the curve around them. Modified overrides that.
+ b32 ControlPointsModified;
+ u32 ModifiedControlPointBegin;
+ u32 ModifiedControlPointEnd;
+ // NOTE(hbr): Stages invalidated by changes that don't move the curve itself (draw widths,
+ // tracked point). Modified and ControlPointsModified override that.
+ curve_recompute_stage_flags DirtyStages;
 };
 
 struct entity_handle
@@ -688,7 +880,7 @@ struct entity_array
  entity **Entities;
 };
 
-enum modify_curve_points_static_which_points
+enum modify_curve_points_which_points
 {
  ModifyCurvePointsWhichPoints_ControlPointsOnly,
  ModifyCurvePointsWhichPoints_ControlPointsAndWeights,
@@ -702,7 +894,7 @@ struct curve_points_modify_handle
  f32 *Weights;
  cubic_bezier_point *CubicBeziers;
  f32 *BSplineKnots;
- modify_curve_points_static_which_points Which;
+ modify_curve_points_which_points Which;
 };
 
 struct point_draw_info
@@ -785,6 +977,41 @@ struct entity_list_node
 //~ stores
 
 //- arena store
+// NOTE(hbr): Every arena handed out by the store is tagged with the subsystem that owns it
+enum memory_tag : u32
+{
+ MemoryTag_Untagged,
+ MemoryTag_Pooled,
+ MemoryTag_Editor,
+ MemoryTag_UI,
+ MemoryTag_Entities,
+ MemoryTag_Strings,
+ MemoryTag_CurvePoints,
+ MemoryTag_CurveCompute,
+ MemoryTag_CurveCaches,
+ MemoryTag_CurveAsyncRecompute,
+ MemoryTag_CurveRecomputeBatch,
+ MemoryTag_CurveEvalCache,
+ MemoryTag_Tasks,
+ MemoryTag_Count
+};
+global read_only string MemoryTagNames[] = {
+ StrLitComp("Untagged"),
+ StrLitComp("Pooled (idle)"),
+ StrLitComp("Editor"),
+ StrLitComp("UI"),
+ StrLitComp("Entities"),
+ StrLitComp("Strings"),
+ StrLitComp("Curve Points"),
+ StrLitComp("Curve Compute"),
+ StrLitComp("Curve Caches"),
+ StrLitComp("Curve Async Recompute"),
+ StrLitComp("Curve Recompute Batch"),
+ StrLitComp("Curve Eval Cache"),
+ StrLitComp("Tasks"),
+};
+StaticAssert(ArrayCount(MemoryTagNames) == MemoryTag_Count, MemoryTagNamesDefined);
+
 struct arena_node
 {
  arena_node *Next;
@@ -792,11 +1019,46 @@ struct arena_node
  arena *Arena;
 };
 
+struct arena_pool_entry
+{
+ arena_pool_entry *Next;
+ arena *Arena;
+};
+
+struct arena_pool_stats
+{
+ u32 LiveCount;
+ u32 IdleCount;
+ u32 AllocCount;
+ u32 ReuseCount;
+ u32 DecommitCount;
+ u64 IdleCommited;
+};
+
+// NOTE(hbr): Arenas given back to the store wait here, cleared but with their pages
+// still commited, until someone asks for the same reserve size class again
+struct arena_pool
+{
+ arena_pool_entry *Idle;
+ arena_pool_stats Stats;
+};
+
+#define ArenaPoolMinReserveLog2 20
+#define ArenaPoolSizeClassCount 17
+#define ArenaPoolDefaultMaxIdleCommited Megabytes(256)
 struct arena_store
 {
  arena *Arena;
  arena_node *Head;
  arena_node *Tail;
+ 
+ // NOTE(hbr): Pool of class i holds arenas reserving (1 << (ArenaPoolMinReserveLog2 + i)) bytes
+ arena_pool Pools[ArenaPoolSizeClassCount];
+ arena_pool_entry *FreeEntry;
+ u64 IdleCommited;
+ u64 MaxIdleCommited;
+ // NOTE(hbr): Worker threads give their task arenas back as well
+ os_mutex_handle Mutex;
 };
 
 //- string store
@@ -811,12 +1073,16 @@ struct string_store
 };
 
 //- curve points store
+#define CurvePointsMinCapacityLog2 2
+#define CurvePointsSizeClassCount 24
 struct curve_points_store
 {
  arena *Arena;
- curve_points_static *CurvePoints;
+ curve_points *CurvePoints;
  u32 Count;
  u32 Capacity;
+ // NOTE(hbr): Blocks of capacity (1 << (CurvePointsMinCapacityLog2 + SizeClass))
+ curve_points_block *FreeBlocks[CurvePointsSizeClassCount];
  arena_store *ArenaStore;
 };
 
@@ -852,6 +1118,69 @@ struct thread_task_memory_store
  arena_store *ArenaStore;
 };
 
+//- curve recompute batch
+struct curve_recompute_batch_node
+{
+ curve_recompute_batch_node *Next;
+ entity *Entity;
+};
+struct curve_recompute_batch
+{
+ arena *Arena;
+ temp_arena Temp;
+ u32 Depth;
+ u32 Count;
+ curve_recompute_batch_node *Head;
+};
+
+//- curve eval cache
+// NOTE(hbr): Curve evaluation results keyed by everything the curve shape depends on. Undo/redo,
+// duplicating, loading and toggling params back and forth all recompute curves seen before.
+// Bounded both in entry count and in total size, least recently used entries go first.
+#define CurveEvalCacheBucketCount 256
+#define CurveEvalCacheMaxEntryCount 64
+#define CurveEvalCacheMaxSize Megabytes(256)
+struct curve_eval_cache_key
+{
+ u64 Hash;
+ u64 Size;
+ u8 *Data;
+};
+struct curve_eval_cache_entry
+{
+ curve_eval_cache_entry *Next; // least recently used order, free list
+ curve_eval_cache_entry *Prev;
+ curve_eval_cache_entry *HashNext;
+ arena *Arena;
+ u64 Size;
+ curve_eval_cache_key Key;
+ 
+ u32 SampleCount;
+ v2 *Samples;
+ f32 *Ts;
+ u32 SegmentSampleIndexCount;
+ u32 *SegmentSampleIndices;
+ u32 BSplinePartitionKnotCount;
+ v2 *BSplinePartitionKnots;
+ // NOTE(hbr): Stroke is reused only if line width is the same
+ f32 LineWidth;
+ vertex_array CurveVertices;
+ u32 *CurveVertexOffsets;
+};
+struct curve_eval_cache
+{
+ arena *Arena;
+ arena_store *ArenaStore;
+ curve_eval_cache_entry *Buckets[CurveEvalCacheBucketCount];
+ curve_eval_cache_entry *Head; // most recently used
+ curve_eval_cache_entry *Tail;
+ curve_eval_cache_entry *Free;
+ u32 EntryCount;
+ u64 TotalSize;
+ u32 HitCount;
+ u32 MissCount;
+};
+
 //- image loading store
 enum image_loading_state
 {
@@ -946,8 +1275,8 @@ struct tracked_action
  xform2d OriginalEntityXForm;
  xform2d XFormedToEntityXForm;
  b32 IsPending;
- curve_points_static *CurvePoints;
- curve_points_static *FinalCurvePoints;
+ curve_points *CurvePoints;
+ curve_points *FinalCurvePoints;
 };
 global tracked_action NilTrackedAction;
 struct action_tracking_group
@@ -966,7 +1295,7 @@ struct action_tracking_group_batch
  u32 ActionTrackingGroupCount;
 };
 
-struct begin_modify_curve_points_static_tracked_result
+struct begin_modify_curve_points_tracked_result
 {
  curve_points_modify_handle ModifyPoints;
  tracked_action *ModifyAction;
@@ -1155,10 +1484,10 @@ struct editor_command_node
  editor_command Command;
 };
 
-struct curve_points_static_node
+struct curve_points_node
 {
- curve_points_static_node *Next;
- curve_points_static Points;
+ curve_points_node *Next;
+ curve_points Points;
 };
 
 struct selected_entity_transform_state
@@ -1234,11 +1563,104 @@ struct editor_last_sessions
  string_list ProjectFilePaths; // sorted from most oldest to most recent
 };
 
+struct curve_eval_kernel
+{
+ work_queue_func *EvalWorkFunc;
+ b32 MultiThreaded;
+ instruction_set_flags RequiredInstructionSets;
+ b32 Approximate; // trades accuracy for speed, never picked by calibration
+ u32 BlockSize; // NOTE(hbr): filled when resolving kernel, taken from calibration
+};
+
+struct curve_eval_tuning
+{
+ u32 Method; // fastest single threaded eval method of given curve type on this machine
+ u32 BlockSize; // fastest block size passed to WorkQueueCalculateBlocks
+};
+
+// NOTE(hbr): Measured once at startup on the host. Adaptive eval methods dispatch
+// using these instead of deciding on every call.
+struct curve_eval_calibration
+{
+ b32 Calibrated;
+ curve_eval_tuning Bezier;
+ curve_eval_tuning NURBS;
+ curve_eval_tuning CubicSpline;
+ curve_eval_tuning Polynomial;
+};
+
 struct editor_persistent_state
 {
  arena *Arena;
  editor_memory *Memory;
  editor_last_sessions LastSessions;
+ curve_eval_calibration EvalCalibration;
+};
+
+//- memory accounting
+struct memory_tag_usage
+{
+ u32 ArenaCount;
+ arena_usage Usage;
+};
+
+struct memory_usage
+{
+ memory_tag_usage Tags[MemoryTag_Count];
+ memory_tag_usage Total;
+ 
+ // NOTE(hbr): Curve point blocks live inside the curve points store arena, split by owner
+ u32 CurvePointsLiveCount;
+ u64 CurvePointsLiveSize;
+ u32 CurvePointsUndoCount;
+ u64 CurvePointsUndoSize;
+ u32 CurvePointsFreeBlockCount;
+ u64 CurvePointsFreeBlockSize;
+ 
+ u32 UndoBatchCount;
+ u32 UndoGroupCount;
+ u32 UndoActionCount;
+ u64 UndoSize;
+ 
+ u64 RendererTransferMemorySize;
+ u32 RendererTransferPendingCount;
+ u64 ProfilerSize;
+ 
+ arena_pool_stats Pools[ArenaPoolSizeClassCount];
+ u64 PoolIdleCommited;
+ u64 PoolMaxIdleCommited;
+};
+
+enum entity_memory_sort : u32
+{
+ EntityMemorySort_Total,
+ EntityMemorySort_Points,
+ EntityMemorySort_Compute,
+ EntityMemorySort_Caches,
+ EntityMemorySort_Async,
+ EntityMemorySort_Texture,
+ EntityMemorySort_Count
+};
+global read_only string EntityMemorySortNames[] = {
+ StrLitComp("Total"),
+ StrLitComp("Points"),
+ StrLitComp("Compute"),
+ StrLitComp("Caches"),
+ StrLitComp("Async"),
+ StrLitComp("Texture"),
+};
+StaticAssert(ArrayCount(EntityMemorySortNames) == EntityMemorySort_Count, EntityMemorySortNamesDefined);
+
+struct entity_memory_usage
+{
+ entity *Entity;
+ u64 Sizes[EntityMemorySort_Count];
+};
+
+struct entity_memory_usage_array
+{
+ u32 Count;
+ entity_memory_usage *Entities;
 };
 
 struct editor
@@ -1252,6 +1674,8 @@ struct editor
  image_loading_store *ImageLoadingStore;
  string_store *StrStore;
  curve_points_store *CurvePointsStore;
+ curve_recompute_batch *CurveRecomputeBatch;
+ curve_eval_cache *CurveEvalCache;
  struct work_queue *LowPriorityQueue;
  struct work_queue *HighPriorityQueue;
  
@@ -1266,7 +1690,7 @@ struct editor
  action_tracking_group PendingActionTrackingGroup;
  tracked_action *FreeTrackedAction;
  
- curve_points_static_node *FreeCurvePointsNode;
+ curve_points_node *FreeCurvePointsNode;
  
  editor_command_node *EditorCommandsHead;
  editor_command_node *EditorCommandsTail;
@@ -1299,6 +1723,10 @@ struct editor
  merging_curves_state MergingCurves;
  visual_profiler_state Profiler;
  
+ // NOTE(hbr): Dev only window, deliberately not part of serializable state
+ b32 MemoryWindow;
+ entity_memory_sort MemorySort;
+ 
  b32 ProjectModified;
  b32 IsProjectFileBacked;
  arena *ProjectFilePathArena;
@@ -1325,8 +1753,10 @@ internal entity *EntityFromHandle(entity_handle Handle, b32 AllowDeactived = fal
 internal entity_with_modify_witness BeginEntityModify(entity *Entity);
 internal void EndEntityModify(entity_with_modify_witness Witness);
 internal void MarkEntityModified(entity_with_modify_witness *Witness);
+internal void MarkEntityControlPointModified(entity_with_modify_witness *Witness, u32 ControlPointIndex);
+internal void MarkCurveRecomputeStages(entity_with_modify_witness *Witness, curve_recompute_stage_flags Stages);
 
-internal curve_points_modify_handle BeginModifyCurvePoints(entity_with_modify_witness *Curve, u32 RequestedPointCount, modify_curve_points_static_which_points Which);
+internal curve_points_modify_handle BeginModifyCurvePoints(entity_with_modify_witness *Curve, u32 RequestedPointCount, modify_curve_points_which_points Which);
 internal void EndModifyCurvePoints(curve_points_modify_handle Handle);
 
 internal control_point_handle ControlPointHandleZero(void);
@@ -1348,9 +1778,9 @@ internal control_point MakeControlPoint(v2 Point, f32 Weight, cubic_bezier_point
 
 internal curve_points_handle MakeCurvePointsHandle(u32 ControlPointCount, v2 *ControlPoints, f32 *ControlPointWeights, cubic_bezier_point *CubicBezierPoints, u32 BSplineKnotCount, f32 *BSplineKnots);
 internal curve_points_handle CurvePointsHandleZero(void);
-internal curve_points_handle CurvePointsHandleFromCurvePointsStatic(curve_points_static *Static);
+internal curve_points_handle CurvePointsHandleFromCurvePoints(curve_points *Points);
 internal curve_points_dynamic MakeCurvePointsDynamic(u32 *ControlPointCount, v2 *ControlPoints, f32 *ControlPointWeights, cubic_bezier_point *CubicBezierPoints, u32 Capacity);
-internal curve_points_dynamic CurvePointsDynamicFromStatic(curve_points_static *Static);
+internal curve_points_dynamic CurvePointsDynamicFromCurvePoints(curve_points *Points);
 internal void CopyCurvePoints(curve_points_dynamic Dst, curve_points_handle Src);
 
 internal b_spline_knot_handle BSplineKnotHandleZero(void);
@@ -1373,6 +1803,7 @@ internal void InitEntityImagePart(image *Image, u32 Width, u32 Height, string Im
 internal void TranslateCurvePointTo(entity_with_modify_witness *Entity, curve_point_handle Handle, v2 P, translate_curve_point_flags Flags); // this can be any point - either control or bezier
 internal void SetControlPoint(entity_with_modify_witness *Entity, control_point_handle Handle, v2 P, f32 Weight); // this can be only control point thus we accept weight as well
 internal void SetControlPoint(entity_with_modify_witness *Witness, control_point_handle Handle, control_point Point);
+internal void SetControlPointWeight(entity_with_modify_witness *Witness, control_point_handle Handle, f32 Weight);
 internal void RemoveControlPoint(entity_with_modify_witness *Entity, control_point_handle Point);
 internal control_point_handle AppendControlPoint(entity_with_modify_witness *Entity, v2 P);
 internal control_point_handle InsertControlPoint(entity_with_modify_witness *Entity, control_point Point, u32 At);
@@ -1406,19 +1837,30 @@ internal visible_cubic_bezier_points GetVisibleCubicBezierPoints(entity *Entity)
 internal b32 IsCurveEligibleForPointTracking(curve *Curve);
 internal b32 CurveHasWeights(curve *Curve);
 internal b32 IsCurveTotalSamplesMode(curve *Curve);
+internal b32 IsCurveAdaptiveSamplingMode(curve *Curve);
+internal b32 IsCurveLooped(curve *Curve);
+internal f32 CurveSampleFraction(curve *Curve, u32 CurveSampleIndex);
+internal f32 CurveSampleT(curve *Curve, u32 CurveSampleIndex);
+internal u32 CurveSampleIndexAtT(curve *Curve, f32 T);
+internal f32 CurveArcLengthAtT(curve *Curve, f32 T);
+internal f32 CurveTAtArcLength(curve *Curve, f32 Distance, curve_arc_length_cursor *Cursor = 0);
+internal v2 CurvePointAtArcLength(curve *Curve, f32 Distance, curve_arc_length_cursor *Cursor = 0);
 internal b32 IsCurveReversed(entity *Curve);
 internal b32 IsRegularBezierCurve(curve *Curve);
 internal b32 AreBSplineKnotsVisible(curve *Curve);
 internal string GetEntityName(entity *Entity);
 internal char_buffer *GetEntityNameBuffer(entity *Entity, string_store *StrStore);
 internal control_point GetCurveControlPointInWorldSpace(entity *Entity, control_point_handle Point);
-internal void CopyCurvePointsFromCurve(curve *Curve, curve_points_dynamic Dst);
+internal void CopyCurvePointsFromCurve(curve *Curve, curve_points *Dst);
 internal rect2 EntityAABB(curve *Curve);
 internal b_spline_params GetBSplineParams(curve *Curve);
 internal v2 GetCubicBezierPoint(curve *Curve, cubic_bezier_point_handle Point);
 internal v2 WorldToLocalEntityPosition(entity *Entity, v2 P);
 internal v2 LocalToWorldEntityPosition(entity *Entity, v2 P);
 internal f32 GetCurvePartVisibilityZOffset(curve_part_visibility Part);
+internal u32 PickCurveLODLevel(entity *Entity, render_group *RenderGroup);
+internal vertex_array CurveLODVertices(entity *Entity, u32 Level);
+internal b32 ShouldRetessellateCurveForZoom(curve *Curve, f32 WorldUnitsPerPixel);
 
 //- b-spline specific
 internal point_draw_info GetBSplinePartitionKnotPointDrawInfo(entity *Entity);
@@ -1481,7 +1923,7 @@ internal tracked_action *BeginEntityTransform(editor *Editor, entity *Entity);
 internal void EndEntityTransform(editor *Editor, tracked_action *MoveAction);
 internal tracked_action *BeginControlPointMove(editor *Editor, entity *Entity, control_point_handle Point);
 internal void EndControlPointMove(editor *Editor, tracked_action *MoveAction);
-internal begin_modify_curve_points_static_tracked_result BeginModifyCurvePointsTracked(editor *Editor, entity_with_modify_witness *Entity, u32 RequestedPointCount, modify_curve_points_static_which_points Which);
+internal begin_modify_curve_points_tracked_result BeginModifyCurvePointsTracked(editor *Editor, entity_with_modify_witness *Entity, u32 RequestedPointCount, modify_curve_points_which_points Which);
 internal void EndModifyCurvePointsTracked(editor *Editor, tracked_action *ModifyAction, curve_points_modify_handle ModifyPoints);
 internal void SetCurvePointsTracked(editor *Editor, entity_with_modify_witness *Curve, curve_points_handle Points);
 
@@ -1533,12 +1975,19 @@ internal void AddNotificationF(editor *Editor, notification_type Type, char cons
 //- collisions
 internal collision CheckCollisionWithEntities(editor *Editor, v2 AtP, f32 Tolerance);
 
+//- memory accounting
+internal memory_usage ComputeMemoryUsage(editor *Editor);
+internal entity_memory_usage_array ComputeEntityMemoryUsage(arena *Arena, entity_store *Store, entity_memory_sort SortBy);
+internal string_list MemoryUsageReport(arena *Arena, memory_usage *Usage, entity_memory_usage_array Entities);
+internal void DumpMemoryUsageSnapshot(editor *Editor);
+
 //~ store type functions
 
 //- arena store
 internal arena_store *AllocArenaStore(void);
 internal void DeallocArenaStoreAndAllArenas(arena_store *ArenaStore);
-internal arena *AllocArenaFromStore(arena_store *ArenaStore, u64 ReserveButNotCommit);
+internal arena *AllocArenaFromStore(arena_store *ArenaStore, u64 ReserveButNotCommit, memory_tag Tag);
+internal void TrimArenaStore(arena_store *ArenaStore, u64 MaxIdleCommited);
 
 //- string store
 internal string_store *AllocStringStore(arena_store *ArenaStore);
@@ -1556,8 +2005,13 @@ internal b32 StringIdMatch(string_id A, string_id B);
 internal curve_points_store *AllocCurvePointsStore(arena_store *ArenaStore);
 internal curve_points_id AllocCurvePointsFromStore(curve_points_store *Store);
 internal void SetOrAllocCurvePointsOfId(curve_points_store *Store, curve_points_id Id, curve_points_handle Points);
+internal void ReserveCurvePointsInStore(curve_points_store *Store, curve_points *Points, u32 ControlPointCount, u32 BSplineKnotCount);
+internal void ReleaseCurvePointsToStore(curve_points_store *Store, curve_points *Points);
+internal void SetCurvePointsInStore(curve_points_store *Store, curve_points *Dst, curve_points_handle Src);
+internal void CopyCurvePointsToArena(arena *Arena, curve_points *Dst, curve_points_handle Src);
+internal u64 CurvePointsSizeFromCapacity(u32 Capacity);
 
-internal curve_points_static *CurvePointsFromId(curve_points_store *Store, curve_points_id Id);
+internal curve_points *CurvePointsFromId(curve_points_store *Store, curve_points_id Id);
 internal curve_points_id CurvePointsIdFromIndex(u32 Index);
 internal u32 IndexFromCurvePointsId(curve_points_id Id);
 internal b32 CurvePointsIdMatch(curve_points_id A, curve_points_id B);
@@ -1581,6 +2035,18 @@ internal thread_task_memory_store *AllocThreadTaskMemoryStore(arena_store *Arena
 internal thread_task_memory *BeginThreadTaskMemory(thread_task_memory_store *Store);
 internal void EndThreadTaskMemory(thread_task_memory_store *Store, thread_task_memory *Task);
 
+//- curve recompute batch
+internal curve_recompute_batch *AllocCurveRecomputeBatch(arena_store *ArenaStore);
+// NOTE(hbr): While a batch is open, modified curves are only queued. Closing the outermost
+// batch recomputes all of them at once, spreading all their samples across work queue together.
+internal void BeginCurveRecomputeBatch(void);
+internal void EndCurveRecomputeBatch(void);
+internal curve_eval_cache *AllocCurveEvalCache(arena_store *ArenaStore);
+internal void RecomputeCurves(u32 CurveCount, curve **Curves);
+internal void ProcessCurveAsyncRecomputes(editor *Editor);
+internal void WaitForCurveAsyncRecompute(curve *Curve);
+internal void MarkCurveRecomputed(entity *Entity);
+
 //- image loading store
 internal image_loading_store *AllocImageLoadingStore(arena_store *ArenaStore);
 internal image_loading_task *BeginAsyncImageLoadingTask(image_loading_store *Store);
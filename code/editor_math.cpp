@@ -489,25 +489,42 @@ AngleSort(u32 PointCount, v2 *Points)
    }
   }
   
-  //- Bubble sort
-  b32 Sorting = true;
-  for (u32 Iteration = 0;
-       Sorting;
-       ++Iteration)
-  {
-   Sorting = false;
-   for (u32 J = 1; J < PointCount - Iteration; ++J)
+  //- Bottom-up merge sort, stable just like bubble sort that was here before, but
+  // doesn't make convex hull of many control points quadratic
+  temp_arena Temp = TempArena(0);
+  v2 *Curr = Points;
+  v2 *Next = PushArrayNonZero(Temp.Arena, PointCount, v2);
+  for (u32 Length = 1;
+       Length < PointCount;
+       Length <<= 1)
+  {
+   for (u32 Index = 0;
+        Index < PointCount;
+        Index += (Length << 1))
    {
-    v2 A = Points[J-1];
-    v2 B = Points[J];
-    if (AngleCompareLess(B, A, BottomLeftMostPoint))
+    u32 Mid = Min(Index + Length, PointCount);
+    u32 End = Min(Index + (Length << 1), PointCount);
+    u32 Left = Index;
+    u32 Right = Mid;
+    for (u32 At = Index; At < End; ++At)
     {
-     Points[J-1] = B;
-     Points[J] = A;
-     Sorting = true;
+     if (Left < Mid && (Right == End || !AngleCompareLess(Curr[Right], Curr[Left], BottomLeftMostPoint)))
+     {
+      Next[At] = Curr[Left++];
+     }
+     else
+     {
+      Next[At] = Curr[Right++];
+     }
     }
    }
+   Swap(Curr, Next, v2 *);
+  }
+  if (Curr != Points)
+  {
+   ArrayCopy(Points, Curr, PointCount);
   }
+  EndTemp(Temp);
  }
 }
 
@@ -569,39 +586,147 @@ CalcConvexHull(u32 PointCount, v2 *Points, v2 *OutPoints)
  return HullPointCount;
 }
 
+internal u32
+StrokeTessellateStartCap(v2 A, v2 B, f32 Width, v2 *Out)
+{
+ v2 V_Line = B - A;
+ rotation2d NV_Line = Rotate90DegreesAntiClockwise(Rotation2D(V_Line));
+ Normalize(&NV_Line.V);
+ 
+ Out[0] = (A + 0.5f * Width * NV_Line.V);
+ Out[1] = (A - 0.5f * Width * NV_Line.V);
+ 
+ return 2;
+}
+
+internal u32
+StrokeTessellateEndCap(v2 A, v2 B, f32 Width, b32 IsLastInside, v2 *Out)
+{
+ v2 V_Line = B - A;
+ rotation2d NV_Line = Rotate90DegreesAntiClockwise(Rotation2D(V_Line));
+ Normalize(&NV_Line.V);
+ 
+ v2 B_Inside  = B + 0.5f * Width * NV_Line.V;
+ v2 B_Outside = B - 0.5f * Width * NV_Line.V;
+ 
+ if (IsLastInside)
+ {
+  Out[0] = B_Outside;
+  Out[1] = B_Inside;
+ }
+ else
+ {
+  Out[0] = B_Inside;
+  Out[1] = B_Outside;
+ }
+ 
+ return 2;
+}
+
+// NOTE(hbr): Vertices around B, where line A-B turns into B-C. Emits 3 or 4 vertices,
+// depending on the turn direction of this and the previous join.
+internal u32
+StrokeTessellateJoin(v2 A, v2 B, v2 C, f32 Width, b32 *IsLastInside, v2 *Out)
+{
+ v2 V_Line = B - A;
+ Normalize(&V_Line);
+ rotation2d NV_Line = Rotate90DegreesAntiClockwise(Rotation2D(V_Line));
+ 
+ v2 V_Succ = C - B;
+ Normalize(&V_Succ);
+ rotation2d NV_Succ = Rotate90DegreesAntiClockwise(Rotation2D(V_Succ));
+ 
+ b32 LeftTurn = (Cross(V_Line, V_Succ) >= 0.0f);
+ f32 TurnedHalfWidth = (LeftTurn ? 1.0f : -1.0f) * 0.5f * Width;
+ 
+ line_intersection Intersection = LineIntersection(A + TurnedHalfWidth * NV_Line.V,
+                                                   B + TurnedHalfWidth * NV_Line.V,
+                                                   B + TurnedHalfWidth * NV_Succ.V,
+                                                   C + TurnedHalfWidth * NV_Succ.V);
+ 
+ v2 IntersectionPoint = {};
+ if (Intersection.IsOneIntersection)
+ {
+  IntersectionPoint = Intersection.IntersectionPoint;
+ }
+ else
+ {
+  IntersectionPoint = B + TurnedHalfWidth * NV_Line.V;
+ }
+ 
+ v2 B_Line = B - TurnedHalfWidth * NV_Line.V;
+ v2 B_Succ = B - TurnedHalfWidth * NV_Succ.V;
+ 
+ u32 VertexCount = 0;
+ if ((LeftTurn && *IsLastInside) || (!LeftTurn && !*IsLastInside))
+ {
+  Out[0] = B_Line;
+  Out[1] = IntersectionPoint;
+  Out[2] = B_Succ;
+  
+  VertexCount = 3;
+ }
+ else
+ {
+  Out[0] = IntersectionPoint;
+  Out[1] = B_Line;
+  Out[2] = IntersectionPoint;
+  Out[3] = B_Succ;
+  
+  VertexCount = 4;
+ }
+ 
+ *IsLastInside = !LeftTurn;
+ 
+ return VertexCount;
+}
+
+internal b32
+StrokeTessellateIsLeftTurn(v2 A, v2 B, v2 C)
+{
+ v2 V_Line = B - A;
+ Normalize(&V_Line);
+ v2 V_Succ = C - B;
+ Normalize(&V_Succ);
+ b32 LeftTurn = (Cross(V_Line, V_Succ) >= 0.0f);
+ return LeftTurn;
+}
+
+internal u32
+StrokeTessellateMaxVertexCount(u32 PointCount, b32 Loop)
+{
+ u32 N = PointCount;
+ if (Loop) N += 2;
+ 
+ u32 MaxVertexCount = 0;
+ if (N >= 2) MaxVertexCount = 2*2 + 4 * N;
+ 
+ return MaxVertexCount;
+}
+
 // NOTE(hbr): Trinale-strip-based, no mitter, no-spiky line version.
 // TODO(hbr): Loop logic is very ugly but works. Clean it up.
 // Might have only work because we need only loop on convex hull order points.
+// Vertices has to have room for StrokeTessellateMaxVertexCount vertices. When OutPointVertexOffsets
+// is given (only without Loop), stores index of the first vertex of every point, see StrokeRetessellateRange.
 internal vertex_array
-StrokeTessellate_CustomWithoutOverlap(arena *Arena, u32 PointCount, v2 *LinePoints, f32 Width, b32 Loop)
+StrokeTessellate_CustomWithoutOverlapInto(v2 *Vertices, u32 PointCount, v2 *LinePoints, f32 Width, b32 Loop,
+                                          u32 *OutPointVertexOffsets)
 {
  ProfileFunctionBegin();
  
+ Assert(!Loop || !OutPointVertexOffsets);
+ 
  u32 N = PointCount;
  if (Loop) N += 2;
  
- u32 MaxVertexCount = 0;
- if (N >= 2) MaxVertexCount = 2*2 + 4 * N;
- 
- v2 *Vertices = PushArrayNonZero(Arena, MaxVertexCount, v2);
- 
  u32 VertexIndex = 0;
  b32 IsLastInside = false;
  
  if (!Loop && PointCount >= 2)
  {
-  v2 A = LinePoints[0];
-  v2 B = LinePoints[1];
-  
-  v2 V_Line = B - A;
-  rotation2d NV_Line = Rotate90DegreesAntiClockwise(Rotation2D(V_Line));
-  Normalize(&NV_Line.V);
-  
-  Vertices[VertexIndex + 0] = (A + 0.5f * Width * NV_Line.V);
-  Vertices[VertexIndex + 1] = (A - 0.5f * Width * NV_Line.V);
-  
-  VertexIndex += 2;
-  
+  if (OutPointVertexOffsets) OutPointVertexOffsets[0] = VertexIndex;
+  VertexIndex += StrokeTessellateStartCap(LinePoints[0], LinePoints[1], Width, Vertices + VertexIndex);
   IsLastInside = false;
  }
  
@@ -613,83 +738,16 @@ StrokeTessellate_CustomWithoutOverlap(arena *Arena, u32 PointCount, v2 *LinePoin
   v2 B = LinePoints[(PointIndex + 0) % PointCount];
   v2 C = LinePoints[(PointIndex + 1) % PointCount];
   
-  v2 V_Line = B - A;
-  Normalize(&V_Line);
-  rotation2d NV_Line = Rotate90DegreesAntiClockwise(Rotation2D(V_Line));
-  
-  v2 V_Succ = C - B;
-  Normalize(&V_Succ);
-  rotation2d NV_Succ = Rotate90DegreesAntiClockwise(Rotation2D(V_Succ));
-  
-  b32 LeftTurn = (Cross(V_Line, V_Succ) >= 0.0f);
-  f32 TurnedHalfWidth = (LeftTurn ? 1.0f : -1.0f) * 0.5f * Width;
-  
-  line_intersection Intersection = LineIntersection(A + TurnedHalfWidth * NV_Line.V,
-                                                    B + TurnedHalfWidth * NV_Line.V,
-                                                    B + TurnedHalfWidth * NV_Succ.V,
-                                                    C + TurnedHalfWidth * NV_Succ.V);
-  
-  v2 IntersectionPoint = {};
-  if (Intersection.IsOneIntersection)
-  {
-   IntersectionPoint = Intersection.IntersectionPoint;
-  }
-  else
-  {
-   IntersectionPoint = B + TurnedHalfWidth * NV_Line.V;
-  }
-  
-  v2 B_Line = B - TurnedHalfWidth * NV_Line.V;
-  v2 B_Succ = B - TurnedHalfWidth * NV_Succ.V;
-  
-  if ((LeftTurn && IsLastInside) || (!LeftTurn && !IsLastInside))
-  {
-   Vertices[VertexIndex + 0] = B_Line;
-   Vertices[VertexIndex + 1] = IntersectionPoint;
-   Vertices[VertexIndex + 2] = B_Succ;
-   
-   VertexIndex += 3;
-  }
-  else
-  {
-   Vertices[VertexIndex + 0] = IntersectionPoint;
-   Vertices[VertexIndex + 1] = B_Line;
-   Vertices[VertexIndex + 2] = IntersectionPoint;
-   Vertices[VertexIndex + 3] = B_Succ;
-   
-   VertexIndex += 4;
-  }
-  
-  IsLastInside = !LeftTurn;
+  if (OutPointVertexOffsets) OutPointVertexOffsets[PointIndex] = VertexIndex;
+  VertexIndex += StrokeTessellateJoin(A, B, C, Width, &IsLastInside, Vertices + VertexIndex);
  }
  
  if (!Loop)
  {
   if (PointCount >= 2)
   {
-   v2 A = LinePoints[N-2];
-   v2 B = LinePoints[N-1];
-   
-   v2 V_Line = B - A;
-   rotation2d NV_Line = Rotate90DegreesAntiClockwise(Rotation2D(V_Line));
-   Normalize(&NV_Line.V);
-   
-   v2 B_Inside  = B + 0.5f * Width * NV_Line.V;
-   v2 B_Outside = B - 0.5f * Width * NV_Line.V;
-   
-   if (IsLastInside)
-   {
-    Vertices[VertexIndex + 0] = B_Outside;
-    Vertices[VertexIndex + 1] = B_Inside;
-   }
-   else
-   {
-    Vertices[VertexIndex + 0] = B_Inside;
-    Vertices[VertexIndex + 1] = B_Outside;
-   }
-   
-   VertexIndex += 2;
-   
+   if (OutPointVertexOffsets) OutPointVertexOffsets[N-1] = VertexIndex;
+   VertexIndex += StrokeTessellateEndCap(LinePoints[N-2], LinePoints[N-1], Width, IsLastInside, Vertices + VertexIndex);
    IsLastInside = false;
   }
  }
@@ -725,6 +783,90 @@ StrokeTessellate_CustomWithoutOverlap(arena *Arena, u32 PointCount, v2 *LinePoin
  return Result;
 }
 
+internal vertex_array
+StrokeTessellate_CustomWithoutOverlap(arena *Arena, u32 PointCount, v2 *LinePoints, f32 Width, b32 Loop)
+{
+ v2 *Vertices = PushArrayNonZero(Arena, StrokeTessellateMaxVertexCount(PointCount, Loop), v2);
+ vertex_array Result = StrokeTessellate_CustomWithoutOverlapInto(Vertices, PointCount, LinePoints, Width, Loop, 0);
+ return Result;
+}
+
+// NOTE(hbr): Redo the stroke only around points [DirtyBegin, DirtyEnd) that moved. Vertices of
+// a point depend only on its two neighbours and on the turn at the previous point, so a couple of
+// points around the dirty range are enough. Stroke has to come from the Into version with
+// the same point count and without Loop, vertices are rewritten in place (there is always
+// room for the worst case) and the rest of the stroke is shifted if the count changes.
+internal void
+StrokeRetessellateRange(vertex_array *Stroke, u32 *PointVertexOffsets,
+                        u32 PointCount, v2 *LinePoints, f32 Width,
+                        u32 DirtyBegin, u32 DirtyEnd)
+{
+ if (PointCount >= 2 && DirtyBegin < DirtyEnd)
+ {
+  temp_arena Temp = TempArena(0);
+  
+  u32 N = PointCount;
+  u32 Begin = (DirtyBegin >= 1 ? DirtyBegin - 1 : 0);
+  u32 End = Min(DirtyEnd + 2, N);
+  
+  b32 IsLastInside = false;
+  if (Begin >= 2)
+  {
+   IsLastInside = !StrokeTessellateIsLeftTurn(LinePoints[Begin - 2], LinePoints[Begin - 1], LinePoints[Begin]);
+  }
+  
+  v2 *NewVertices = PushArrayNonZero(Temp.Arena, 4 * (End - Begin), v2);
+  u32 *NewOffsets = PushArrayNonZero(Temp.Arena, End - Begin, u32);
+  u32 NewCount = 0;
+  for (u32 PointIndex = Begin;
+       PointIndex < End;
+       ++PointIndex)
+  {
+   NewOffsets[PointIndex - Begin] = NewCount;
+   if (PointIndex == 0)
+   {
+    NewCount += StrokeTessellateStartCap(LinePoints[0], LinePoints[1], Width, NewVertices + NewCount);
+    IsLastInside = false;
+   }
+   else if (PointIndex == N-1)
+   {
+    NewCount += StrokeTessellateEndCap(LinePoints[N-2], LinePoints[N-1], Width, IsLastInside, NewVertices + NewCount);
+   }
+   else
+   {
+    NewCount += StrokeTessellateJoin(LinePoints[PointIndex - 1], LinePoints[PointIndex], LinePoints[PointIndex + 1],
+                                     Width, &IsLastInside, NewVertices + NewCount);
+   }
+  }
+  
+  u32 OldBegin = PointVertexOffsets[Begin];
+  u32 OldEnd = (End < N ? PointVertexOffsets[End] : Stroke->VertexCount);
+  u32 OldCount = OldEnd - OldBegin;
+  if (NewCount != OldCount)
+  {
+   u32 TailCount = Stroke->VertexCount - OldEnd;
+   MemoryMove(Stroke->Vertices + OldBegin + NewCount, Stroke->Vertices + OldEnd, TailCount * SizeOf(Stroke->Vertices[0]));
+   for (u32 PointIndex = End;
+        PointIndex < N;
+        ++PointIndex)
+   {
+    PointVertexOffsets[PointIndex] = PointVertexOffsets[PointIndex] - OldCount + NewCount;
+   }
+   Stroke->VertexCount = Stroke->VertexCount - OldCount + NewCount;
+  }
+  
+  MemoryCopy(Stroke->Vertices + OldBegin, NewVertices, NewCount * SizeOf(NewVertices[0]));
+  for (u32 PointIndex = Begin;
+       PointIndex < End;
+       ++PointIndex)
+  {
+   PointVertexOffsets[PointIndex] = OldBegin + NewOffsets[PointIndex - Begin];
+  }
+  
+  EndTemp(Temp);
+ }
+}
+
 //#define ComputeVerticesOfThickLine StrokeTessellate_MiterMethod
 #define ComputeVerticesOfThickLine StrokeTessellate_CustomWithoutOverlap
 //#define ComputeVerticesOfThickLine StrokeTessellate_SimpleWithOverlap
@@ -1077,6 +1219,130 @@ BarycentricEvaluate(f32 T, f32 *Omega, f32 *Ti, f32 *Y, u32 N)
  return Result;
 }
 
+internal void
+BarycentricEvaluateSSE(f32 T[4], f32 *Omega, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, v2 Out[4])
+{
+ __m128 t = _mm_loadu_ps(T);
+ __m128 zero = _mm_setzero_ps();
+ __m128 num_x = zero, num_y = zero, den = zero;
+ 
+ // NOTE(hbr): Lanes that hit a node exactly take node's value, the same as scalar version.
+ // Their sums get infs/nans, but they are masked out at the end anyway.
+ __m128 hit = zero, hit_x = zero, hit_y = zero;
+ 
+ for (u32 I = 0; I < N; ++I)
+ {
+  __m128 diff = _mm_sub_ps(t, _mm_set1_ps(Ti[I]));
+  __m128 eq = _mm_cmpeq_ps(diff, zero);
+  __m128 x = _mm_set1_ps(Xs[I]);
+  __m128 y = _mm_set1_ps(Ys[I]);
+  
+  __m128 fraction = _mm_div_ps(_mm_set1_ps(Omega[I]), diff);
+  num_x = _mm_add_ps(num_x, _mm_mul_ps(x, fraction));
+  num_y = _mm_add_ps(num_y, _mm_mul_ps(y, fraction));
+  den = _mm_add_ps(den, fraction);
+  
+  hit = _mm_or_ps(hit, eq);
+  hit_x = _mm_or_ps(_mm_and_ps(eq, x), _mm_andnot_ps(eq, hit_x));
+  hit_y = _mm_or_ps(_mm_and_ps(eq, y), _mm_andnot_ps(eq, hit_y));
+ }
+ 
+ __m128 X = _mm_div_ps(num_x, den);
+ __m128 Y = _mm_div_ps(num_y, den);
+ X = _mm_or_ps(_mm_and_ps(hit, hit_x), _mm_andnot_ps(hit, X));
+ Y = _mm_or_ps(_mm_and_ps(hit, hit_y), _mm_andnot_ps(hit, Y));
+ 
+ f32 out_x[4], out_y[4];
+ _mm_storeu_ps(out_x, X);
+ _mm_storeu_ps(out_y, Y);
+ for (u32 lane = 0; lane < 4; ++lane)
+ {
+  Out[lane].X = out_x[lane];
+  Out[lane].Y = out_y[lane];
+ }
+}
+
+internal void
+BarycentricEvaluateAVX2(f32 T[8], f32 *Omega, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, v2 Out[8])
+{
+ __m256 t = _mm256_loadu_ps(T);
+ __m256 zero = _mm256_setzero_ps();
+ __m256 num_x = zero, num_y = zero, den = zero;
+ 
+ // NOTE(hbr): See BarycentricEvaluateSSE
+ __m256 hit = zero, hit_x = zero, hit_y = zero;
+ 
+ for (u32 I = 0; I < N; ++I)
+ {
+  __m256 diff = _mm256_sub_ps(t, _mm256_set1_ps(Ti[I]));
+  __m256 eq = _mm256_cmp_ps(diff, zero, _CMP_EQ_OQ);
+  __m256 x = _mm256_set1_ps(Xs[I]);
+  __m256 y = _mm256_set1_ps(Ys[I]);
+  
+  __m256 fraction = _mm256_div_ps(_mm256_set1_ps(Omega[I]), diff);
+  num_x = _mm256_add_ps(num_x, _mm256_mul_ps(x, fraction));
+  num_y = _mm256_add_ps(num_y, _mm256_mul_ps(y, fraction));
+  den = _mm256_add_ps(den, fraction);
+  
+  hit = _mm256_or_ps(hit, eq);
+  hit_x = _mm256_blendv_ps(hit_x, x, eq);
+  hit_y = _mm256_blendv_ps(hit_y, y, eq);
+ }
+ 
+ __m256 X = _mm256_blendv_ps(_mm256_div_ps(num_x, den), hit_x, hit);
+ __m256 Y = _mm256_blendv_ps(_mm256_div_ps(num_y, den), hit_y, hit);
+ 
+ f32 out_x[8], out_y[8];
+ _mm256_storeu_ps(out_x, X);
+ _mm256_storeu_ps(out_y, Y);
+ for (u32 lane = 0; lane < 8; ++lane)
+ {
+  Out[lane].X = out_x[lane];
+  Out[lane].Y = out_y[lane];
+ }
+}
+
+internal void
+BarycentricEvaluateAVX512(f32 T[16], f32 *Omega, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, v2 Out[16])
+{
+ __m512 t = _mm512_loadu_ps(T);
+ __m512 zero = _mm512_setzero_ps();
+ __m512 num_x = zero, num_y = zero, den = zero;
+ 
+ // NOTE(hbr): See BarycentricEvaluateSSE
+ __mmask16 hit = 0;
+ __m512 hit_x = zero, hit_y = zero;
+ 
+ for (u32 I = 0; I < N; ++I)
+ {
+  __m512 diff = _mm512_sub_ps(t, _mm512_set1_ps(Ti[I]));
+  __mmask16 eq = _mm512_cmp_ps_mask(diff, zero, _CMP_EQ_OQ);
+  __m512 x = _mm512_set1_ps(Xs[I]);
+  __m512 y = _mm512_set1_ps(Ys[I]);
+  
+  __m512 fraction = _mm512_div_ps(_mm512_set1_ps(Omega[I]), diff);
+  num_x = _mm512_add_ps(num_x, _mm512_mul_ps(x, fraction));
+  num_y = _mm512_add_ps(num_y, _mm512_mul_ps(y, fraction));
+  den = _mm512_add_ps(den, fraction);
+  
+  hit |= eq;
+  hit_x = _mm512_mask_mov_ps(hit_x, eq, x);
+  hit_y = _mm512_mask_mov_ps(hit_y, eq, y);
+ }
+ 
+ __m512 X = _mm512_mask_mov_ps(_mm512_div_ps(num_x, den), hit, hit_x);
+ __m512 Y = _mm512_mask_mov_ps(_mm512_div_ps(num_y, den), hit, hit_y);
+ 
+ f32 out_x[16], out_y[16];
+ _mm512_storeu_ps(out_x, X);
+ _mm512_storeu_ps(out_y, Y);
+ for (u32 lane = 0; lane < 16; ++lane)
+ {
+  Out[lane].X = out_x[lane];
+  Out[lane].Y = out_y[lane];
+ }
+}
+
 // NOTE(hbr): Compute directly from definition
 internal void
 NewtonBeta(f32 *Beta, f32 *Ti, f32 *Y, u32 N)
@@ -1162,6 +1428,75 @@ NewtonEvaluateUnrolled4x(f32 T, f32 *Beta, f32 *Ti, u32 N)
  return Result;
 }
 
+internal void
+NewtonEvaluateSSE(f32 T[4], f32 *Beta_X, f32 *Beta_Y, f32 *Ti, u32 N, v2 Out[4])
+{
+ __m128 t = _mm_loadu_ps(T);
+ __m128 X = _mm_setzero_ps();
+ __m128 Y = _mm_setzero_ps();
+ for (u32 I = N; I > 0; --I)
+ {
+  __m128 diff = _mm_sub_ps(t, _mm_set1_ps(Ti[I-1]));
+  X = _mm_add_ps(_mm_mul_ps(X, diff), _mm_set1_ps(Beta_X[I-1]));
+  Y = _mm_add_ps(_mm_mul_ps(Y, diff), _mm_set1_ps(Beta_Y[I-1]));
+ }
+ 
+ f32 out_x[4], out_y[4];
+ _mm_storeu_ps(out_x, X);
+ _mm_storeu_ps(out_y, Y);
+ for (u32 lane = 0; lane < 4; ++lane)
+ {
+  Out[lane].X = out_x[lane];
+  Out[lane].Y = out_y[lane];
+ }
+}
+
+internal void
+NewtonEvaluateAVX2(f32 T[8], f32 *Beta_X, f32 *Beta_Y, f32 *Ti, u32 N, v2 Out[8])
+{
+ __m256 t = _mm256_loadu_ps(T);
+ __m256 X = _mm256_setzero_ps();
+ __m256 Y = _mm256_setzero_ps();
+ for (u32 I = N; I > 0; --I)
+ {
+  __m256 diff = _mm256_sub_ps(t, _mm256_set1_ps(Ti[I-1]));
+  X = _mm256_add_ps(_mm256_mul_ps(X, diff), _mm256_set1_ps(Beta_X[I-1]));
+  Y = _mm256_add_ps(_mm256_mul_ps(Y, diff), _mm256_set1_ps(Beta_Y[I-1]));
+ }
+ 
+ f32 out_x[8], out_y[8];
+ _mm256_storeu_ps(out_x, X);
+ _mm256_storeu_ps(out_y, Y);
+ for (u32 lane = 0; lane < 8; ++lane)
+ {
+  Out[lane].X = out_x[lane];
+  Out[lane].Y = out_y[lane];
+ }
+}
+
+internal void
+NewtonEvaluateAVX512(f32 T[16], f32 *Beta_X, f32 *Beta_Y, f32 *Ti, u32 N, v2 Out[16])
+{
+ __m512 t = _mm512_loadu_ps(T);
+ __m512 X = _mm512_setzero_ps();
+ __m512 Y = _mm512_setzero_ps();
+ for (u32 I = N; I > 0; --I)
+ {
+  __m512 diff = _mm512_sub_ps(t, _mm512_set1_ps(Ti[I-1]));
+  X = _mm512_add_ps(_mm512_mul_ps(X, diff), _mm512_set1_ps(Beta_X[I-1]));
+  Y = _mm512_add_ps(_mm512_mul_ps(Y, diff), _mm512_set1_ps(Beta_Y[I-1]));
+ }
+ 
+ f32 out_x[16], out_y[16];
+ _mm512_storeu_ps(out_x, X);
+ _mm512_storeu_ps(out_y, Y);
+ for (u32 lane = 0; lane < 16; ++lane)
+ {
+  Out[lane].X = out_x[lane];
+  Out[lane].Y = out_y[lane];
+ }
+}
+
 internal i32
 GaussianElimination(f32 *A, f32 *B, u32 Rows, u32 Cols)
 {
@@ -1573,13 +1908,13 @@ NURBS_EvaluateAVX2(v2 *P, f32 *W, u32 n, u32 m, f32 *Knots, f32 t8[8], v2 out[8]
  }
  
  // allocate D_x[k], D_y[k], D_w[k] as __m256 for k=0..m
- __m256 *D_x = (__m256*)malloc((size_t)(m + 1) * sizeof(__m256));
- __m256 *D_y = (__m256*)malloc((size_t)(m + 1) * sizeof(__m256));
- __m256 *D_w = (__m256*)malloc((size_t)(m + 1) * sizeof(__m256));
+ __m256 *D_x = (__m256*)_mm_malloc((size_t)(m + 1) * sizeof(__m256), 32);
+ __m256 *D_y = (__m256*)_mm_malloc((size_t)(m + 1) * sizeof(__m256), 32);
+ __m256 *D_w = (__m256*)_mm_malloc((size_t)(m + 1) * sizeof(__m256), 32);
  if (!D_x || !D_y || !D_w) {
   // allocation failed: write zeros to output and return
   for (int lane = 0; lane < 8; ++lane) { out[lane].X = 0.0f; out[lane].Y = 0.0f; }
-  free(D_x); free(D_y); free(D_w);
+  _mm_free(D_x); _mm_free(D_y); _mm_free(D_w);
   return;
  }
  
@@ -1672,38 +2007,469 @@ NURBS_EvaluateAVX2(v2 *P, f32 *W, u32 n, u32 m, f32 *Knots, f32 t8[8], v2 out[8]
   out[lane].Y = out_y[lane];
  }
  
- free(D_x);
- free(D_y);
- free(D_w);
+ _mm_free(D_x);
+ _mm_free(D_y);
+ _mm_free(D_w);
 }
 
-// NOTE(hbr): Those should be local conveniance internal, but impossible in C.
-inline internal f32 Hi(f32 *Ti, u32 I) { return Ti[I+1] - Ti[I]; }
-inline internal f32 Bi(f32 *Ti, f32 *Y, u32 I) { return 1.0f / Hi(Ti, I) * (Y[I+1] - Y[I]); }
-inline internal f32 Vi(f32 *Ti, u32 I) { return 2.0f * (Hi(Ti, I) + Hi(Ti, I+1)); }
-inline internal f32 Ui(f32 *Ti, f32 *Y, u32 I) { return 6.0f * (Bi(Ti, Y, I+1) - Bi(Ti, Y, I)); }
 internal void
-CubicSplineNaturalM(f32 *M, f32 *Ti, f32 *Y, u32 N)
+NURBS_ExtractionBinomials(u32 m, f64 Binomial[NURBS_ExtractionMaxDegree+1][NURBS_ExtractionMaxDegree+1])
 {
- if (N == 0) {} // NOTE(hbr): Nothing to calculate
- else if (N == 1) { M[0] = 0.0f; }
- else if (N == 2) { M[0] = M[N-1] = 0.0f; }
- else
+ for (u32 I = 0; I <= m; ++I)
  {
-  temp_arena Temp = TempArena(0);
-  
-  M[0] = M[N-1] = 0.0f;
-  
-  f32 *Diag = PushArrayNonZero(Temp.Arena, N, f32);
-  for (u32 I = 1; I < N-1; ++I)
+  Binomial[I][0] = 1.0;
+  for (u32 J = 1; J <= I; ++J)
   {
-   Diag[I] = Vi(Ti, I-1);
-   M[I] = Ui(Ti, Y, I-1);
+   Binomial[I][J] = Binomial[I-1][J-1] + Binomial[I-1][J];
   }
-  
-  for (u32 I = 2; I < N-1; ++I)
-  {
-   // NOTE(hbr): Maybe optimize Hi
+ }
+}
+
+// NOTE(hbr): Fills Span from non-empty knot interval [Knots[J], Knots[J+1]).
+internal void
+NURBS_ExtractSpan(nurbs_bezier_extraction *Extraction, u32 Span, u32 J,
+                  v2 *Controls, f32 *Weights, f32 *Knots,
+                  f64 Binomial[NURBS_ExtractionMaxDegree+1][NURBS_ExtractionMaxDegree+1])
+{
+ u32 m = Extraction->Degree;
+ u32 CoeffCount = m + 1;
+ f64 A = Knots[J];
+ f64 B = Knots[J+1];
+ 
+ // NOTE(hbr): Everything in f64, coefficients are rounded to f32 only at the very end
+ // NOTE(hbr): I-th Bezier control point of the span is the blossom f(A,...,A,B,...,B)
+ // with I B's, which is de Boor with different parameter at every level. This is the
+ // same as inserting A and B until they have multiplicity Degree.
+ f64 Bezier[NURBS_ExtractionMaxDegree+1][3];
+ for (u32 I = 0; I <= m; ++I)
+ {
+  f64 D[NURBS_ExtractionMaxDegree+1][3];
+  for (u32 K = 0; K <= m; ++K)
+  {
+   u32 Index = J - m + K;
+   f64 W = Weights[Index];
+   D[K][0] = Controls[Index].X * W;
+   D[K][1] = Controls[Index].Y * W;
+   D[K][2] = W;
+  }
+  
+  for (u32 R = 1; R <= m; ++R)
+  {
+   f64 U = (R <= m - I ? A : B);
+   for (u32 K = m; K >= R; --K)
+   {
+    u32 Index = J - m + K;
+    f64 Den = Cast(f64)Knots[Index + m + 1 - R] - Knots[Index];
+    f64 Alpha = (Den == 0.0 ? 0.0 : (U - Knots[Index]) / Den);
+    for (u32 C = 0; C < 3; ++C)
+    {
+     D[K][C] = (1.0 - Alpha) * D[K-1][C] + Alpha * D[K][C];
+    }
+   }
+  }
+  
+  for (u32 C = 0; C < 3; ++C)
+  {
+   Bezier[I][C] = D[m][C];
+  }
+ }
+ 
+ f32 *Coeffs = Extraction->Coeffs + Span * 3 * CoeffCount;
+ for (u32 C = 0; C < 3; ++C)
+ {
+  // NOTE(hbr): Bernstein -> power basis in u in [0,1]
+  f64 Power[NURBS_ExtractionMaxDegree+1];
+  for (u32 K = 0; K <= m; ++K)
+  {
+   f64 Sum = 0.0;
+   for (u32 I = 0; I <= K; ++I)
+   {
+    f64 Sign = (((K - I) & 1) ? -1.0 : 1.0);
+    Sum += Sign * Binomial[K][I] * Bezier[I][C];
+   }
+   Power[K] = Binomial[m][K] * Sum;
+  }
+  
+  // NOTE(hbr): Substitute u = (1+x)/2, Horner-style, to get power basis in x in [-1,1]
+  f64 Centered[NURBS_ExtractionMaxDegree+1] = {};
+  for (u32 K = m+1; K-- > 0;)
+  {
+   for (u32 I = m; I > 0; --I)
+   {
+    Centered[I] = 0.5 * (Centered[I] + Centered[I-1]);
+   }
+   Centered[0] = 0.5 * Centered[0] + Power[K];
+  }
+  
+  for (u32 K = 0; K <= m; ++K)
+  {
+   Coeffs[C * CoeffCount + (m - K)] = Cast(f32)Centered[K];
+  }
+ }
+ 
+ Extraction->SpanStarts[Span] = Knots[J];
+ Extraction->SpanMids[Span] = Cast(f32)(0.5 * (A + B));
+ Extraction->SpanInvHalfWidths[Span] = Cast(f32)(2.0 / (B - A));
+}
+
+internal nurbs_bezier_extraction
+NURBS_BezierExtraction(arena *Arena, v2 *Controls, f32 *Weights, b_spline_knot_params KnotParams, f32 *Knots)
+{
+ nurbs_bezier_extraction Result = {};
+ u32 m = KnotParams.Degree;
+ Result.Degree = m;
+ 
+ if (m <= NURBS_ExtractionMaxDegree && KnotParams.PartitionSize >= 2)
+ {
+  u32 n = KnotParams.PartitionSize - 1;
+  u32 CoeffCount = m + 1;
+  Result.SpanStarts = PushArrayNonZero(Arena, n + 1, f32);
+  Result.SpanMids = PushArrayNonZero(Arena, n, f32);
+  Result.SpanInvHalfWidths = PushArrayNonZero(Arena, n, f32);
+  Result.Coeffs = PushArrayNonZero(Arena, n * 3 * CoeffCount, f32);
+  
+  f64 Binomial[NURBS_ExtractionMaxDegree+1][NURBS_ExtractionMaxDegree+1] = {};
+  NURBS_ExtractionBinomials(m, Binomial);
+  
+  for (u32 J = m; J < n + m; ++J)
+  {
+   if (Knots[J] < Knots[J+1])
+   {
+    u32 Span = Result.SpanCount++;
+    NURBS_ExtractSpan(&Result, Span, J, Controls, Weights, Knots, Binomial);
+   }
+  }
+  
+  if (Result.SpanCount > 0)
+  {
+   Result.SpanStarts[Result.SpanCount] = Knots[n + m];
+   Result.Extracted = true;
+  }
+ }
+ 
+ return Result;
+}
+
+internal void
+NURBS_BezierExtractionUpdate(nurbs_bezier_extraction *Extraction, v2 *Controls, f32 *Weights, b_spline_knot_params KnotParams, f32 *Knots,
+                             u32 ControlBegin, u32 ControlEnd)
+{
+ if (Extraction->Extracted && ControlBegin < ControlEnd)
+ {
+  u32 m = KnotParams.Degree;
+  u32 n = KnotParams.PartitionSize - 1;
+  Assert(m == Extraction->Degree);
+  
+  // NOTE(hbr): Control I is used by knot intervals [I, I+m]
+  u32 JBegin = Max(ControlBegin, m);
+  u32 JEnd = Min(ControlEnd + m, n + m);
+  if (JBegin < JEnd)
+  {
+   f64 Binomial[NURBS_ExtractionMaxDegree+1][NURBS_ExtractionMaxDegree+1] = {};
+   NURBS_ExtractionBinomials(m, Binomial);
+   
+   // NOTE(hbr): Spans are non-empty intervals in order, find the first one at or after JBegin
+   f32 *Starts = Extraction->SpanStarts;
+   u32 Lo = 0;
+   u32 Hi = Extraction->SpanCount;
+   while (Lo < Hi)
+   {
+    u32 Mid = (Lo + Hi) / 2;
+    if (Starts[Mid] < Knots[JBegin]) Lo = Mid + 1;
+    else Hi = Mid;
+   }
+   
+   u32 Span = Lo;
+   for (u32 J = JBegin; J < JEnd; ++J)
+   {
+    if (Knots[J] < Knots[J+1])
+    {
+     Assert(Span < Extraction->SpanCount);
+     NURBS_ExtractSpan(Extraction, Span, J, Controls, Weights, Knots, Binomial);
+     ++Span;
+    }
+   }
+  }
+ }
+}
+
+internal u32
+NURBS_ExtractionFindSpan(f32 T, nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It)
+{
+ f32 *Starts = Extraction->SpanStarts;
+ u32 LastSpan = Extraction->SpanCount - 1;
+ u32 Span = It->Span;
+ if (T < Starts[Span])
+ {
+  // NOTE(hbr): Went backwards, binary search for the last span starting at or before T
+  u32 Lo = 0;
+  u32 Hi = Span;
+  while (Lo < Hi)
+  {
+   u32 Mid = (Lo + Hi + 1) / 2;
+   if (Starts[Mid] <= T) Lo = Mid;
+   else Hi = Mid - 1;
+  }
+  Span = Lo;
+ }
+ while (Span < LastSpan && T >= Starts[Span+1]) ++Span;
+ It->Span = Span;
+ return Span;
+}
+
+inline internal f32
+NURBS_ExtractionClampT(f32 T, nurbs_bezier_extraction *Extraction)
+{
+ f32 Result = Clamp(T, Extraction->SpanStarts[0], Extraction->SpanStarts[Extraction->SpanCount]);
+ return Result;
+}
+
+internal v2
+NURBS_EvaluateExtractedScalar(f32 T, nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It)
+{
+ T = NURBS_ExtractionClampT(T, Extraction);
+ u32 Span = NURBS_ExtractionFindSpan(T, Extraction, It);
+ u32 CoeffCount = Extraction->Degree + 1;
+ f32 *C = Extraction->Coeffs + Span * 3 * CoeffCount;
+ f32 X = (T - Extraction->SpanMids[Span]) * Extraction->SpanInvHalfWidths[Span];
+ 
+ f32 XW = C[0];
+ f32 YW = C[CoeffCount];
+ f32 W = C[2*CoeffCount];
+ for (u32 K = 1; K < CoeffCount; ++K)
+ {
+  XW = XW * X + C[K];
+  YW = YW * X + C[CoeffCount + K];
+  W = W * X + C[2*CoeffCount + K];
+ }
+ 
+ v2 Result = V2(XW / W, YW / W);
+ return Result;
+}
+
+// NOTE(hbr): Finds spans of all lanes. Returns true if all of them are the same, which is
+// almost always the case for sorted T, then coefficients can be just broadcasted.
+internal b32
+NURBS_ExtractionFindLaneSpans(f32 *T, u32 LaneCount, nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It, u32 *Spans)
+{
+ b32 SameSpan = true;
+ for (u32 Lane = 0; Lane < LaneCount; ++Lane)
+ {
+  T[Lane] = NURBS_ExtractionClampT(T[Lane], Extraction);
+  Spans[Lane] = NURBS_ExtractionFindSpan(T[Lane], Extraction, It);
+  SameSpan &= (Spans[Lane] == Spans[0]);
+ }
+ return SameSpan;
+}
+
+internal void
+NURBS_EvaluateExtractedSSE(f32 T[4], nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It, v2 Out[4])
+{
+ u32 CoeffCount = Extraction->Degree + 1;
+ f32 Ts[4];
+ u32 Spans[4];
+ MemoryCopy(Ts, T, SizeOf(Ts));
+ b32 SameSpan = NURBS_ExtractionFindLaneSpans(Ts, 4, Extraction, It, Spans);
+ 
+ __m128 t = _mm_loadu_ps(Ts);
+ __m128 XW, YW, W;
+ if (SameSpan)
+ {
+  u32 Span = Spans[0];
+  f32 *C = Extraction->Coeffs + Span * 3 * CoeffCount;
+  __m128 x = _mm_mul_ps(_mm_sub_ps(t, _mm_set1_ps(Extraction->SpanMids[Span])), _mm_set1_ps(Extraction->SpanInvHalfWidths[Span]));
+  XW = _mm_set1_ps(C[0]);
+  YW = _mm_set1_ps(C[CoeffCount]);
+  W = _mm_set1_ps(C[2*CoeffCount]);
+  for (u32 K = 1; K < CoeffCount; ++K)
+  {
+   XW = _mm_add_ps(_mm_mul_ps(XW, x), _mm_set1_ps(C[K]));
+   YW = _mm_add_ps(_mm_mul_ps(YW, x), _mm_set1_ps(C[CoeffCount + K]));
+   W = _mm_add_ps(_mm_mul_ps(W, x), _mm_set1_ps(C[2*CoeffCount + K]));
+  }
+ }
+ else
+ {
+  // NOTE(hbr): SSE has no gather instruction
+  f32 *C[4];
+  for (u32 Lane = 0; Lane < 4; ++Lane)
+  {
+   C[Lane] = Extraction->Coeffs + Spans[Lane] * 3 * CoeffCount;
+  }
+  f32 *Mids = Extraction->SpanMids;
+  f32 *InvHalfWidths = Extraction->SpanInvHalfWidths;
+  __m128 mid = _mm_setr_ps(Mids[Spans[0]], Mids[Spans[1]], Mids[Spans[2]], Mids[Spans[3]]);
+  __m128 inv_half = _mm_setr_ps(InvHalfWidths[Spans[0]], InvHalfWidths[Spans[1]], InvHalfWidths[Spans[2]], InvHalfWidths[Spans[3]]);
+  __m128 x = _mm_mul_ps(_mm_sub_ps(t, mid), inv_half);
+  XW = _mm_setr_ps(C[0][0], C[1][0], C[2][0], C[3][0]);
+  YW = _mm_setr_ps(C[0][CoeffCount], C[1][CoeffCount], C[2][CoeffCount], C[3][CoeffCount]);
+  W = _mm_setr_ps(C[0][2*CoeffCount], C[1][2*CoeffCount], C[2][2*CoeffCount], C[3][2*CoeffCount]);
+  for (u32 K = 1; K < CoeffCount; ++K)
+  {
+   u32 KY = CoeffCount + K;
+   u32 KW = 2*CoeffCount + K;
+   XW = _mm_add_ps(_mm_mul_ps(XW, x), _mm_setr_ps(C[0][K], C[1][K], C[2][K], C[3][K]));
+   YW = _mm_add_ps(_mm_mul_ps(YW, x), _mm_setr_ps(C[0][KY], C[1][KY], C[2][KY], C[3][KY]));
+   W = _mm_add_ps(_mm_mul_ps(W, x), _mm_setr_ps(C[0][KW], C[1][KW], C[2][KW], C[3][KW]));
+  }
+ }
+ 
+ __m128 inv_w = _mm_div_ps(_mm_set1_ps(1.0f), W);
+ f32 out_x[4], out_y[4];
+ _mm_storeu_ps(out_x, _mm_mul_ps(XW, inv_w));
+ _mm_storeu_ps(out_y, _mm_mul_ps(YW, inv_w));
+ for (u32 Lane = 0; Lane < 4; ++Lane)
+ {
+  Out[Lane].X = out_x[Lane];
+  Out[Lane].Y = out_y[Lane];
+ }
+}
+
+internal void
+NURBS_EvaluateExtractedAVX2(f32 T[8], nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It, v2 Out[8])
+{
+ u32 CoeffCount = Extraction->Degree + 1;
+ f32 Ts[8];
+ u32 Spans[8];
+ MemoryCopy(Ts, T, SizeOf(Ts));
+ b32 SameSpan = NURBS_ExtractionFindLaneSpans(Ts, 8, Extraction, It, Spans);
+ 
+ __m256 t = _mm256_loadu_ps(Ts);
+ __m256 XW, YW, W;
+ if (SameSpan)
+ {
+  u32 Span = Spans[0];
+  f32 *C = Extraction->Coeffs + Span * 3 * CoeffCount;
+  __m256 x = _mm256_mul_ps(_mm256_sub_ps(t, _mm256_set1_ps(Extraction->SpanMids[Span])), _mm256_set1_ps(Extraction->SpanInvHalfWidths[Span]));
+  XW = _mm256_set1_ps(C[0]);
+  YW = _mm256_set1_ps(C[CoeffCount]);
+  W = _mm256_set1_ps(C[2*CoeffCount]);
+  for (u32 K = 1; K < CoeffCount; ++K)
+  {
+   XW = _mm256_add_ps(_mm256_mul_ps(XW, x), _mm256_set1_ps(C[K]));
+   YW = _mm256_add_ps(_mm256_mul_ps(YW, x), _mm256_set1_ps(C[CoeffCount + K]));
+   W = _mm256_add_ps(_mm256_mul_ps(W, x), _mm256_set1_ps(C[2*CoeffCount + K]));
+  }
+ }
+ else
+ {
+  __m256i span = _mm256_loadu_si256(Cast(__m256i *)Spans);
+  __m256i base = _mm256_mullo_epi32(span, _mm256_set1_epi32(3 * CoeffCount));
+  __m256 mid = _mm256_i32gather_ps(Extraction->SpanMids, span, 4);
+  __m256 inv_half = _mm256_i32gather_ps(Extraction->SpanInvHalfWidths, span, 4);
+  __m256 x = _mm256_mul_ps(_mm256_sub_ps(t, mid), inv_half);
+  f32 *CX = Extraction->Coeffs;
+  f32 *CY = CX + CoeffCount;
+  f32 *CW = CY + CoeffCount;
+  XW = _mm256_i32gather_ps(CX, base, 4);
+  YW = _mm256_i32gather_ps(CY, base, 4);
+  W = _mm256_i32gather_ps(CW, base, 4);
+  for (u32 K = 1; K < CoeffCount; ++K)
+  {
+   __m256i index = _mm256_add_epi32(base, _mm256_set1_epi32(K));
+   XW = _mm256_add_ps(_mm256_mul_ps(XW, x), _mm256_i32gather_ps(CX, index, 4));
+   YW = _mm256_add_ps(_mm256_mul_ps(YW, x), _mm256_i32gather_ps(CY, index, 4));
+   W = _mm256_add_ps(_mm256_mul_ps(W, x), _mm256_i32gather_ps(CW, index, 4));
+  }
+ }
+ 
+ __m256 inv_w = _mm256_div_ps(_mm256_set1_ps(1.0f), W);
+ f32 out_x[8], out_y[8];
+ _mm256_storeu_ps(out_x, _mm256_mul_ps(XW, inv_w));
+ _mm256_storeu_ps(out_y, _mm256_mul_ps(YW, inv_w));
+ for (u32 Lane = 0; Lane < 8; ++Lane)
+ {
+  Out[Lane].X = out_x[Lane];
+  Out[Lane].Y = out_y[Lane];
+ }
+}
+
+internal void
+NURBS_EvaluateExtractedAVX512(f32 T[16], nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It, v2 Out[16])
+{
+ u32 CoeffCount = Extraction->Degree + 1;
+ f32 Ts[16];
+ u32 Spans[16];
+ MemoryCopy(Ts, T, SizeOf(Ts));
+ b32 SameSpan = NURBS_ExtractionFindLaneSpans(Ts, 16, Extraction, It, Spans);
+ 
+ __m512 t = _mm512_loadu_ps(Ts);
+ __m512 XW, YW, W;
+ if (SameSpan)
+ {
+  u32 Span = Spans[0];
+  f32 *C = Extraction->Coeffs + Span * 3 * CoeffCount;
+  __m512 x = _mm512_mul_ps(_mm512_sub_ps(t, _mm512_set1_ps(Extraction->SpanMids[Span])), _mm512_set1_ps(Extraction->SpanInvHalfWidths[Span]));
+  XW = _mm512_set1_ps(C[0]);
+  YW = _mm512_set1_ps(C[CoeffCount]);
+  W = _mm512_set1_ps(C[2*CoeffCount]);
+  for (u32 K = 1; K < CoeffCount; ++K)
+  {
+   XW = _mm512_add_ps(_mm512_mul_ps(XW, x), _mm512_set1_ps(C[K]));
+   YW = _mm512_add_ps(_mm512_mul_ps(YW, x), _mm512_set1_ps(C[CoeffCount + K]));
+   W = _mm512_add_ps(_mm512_mul_ps(W, x), _mm512_set1_ps(C[2*CoeffCount + K]));
+  }
+ }
+ else
+ {
+  __m512i span = _mm512_loadu_si512(Spans);
+  __m512i base = _mm512_mullo_epi32(span, _mm512_set1_epi32(3 * CoeffCount));
+  __m512 mid = _mm512_i32gather_ps(span, Extraction->SpanMids, 4);
+  __m512 inv_half = _mm512_i32gather_ps(span, Extraction->SpanInvHalfWidths, 4);
+  __m512 x = _mm512_mul_ps(_mm512_sub_ps(t, mid), inv_half);
+  f32 *CX = Extraction->Coeffs;
+  f32 *CY = CX + CoeffCount;
+  f32 *CW = CY + CoeffCount;
+  XW = _mm512_i32gather_ps(base, CX, 4);
+  YW = _mm512_i32gather_ps(base, CY, 4);
+  W = _mm512_i32gather_ps(base, CW, 4);
+  for (u32 K = 1; K < CoeffCount; ++K)
+  {
+   __m512i index = _mm512_add_epi32(base, _mm512_set1_epi32(K));
+   XW = _mm512_add_ps(_mm512_mul_ps(XW, x), _mm512_i32gather_ps(index, CX, 4));
+   YW = _mm512_add_ps(_mm512_mul_ps(YW, x), _mm512_i32gather_ps(index, CY, 4));
+   W = _mm512_add_ps(_mm512_mul_ps(W, x), _mm512_i32gather_ps(index, CW, 4));
+  }
+ }
+ 
+ __m512 inv_w = _mm512_div_ps(_mm512_set1_ps(1.0f), W);
+ f32 out_x[16], out_y[16];
+ _mm512_storeu_ps(out_x, _mm512_mul_ps(XW, inv_w));
+ _mm512_storeu_ps(out_y, _mm512_mul_ps(YW, inv_w));
+ for (u32 Lane = 0; Lane < 16; ++Lane)
+ {
+  Out[Lane].X = out_x[Lane];
+  Out[Lane].Y = out_y[Lane];
+ }
+}
+
+// NOTE(hbr): Those should be local conveniance internal, but impossible in C.
+inline internal f32 Hi(f32 *Ti, u32 I) { return Ti[I+1] - Ti[I]; }
+inline internal f32 Bi(f32 *Ti, f32 *Y, u32 I) { return 1.0f / Hi(Ti, I) * (Y[I+1] - Y[I]); }
+inline internal f32 Vi(f32 *Ti, u32 I) { return 2.0f * (Hi(Ti, I) + Hi(Ti, I+1)); }
+inline internal f32 Ui(f32 *Ti, f32 *Y, u32 I) { return 6.0f * (Bi(Ti, Y, I+1) - Bi(Ti, Y, I)); }
+internal void
+CubicSplineNaturalM(f32 *M, f32 *Ti, f32 *Y, u32 N)
+{
+ if (N == 0) {} // NOTE(hbr): Nothing to calculate
+ else if (N == 1) { M[0] = 0.0f; }
+ else if (N == 2) { M[0] = M[N-1] = 0.0f; }
+ else
+ {
+  temp_arena Temp = TempArena(0);
+  
+  M[0] = M[N-1] = 0.0f;
+  
+  f32 *Diag = PushArrayNonZero(Temp.Arena, N, f32);
+  for (u32 I = 1; I < N-1; ++I)
+  {
+   Diag[I] = Vi(Ti, I-1);
+   M[I] = Ui(Ti, Y, I-1);
+  }
+  
+  for (u32 I = 2; I < N-1; ++I)
+  {
+   // NOTE(hbr): Maybe optimize Hi
    f32 Multiplier = Hi(Ti, I-1) / Diag[I-1];
    Diag[I] -= Multiplier * Hi(Ti, I-1);
    M[I] -= Multiplier * M[I-1];
@@ -1942,7 +2708,9 @@ CubicSplineEvaluateScalarWithConstantSearch(f32 T, f32 *M, f32 *Ti, f32 *Y, u32
  else
  {
   u32 I = It->I;
-  if (I < N-1 && T >= Ti[I]) ++I;
+  // NOTE(hbr): Loop instead of single step, so that it is correct also when samples are
+  // sparser than control points or when evaluation starts in the middle of the curve.
+  while (I < N-1 && T >= Ti[I]) ++I;
   Assert(I > 0);
   Assert(T >= Ti[I-1]);
   Assert(T < Ti[I] || I == N-1);
@@ -1962,6 +2730,240 @@ CubicSplineEvaluateScalarWithConstantSearch(f32 T, f32 *M, f32 *Ti, f32 *Y, u32
  return R;
 }
 
+internal void
+CubicSplineEvaluateDegenerate(f32 *Xs, f32 *Ys, u32 N, u32 LaneCount, v2 *Out)
+{
+ Assert(N < 2);
+ v2 P = (N == 1 ? V2(Xs[0], Ys[0]) : V2(0.0f, 0.0f));
+ for (u32 Lane = 0; Lane < LaneCount; ++Lane)
+ {
+  Out[Lane] = P;
+ }
+}
+
+// NOTE(hbr): SIMD evaluators require T to be sorted ascending, across lanes and across
+// consecutive calls with the same iterator. Cursor walks forward to the segment of the last
+// lane, and lanes then binary search only between previous and new cursor. That is usually
+// just one or two segments, so almost no gathers are spent on searching.
+internal u32
+CubicSplineAdvanceCursor(f32 LastT, f32 *Ti, u32 N, cubic_spline_evaluate_iterator *It)
+{
+ u32 I = It->I;
+ while (I+1 < N-1 && LastT >= Ti[I+1]) ++I;
+ return I;
+}
+
+internal __m128
+CubicSplineGatherSSE(f32 *Base, __m128i Indices)
+{
+ // NOTE(hbr): SSE has no gather instruction
+ u32 I[4];
+ _mm_storeu_si128(Cast(__m128i *)I, Indices);
+ __m128 Result = _mm_setr_ps(Base[I[0]], Base[I[1]], Base[I[2]], Base[I[3]]);
+ return Result;
+}
+
+internal __m128
+CubicSplineSegmentSSE(__m128 a, __m128 b, __m128 h2_6, __m128 h,
+                      __m128 m0, __m128 m1, __m128 y0, __m128 y1)
+{
+ __m128 one_6 = _mm_set1_ps(1.0f / 6.0f);
+ __m128 A = _mm_mul_ps(_mm_mul_ps(one_6, m0), _mm_mul_ps(_mm_mul_ps(a, a), a));
+ __m128 B = _mm_mul_ps(_mm_mul_ps(one_6, m1), _mm_mul_ps(_mm_mul_ps(b, b), b));
+ __m128 C = _mm_mul_ps(_mm_sub_ps(y0, _mm_mul_ps(m0, h2_6)), a);
+ __m128 D = _mm_mul_ps(_mm_sub_ps(y1, _mm_mul_ps(m1, h2_6)), b);
+ __m128 R = _mm_div_ps(_mm_add_ps(_mm_add_ps(A, B), _mm_add_ps(C, D)), h);
+ return R;
+}
+
+internal void
+CubicSplineEvaluateSSE(f32 T[4], f32 *Mx, f32 *My, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, cubic_spline_evaluate_iterator *It, v2 Out[4])
+{
+ if (N < 2)
+ {
+  CubicSplineEvaluateDegenerate(Xs, Ys, N, 4, Out);
+ }
+ else
+ {
+  __m128 t = _mm_loadu_ps(T);
+  
+  // NOTE(hbr): Branchless binary search, every lane does the same number of steps.
+  // Finds the last segment I in [First, Last] such that Ti[I] <= T, the same as scalar versions.
+  u32 First = It->I;
+  u32 Last = CubicSplineAdvanceCursor(T[3], Ti, N, It);
+  It->I = Last;
+  
+  __m128i I = _mm_set1_epi32(First);
+  u32 Len = Last - First + 1;
+  while (Len > 1)
+  {
+   u32 Half = Len / 2;
+   __m128i mid = _mm_add_epi32(I, _mm_set1_epi32(Half));
+   __m128i take = _mm_castps_si128(_mm_cmpge_ps(t, CubicSplineGatherSSE(Ti, mid)));
+   I = _mm_add_epi32(I, _mm_and_si128(take, _mm_set1_epi32(Half)));
+   Len -= Half;
+  }
+  __m128i I1 = _mm_add_epi32(I, _mm_set1_epi32(1));
+  
+  __m128 t0 = CubicSplineGatherSSE(Ti, I);
+  __m128 t1 = CubicSplineGatherSSE(Ti, I1);
+  __m128 h = _mm_sub_ps(t1, t0);
+  __m128 h2_6 = _mm_mul_ps(_mm_mul_ps(h, h), _mm_set1_ps(1.0f / 6.0f));
+  __m128 a = _mm_sub_ps(t1, t);
+  __m128 b = _mm_sub_ps(t, t0);
+  
+  __m128 X = CubicSplineSegmentSSE(a, b, h2_6, h,
+                                   CubicSplineGatherSSE(Mx, I), CubicSplineGatherSSE(Mx, I1),
+                                   CubicSplineGatherSSE(Xs, I), CubicSplineGatherSSE(Xs, I1));
+  __m128 Y = CubicSplineSegmentSSE(a, b, h2_6, h,
+                                   CubicSplineGatherSSE(My, I), CubicSplineGatherSSE(My, I1),
+                                   CubicSplineGatherSSE(Ys, I), CubicSplineGatherSSE(Ys, I1));
+  
+  f32 out_x[4], out_y[4];
+  _mm_storeu_ps(out_x, X);
+  _mm_storeu_ps(out_y, Y);
+  for (u32 lane = 0; lane < 4; ++lane)
+  {
+   Out[lane].X = out_x[lane];
+   Out[lane].Y = out_y[lane];
+  }
+ }
+}
+
+internal __m256
+CubicSplineSegmentAVX2(__m256 a, __m256 b, __m256 h2_6, __m256 h,
+                       __m256 m0, __m256 m1, __m256 y0, __m256 y1)
+{
+ __m256 one_6 = _mm256_set1_ps(1.0f / 6.0f);
+ __m256 A = _mm256_mul_ps(_mm256_mul_ps(one_6, m0), _mm256_mul_ps(_mm256_mul_ps(a, a), a));
+ __m256 B = _mm256_mul_ps(_mm256_mul_ps(one_6, m1), _mm256_mul_ps(_mm256_mul_ps(b, b), b));
+ __m256 C = _mm256_mul_ps(_mm256_sub_ps(y0, _mm256_mul_ps(m0, h2_6)), a);
+ __m256 D = _mm256_mul_ps(_mm256_sub_ps(y1, _mm256_mul_ps(m1, h2_6)), b);
+ __m256 R = _mm256_div_ps(_mm256_add_ps(_mm256_add_ps(A, B), _mm256_add_ps(C, D)), h);
+ return R;
+}
+
+internal void
+CubicSplineEvaluateAVX2(f32 T[8], f32 *Mx, f32 *My, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, cubic_spline_evaluate_iterator *It, v2 Out[8])
+{
+ if (N < 2)
+ {
+  CubicSplineEvaluateDegenerate(Xs, Ys, N, 8, Out);
+ }
+ else
+ {
+  __m256 t = _mm256_loadu_ps(T);
+  
+  // NOTE(hbr): See CubicSplineEvaluateSSE
+  u32 First = It->I;
+  u32 Last = CubicSplineAdvanceCursor(T[7], Ti, N, It);
+  It->I = Last;
+  
+  __m256i I = _mm256_set1_epi32(First);
+  u32 Len = Last - First + 1;
+  while (Len > 1)
+  {
+   u32 Half = Len / 2;
+   __m256i mid = _mm256_add_epi32(I, _mm256_set1_epi32(Half));
+   __m256 ti_mid = _mm256_i32gather_ps(Ti, mid, 4);
+   __m256i take = _mm256_castps_si256(_mm256_cmp_ps(t, ti_mid, _CMP_GE_OQ));
+   I = _mm256_add_epi32(I, _mm256_and_si256(take, _mm256_set1_epi32(Half)));
+   Len -= Half;
+  }
+  __m256i I1 = _mm256_add_epi32(I, _mm256_set1_epi32(1));
+  
+  __m256 t0 = _mm256_i32gather_ps(Ti, I, 4);
+  __m256 t1 = _mm256_i32gather_ps(Ti, I1, 4);
+  __m256 h = _mm256_sub_ps(t1, t0);
+  __m256 h2_6 = _mm256_mul_ps(_mm256_mul_ps(h, h), _mm256_set1_ps(1.0f / 6.0f));
+  __m256 a = _mm256_sub_ps(t1, t);
+  __m256 b = _mm256_sub_ps(t, t0);
+  
+  __m256 X = CubicSplineSegmentAVX2(a, b, h2_6, h,
+                                    _mm256_i32gather_ps(Mx, I, 4), _mm256_i32gather_ps(Mx, I1, 4),
+                                    _mm256_i32gather_ps(Xs, I, 4), _mm256_i32gather_ps(Xs, I1, 4));
+  __m256 Y = CubicSplineSegmentAVX2(a, b, h2_6, h,
+                                    _mm256_i32gather_ps(My, I, 4), _mm256_i32gather_ps(My, I1, 4),
+                                    _mm256_i32gather_ps(Ys, I, 4), _mm256_i32gather_ps(Ys, I1, 4));
+  
+  f32 out_x[8], out_y[8];
+  _mm256_storeu_ps(out_x, X);
+  _mm256_storeu_ps(out_y, Y);
+  for (u32 lane = 0; lane < 8; ++lane)
+  {
+   Out[lane].X = out_x[lane];
+   Out[lane].Y = out_y[lane];
+  }
+ }
+}
+
+internal __m512
+CubicSplineSegmentAVX512(__m512 a, __m512 b, __m512 h2_6, __m512 h,
+                         __m512 m0, __m512 m1, __m512 y0, __m512 y1)
+{
+ __m512 one_6 = _mm512_set1_ps(1.0f / 6.0f);
+ __m512 A = _mm512_mul_ps(_mm512_mul_ps(one_6, m0), _mm512_mul_ps(_mm512_mul_ps(a, a), a));
+ __m512 B = _mm512_mul_ps(_mm512_mul_ps(one_6, m1), _mm512_mul_ps(_mm512_mul_ps(b, b), b));
+ __m512 C = _mm512_mul_ps(_mm512_sub_ps(y0, _mm512_mul_ps(m0, h2_6)), a);
+ __m512 D = _mm512_mul_ps(_mm512_sub_ps(y1, _mm512_mul_ps(m1, h2_6)), b);
+ __m512 R = _mm512_div_ps(_mm512_add_ps(_mm512_add_ps(A, B), _mm512_add_ps(C, D)), h);
+ return R;
+}
+
+internal void
+CubicSplineEvaluateAVX512(f32 T[16], f32 *Mx, f32 *My, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, cubic_spline_evaluate_iterator *It, v2 Out[16])
+{
+ if (N < 2)
+ {
+  CubicSplineEvaluateDegenerate(Xs, Ys, N, 16, Out);
+ }
+ else
+ {
+  __m512 t = _mm512_loadu_ps(T);
+  
+  // NOTE(hbr): See CubicSplineEvaluateSSE
+  u32 First = It->I;
+  u32 Last = CubicSplineAdvanceCursor(T[15], Ti, N, It);
+  It->I = Last;
+  
+  __m512i I = _mm512_set1_epi32(First);
+  u32 Len = Last - First + 1;
+  while (Len > 1)
+  {
+   u32 Half = Len / 2;
+   __m512i half = _mm512_set1_epi32(Half);
+   __m512 ti_mid = _mm512_i32gather_ps(_mm512_add_epi32(I, half), Ti, 4);
+   __mmask16 take = _mm512_cmp_ps_mask(t, ti_mid, _CMP_GE_OQ);
+   I = _mm512_mask_add_epi32(I, take, I, half);
+   Len -= Half;
+  }
+  __m512i I1 = _mm512_add_epi32(I, _mm512_set1_epi32(1));
+  
+  __m512 t0 = _mm512_i32gather_ps(I, Ti, 4);
+  __m512 t1 = _mm512_i32gather_ps(I1, Ti, 4);
+  __m512 h = _mm512_sub_ps(t1, t0);
+  __m512 h2_6 = _mm512_mul_ps(_mm512_mul_ps(h, h), _mm512_set1_ps(1.0f / 6.0f));
+  __m512 a = _mm512_sub_ps(t1, t);
+  __m512 b = _mm512_sub_ps(t, t0);
+  
+  __m512 X = CubicSplineSegmentAVX512(a, b, h2_6, h,
+                                      _mm512_i32gather_ps(I, Mx, 4), _mm512_i32gather_ps(I1, Mx, 4),
+                                      _mm512_i32gather_ps(I, Xs, 4), _mm512_i32gather_ps(I1, Xs, 4));
+  __m512 Y = CubicSplineSegmentAVX512(a, b, h2_6, h,
+                                      _mm512_i32gather_ps(I, My, 4), _mm512_i32gather_ps(I1, My, 4),
+                                      _mm512_i32gather_ps(I, Ys, 4), _mm512_i32gather_ps(I1, Ys, 4));
+  
+  f32 out_x[16], out_y[16];
+  _mm512_storeu_ps(out_x, X);
+  _mm512_storeu_ps(out_y, Y);
+  for (u32 lane = 0; lane < 16; ++lane)
+  {
+   Out[lane].X = out_x[lane];
+   Out[lane].Y = out_y[lane];
+  }
+ }
+}
+
 // NOTE(hbr): O(n) time, O(1) memory versions
 internal v2
 BezierCurveEvaluate(f32 T, v2 *P, u32 N)
@@ -2124,16 +3126,393 @@ BezierCurveRational_Evaluate_AVX512(f32 T[16], v2 *P, f32 *W, u32 N, v2 Out[16])
   Qy = _mm512_add_ps(_mm512_mul_ps(one_minus_H, Qy), _mm512_mul_ps(H, Py));
  }
  
- f32 out_x[8], out_y[8];
+ f32 out_x[16], out_y[16];
  _mm512_storeu_ps(out_x, Qx);
  _mm512_storeu_ps(out_y, Qy);
  
+ for (u32 lane = 0; lane < 16; ++lane) {
+  Out[lane].X = out_x[lane];
+  Out[lane].Y = out_y[lane];
+ }
+}
+
+internal v2
+BezierCurveRationalEvaluateF64(f32 T, v2 *P, f32 *W, u32 N)
+{
+ f64 T64 = T;
+ f64 H = 1.0;
+ f64 U = 1 - T64;
+ f64 Qx = P[0].X;
+ f64 Qy = P[0].Y;
+ 
+ for (u32 K = 1; K < N; ++K)
+ {
+  H = H * T64 * (N - K) * W[K];
+  H = H / (K * U * W[K-1] + H);
+  Qx = (1 - H) * Qx + H * P[K].X;
+  Qy = (1 - H) * Qy + H * P[K].Y;
+ }
+ 
+ v2 Q = V2(Cast(f32)Qx, Cast(f32)Qy);
+ return Q;
+}
+
+internal void
+BezierCurveRationalEvaluateF64_AVX2(f32 T[4], v2 *P, f32 *W, u32 N, v2 Out[4])
+{
+ __m256d t = _mm256_cvtps_pd(_mm_loadu_ps(T));
+ __m256d u = _mm256_sub_pd(_mm256_set1_pd(1.0), t);
+ __m256d H = _mm256_set1_pd(1.0);
+ 
+ __m256d Qx = _mm256_set1_pd(P[0].X);
+ __m256d Qy = _mm256_set1_pd(P[0].Y);
+ 
+ for (u32 K = 1; K < N; ++K) {
+  __m256d num = _mm256_mul_pd(H, t);
+  num = _mm256_mul_pd(num, _mm256_set1_pd(Cast(f64)(N - K) * W[K]));
+  
+  __m256d denom = _mm256_add_pd(_mm256_mul_pd(u, _mm256_set1_pd(Cast(f64)K * W[K - 1])), num);
+  
+  H = _mm256_div_pd(num, denom);
+  
+  __m256d one_minus_H = _mm256_sub_pd(_mm256_set1_pd(1.0), H);
+  Qx = _mm256_add_pd(_mm256_mul_pd(one_minus_H, Qx), _mm256_mul_pd(H, _mm256_set1_pd(P[K].X)));
+  Qy = _mm256_add_pd(_mm256_mul_pd(one_minus_H, Qy), _mm256_mul_pd(H, _mm256_set1_pd(P[K].Y)));
+ }
+ 
+ f32 out_x[4], out_y[4];
+ _mm_storeu_ps(out_x, _mm256_cvtpd_ps(Qx));
+ _mm_storeu_ps(out_y, _mm256_cvtpd_ps(Qy));
+ 
+ for (u32 lane = 0; lane < 4; ++lane) {
+  Out[lane].X = out_x[lane];
+  Out[lane].Y = out_y[lane];
+ }
+}
+
+internal void
+BezierCurveRationalEvaluateF64_AVX512(f32 T[8], v2 *P, f32 *W, u32 N, v2 Out[8])
+{
+ __m512d t = _mm512_cvtps_pd(_mm256_loadu_ps(T));
+ __m512d u = _mm512_sub_pd(_mm512_set1_pd(1.0), t);
+ __m512d H = _mm512_set1_pd(1.0);
+ 
+ __m512d Qx = _mm512_set1_pd(P[0].X);
+ __m512d Qy = _mm512_set1_pd(P[0].Y);
+ 
+ for (u32 K = 1; K < N; ++K) {
+  __m512d num = _mm512_mul_pd(H, t);
+  num = _mm512_mul_pd(num, _mm512_set1_pd(Cast(f64)(N - K) * W[K]));
+  
+  __m512d denom = _mm512_add_pd(_mm512_mul_pd(u, _mm512_set1_pd(Cast(f64)K * W[K - 1])), num);
+  
+  H = _mm512_div_pd(num, denom);
+  
+  __m512d one_minus_H = _mm512_sub_pd(_mm512_set1_pd(1.0), H);
+  Qx = _mm512_add_pd(_mm512_mul_pd(one_minus_H, Qx), _mm512_mul_pd(H, _mm512_set1_pd(P[K].X)));
+  Qy = _mm512_add_pd(_mm512_mul_pd(one_minus_H, Qy), _mm512_mul_pd(H, _mm512_set1_pd(P[K].Y)));
+ }
+ 
+ f32 out_x[8], out_y[8];
+ _mm256_storeu_ps(out_x, _mm512_cvtpd_ps(Qx));
+ _mm256_storeu_ps(out_y, _mm512_cvtpd_ps(Qy));
+ 
  for (u32 lane = 0; lane < 8; ++lane) {
   Out[lane].X = out_x[lane];
   Out[lane].Y = out_y[lane];
  }
 }
 
+// NOTE(hbr): Error-free transformations, A + B == Value + Error and A * B == Value + Error exactly.
+// They rely on strict IEEE arithmetic. Release builds use -Ofast, which would fold the error
+// terms to zero (A + B - A - B == 0 algebraically), so fast math is turned off up to the end
+// of BezierCurveRationalEvaluateCompensated.
+#if COMPILER_GCC
+# pragma GCC push_options
+# pragma GCC optimize("no-fast-math")
+#else
+# pragma float_control(precise, on, push)
+#endif
+internal f32_with_error
+TwoSum(f32 A, f32 B)
+{
+ f32_with_error Result = {};
+ Result.Value = A + B;
+ f32 Z = Result.Value - A;
+ Result.Error = (A - (Result.Value - Z)) + (B - Z);
+ return Result;
+}
+
+internal f32_with_error
+TwoProd(f32 A, f32 B)
+{
+ f32_with_error Result = {};
+ Result.Value = A * B;
+ Result.Error = fmaf(A, B, -Result.Value);
+ return Result;
+}
+
+// NOTE(hbr): Compensated de Casteljau (Graillat, Jiang, Langlois). Rounding error of every
+// step is captured exactly and propagated through the same recurrence, then added back at
+// the end. The result is as accurate as if computed in twice the working precision.
+// B and E hold N coefficients and their (initial) errors, both are overwritten.
+internal f32
+CompensatedDeCasteljau(f32 T, f32_with_error U, f32 *B, f32 *E, u32 N)
+{
+ for (u32 J = 1; J < N; ++J)
+ {
+  for (u32 I = 0; I < N - J; ++I)
+  {
+   f32_with_error P1 = TwoProd(U.Value, B[I]);
+   f32_with_error P2 = TwoProd(T, B[I+1]);
+   f32_with_error S = TwoSum(P1.Value, P2.Value);
+   // NOTE(hbr): U.Error accounts for 1-T not being exact
+   f32 Error = P1.Error + P2.Error + S.Error + U.Error * B[I];
+   E[I] = U.Value * E[I] + T * E[I+1] + Error;
+   B[I] = S.Value;
+  }
+ }
+ 
+ f32 Result = B[0] + E[0];
+ return Result;
+}
+
+internal v2
+BezierCurveRationalEvaluateCompensated(f32 T, v2 *P, f32 *W, u32 N, f32 *Scratch)
+{
+ v2 Result = {};
+ if (N > 0)
+ {
+  f32_with_error U = TwoSum(1.0f, -T);
+  f32 *B = Scratch;
+  f32 *E = Scratch + N;
+  f32 Homogeneous[3] = {};
+  
+  // NOTE(hbr): Rational curve is a ratio of two polynomials in homogeneous coordinates,
+  // evaluate W*X, W*Y and W separately.
+  for (u32 Coord = 0; Coord < 3; ++Coord)
+  {
+   for (u32 K = 0; K < N; ++K)
+   {
+    f32 Value = (Coord < 2 ? P[K].E[Coord] : 1.0f);
+    f32_with_error WP = TwoProd(W[K], Value);
+    B[K] = WP.Value;
+    E[K] = WP.Error;
+   }
+   Homogeneous[Coord] = CompensatedDeCasteljau(T, U, B, E, N);
+  }
+  
+  Result = V2(Homogeneous[0] / Homogeneous[2], Homogeneous[1] / Homogeneous[2]);
+ }
+ 
+ return Result;
+}
+#if COMPILER_GCC
+# pragma GCC pop_options
+#else
+# pragma float_control(pop)
+#endif
+
+// NOTE(hbr): Analytic forward differences of C[0] + C[1]*u + C[2]*u^2 + C[3]*u^3 at U with step H.
+// Analytic instead of differencing 4 evaluated points, because that loses a lot of precision.
+internal cubic_forward_differences
+CubicForwardDifferencesInit(f32 C[4][3], u32 ComponentCount, f32 U, f32 H)
+{
+ cubic_forward_differences FD = {};
+ FD.ComponentCount = ComponentCount;
+ 
+ f32 H2 = H * H;
+ f32 H3 = H2 * H;
+ for (u32 I = 0; I < ComponentCount; ++I)
+ {
+  f32 C0 = C[0][I], C1 = C[1][I], C2 = C[2][I], C3 = C[3][I];
+  FD.F[I] = ((C3 * U + C2) * U + C1) * U + C0;
+  FD.D1[I] = C1 * H + C2 * (2*U*H + H2) + C3 * (3*U*U*H + 3*U*H2 + H3);
+  FD.D2[I] = 2*C2 * H2 + C3 * (6*U*H2 + 6*H3);
+  FD.D3[I] = 6*C3 * H3;
+ }
+ 
+ return FD;
+}
+
+internal void
+CubicForwardDifferencesStep(cubic_forward_differences *FD)
+{
+ // NOTE(hbr): Unused components are zero, stepping all of them lets compiler vectorize this
+ for (u32 I = 0; I < ArrayCount(FD->F); ++I)
+ {
+  FD->F[I] += FD->D1[I];
+  FD->D1[I] += FD->D2[I];
+  FD->D2[I] += FD->D3[I];
+ }
+}
+
+internal void
+BezierCurveRationalForwardDifferencesExact(f32 T0, f32 Delta_T, u32 SampleCount, v2 *P, f32 *W, u32 N, v2 *Out)
+{
+ Assert(N > 0 && N <= 4);
+ 
+ // NOTE(hbr): Homogeneous coordinates (w*x, w*y, w) are polynomials, so they can be forward
+ // differenced exactly. Convert them from Bernstein to power basis first.
+ f32 Binomial[4][4] = {
+  {1},
+  {1, 1},
+  {1, 2, 1},
+  {1, 3, 3, 1},
+ };
+ u32 Degree = N - 1;
+ f32 C[4][3] = {};
+ for (u32 K = 0; K <= Degree; ++K)
+ {
+  for (u32 I = 0; I <= K; ++I)
+  {
+   f32 Sign = (((K - I) & 1) ? -1.0f : 1.0f);
+   f32 Coeff = Binomial[Degree][K] * Binomial[K][I] * Sign;
+   C[K][0] += Coeff * W[I] * P[I].X;
+   C[K][1] += Coeff * W[I] * P[I].Y;
+   C[K][2] += Coeff * W[I];
+  }
+ }
+ 
+ u32 SampleIndex = 0;
+ while (SampleIndex < SampleCount)
+ {
+  cubic_forward_differences FD = CubicForwardDifferencesInit(C, 3, T0 + SampleIndex * Delta_T, Delta_T);
+  u32 AnchorEnd = Min(SampleIndex + BezierForwardDifferencesReanchorInterval, SampleCount);
+  for (; SampleIndex < AnchorEnd; ++SampleIndex)
+  {
+   f32 Inv_W = 1.0f / FD.F[2];
+   Out[SampleIndex] = V2(FD.F[0] * Inv_W, FD.F[1] * Inv_W);
+   CubicForwardDifferencesStep(&FD);
+  }
+ }
+}
+
+internal void
+BezierCurveRationalForwardDifferencesPiecewise(f32 T0, f32 Delta_T, u32 SampleCount, v2 *P, f32 *W, u32 N, v2 *Out)
+{
+ // NOTE(hbr): High degree polynomials can't be forward differenced directly, error grows
+ // exponentially with the degree. Instead, every piece of consecutive samples is
+ // approximated with a cubic that interpolates the curve exactly at four evenly spaced
+ // parameters within that piece (including both ends, so pieces connect exactly), and
+ // only that cubic is forward differenced.
+ //
+ // Cubic approximation error grows roughly like (Degree * PieceSpan)^4, which gives the
+ // first guess of the piece span. Every piece is then checked against the curve at s=0.5
+ // and s=2.5, where interpolation error s(s-1)(s-2)(s-3) peaks, and halved until it is
+ // within half of the tolerance (margin for the error between checked points). Fitting a
+ // piece costs 6 evaluations, so pieces shorter than BezierForwardDifferencesMinPieceLength
+ // are not worth it, such samples are just evaluated exactly.
+ u32 Degree = N - 1;
+ f32 MaxPieceSpan = BezierForwardDifferencesMaxPieceSpanTimesDegree / Degree;
+ u32 MaxPieceLength = BezierForwardDifferencesSamplesPerPiece;
+ if (Delta_T > 0.0f)
+ {
+  MaxPieceLength = Cast(u32)Min(Cast(f32)MaxPieceLength, MaxPieceSpan / Delta_T);
+ }
+ 
+ // NOTE(hbr): With positive weights curve stays within convex hull of control points
+ v2 BoundsMin = P[0];
+ v2 BoundsMax = P[0];
+ for (u32 K = 1; K < N; ++K)
+ {
+  BoundsMin = V2(Min(BoundsMin.X, P[K].X), Min(BoundsMin.Y, P[K].Y));
+  BoundsMax = V2(Max(BoundsMax.X, P[K].X), Max(BoundsMax.Y, P[K].Y));
+ }
+ f32 Tolerance = BezierForwardDifferencesRelativeTolerance * Max(BoundsMax.X - BoundsMin.X, BoundsMax.Y - BoundsMin.Y);
+ 
+ u32 SampleIndex = 0;
+ u32 PieceLengthGuess = MaxPieceLength;
+ v2 PieceBegin = BezierCurveRationalEvaluateScalar(T0, P, W, N);
+ while (SampleIndex + 1 < SampleCount)
+ {
+  u32 PieceLength = Min(PieceLengthGuess, SampleCount - 1 - SampleIndex);
+  f32 PieceT0 = T0 + SampleIndex * Delta_T;
+  b32 Fitted = false;
+  v2 F3 = {};
+  f32 C[4][3] = {};
+  while (PieceLength >= BezierForwardDifferencesMinPieceLength && !Fitted)
+  {
+   f32 NodeDelta_T = PieceLength * Delta_T / 3;
+   
+   v2 F0 = PieceBegin;
+   v2 F1 = BezierCurveRationalEvaluateScalar(PieceT0 + 1 * NodeDelta_T, P, W, N);
+   v2 F2 = BezierCurveRationalEvaluateScalar(PieceT0 + 2 * NodeDelta_T, P, W, N);
+   F3 = BezierCurveRationalEvaluateScalar(PieceT0 + 3 * NodeDelta_T, P, W, N);
+   
+   // NOTE(hbr): Newton form in s (nodes at s=0,1,2,3) expanded into power basis
+   v2 Delta1 = F1 - F0;
+   v2 Delta2 = F2 - 2*F1 + F0;
+   v2 Delta3 = F3 - 3*F2 + 3*F1 - F0;
+   v2 C0 = F0;
+   v2 C1 = Delta1 - 0.5f*Delta2 + (1.0f/3.0f)*Delta3;
+   v2 C2 = 0.5f*Delta2 - 0.5f*Delta3;
+   v2 C3 = (1.0f/6.0f)*Delta3;
+   
+   v2 Check0 = BezierCurveRationalEvaluateScalar(PieceT0 + 0.5f * NodeDelta_T, P, W, N);
+   v2 Check1 = BezierCurveRationalEvaluateScalar(PieceT0 + 2.5f * NodeDelta_T, P, W, N);
+   v2 Cubic0 = 0.5f*(0.5f*(0.5f*C3 + C2) + C1) + C0;
+   v2 Cubic1 = 2.5f*(2.5f*(2.5f*C3 + C2) + C1) + C0;
+   f32 Error = Max(Norm(Cubic0 - Check0), Norm(Cubic1 - Check1));
+   
+   if (Error <= 0.5f * Tolerance)
+   {
+    Fitted = true;
+    C[0][0] = C0.X; C[0][1] = C0.Y;
+    C[1][0] = C1.X; C[1][1] = C1.Y;
+    C[2][0] = C2.X; C[2][1] = C2.Y;
+    C[3][0] = C3.X; C[3][1] = C3.Y;
+   }
+   else
+   {
+    PieceLength /= 2;
+   }
+  }
+  
+  if (Fitted)
+  {
+   cubic_forward_differences FD = CubicForwardDifferencesInit(C, 2, 0.0f, 3.0f / PieceLength);
+   for (u32 I = 0; I < PieceLength; ++I)
+   {
+    Out[SampleIndex++] = V2(FD.F[0], FD.F[1]);
+    CubicForwardDifferencesStep(&FD);
+   }
+   PieceBegin = F3;
+   // NOTE(hbr): Curvature changes smoothly, start next piece from the length that worked
+   PieceLengthGuess = Min(2 * PieceLength, MaxPieceLength);
+  }
+  else
+  {
+   u32 ExactCount = Min(BezierForwardDifferencesMinPieceLength, SampleCount - 1 - SampleIndex);
+   for (u32 I = 0; I < ExactCount; ++I)
+   {
+    Out[SampleIndex++] = PieceBegin;
+    PieceBegin = BezierCurveRationalEvaluateScalar(T0 + SampleIndex * Delta_T, P, W, N);
+   }
+   PieceLengthGuess = Min(2 * BezierForwardDifferencesMinPieceLength, MaxPieceLength);
+  }
+ }
+ 
+ if (SampleIndex < SampleCount)
+ {
+  Out[SampleIndex] = PieceBegin;
+ }
+}
+
+internal void
+BezierCurveRationalForwardDifferences(f32 T0, f32 Delta_T, u32 SampleCount, v2 *P, f32 *W, u32 N, v2 *Out)
+{
+ if (N == 0) {} // NOTE(hbr): Nothing to do
+ else if (N <= 4)
+ {
+  BezierCurveRationalForwardDifferencesExact(T0, Delta_T, SampleCount, P, W, N, Out);
+ }
+ else
+ {
+  BezierCurveRationalForwardDifferencesPiecewise(T0, Delta_T, SampleCount, P, W, N, Out);
+ }
+}
+
 internal void
 BezierCurve_ElevateDegree(v2 *P, u32 N)
 {
@@ -2616,14 +3995,20 @@ BezierCurveSplit(f32 T, u32 N, v2 *P, f32 *W,
  EndTemp(Temp);
 }
 
+internal u32
+DeCasteljauTotalPointCount(u32 N)
+{
+ u32 Result = N * (N+1) / 2;
+ return Result;
+}
+
+// NOTE(hbr): OutP and OutW have to have room for DeCasteljauTotalPointCount(N) elements
 internal all_de_casteljau_intermediate_results
-DeCasteljauAlgorithm(arena *Arena, f32 T, v2 *P, f32 *W, u32 N)
+DeCasteljauAlgorithmInto(f32 T, v2 *P, f32 *W, u32 N, v2 *OutP, f32 *OutW)
 {
  all_de_casteljau_intermediate_results Result = {};
  
- u32 TotalPointCount = N * (N+1) / 2;
- v2 *OutP = PushArrayNonZero(Arena, TotalPointCount, v2);
- f32   *OutW = PushArrayNonZero(Arena, TotalPointCount, f32);
+ u32 TotalPointCount = DeCasteljauTotalPointCount(N);
  
  MemoryCopy(OutW, W, N * SizeOf(OutW[0]));
  MemoryCopy(OutP, P, N * SizeOf(OutP[0]));
@@ -2661,6 +4046,16 @@ DeCasteljauAlgorithm(arena *Arena, f32 T, v2 *P, f32 *W, u32 N)
  return Result;
 }
 
+internal all_de_casteljau_intermediate_results
+DeCasteljauAlgorithm(arena *Arena, f32 T, v2 *P, f32 *W, u32 N)
+{
+ u32 TotalPointCount = DeCasteljauTotalPointCount(N);
+ v2 *OutP = PushArrayNonZero(Arena, TotalPointCount, v2);
+ f32 *OutW = PushArrayNonZero(Arena, TotalPointCount, f32);
+ all_de_casteljau_intermediate_results Result = DeCasteljauAlgorithmInto(T, P, W, N, OutP, OutW);
+ return Result;
+}
+
 internal f32
 PointDistanceSquaredSigned(v2 P, v2 Point, f32 Radius)
 {
@@ -2712,6 +4107,23 @@ SegmentSignedDistance(v2 P, v2 SegmentBegin, v2 SegmentEnd, f32 SegmentWidth)
  return Result;
 }
 
+internal f32
+PointSegmentDistanceSquared(v2 P, v2 SegmentBegin, v2 SegmentEnd)
+{
+ v2 U = SegmentEnd - SegmentBegin;
+ v2 V = P - SegmentBegin;
+ f32 SegmentLengthSquared = Dot(U, U);
+ f32 Fraction = 0.0f;
+ if (SegmentLengthSquared > 0.0f)
+ {
+  Fraction = Clamp01(Dot(U, V) / SegmentLengthSquared);
+ }
+ v2 Closest = SegmentBegin + Fraction * U;
+ f32 Result = NormSquared(P - Closest);
+ 
+ return Result;
+}
+
 internal b32
 SegmentCollision(v2 P, v2 LineA, v2 LineB, f32 LineWidth)
 {
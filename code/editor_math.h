@@ -35,6 +35,8 @@
 #define SqrtF32(X)             sqrtf(X)
 #define ExpF32(X)              expf(X)
 #define LogF32(X)              logf(X)
+#define ExpF64(X)              exp(X)
+#define LogF64(X)              log(X)
 #define LogBaseF32(Base, X)    (LogF32(X) / LogF32(Base))
 #define Log10F32(X)            log10f(X)
 #define TanhF32(X)             tanhf(X)
@@ -194,11 +196,20 @@ internal void BarycentricOmegaWerner(f32 *Omega, f32 *Ti, u32 N);
 internal void BarycentricOmegaEquidistant(f32 *Omega, f32 *Ti, u32 N);
 internal void BarycentricOmegaChebychev(f32 *Omega, u32 N);
 internal f32 BarycentricEvaluate(f32 T, f32 *Omega, f32 *Ti, f32 *Y, u32 N);
+// NOTE(hbr): SIMD versions evaluate both coordinates at once, sharing Omega/(T-Ti) terms
+internal void BarycentricEvaluateSSE(f32 T[4], f32 *Omega, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, v2 Out[4]);
+internal void BarycentricEvaluateAVX2(f32 T[8], f32 *Omega, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, v2 Out[8]);
+internal void BarycentricEvaluateAVX512(f32 T[16], f32 *Omega, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, v2 Out[16]);
 
 //- Newton form polynomial
 internal void NewtonBeta(f32 *Beta, f32 *Ti, f32 *Y, u32 N);
 internal void NewtonBetaFast(f32 *Beta, f32 *Ti, f32 *Y, u32 N);
 internal f32  NewtonEvaluate(f32 T, f32 *Beta, f32 *Ti, u32 N);
+internal f32  NewtonEvaluateUnrolled4x(f32 T, f32 *Beta, f32 *Ti, u32 N);
+// NOTE(hbr): SIMD versions evaluate both coordinates at once, sharing T-Ti terms
+internal void NewtonEvaluateSSE(f32 T[4], f32 *Beta_X, f32 *Beta_Y, f32 *Ti, u32 N, v2 Out[4]);
+internal void NewtonEvaluateAVX2(f32 T[8], f32 *Beta_X, f32 *Beta_Y, f32 *Ti, u32 N, v2 Out[8]);
+internal void NewtonEvaluateAVX512(f32 T[16], f32 *Beta_X, f32 *Beta_Y, f32 *Ti, u32 N, v2 Out[16]);
 
 //- Cubic Spline interpolation
 internal void CubicSplineNaturalM(f32 *M, f32 *Ti, f32 *Y, u32 N);
@@ -208,6 +219,12 @@ struct cubic_spline_evaluate_iterator { u32 I; };
 internal f32 CubicSplineEvaluateScalar(f32 T, f32 *M, f32 *Ti, f32 *Y, u32 N);
 internal f32 CubicSplineEvaluateScalarWithBinarySearch(f32 T, f32 *M, f32 *Ti, f32 *Y, u32 N);
 internal f32 CubicSplineEvaluateScalarWithConstantSearch(f32 T, f32 *M, f32 *Ti, f32 *Y, u32 N, cubic_spline_evaluate_iterator *It);
+// NOTE(hbr): SIMD versions evaluate both coordinates at once, so that segment search is done
+// only once per lane. T has to be sorted, same as for constant search version. Iterator has
+// to be zero initialized and not shared with constant search version.
+internal void CubicSplineEvaluateSSE(f32 T[4], f32 *Mx, f32 *My, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, cubic_spline_evaluate_iterator *It, v2 Out[4]);
+internal void CubicSplineEvaluateAVX2(f32 T[8], f32 *Mx, f32 *My, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, cubic_spline_evaluate_iterator *It, v2 Out[8]);
+internal void CubicSplineEvaluateAVX512(f32 T[16], f32 *Mx, f32 *My, f32 *Ti, f32 *Xs, f32 *Ys, u32 N, cubic_spline_evaluate_iterator *It, v2 Out[16]);
 
 //- Bezier curve
 struct bezier_lower_degree_inverse_degree_elevation
@@ -239,6 +256,43 @@ internal void BezierCurveRationalEvaluateSSE(f32 T[4], v2 *P, f32 *W, u32 N, v2
 internal void BezierCurveRationalEvaluateAVX2(f32 T[8], v2 *P, f32 *W, u32 N, v2 Out[8]);
 internal void BezierCurveRationalEvaluateAVX512(f32 T[16], v2 *P, f32 *W, u32 N, v2 Out[16]);
 
+// NOTE(hbr): Same as above but in f64, for high degree curves where f32 loses precision
+internal v2 BezierCurveRationalEvaluateF64(f32 T, v2 *P, f32 *W, u32 N);
+internal void BezierCurveRationalEvaluateF64_AVX2(f32 T[4], v2 *P, f32 *W, u32 N, v2 Out[4]);
+internal void BezierCurveRationalEvaluateF64_AVX512(f32 T[8], v2 *P, f32 *W, u32 N, v2 Out[8]);
+
+struct f32_with_error
+{
+ f32 Value;
+ f32 Error;
+};
+internal f32_with_error TwoSum(f32 A, f32 B);
+internal f32_with_error TwoProd(f32 A, f32 B);
+internal f32 CompensatedDeCasteljau(f32 T, f32_with_error U, f32 *B, f32 *E, u32 N);
+// NOTE(hbr): O(N^2), Scratch has to hold 2*N floats
+internal v2 BezierCurveRationalEvaluateCompensated(f32 T, v2 *P, f32 *W, u32 N, f32 *Scratch);
+
+// NOTE(hbr): Samples at T0, T0+Delta_T, ..., in O(1) per sample. Exact (up to float error,
+// bounded by reanchoring) for cubic and lower degrees. Higher degrees are approximated
+// piecewise with cubics, each piece within tolerance (relative to control points' bounding
+// box) of the curve, see BezierCurveRationalForwardDifferencesPiecewise.
+#define BezierForwardDifferencesReanchorInterval 64
+#define BezierForwardDifferencesSamplesPerPiece 64
+#define BezierForwardDifferencesMaxPieceSpanTimesDegree 0.5f
+#define BezierForwardDifferencesMinPieceLength 8
+#define BezierForwardDifferencesRelativeTolerance 1e-4f
+struct cubic_forward_differences
+{
+ u32 ComponentCount;
+ f32 F[3];
+ f32 D1[3];
+ f32 D2[3];
+ f32 D3[3];
+};
+internal cubic_forward_differences CubicForwardDifferencesInit(f32 C[4][3], u32 ComponentCount, f32 U, f32 H);
+internal void                      CubicForwardDifferencesStep(cubic_forward_differences *FD);
+internal void BezierCurveRationalForwardDifferences(f32 T0, f32 Delta_T, u32 SampleCount, v2 *P, f32 *W, u32 N, v2 *Out);
+
 internal void                                         BezierCurveElevateDegree(v2 *P, u32 N);
 internal void                                         BezierCurveRationalEvelateDegree(v2 *P, f32 *W, u32 N);
 internal bezier_lower_degree_inverse_degree_elevation BezierCurveLowerDegreeUsingInverseDegreeElevation(v2 *P, f32 *W, u32 N);
@@ -256,7 +310,9 @@ struct all_de_casteljau_intermediate_results
  v2 *P;
  f32 *W;
 };
+internal u32 DeCasteljauTotalPointCount(u32 N);
 internal all_de_casteljau_intermediate_results DeCasteljauAlgorithm(arena *Arena, f32 T, v2 *P, f32 *W, u32 N);
+internal all_de_casteljau_intermediate_results DeCasteljauAlgorithmInto(f32 T, v2 *P, f32 *W, u32 N, v2 *OutP, f32 *OutW);
 
 //- B-Spline curve
 struct b_spline_degree_bounds
@@ -286,6 +342,33 @@ internal v2 NURBS_EvaluateScalar(f32 T, v2 *Controls, f32 *Weights, b_spline_kno
 internal void NURBS_EvaluateSSE(v2 *P, f32 *W, u32 n, u32 m, f32 *Knots, f32 t4[4], v2 out[4]);
 internal void NURBS_EvaluateAVX2(v2 *P, f32 *W, u32 n, u32 m, f32 *Knots, f32 t8[8], v2 out[8]);
 
+// NOTE(hbr): Bezier extraction turns every non-empty knot span into rational polynomial
+// (homogeneous X*W, Y*W, W) in power basis, so that evaluation is span lookup + Horner
+// instead of O(Degree^2) Cox-de Boor per sample. Power basis is in variable centered on the span
+// and scaled to [-1,1], which keeps it well-conditioned, but only up to some degree. Above that
+// extraction is not done (Extracted == false) and callers should fall back to Cox-de Boor.
+#define NURBS_ExtractionMaxDegree 10
+struct nurbs_bezier_extraction
+{
+ b32 Extracted;
+ u32 Degree;
+ u32 SpanCount;
+ f32 *SpanStarts; // SpanCount+1 breakpoints
+ f32 *SpanMids;
+ f32 *SpanInvHalfWidths;
+ f32 *Coeffs; // per span: X*W, Y*W, W coefficients, each (Degree+1) long, highest power first
+};
+struct nurbs_extraction_iterator { u32 Span; };
+internal nurbs_bezier_extraction NURBS_BezierExtraction(arena *Arena, v2 *Controls, f32 *Weights, b_spline_knot_params KnotParams, f32 *Knots);
+// NOTE(hbr): Re-extracts only spans that use controls [ControlBegin, ControlEnd), knots have to stay the same.
+internal void NURBS_BezierExtractionUpdate(nurbs_bezier_extraction *Extraction, v2 *Controls, f32 *Weights, b_spline_knot_params KnotParams, f32 *Knots, u32 ControlBegin, u32 ControlEnd);
+// NOTE(hbr): Iterator has to be zero initialized. Evaluation is the fastest when T is sorted
+// (span lookup is then amortized O(1)), but any order works.
+internal v2   NURBS_EvaluateExtractedScalar(f32 T, nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It);
+internal void NURBS_EvaluateExtractedSSE(f32 T[4], nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It, v2 Out[4]);
+internal void NURBS_EvaluateExtractedAVX2(f32 T[8], nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It, v2 Out[8]);
+internal void NURBS_EvaluateExtractedAVX512(f32 T[16], nurbs_bezier_extraction *Extraction, nurbs_extraction_iterator *It, v2 Out[16]);
+
 //~ Collisions, intersections, geometry
 struct line_intersection
 {
@@ -299,6 +382,7 @@ internal b32               SegmentCollision(v2 Position, v2 LineA, v2 LineB, f32
 internal line_intersection LineIntersection(v2 A, v2 B, v2 C, v2 D);
 internal f32               AABBSignedDistance(v2 P, v2 BoxP, v2 BoxSize);
 internal f32               SegmentSignedDistance(v2 P, v2 SegmentBegin, v2 SegmentEnd, f32 SegmentWidth);
+internal f32               PointSegmentDistanceSquared(v2 P, v2 SegmentBegin, v2 SegmentEnd);
 internal f32               TriangleArea(v2 P0, v2 P1, v2 P2);
 
 //~ Misc
@@ -228,6 +228,9 @@ typedef PLATFORM_DEALLOC_VIRTUAL_MEMORY(platform_dealloc_virtual_memory);
 #define PLATFORM_COMMIT_VIRTUAL_MEMORY(Name) void Name(void *Memory, u64 Size)
 typedef PLATFORM_COMMIT_VIRTUAL_MEMORY(platform_commit_virtual_memory);
 
+#define PLATFORM_DECOMMIT_VIRTUAL_MEMORY(Name) void Name(void *Memory, u64 Size)
+typedef PLATFORM_DECOMMIT_VIRTUAL_MEMORY(platform_decommit_virtual_memory);
+
 #define PLATFORM_GET_SCRATCH_ARENA(Name) temp_arena Name(arena *Conflict)
 typedef PLATFORM_GET_SCRATCH_ARENA(platform_get_scratch_arena);
 
@@ -250,15 +253,36 @@ typedef PLATFORM_GET_PLATFORM_INFO(platform_get_platform_info);
 typedef PLATFORM_TOGGLE_FULLSCREEN(platform_toggle_fullscreen);
 
 typedef void work_queue_func(void *UserData);
+// NOTE(hbr): Entries added with a group can be waited for without waiting for
+// everything else on the queue. Zero initialized group is empty.
+struct work_queue_group
+{
+ u64 volatile PendingCount;
+};
 #define PLATFORM_WORK_QUEUE_ADD_ENTRY(Name) void Name(work_queue *Queue, work_queue_func *Func, void *UserData)
 typedef PLATFORM_WORK_QUEUE_ADD_ENTRY(platform_work_queue_add_entry);
 
+#define PLATFORM_WORK_QUEUE_ADD_GROUP_ENTRY(Name) void Name(work_queue *Queue, work_queue_group *Group, work_queue_func *Func, void *UserData)
+typedef PLATFORM_WORK_QUEUE_ADD_GROUP_ENTRY(platform_work_queue_add_group_entry);
+
+#define PLATFORM_WORK_QUEUE_ADD_GROUP_ENTRIES(Name) void Name(work_queue *Queue, work_queue_group *Group, work_queue_func *Func, void *UserData, u32 UserDataSize, u32 Count)
+typedef PLATFORM_WORK_QUEUE_ADD_GROUP_ENTRIES(platform_work_queue_add_group_entries);
+
+#define PLATFORM_WORK_QUEUE_COMPLETE_GROUP(Name) void Name(work_queue *Queue, work_queue_group *Group)
+typedef PLATFORM_WORK_QUEUE_COMPLETE_GROUP(platform_work_queue_complete_group);
+
 #define PLATFORM_WORK_QUEUE_COMPLETE_ALL_WORK(Name) void Name(work_queue *Queue)
 typedef PLATFORM_WORK_QUEUE_COMPLETE_ALL_WORK(platform_work_queue_complete_all_work);
 
 #define PLATFORM_WORK_QUEUE_FREE_ENTRY_COUNT(Name) u32 Name(work_queue *Queue)
 typedef PLATFORM_WORK_QUEUE_FREE_ENTRY_COUNT(platform_work_queue_free_entry_count);
 
+// NOTE(hbr): Called with consecutive, disjoint [Begin, End) chunks that cover [0, Count).
+// Zero grain lets the queue pick one based on its worker count.
+typedef void parallel_for_func(void *UserData, u32 Begin, u32 End);
+#define PLATFORM_WORK_QUEUE_PARALLEL_FOR(Name) void Name(work_queue *Queue, u32 Count, u32 Grain, parallel_for_func *Func, void *UserData)
+typedef PLATFORM_WORK_QUEUE_PARALLEL_FOR(platform_work_queue_parallel_for);
+
 #define PLATFORM_INSTRUCTION_SET_SUPPORT(Name) instruction_set_flags Name(void)
 typedef PLATFORM_INSTRUCTION_SET_SUPPORT(platform_instruction_set_support);
 
@@ -267,6 +291,7 @@ struct platform_api
  platform_alloc_virtual_memory *AllocVirtualMemory;
  platform_dealloc_virtual_memory *DeallocVirtualMemory;
  platform_commit_virtual_memory *CommitVirtualMemory;
+ platform_decommit_virtual_memory *DecommitVirtualMemory;
  platform_get_scratch_arena *GetScratchArena;
  
  platform_open_file_dialog *OpenFileDialog;
@@ -279,6 +304,10 @@ struct platform_api
  platform_work_queue_add_entry *WorkQueueAddEntry;
  platform_work_queue_complete_all_work *WorkQueueCompleteAllWork;
  platform_work_queue_free_entry_count *WorkQueueFreeEntryCount;
+ platform_work_queue_add_group_entry *WorkQueueAddGroupEntry;
+ platform_work_queue_add_group_entries *WorkQueueAddGroupEntries;
+ platform_work_queue_complete_group *WorkQueueCompleteGroup;
+ platform_work_queue_parallel_for *WorkQueueParallelFor;
  
  platform_instruction_set_support *InstructionSetSupport;
  
@@ -288,6 +317,7 @@ extern platform_api Platform;
 #define AllocVirtualMemory Platform.AllocVirtualMemory
 #define DeallocVirtualMemory Platform.DeallocVirtualMemory
 #define CommitVirtualMemory Platform.CommitVirtualMemory
+#define DecommitVirtualMemory Platform.DecommitVirtualMemory
 #define TempArena Platform.GetScratchArena
 
 struct editor_memory
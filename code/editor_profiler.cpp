@@ -11,6 +11,8 @@
 #if EDITOR_PROFILER
 
 global profiler *GlobalProfiler;
+// NOTE(hbr): Profiler keeps a single stack of open blocks, so only one thread can use it
+global thread_static b32 GlobalProfilerDisabledOnThisThread;
 
 internal void
 ProfilerInit(profiler *Profiler)
@@ -59,6 +61,25 @@ ProfilerReset(profiler *Profiler)
  ProfilerInit(Profiler);
 }
 
+internal void
+ProfilerDisableOnThisThread(void)
+{
+ GlobalProfilerDisabledOnThisThread = true;
+}
+
+internal void
+ProfilerEnableOnThisThread(void)
+{
+ GlobalProfilerDisabledOnThisThread = false;
+}
+
+internal b32
+ProfilerIsDisabledOnThisThread(void)
+{
+ b32 Result = GlobalProfilerDisabledOnThisThread;
+ return Result;
+}
+
 inline internal void
 __ProfileBegin(char const *Label, char const *File, int Line, u16 AnchorIndex)
 {
@@ -66,67 +87,73 @@ __ProfileBegin(char const *Label, char const *File, int Line, u16 AnchorIndex)
         AnchorIndex < (COMPILATION_UNIT_PROFILER_ANCHOR_INDEX_OFFSET +
                        COMPILATION_UNIT_PROFILER_MAX_ANCHOR_COUNT));
  
- profiler *Profiler = GlobalProfiler;
- profiler_frame *Frame = Profiler->CurrentFrame;
- 
- Assert(Profiler->UsedBlockCount < ArrayCount(Profiler->Blocks));
- profile_block *Block = Profiler->Blocks + Profiler->UsedBlockCount++;
- 
- profile_anchor *Anchor = Frame->Anchors + AnchorIndex;
- 
- Block->OldTotalTSC = Anchor->TotalTSC;
- Block->AnchorIndex.Index = AnchorIndex;
- Block->ParentIndex = Profiler->AnchorParentIndex;
- Profiler->AnchorParentIndex.Index = AnchorIndex;
- Block->Label = Label;
- Block->File = File;
- Block->Line = Line;
- 
- Block->StartTSC = OS_ReadCPUTimer();
+ if (!GlobalProfilerDisabledOnThisThread)
+ {
+  profiler *Profiler = GlobalProfiler;
+  profiler_frame *Frame = Profiler->CurrentFrame;
+  
+  Assert(Profiler->UsedBlockCount < ArrayCount(Profiler->Blocks));
+  profile_block *Block = Profiler->Blocks + Profiler->UsedBlockCount++;
+  
+  profile_anchor *Anchor = Frame->Anchors + AnchorIndex;
+  
+  Block->OldTotalTSC = Anchor->TotalTSC;
+  Block->AnchorIndex.Index = AnchorIndex;
+  Block->ParentIndex = Profiler->AnchorParentIndex;
+  Profiler->AnchorParentIndex.Index = AnchorIndex;
+  Block->Label = Label;
+  Block->File = File;
+  Block->Line = Line;
+  
+  Block->StartTSC = OS_ReadCPUTimer();
+ }
 }
 
 inline internal void
 __ProfileEnd(void)
 {
- u64 EndTSC = OS_ReadCPUTimer();
- 
- profiler *Profiler = GlobalProfiler;
- profiler_frame *Frame = Profiler->CurrentFrame;
- 
- Assert(Profiler->UsedBlockCount > 0);
- profile_block *Block = Profiler->Blocks + --Profiler->UsedBlockCount;
- 
- anchor_index AnchorIndex = Block->AnchorIndex;
- 
- profile_anchor *Anchor = Frame->Anchors + AnchorIndex.Index;
- profile_anchor *Parent = Frame->Anchors + Block->ParentIndex.Index;
- 
- u64 ElapsedTSC = EndTSC - Block->StartTSC;
- 
- Anchor->TotalTSC = Block->OldTotalTSC + ElapsedTSC;
- Anchor->TotalSelfTSC += ElapsedTSC;
- ++Anchor->HitCount;
- Anchor->Parent = Block->ParentIndex;
- Parent->TotalSelfTSC -= ElapsedTSC;
- 
- if (!ProfilerIsAnchorActive(AnchorIndex))
+ if (!GlobalProfilerDisabledOnThisThread)
  {
-  u32 LabelBufferAt = Profiler->LabelBufferAt;
-  u32 SpaceLeft = MAX_PROFILER_LABEL_BUFFER_LENGTH - LabelBufferAt;
+  u64 EndTSC = OS_ReadCPUTimer();
+  
+  profiler *Profiler = GlobalProfiler;
+  profiler_frame *Frame = Profiler->CurrentFrame;
+  
+  Assert(Profiler->UsedBlockCount > 0);
+  profile_block *Block = Profiler->Blocks + --Profiler->UsedBlockCount;
   
-  char *Label = Profiler->LabelBuffer + LabelBufferAt;
-  u32 ToCopy = Min(SpaceLeft, SafeCastU32(CStrLen(Block->Label)));
-  MemoryCopy(Label, Block->Label, ToCopy);
+  anchor_index AnchorIndex = Block->AnchorIndex;
   
-  Profiler->LabelBufferAt = LabelBufferAt + ToCopy;
-  Profiler->AnchorLabels[AnchorIndex.Index] = MakeStr(Label, ToCopy);
+  profile_anchor *Anchor = Frame->Anchors + AnchorIndex.Index;
+  profile_anchor *Parent = Frame->Anchors + Block->ParentIndex.Index;
   
-  profile_anchor_source_code_location *Location = Profiler->AnchorLocations + AnchorIndex.Index;
-  Location->File = Block->File;
-  Location->Line = Block->Line;
+  u64 ElapsedTSC = EndTSC - Block->StartTSC;
+  
+  Anchor->TotalTSC = Block->OldTotalTSC + ElapsedTSC;
+  Anchor->TotalSelfTSC += ElapsedTSC;
+  ++Anchor->HitCount;
+  Anchor->Parent = Block->ParentIndex;
+  Parent->TotalSelfTSC -= ElapsedTSC;
+  
+  if (!ProfilerIsAnchorActive(AnchorIndex))
+  {
+   u32 LabelBufferAt = Profiler->LabelBufferAt;
+   u32 SpaceLeft = MAX_PROFILER_LABEL_BUFFER_LENGTH - LabelBufferAt;
+   
+   char *Label = Profiler->LabelBuffer + LabelBufferAt;
+   u32 ToCopy = Min(SpaceLeft, SafeCastU32(CStrLen(Block->Label)));
+   MemoryCopy(Label, Block->Label, ToCopy);
+   
+   Profiler->LabelBufferAt = LabelBufferAt + ToCopy;
+   Profiler->AnchorLabels[AnchorIndex.Index] = MakeStr(Label, ToCopy);
+   
+   profile_anchor_source_code_location *Location = Profiler->AnchorLocations + AnchorIndex.Index;
+   Location->File = Block->File;
+   Location->Line = Block->Line;
+  }
+  
+  Profiler->AnchorParentIndex = Block->ParentIndex;
  }
- 
- Profiler->AnchorParentIndex = Block->ParentIndex;
 }
 
 inline internal b32
@@ -108,6 +108,9 @@ internal void ProfilerEquip(profiler *Profiler);
 internal void ProfilerBeginFrame(profiler *Profiler);
 internal void ProfilerEndFrame(profiler *Profiler);
 internal void ProfilerReset(profiler *Profiler); // useful when some code hot-reloaded because anchor indices might be stale
+internal void ProfilerDisableOnThisThread(void); // blocks opened on other threads than main one are ignored
+internal void ProfilerEnableOnThisThread(void);
+internal b32  ProfilerIsDisabledOnThisThread(void);
 
 #else
 
@@ -121,6 +124,9 @@ internal void ProfilerReset(profiler *Profiler); // useful when some code hot-re
 #define ProfilerBeginFrame(...)
 #define ProfilerEndFrame(...)
 #define ProfilerReset(...)
+#define ProfilerDisableOnThisThread(...)
+#define ProfilerEnableOnThisThread(...)
+#define ProfilerIsDisabledOnThisThread(...) true
 
 #endif
 
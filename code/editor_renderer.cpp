@@ -280,6 +280,16 @@ ClipSpaceLengthToWorldSpace(render_group *RenderGroup, f32 Clip)
  return World;
 }
 
+internal f32
+PixelLengthToWorldSpace(render_group *RenderGroup, f32 Pixels)
+{
+ // NOTE(hbr): Clip space spans [-1,1] along window height
+ f32 WindowHeight = Cast(f32)Max(RenderGroup->Frame->WindowDim.Y, 1u);
+ f32 Clip = 2.0f * Pixels / WindowHeight;
+ f32 World = ClipSpaceLengthToWorldSpace(RenderGroup, Clip);
+ return World;
+}
+
 internal renderer_transfer_op *
 PushTextureTransfer(renderer_transfer_queue *Queue,
                     u32 TextureWidth, u32 TextureHeight, u64 SizeInBytes,
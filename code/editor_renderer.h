@@ -135,6 +135,7 @@ internal void PushLine(render_group *Group, v2 BeginPoint, v2 EndPoint, f32 Line
 internal void PushTriangle(render_group *Group, v2 P0, v2 P1, v2 P2, rgba Color, f32 ZOffset);
 internal void PushImage(render_group *Group, scale2d Dim, render_texture_handle TextureHandle);
 internal f32 ClipSpaceLengthToWorldSpace(render_group *RenderGroup, f32 Clip);
+internal f32 PixelLengthToWorldSpace(render_group *RenderGroup, f32 Pixels);
 internal void SetTransform(render_group *RenderGroup, mat3 Model, f32 ZOffset);
 internal void ResetTransform(render_group *RenderGroup);
 internal void SetPolygonMode(render_group *RenderGroup, b32 WireFrame);
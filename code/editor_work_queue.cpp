@@ -8,42 +8,346 @@
    Date: September 2025
    ======================================================================== */
 
+// NOTE(hbr): Set on worker threads, tells WorkQueueAddEntry to push into worker's own deque
+global thread_static work_queue_worker *GlobalThreadWorker;
+
+enum work_queue_steal_result
+{
+ WorkQueueSteal_Empty,
+ WorkQueueSteal_Success,
+ WorkQueueSteal_Lost, // raced with another thief or the owner, deque might still have entries
+};
+
+//- chase-lev deque
+// NOTE(hbr): Written for x86 memory model. Loads aren't reordered with other loads and
+// stores with other stores there, so only pop needs a full fence (store Bottom, load Top).
 internal b32
-DoWork(work_queue *Queue)
+WorkQueueDequePush(work_queue_deque *Deque, work_queue_entry Entry)
 {
- b32 ShouldSleep = false;
+ b32 Pushed = false;
  
- u32 EntryIndex = Queue->NextEntryToRead;
- u32 NextEntryIndex = (EntryIndex + 1) % ArrayCount(Queue->Entries);
- u32 NextEntryToWrite = Queue->NextEntryToWrite;
- if (EntryIndex != NextEntryToWrite)
+ u64 Bottom = Deque->Bottom;
+ u64 Top = Deque->Top;
+ if (Bottom - Top < WorkQueueDequeCapacity)
  {
-  if (OS_AtomicCmpExch32(&Queue->NextEntryToRead, EntryIndex, NextEntryIndex) == EntryIndex)
+  Deque->Entries[Bottom & (WorkQueueDequeCapacity - 1)] = Entry;
+  CompilerWriteBarrier;
+  Deque->Bottom = Bottom + 1;
+  Pushed = true;
+ }
+ 
+ return Pushed;
+}
+
+internal b32
+WorkQueueDequePop(work_queue_deque *Deque, work_queue_entry *Entry)
+{
+ b32 Popped = false;
+ 
+ u64 Bottom = Deque->Bottom - 1;
+ Deque->Bottom = Bottom;
+ OS_MemoryBarrier();
+ u64 Top = Deque->Top;
+ 
+ if (Cast(i64)(Bottom - Top) >= 0)
+ {
+  *Entry = Deque->Entries[Bottom & (WorkQueueDequeCapacity - 1)];
+  Popped = true;
+  if (Bottom == Top)
   {
-   work_queue_entry Entry = Queue->Entries[EntryIndex];
-   Entry.Func(Entry.UserData);
-   OS_AtomicIncr32(&Queue->CompletionCount);
+   // NOTE(hbr): Last entry, thieves might be going for it as well
+   if (OS_AtomicCmpExch64(&Deque->Top, Top, Top + 1) != Top)
+   {
+    Popped = false;
+   }
+   Deque->Bottom = Bottom + 1;
   }
  }
  else
  {
-  ShouldSleep = true;
+  Deque->Bottom = Bottom + 1;
+ }
+ 
+ return Popped;
+}
+
+internal work_queue_steal_result
+WorkQueueDequeSteal(work_queue_deque *Deque, work_queue_entry *Entry)
+{
+ work_queue_steal_result Result = WorkQueueSteal_Empty;
+ 
+ u64 Top = Deque->Top;
+ u64 Bottom = Deque->Bottom;
+ if (Cast(i64)(Bottom - Top) > 0)
+ {
+  // NOTE(hbr): Entry might get overwritten by the owner after we read it, but then
+  // Top has moved as well and exchange below fails
+  *Entry = Deque->Entries[Top & (WorkQueueDequeCapacity - 1)];
+  if (OS_AtomicCmpExch64(&Deque->Top, Top, Top + 1) == Top)
+  {
+   Result = WorkQueueSteal_Success;
+  }
+  else
+  {
+   Result = WorkQueueSteal_Lost;
+  }
+ }
+ 
+ return Result;
+}
+
+//- inject queue
+internal void
+WorkQueueInjectInit(work_queue_inject *Inject)
+{
+ ForEachIndex(CellIndex, WorkQueueInjectCapacity)
+ {
+  Inject->Cells[CellIndex].Sequence = CellIndex;
  }
+}
+
+internal b32
+WorkQueueInjectPush(work_queue_inject *Inject, work_queue_entry Entry)
+{
+ b32 Pushed = false;
  
- return ShouldSleep;
+ for (;;)
+ {
+  u64 Pos = Inject->EnqueuePos;
+  work_queue_inject_cell *Cell = Inject->Cells + (Pos & (WorkQueueInjectCapacity - 1));
+  i64 Diff = Cast(i64)(Cell->Sequence - Pos);
+  if (Diff == 0)
+  {
+   if (OS_AtomicCmpExch64(&Inject->EnqueuePos, Pos, Pos + 1) == Pos)
+   {
+    Cell->Entry = Entry;
+    CompilerWriteBarrier;
+    Cell->Sequence = Pos + 1;
+    Pushed = true;
+    break;
+   }
+  }
+  else if (Diff < 0)
+  {
+   // NOTE(hbr): Full
+   break;
+  }
+ }
+ 
+ return Pushed;
+}
+
+internal b32
+WorkQueueInjectPop(work_queue_inject *Inject, work_queue_entry *Entry)
+{
+ b32 Popped = false;
+ 
+ for (;;)
+ {
+  u64 Pos = Inject->DequeuePos;
+  work_queue_inject_cell *Cell = Inject->Cells + (Pos & (WorkQueueInjectCapacity - 1));
+  i64 Diff = Cast(i64)(Cell->Sequence - (Pos + 1));
+  if (Diff == 0)
+  {
+   if (OS_AtomicCmpExch64(&Inject->DequeuePos, Pos, Pos + 1) == Pos)
+   {
+    *Entry = Cell->Entry;
+    CompilerWriteBarrier;
+    Cell->Sequence = Pos + WorkQueueInjectCapacity;
+    Popped = true;
+    break;
+   }
+  }
+  else if (Diff < 0)
+  {
+   // NOTE(hbr): Empty
+   break;
+  }
+ }
+ 
+ return Popped;
+}
+
+//- work queue
+internal work_queue_worker *
+WorkQueueWorkerFromThisThread(work_queue *Queue)
+{
+ work_queue_worker *Worker = GlobalThreadWorker;
+ if (Worker && Worker->Queue != Queue)
+ {
+  Worker = 0;
+ }
+ return Worker;
+}
+
+internal b32
+WorkQueueSteal(work_queue *Queue, work_queue_worker *Thief, work_queue_entry *Entry)
+{
+ b32 Stolen = false;
+ 
+ b32 Lost = true;
+ while (!Stolen && Lost)
+ {
+  Lost = false;
+  u32 FirstVictim = (Thief ? RandomBetween(&Thief->Series, 0, Queue->WorkerCount) : 0);
+  for (u32 VictimOffset = 0;
+       VictimOffset < Queue->WorkerCount && !Stolen;
+       ++VictimOffset)
+  {
+   work_queue_worker *Victim = Queue->Workers + (FirstVictim + VictimOffset) % Queue->WorkerCount;
+   if (Victim != Thief)
+   {
+    work_queue_steal_result Result = WorkQueueDequeSteal(&Victim->Deque, Entry);
+    switch (Result)
+    {
+     case WorkQueueSteal_Empty: {}break;
+     case WorkQueueSteal_Success: {Stolen = true;}break;
+     case WorkQueueSteal_Lost: {Lost = true;}break;
+    }
+   }
+  }
+ }
+ 
+ return Stolen;
+}
+
+// NOTE(hbr): Group usually lives on the waiting thread's stack, it must not be touched
+// after its count drops to zero
+internal void
+WorkQueueFinishEntry(work_queue *Queue, work_queue_group *Group)
+{
+ if (Group)
+ {
+  OS_AtomicAdd64(&Group->PendingCount, Cast(u64)-1);
+ }
+ OS_AtomicAdd64(&Queue->PendingCount, Cast(u64)-1);
+}
+
+// NOTE(hbr): Own deque first (most recently spawned subtasks, still in cache),
+// then entries submitted from outside, then other workers' oldest entries
+internal b32
+DoWork(work_queue *Queue, work_queue_worker *Worker)
+{
+ work_queue_entry Entry = {};
+ b32 Found = false;
+ if (Worker)
+ {
+  Found = WorkQueueDequePop(&Worker->Deque, &Entry);
+ }
+ if (!Found)
+ {
+  Found = WorkQueueInjectPop(Queue->Inject, &Entry);
+ }
+ if (!Found)
+ {
+  Found = WorkQueueSteal(Queue, Worker, &Entry);
+ }
+ 
+ if (Found)
+ {
+  Entry.Func(Entry.UserData);
+  WorkQueueFinishEntry(Queue, Entry.Group);
+ }
+ 
+ return Found;
+}
+
+//- waiting
+// NOTE(hbr): Whether any entry sits in the inject queue or in any worker's deque
+internal b32
+WorkQueueHasQueuedEntries(work_queue *Queue)
+{
+ b32 Result = (Queue->Inject->EnqueuePos != Queue->Inject->DequeuePos);
+ for (u32 WorkerIndex = 0;
+      WorkerIndex < Queue->WorkerCount && !Result;
+      ++WorkerIndex)
+ {
+  work_queue_deque *Deque = &Queue->Workers[WorkerIndex].Deque;
+  u64 Top = Deque->Top;
+  u64 Bottom = Deque->Bottom;
+  Result = (Cast(i64)(Bottom - Top) > 0);
+ }
+ return Result;
+}
+
+// NOTE(hbr): Returns once there might be something to do. Parking goes: read epoch,
+// announce as sleeper, check for entries once more, sleep if epoch didn't change. Producer
+// publishes its entries, fences and then checks for sleepers, so either it sees this
+// sleeper and bumps the epoch, or this sleeper sees its entries.
+internal void
+WorkQueueWaitForWork(work_queue *Queue)
+{
+ work_queue_wait_policy Policy = Queue->WaitPolicy;
+ b32 Found = false;
+ for (u32 SpinIndex = 0;
+      SpinIndex < Policy.SpinCount && !Found;
+      ++SpinIndex)
+ {
+  _mm_pause();
+  Found = WorkQueueHasQueuedEntries(Queue);
+ }
+ for (u32 YieldIndex = 0;
+      YieldIndex < Policy.YieldCount && !Found;
+      ++YieldIndex)
+ {
+  OS_ThreadYield();
+  Found = WorkQueueHasQueuedEntries(Queue);
+ }
+ 
+ if (!Found)
+ {
+  u32 Epoch = Queue->WakeEpoch;
+  OS_AtomicIncr32(&Queue->SleeperCount);
+  if (!WorkQueueHasQueuedEntries(Queue))
+  {
+   OS_FutexWait(&Queue->WakeEpoch, Epoch);
+  }
+  OS_AtomicAdd32(&Queue->SleeperCount, Cast(u32)-1);
+ }
+}
+
+internal void
+WorkQueueWakeWorkers(work_queue *Queue, u32 WakeCount)
+{
+ OS_MemoryBarrier();
+ u32 SleeperCount = Queue->SleeperCount;
+ if (SleeperCount > 0 && WakeCount > 0)
+ {
+  OS_AtomicIncr32(&Queue->WakeEpoch);
+  OS_FutexWake(&Queue->WakeEpoch, Min(WakeCount, SleeperCount));
+ }
+}
+
+internal work_queue_wait_policy
+WorkQueueDefaultWaitPolicy(void)
+{
+ // NOTE(hbr): Roughly tens of microseconds of spinning, then a few yields
+ work_queue_wait_policy Policy = {};
+ Policy.SpinCount = 2048;
+ Policy.YieldCount = 16;
+ return Policy;
 }
 
 internal
 OS_THREAD_FUNC(WorkQueueThreadEntry)
 {
  ThreadCtxInit();
+ // NOTE(hbr): Profiler is main thread only. Entries coming from hot reloaded code still
+ // have to disable it on their own, they see their own copy of this flag.
+ ProfilerDisableOnThisThread();
  
- work_queue *Queue = Cast(work_queue *)ThreadEntryDataPtr;
+ work_queue_worker *Worker = Cast(work_queue_worker *)ThreadEntryDataPtr;
+ work_queue *Queue = Worker->Queue;
+ GlobalThreadWorker = Worker;
+ if (Worker->Pinned)
+ {
+  OS_ThreadSetAffinity(&Worker->Affinity);
+ }
  for (;;)
  {
-  if (DoWork(Queue))
+  if (!DoWork(Queue, Worker))
   {
-   OS_SemaphoreWait(&Queue->Semaphore);
+   WorkQueueWaitForWork(Queue);
   }
  }
  
@@ -55,49 +359,222 @@ OS_THREAD_FUNC(WorkQueueThreadEntry)
 }
 
 internal void
-WorkQueueAddEntry(work_queue *Queue, work_queue_func *Func, void *UserData)
+WorkQueueAddGroupEntries(work_queue *Queue, work_queue_group *Group, work_queue_func *Func, void *UserData, u32 UserDataSize, u32 Count)
 {
- u32 EntryIndex = Queue->NextEntryToWrite;
- u32 NextEntryIndex = (EntryIndex + 1) % ArrayCount(Queue->Entries);
- 
- work_queue_entry *Entry = Queue->Entries + EntryIndex;
- Entry->Func = Func;
- Entry->UserData = UserData;
+ if (Group)
+ {
+  OS_AtomicAdd64(&Group->PendingCount, Count);
+ }
+ OS_AtomicAdd64(&Queue->PendingCount, Count);
  
- CompilerWriteBarrier;
+ work_queue_worker *Worker = WorkQueueWorkerFromThisThread(Queue);
+ u32 PushedCount = 0;
+ ForEachIndex(EntryIndex, Count)
+ {
+  work_queue_entry Entry = {};
+  Entry.Func = Func;
+  Entry.UserData = Cast(u8 *)UserData + EntryIndex * UserDataSize;
+  Entry.Group = Group;
+  
+  b32 Pushed = false;
+  if (Worker)
+  {
+   Pushed = WorkQueueDequePush(&Worker->Deque, Entry);
+  }
+  if (!Pushed)
+  {
+   Pushed = WorkQueueInjectPush(Queue->Inject, Entry);
+  }
+  
+  if (Pushed)
+  {
+   ++PushedCount;
+  }
+  else
+  {
+   // NOTE(hbr): Everything is full, better run it here than drop it. Let others start
+   // on what was pushed so far first.
+   WorkQueueWakeWorkers(Queue, PushedCount);
+   PushedCount = 0;
+   Entry.Func(Entry.UserData);
+   WorkQueueFinishEntry(Queue, Group);
+  }
+ }
  
- Queue->NextEntryToWrite = NextEntryIndex;
- ++Queue->EntryCount;
- OS_SemaphorePost(&Queue->Semaphore);
+ WorkQueueWakeWorkers(Queue, PushedCount);
+}
+
+internal void
+WorkQueueAddGroupEntry(work_queue *Queue, work_queue_group *Group, work_queue_func *Func, void *UserData)
+{
+ WorkQueueAddGroupEntries(Queue, Group, Func, UserData, 0, 1);
+}
+
+internal void
+WorkQueueAddEntry(work_queue *Queue, work_queue_func *Func, void *UserData)
+{
+ WorkQueueAddGroupEntry(Queue, 0, Func, UserData);
+}
+
+internal void
+WorkQueueCompleteGroup(work_queue *Queue, work_queue_group *Group)
+{
+ work_queue_worker *Worker = WorkQueueWorkerFromThisThread(Queue);
+ while (Group->PendingCount != 0)
+ {
+  if (!DoWork(Queue, Worker))
+  {
+   _mm_pause();
+  }
+ }
 }
 
+// NOTE(hbr): Calling thread helps out until every entry added so far, of any group, is
+// finished. Must not be called from inside of an entry running on the same queue.
 internal void
 WorkQueueCompleteAllWork(work_queue *Queue)
 {
- while (Queue->CompletionCount != Queue->EntryCount)
+ work_queue_worker *Worker = WorkQueueWorkerFromThisThread(Queue);
+ while (Queue->PendingCount != 0)
  {
-  DoWork(Queue);
+  if (!DoWork(Queue, Worker))
+  {
+   _mm_pause();
+  }
  }
+}
+
+internal void
+WorkQueueInit(work_queue *Queue, u32 ThreadCount, os_cpu_set *Affinities)
+{
+ Queue->Arena = AllocArena(SizeOf(work_queue_inject) + ThreadCount * SizeOf(work_queue_worker));
+ Queue->Inject = PushStruct(Queue->Arena, work_queue_inject);
+ WorkQueueInjectInit(Queue->Inject);
  
- Queue->CompletionCount = 0;
- Queue->EntryCount = 0;
+ Queue->WorkerCount = ThreadCount;
+ Queue->Workers = PushArray(Queue->Arena, ThreadCount, work_queue_worker);
+ for (u32 WorkerIndex = 0;
+      WorkerIndex < ThreadCount;
+      ++WorkerIndex)
+ {
+  work_queue_worker *Worker = Queue->Workers + WorkerIndex;
+  Worker->Queue = Queue;
+  Worker->Index = WorkerIndex;
+  Worker->Series = RandomSeed(78953890 + 235498 * WorkerIndex);
+  if (Affinities)
+  {
+   Worker->Pinned = true;
+   Worker->Affinity = Affinities[WorkerIndex];
+  }
+ }
+ 
+ Queue->WaitPolicy = WorkQueueDefaultWaitPolicy();
+ for (u32 WorkerIndex = 0;
+      WorkerIndex < ThreadCount;
+      ++WorkerIndex)
+ {
+  OS_ThreadLaunch(WorkQueueThreadEntry, Queue->Workers + WorkerIndex);
+ }
+}
+
+//- parallel for
+// NOTE(hbr): Automatic grain aims at this many chunks per thread, so stealing has
+// something left to even out. Below minimum grain per chunk overhead dominates.
+#define WorkQueueParallelForChunksPerThread 8
+#define WorkQueueParallelForMinGrain 32
+
+// NOTE(hbr): Whether entries queued by the calling thread are still waiting to be picked up
+internal b32
+WorkQueueHasQueuedWork(work_queue *Queue, work_queue_worker *Worker)
+{
+ b32 Result = false;
+ if (Worker)
+ {
+  Result = (Worker->Deque.Bottom > Worker->Deque.Top);
+ }
+ else
+ {
+  Result = (Queue->Inject->EnqueuePos != Queue->Inject->DequeuePos);
+ }
+ return Result;
+}
+
+internal void WorkQueueParallelForRange_Work(void *UserData);
+
+// NOTE(hbr): Lazy binary splitting. Range is processed Grain elements at a time and its
+// upper half is handed off only when everything this thread offered before got stolen.
+// Chunks whose cost differs a lot (NURBS spans of different degree or density) get
+// balanced that way, without splitting everything into tiny entries upfront.
+internal void
+WorkQueueParallelForRun(work_queue_parallel_for *For, u32 Begin, u32 End)
+{
+ work_queue *Queue = For->Queue;
+ work_queue_worker *Worker = WorkQueueWorkerFromThisThread(Queue);
+ while (Begin < End)
+ {
+  u32 Left = End - Begin;
+  if (Left > For->Grain &&
+      For->RangeCount < WorkQueueParallelForMaxRangeCount &&
+      !WorkQueueHasQueuedWork(Queue, Worker))
+  {
+   u32 RangeIndex = OS_AtomicIncr32(&For->RangeCount) - 1;
+   if (RangeIndex < WorkQueueParallelForMaxRangeCount)
+   {
+    u32 Mid = Begin + Left / 2;
+    work_queue_parallel_for_range *Range = For->Ranges + RangeIndex;
+    Range->For = For;
+    Range->Begin = Mid;
+    Range->End = End;
+    WorkQueueAddGroupEntry(Queue, &For->Group, WorkQueueParallelForRange_Work, Range);
+    End = Mid;
+   }
+  }
+  
+  u32 ChunkEnd = Begin + Min(End - Begin, For->Grain);
+  For->Func(For->UserData, Begin, ChunkEnd);
+  Begin = ChunkEnd;
+ }
+}
+
+internal void
+WorkQueueParallelForRange_Work(void *UserData)
+{
+ work_queue_parallel_for_range *Range = Cast(work_queue_parallel_for_range *)UserData;
+ WorkQueueParallelForRun(Range->For, Range->Begin, Range->End);
 }
 
 internal void
-WorkQueueInit(work_queue *Queue, u32 ThreadCount)
+WorkQueueParallelFor(work_queue *Queue, u32 Count, u32 Grain, parallel_for_func *Func, void *UserData)
 {
- OS_SemaphoreAlloc(&Queue->Semaphore, 0, ThreadCount);
- for (u32 ThreadIndex = 0;
-      ThreadIndex < ThreadCount;
-      ++ThreadIndex)
+ if (Grain == 0)
  {
-  OS_ThreadLaunch(WorkQueueThreadEntry, Queue);
+  u32 ThreadCount = Queue->WorkerCount + 1;
+  Grain = Count / (ThreadCount * WorkQueueParallelForChunksPerThread);
+  Grain = Max(Grain, WorkQueueParallelForMinGrain);
  }
+ 
+ work_queue_parallel_for For = {};
+ For.Queue = Queue;
+ For.Func = Func;
+ For.UserData = UserData;
+ For.Grain = Grain;
+ 
+ WorkQueueParallelForRun(&For, 0, Count);
+ WorkQueueCompleteGroup(Queue, &For.Group);
 }
 
+// NOTE(hbr): How many entries the calling thread can add before they start running in place
 internal u32
 WorkQueueFreeEntryCount(work_queue *Queue)
 {
- u32 Result = ArrayCount(Queue->Entries) - Queue->EntryCount;
+ u64 Used = Queue->Inject->EnqueuePos - Queue->Inject->DequeuePos;
+ u64 Free = WorkQueueInjectCapacity - Min(Used, WorkQueueInjectCapacity);
+ work_queue_worker *Worker = WorkQueueWorkerFromThisThread(Queue);
+ if (Worker)
+ {
+  work_queue_deque *Deque = &Worker->Deque;
+  Free += WorkQueueDequeCapacity - (Deque->Bottom - Deque->Top);
+ }
+ u32 Result = SafeCastU32(Free);
  return Result;
-}
\ No newline at end of file
+}
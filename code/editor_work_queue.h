@@ -17,21 +17,108 @@ struct work_queue_entry
 {
  work_queue_func *Func;
  void *UserData;
+ work_queue_group *Group;
+};
+
+// NOTE(hbr): Chase-Lev deque. Only the worker owning it pushes and pops at Bottom,
+// any other thread can steal from Top. Top and Bottom live on separate cache lines.
+#define WorkQueueDequeCapacity 4096
+struct work_queue_deque
+{
+ u64 volatile Top;
+ u8 TopPad[64 - SizeOf(u64)];
+ u64 volatile Bottom;
+ u8 BottomPad[64 - SizeOf(u64)];
+ work_queue_entry Entries[WorkQueueDequeCapacity];
+};
+
+// NOTE(hbr): Bounded multi producer multi consumer queue (Vyukov). Threads that are not
+// workers of the queue (main thread, workers of other queues) submit through it.
+#define WorkQueueInjectCapacity 4096
+struct work_queue_inject_cell
+{
+ u64 volatile Sequence;
+ work_queue_entry Entry;
+};
+struct work_queue_inject
+{
+ u64 volatile EnqueuePos;
+ u8 EnqueuePad[64 - SizeOf(u64)];
+ u64 volatile DequeuePos;
+ u8 DequeuePad[64 - SizeOf(u64)];
+ work_queue_inject_cell Cells[WorkQueueInjectCapacity];
+};
+
+struct work_queue_worker
+{
+ struct work_queue *Queue;
+ u32 Index;
+ random_series Series; // picks steal victims
+ b32 Pinned;
+ os_cpu_set Affinity;
+ work_queue_deque Deque;
+};
+
+// NOTE(hbr): Halves handed off by a running parallel for live here, on the caller's stack
+#define WorkQueueParallelForMaxRangeCount 256
+struct work_queue_parallel_for_range
+{
+ struct work_queue_parallel_for *For;
+ u32 Begin;
+ u32 End;
+};
+struct work_queue_parallel_for
+{
+ struct work_queue *Queue;
+ work_queue_group Group;
+ parallel_for_func *Func;
+ void *UserData;
+ u32 Grain;
+ u32 volatile RangeCount;
+ work_queue_parallel_for_range Ranges[WorkQueueParallelForMaxRangeCount];
+};
+
+// NOTE(hbr): How an idle worker waits for new entries. It spins with pause first, then
+// yields its core, then parks. Spinning keeps wake up latency low for bursts of small
+// dispatches (a few recomputes every frame while dragging), parking gives the core back.
+struct work_queue_wait_policy
+{
+ u32 SpinCount; // pause rounds before yielding
+ u32 YieldCount; // yields before parking
 };
 
 struct work_queue
 {
- u32 volatile EntryCount;
- u32 volatile CompletionCount;
- u32 volatile NextEntryToRead;
- u32 volatile NextEntryToWrite;
- os_semaphore_handle Semaphore;
- work_queue_entry Entries[4096];
+ arena *Arena;
+ u32 WorkerCount;
+ work_queue_worker *Workers;
+ work_queue_inject *Inject;
+ // NOTE(hbr): Entries added but not finished yet
+ u64 volatile PendingCount;
+ // NOTE(hbr): Can be changed at any time, idle workers reread it every time they run out of work
+ work_queue_wait_policy WaitPolicy;
+ // NOTE(hbr): Parked workers sleep on WakeEpoch (futex), producers bump it only when
+ // SleeperCount says that someone might be sleeping
+ u32 volatile WakeEpoch;
+ u32 volatile SleeperCount;
 };
 
-internal void WorkQueueInit(work_queue *Queue, u32 ThreadCount);
+// NOTE(hbr): [Affinities], when given, holds one set of allowed processors per thread
+internal void WorkQueueInit(work_queue *Queue, u32 ThreadCount, os_cpu_set *Affinities = 0);
+internal work_queue_wait_policy WorkQueueDefaultWaitPolicy(void);
+// NOTE(hbr): Safe to call from any thread, including from inside of a running entry
+// (subtasks go straight to the calling worker's own deque)
 internal void WorkQueueAddEntry(work_queue *Queue, work_queue_func *Func, void *UserData);
 internal void WorkQueueCompleteAllWork(work_queue *Queue);
 internal u32 WorkQueueFreeEntryCount(work_queue *Queue);
+internal void WorkQueueAddGroupEntry(work_queue *Queue, work_queue_group *Group, work_queue_func *Func, void *UserData);
+// NOTE(hbr): Adds [Count] entries at once, i-th one gets UserData + i * UserDataSize.
+// Wakes at most as many parked workers as there are entries.
+internal void WorkQueueAddGroupEntries(work_queue *Queue, work_queue_group *Group, work_queue_func *Func, void *UserData, u32 UserDataSize, u32 Count);
+// NOTE(hbr): Calling thread helps out with any entries until all entries of [Group] finish.
+// Can be called from inside of a running entry, as long as that entry isn't part of [Group].
+internal void WorkQueueCompleteGroup(work_queue *Queue, work_queue_group *Group);
+// NOTE(hbr): Returns once all of [0, Count) is processed. Calling thread takes part.
+internal void WorkQueueParallelFor(work_queue *Queue, u32 Count, u32 Grain, parallel_for_func *Func, void *UserData);
 
 #endif //EDITOR_WORK_QUEUE_H
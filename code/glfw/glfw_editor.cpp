@@ -500,7 +500,8 @@ Table[GLFWButton] = PlatformButton
    
    work_queue LowPriorityQueue = {};
    work_queue HighPriorityQueue = {};
-   Platform_MakeWorkQueues(&LowPriorityQueue, &HighPriorityQueue);
+   platform_work_queue_options WorkQueueOptions = Platform_ParseWorkQueueOptions(ArgCount, Args);
+   Platform_MakeWorkQueues(WorkQueueOptions, &LowPriorityQueue, &HighPriorityQueue);
    
    renderer *Renderer = GLFWRendererInit(PermamentArena, &RendererMemory, Window);
    
@@ -18,18 +18,160 @@
 #include "editor_work_queue.cpp"
 #include "editor_profiler.cpp"
 
+internal platform_work_queue_options
+Platform_ParseWorkQueueOptions(int ArgCount, char *Args[])
+{
+ platform_work_queue_options Options = {};
+ Options.HighPriorityWaitPolicy = WorkQueueDefaultWaitPolicy();
+ for (int ArgIndex = 1; ArgIndex < ArgCount; ++ArgIndex)
+ {
+  string Arg = StrFromCStr(Args[ArgIndex]);
+  string HighFlag = StrLit("--high-priority-threads=");
+  string LowFlag = StrLit("--low-priority-threads=");
+  string SpinFlag = StrLit("--worker-spin=");
+  string YieldFlag = StrLit("--worker-yield=");
+  if (StrStartsWith(Arg, HighFlag))
+  {
+   if (!U32FromStr(StrSuffix(Arg, Arg.Count - HighFlag.Count), &Options.HighPriorityThreadCount))
+   {
+    OS_PrintErrorF("[invalid thread count: %S]\n", Arg);
+   }
+  }
+  else if (StrStartsWith(Arg, LowFlag))
+  {
+   if (!U32FromStr(StrSuffix(Arg, Arg.Count - LowFlag.Count), &Options.LowPriorityThreadCount))
+   {
+    OS_PrintErrorF("[invalid thread count: %S]\n", Arg);
+   }
+  }
+  else if (StrStartsWith(Arg, SpinFlag))
+  {
+   if (!U32FromStr(StrSuffix(Arg, Arg.Count - SpinFlag.Count), &Options.HighPriorityWaitPolicy.SpinCount))
+   {
+    OS_PrintErrorF("[invalid spin count: %S]\n", Arg);
+   }
+  }
+  else if (StrStartsWith(Arg, YieldFlag))
+  {
+   if (!U32FromStr(StrSuffix(Arg, Arg.Count - YieldFlag.Count), &Options.HighPriorityWaitPolicy.YieldCount))
+   {
+    OS_PrintErrorF("[invalid yield count: %S]\n", Arg);
+   }
+  }
+  else if (StrEqual(Arg, StrLit("--no-pin")))
+  {
+   Options.NoPinning = true;
+  }
+ }
+ 
+ return Options;
+}
+
+// NOTE(hbr): Background work (image loading, saving, async recomputes) rarely has more
+// than a few things to do at once
+#define PlatformMaxLowPriorityThreadCount 4
+
+// NOTE(hbr): Recompute, which the user waits for, runs on one hardware thread per physical
+// performance core of a single NUMA node. Its workers then neither share a core nor reach
+// for memory of the other socket. Main thread helps with the recompute, so it is kept on
+// that node and one core is left for it. Background work gets everything else: SMT
+// siblings, efficiency cores and other nodes.
 internal void
-Platform_MakeWorkQueues(work_queue *LowPriorityQueue, work_queue *HighPriorityQueue)
+Platform_MakeWorkQueues(platform_work_queue_options Options, work_queue *LowPriorityQueue, work_queue *HighPriorityQueue)
 {
- u32 ProcCount = OS_ProcCount();
+ temp_arena Temp = TempArena(0);
+ os_cpu_topology Topology = OS_CPUTopology(Temp.Arena);
+ 
+ // NOTE(hbr): Home node is the one with the most performance cores
+ u32 HomeNode = 0;
+ u32 HomeCoreCount = 0;
+ for (u32 Node = 0; Node < Topology.NodeCount; ++Node)
+ {
+  u32 CoreCount = 0;
+  ForEachIndex(CPUIndex, Topology.CPUCount)
+  {
+   os_cpu *Cpu = Topology.CPUs + CPUIndex;
+   CoreCount += (Cpu->Node == Node && Cpu->FirstSibling && !Cpu->Efficient);
+  }
+  if (CoreCount > HomeCoreCount)
+  {
+   HomeNode = Node;
+   HomeCoreCount = CoreCount;
+  }
+ }
+ 
+ u32 *HomeCores = PushArrayNonZero(Temp.Arena, HomeCoreCount, u32);
+ u32 HomeCoreIndex = 0;
+ os_cpu_set HomeCPUs = {};
+ os_cpu_set RestCPUs = {};
+ ForEachIndex(CPUIndex, Topology.CPUCount)
+ {
+  os_cpu *Cpu = Topology.CPUs + CPUIndex;
+  if (Cpu->Node == HomeNode)
+  {
+   OS_CPUSetAdd(&HomeCPUs, Cpu->Index);
+  }
+  if (Cpu->Node == HomeNode && Cpu->FirstSibling && !Cpu->Efficient)
+  {
+   HomeCores[HomeCoreIndex++] = Cpu->Index;
+  }
+  else
+  {
+   OS_CPUSetAdd(&RestCPUs, Cpu->Index);
+  }
+ }
+ u32 RestCPUCount = OS_CPUSetCount(&RestCPUs);
  
- u32 LowPriorityThreadCount = 1;
- u32 HighPriorityThreadCount = ProcCount - 1;
+ u32 HighPriorityThreadCount = 0;
+ u32 LowPriorityThreadCount = 0;
+ b32 Pin = (HomeCoreCount > 0 && !Options.NoPinning);
+ if (HomeCoreCount > 0)
+ {
+  HighPriorityThreadCount = HomeCoreCount - 1;
+  LowPriorityThreadCount = Min(RestCPUCount, PlatformMaxLowPriorityThreadCount);
+ }
+ else
+ {
+  // NOTE(hbr): Topology unknown
+  HighPriorityThreadCount = OS_ProcCount() - 1;
+  LowPriorityThreadCount = 1;
+ }
+ if (Options.HighPriorityThreadCount) HighPriorityThreadCount = Options.HighPriorityThreadCount;
+ if (Options.LowPriorityThreadCount) LowPriorityThreadCount = Options.LowPriorityThreadCount;
  LowPriorityThreadCount = ClampBot(LowPriorityThreadCount, 1);
  HighPriorityThreadCount = ClampBot(HighPriorityThreadCount, 1);
  
- WorkQueueInit(LowPriorityQueue, LowPriorityThreadCount);
- WorkQueueInit(HighPriorityQueue, HighPriorityThreadCount);
+ os_cpu_set *HighPriorityAffinities = 0;
+ os_cpu_set *LowPriorityAffinities = 0;
+ if (Pin)
+ {
+  OS_ThreadSetAffinity(&HomeCPUs);
+  
+  // NOTE(hbr): First core is left for the main thread, unless there are more workers than cores
+  HighPriorityAffinities = PushArray(Temp.Arena, HighPriorityThreadCount, os_cpu_set);
+  ForEachIndex(WorkerIndex, HighPriorityThreadCount)
+  {
+   u32 CPU = HomeCores[(WorkerIndex + 1) % HomeCoreCount];
+   OS_CPUSetAdd(HighPriorityAffinities + WorkerIndex, CPU);
+  }
+  
+  os_cpu_set LowPriorityCPUs = (RestCPUCount > 0 ? RestCPUs : HomeCPUs);
+  LowPriorityAffinities = PushArray(Temp.Arena, LowPriorityThreadCount, os_cpu_set);
+  ForEachIndex(WorkerIndex, LowPriorityThreadCount)
+  {
+   LowPriorityAffinities[WorkerIndex] = LowPriorityCPUs;
+  }
+ }
+ 
+ WorkQueueInit(LowPriorityQueue, LowPriorityThreadCount, LowPriorityAffinities);
+ WorkQueueInit(HighPriorityQueue, HighPriorityThreadCount, HighPriorityAffinities);
+ 
+ // NOTE(hbr): Nobody waits on background work, its workers park right away
+ work_queue_wait_policy ParkPolicy = {};
+ LowPriorityQueue->WaitPolicy = ParkPolicy;
+ HighPriorityQueue->WaitPolicy = Options.HighPriorityWaitPolicy;
+ 
+ EndTemp(Temp);
 }
 
 internal editor_memory
@@ -163,6 +305,7 @@ platform_api Platform = {
  OS_Reserve,
  OS_Release,
  OS_Commit,
+ OS_Decommit,
  ThreadCtxGetScratch,
  OS_OpenFileDialog,
  OS_SaveFileDialog,
@@ -173,6 +316,10 @@ platform_api Platform = {
  WorkQueueAddEntry,
  WorkQueueCompleteAllWork,
  WorkQueueFreeEntryCount,
+ WorkQueueAddGroupEntry,
+ WorkQueueAddGroupEntries,
+ WorkQueueCompleteGroup,
+ WorkQueueParallelFor,
  OS_InstructionSetSupport,
  
  {
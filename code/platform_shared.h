@@ -17,6 +17,7 @@
 #include "base/base_arena.h"
 #include "base/base_thread_ctx.h"
 #include "base/base_hot_reload.h"
+#include "base/base_random.h"
 
 #include "editor_math.h"
 #include "editor_imgui.h"
@@ -40,6 +41,15 @@ struct platform_clock
  u64 CPU_TimerFreq;
 };
 
+// NOTE(hbr): Overrides from the command line, zero thread count means pick it from CPU topology
+struct platform_work_queue_options
+{
+ u32 HighPriorityThreadCount;
+ u32 LowPriorityThreadCount;
+ b32 NoPinning;
+ work_queue_wait_policy HighPriorityWaitPolicy;
+};
+
 struct main_window_params
 {
  v2u LeftCornerP;
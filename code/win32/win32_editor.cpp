@@ -411,7 +411,8 @@ EntryPoint(int ArgCount, char **Args)
    
    work_queue LowPriorityQueue = {};
    work_queue HighPriorityQueue = {};
-   Platform_MakeWorkQueues(&LowPriorityQueue, &HighPriorityQueue);
+   platform_work_queue_options WorkQueueOptions = Platform_ParseWorkQueueOptions(ArgCount, Args);
+   Platform_MakeWorkQueues(WorkQueueOptions, &LowPriorityQueue, &HighPriorityQueue);
    
    //- init editor stuff
    editor_function_table EditorFunctions = {};